@@ -28,6 +28,8 @@ struct bt_event;
 /* Functions */
 struct bt_event *bt_event_create(
 		struct bt_event_class *event_class);
+struct bt_event *bt_event_create_empty(
+		struct bt_event_class *event_class);
 struct bt_event_class *bt_event_get_class(
 		struct bt_event *event);
 struct bt_packet *bt_event_get_packet(
@@ -2649,15 +2649,26 @@ int cmd_run(struct bt_config *cfg)
 			}
 
 			if (cfg->cmd_data.run.retry_duration_us > 0) {
-				BT_LOGV("Got BT_GRAPH_STATUS_AGAIN: sleeping: "
-					"time-us=%" PRIu64,
-					cfg->cmd_data.run.retry_duration_us);
+				enum bt_graph_status wait_status;
 
-				if (usleep(cfg->cmd_data.run.retry_duration_us)) {
-					if (bt_graph_is_canceled(ctx.graph)) {
-						BT_LOGI_STR("Graph was canceled by user.");
-						goto error;
-					}
+				/*
+				 * Wake up as soon as a component is
+				 * ready, or after the retry duration.
+				 */
+				BT_LOGV("Got BT_GRAPH_STATUS_AGAIN: waiting: "
+					"timeout-us=%" PRIu64,
+					cfg->cmd_data.run.retry_duration_us);
+				wait_status = bt_graph_wait(ctx.graph,
+					cfg->cmd_data.run.retry_duration_us);
+				if (wait_status == BT_GRAPH_STATUS_CANCELED) {
+					BT_LOGI_STR("Graph was canceled by user.");
+					goto error;
+				} else if (wait_status != BT_GRAPH_STATUS_OK) {
+					BT_LOGE("Cannot wait for the graph: "
+						"status=%s",
+						bt_graph_status_str(wait_status));
+					fprintf(stderr, "Cannot wait for the graph\n");
+					goto error;
 				}
 			}
 			break;
@@ -1246,3 +1246,18 @@ size_t bt_common_get_page_size(void)
 
 	return page_size;
 }
+
+BT_HIDDEN
+unsigned int bt_common_get_online_cpu_count(void)
+{
+	long count;
+
+	count = bt_sysconf(_SC_NPROCESSORS_ONLN);
+	if (count < 1) {
+		BT_LOGW("Cannot get system's number of online processors: "
+			"ret=%ld", count);
+		count = 1;
+	}
+
+	return (unsigned int) count;
+}
@@ -95,6 +95,36 @@ bool bt_socket_interrupted(void)
 	return false;
 }
 
+static inline
+int bt_socket_set_nonblocking(int sockfd)
+{
+	u_long mode = 1;
+
+	return ioctlsocket(sockfd, FIONBIO, &mode);
+}
+
+static inline
+bool bt_socket_would_block(void)
+{
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+
+/*
+ * Waits until `sockfd` is readable, or writable if `writable` is true.
+ */
+static inline
+int bt_socket_wait(int sockfd, bool writable)
+{
+	fd_set fds;
+	int ret;
+
+	FD_ZERO(&fds);
+	FD_SET(sockfd, &fds);
+	ret = select(sockfd + 1, writable ? NULL : &fds,
+		writable ? &fds : NULL, NULL, NULL);
+	return ret < 0 ? SOCKET_ERROR : 0;
+}
+
 static inline
 const char *bt_socket_errormsg(void)
 {
@@ -275,6 +305,9 @@ const char *bt_socket_errormsg(void)
 #else /* __MINGW32__ */
 
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netdb.h>
@@ -319,6 +352,38 @@ bool bt_socket_interrupted(void)
 	return (errno == EINTR);
 }
 
+static inline
+int bt_socket_set_nonblocking(int sockfd)
+{
+	int flags = fcntl(sockfd, F_GETFL);
+
+	if (flags < 0) {
+		return -1;
+	}
+
+	return fcntl(sockfd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static inline
+bool bt_socket_would_block(void)
+{
+	return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+/*
+ * Waits until `sockfd` is readable, or writable if `writable` is true.
+ */
+static inline
+int bt_socket_wait(int sockfd, bool writable)
+{
+	struct pollfd pollfd = {
+		.fd = sockfd,
+		.events = writable ? POLLOUT : POLLIN,
+	};
+
+	return poll(&pollfd, 1, -1) < 0 ? -1 : 0;
+}
+
 static inline
 const char *bt_socket_errormsg(void)
 {
@@ -66,4 +66,13 @@ void bt_clock_class_serialize(struct bt_clock_class *clock_class,
 BT_HIDDEN
 bt_bool bt_clock_class_is_valid(struct bt_clock_class *clock_class);
 
+/*
+ * Converts a value of a clock described by a clock class to nanoseconds
+ * from Epoch. Returns a negative value if the result overflows the
+ * signed 64-bit integer range.
+ */
+BT_HIDDEN
+int bt_clock_class_cycles_to_ns_from_epoch(struct bt_clock_class *clock_class,
+		uint64_t value, int64_t *ns_from_epoch);
+
 #endif /* BABELTRACE_CTF_IR_CLOCK_CLASS_INTERNAL_H */
@@ -36,7 +36,37 @@
 #include <babeltrace/ctf-ir/stream.h>
 #include <babeltrace/ctf-ir/event-class.h>
 #include <babeltrace/object-internal.h>
+#include <babeltrace/object-pool-internal.h>
 #include <glib.h>
+#include <stdbool.h>
+
+/*
+ * Maximum number of released events which an event class keeps in its
+ * event pool. An event class usually has few live events at a time
+ * (one per stream being decoded, plus the ones which sinks and filters
+ * keep), so this is enough to reuse them without keeping the events of
+ * a burst forever.
+ */
+#define BT_EVENT_CLASS_EVENT_POOL_MAX_COUNT	64
+
+/*
+ * Validated field types from which bt_event_create() creates the
+ * fields of an event. They are set when the first event of an event
+ * class is created: the event class (frozen when it was added to its
+ * stream class) and its stream class (frozen by
+ * init_event_template()) cannot change afterwards, so neither can
+ * these field types.
+ *
+ * init_event_template() does not freeze the trace, and it does not
+ * need to: the template contains none of its field types.
+ */
+struct bt_event_template {
+	struct bt_field_type *event_header_type;
+	struct bt_field_type *stream_event_ctx_type;
+	struct bt_field_type *event_context_type;
+	struct bt_field_type *event_payload_type;
+	bool is_set;
+};
 
 struct bt_event_class {
 	struct bt_object base;
@@ -59,6 +89,16 @@ struct bt_event_class {
 	int64_t id;
 	enum bt_event_class_log_level log_level;
 	GString *emf_uri;
+
+	/*
+	 * Pool of events created from this event class and released
+	 * since, with their (reset) fields: bt_event_create() reuses
+	 * them instead of allocating new events and field trees. It
+	 * keeps at most BT_EVENT_CLASS_EVENT_POOL_MAX_COUNT events.
+	 */
+	struct bt_object_pool event_pool;
+
+	struct bt_event_template event_template;
 };
 
 BT_HIDDEN
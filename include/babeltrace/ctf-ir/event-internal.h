@@ -35,10 +35,23 @@
 #include <babeltrace/ctf-ir/stream.h>
 #include <babeltrace/ctf-ir/packet.h>
 #include <babeltrace/object-internal.h>
+#include <babeltrace/types.h>
 #include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <glib.h>
 
 struct bt_stream_pos;
+struct bt_clock_class;
+
+/* Number of clock values which an event stores inline */
+#define BT_EVENT_INLINE_CLOCK_VALUE_COUNT	2
+
+struct bt_event_clock_value {
+	/* Raw value (cycles) */
+	uint64_t cycles;
+	bool is_set;
+};
 
 struct bt_event {
 	struct bt_object base;
@@ -48,8 +61,17 @@ struct bt_event {
 	struct bt_field *stream_event_context;
 	struct bt_field *context_payload;
 	struct bt_field *fields_payload;
-	/* Maps clock classes to bt_clock_value. */
-	GHashTable *clock_values;
+
+	/*
+	 * Clock values, indexed by the index of their clock class
+	 * within the event's trace (see
+	 * bt_trace_get_clock_class_index()). Most traces have one or
+	 * two clock classes: the first values are stored inline, and
+	 * extra_clock_values (array of struct bt_event_clock_value,
+	 * NULL if not needed) contains the others.
+	 */
+	struct bt_event_clock_value clock_values[BT_EVENT_INLINE_CLOCK_VALUE_COUNT];
+	GArray *extra_clock_values;
 	int frozen;
 };
 
@@ -64,6 +86,20 @@ int bt_event_serialize(struct bt_event *event,
 BT_HIDDEN
 void bt_event_freeze(struct bt_event *event);
 
+/*
+ * Destroys an event which was recycled into its class's event pool.
+ */
+BT_HIDDEN
+void bt_event_destroy_recycled(struct bt_event *event);
+
+/*
+ * Returns whether or not an event has a value for the clock described
+ * by a given clock class.
+ */
+BT_HIDDEN
+bt_bool bt_event_has_clock_value(struct bt_event *event,
+		struct bt_clock_class *clock_class);
+
 static inline struct bt_packet *bt_event_borrow_packet(
 		struct bt_event *event)
 {
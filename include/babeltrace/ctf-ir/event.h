@@ -70,7 +70,9 @@ As a reminder, here's the structure of a CTF packet:
 You can create a CTF IR event \em from a
 \link ctfireventclass CTF IR event class\endlink with
 bt_event_create(). The event class you use to create an event
-object becomes its parent.
+object becomes its parent. If you set all the fields of the event
+yourself, for example with the fields of another event, create it
+without fields with bt_event_create_empty() instead.
 
 If the \link ctfirtraceclass CTF IR trace class\endlink of an event
 object (parent of its \link ctfirstreamclass CTF IR stream class\endlink,
@@ -165,12 +167,62 @@ with bt_trace_add_stream_class(), then this function fails.
 extern struct bt_event *bt_event_create(
 		struct bt_event_class *event_class);
 
+/**
+@brief  Creates a CTF IR event without fields from the CTF IR event
+	class \p event_class.
+
+This function is bt_event_create(), except that it does not create
+the fields of the event: the created event has no stream event
+header, stream event context, event context, and event payload
+fields. Use this function instead of bt_event_create() when you set
+fields which you create or get elsewhere, for example the fields of
+another event, to avoid creating fields which you would replace.
+
+Until you set a field with bt_event_set_header(),
+bt_event_set_stream_event_context(), bt_event_set_event_context(), or
+bt_event_set_event_payload(), the corresponding getter,
+bt_event_get_header(), bt_event_get_stream_event_context(),
+bt_event_get_event_context(), or bt_event_get_event_payload(),
+returns \c NULL.
+
+Before you call bt_notification_event_create() or
+bt_stream_append_event() with the created event, you \em must set
+each of its fields which is described by a field type of
+\p event_class or of its parent stream class. bt_notification_event_create()
+does not check that those fields are set: the consumers of the
+notification would get \c NULL fields.
+
+An event field which you set can be shared with other objects, for
+example the event from which you get it. When you put the last
+reference of the created event, it releases the fields which are
+shared and keeps the others for its next reuse.
+
+As with bt_event_create(), this function resolves the dynamic field
+types of \p event_class and of its parent stream class, and fails if
+any automatic resolving fails.
+
+@param[in] event_class	CTF IR event class to use to create the
+			CTF IR event.
+@returns		Created event object without fields, or \c NULL
+			on error.
+
+@prenotnull{event_class}
+@pre \p event_class has a parent stream class.
+@postsuccessrefcountret1
+@post <strong>On success</strong>, the returned event has no fields.
+
+@sa bt_event_create(): Creates a default CTF IR event.
+*/
+extern struct bt_event *bt_event_create_empty(
+		struct bt_event_class *event_class);
+
 /**
 @brief	Returns the parent CTF IR event class of the CTF IR event
 	\p event.
 
 This function returns a reference to the event class which was used to
-create the event object in the first place with bt_event_create().
+create the event object in the first place with bt_event_create() or
+bt_event_create_empty().
 
 @param[in] event	Event of which to get the parent event class.
 @returns		Parent event class of \p event,
@@ -563,6 +615,98 @@ extern int bt_event_set_clock_value(
 		struct bt_event *event,
 		struct bt_clock_value *clock_value);
 
+/**
+@brief	Returns the raw value (cycles), as of the CTF IR event
+	\p event, of the clock described by the
+	\link ctfirclockclass CTF IR clock class\endlink \p clock_class.
+
+Unlike bt_event_get_clock_value(), this function does not create a
+clock value object.
+
+@param[in] event	Event of which to get the value of the clock
+			described by \p clock_class.
+@param[in] clock_class	Class of the clock of which to get the value.
+@param[out] cycles	Returned raw value of the clock described by
+			\p clock_class as of \p event.
+@returns		0 on success, or a negative value on error,
+			including if \p event has no value for the clock
+			described by \p clock_class.
+
+@prenotnull{event}
+@prenotnull{clock_class}
+@prenotnull{cycles}
+@postrefcountsame{event}
+@postrefcountsame{clock_class}
+
+@sa bt_event_set_clock_value_cycles(): Sets the raw clock value of a
+	given event.
+*/
+extern int bt_event_get_clock_value_cycles(
+		struct bt_event *event,
+		struct bt_clock_class *clock_class, uint64_t *cycles);
+
+/**
+@brief	Returns the value, as of the CTF IR event \p event, of the
+	clock described by the
+	\link ctfirclockclass CTF IR clock class\endlink \p clock_class,
+	converted to nanoseconds from Epoch.
+
+Unlike bt_event_get_clock_value(), this function does not create a
+clock value object.
+
+@param[in] event	Event of which to get the value of the clock
+			described by \p clock_class.
+@param[in] clock_class	Class of the clock of which to get the value.
+@param[out] ns_from_epoch Returned value of the clock described by
+			\p clock_class as of \p event, in nanoseconds
+			from Epoch.
+@returns		0 on success, or a negative value on error,
+			including if \p event has no value for the clock
+			described by \p clock_class, or if the result
+			overflows the signed 64-bit integer range.
+
+@prenotnull{event}
+@prenotnull{clock_class}
+@prenotnull{ns_from_epoch}
+@postrefcountsame{event}
+@postrefcountsame{clock_class}
+
+@sa bt_clock_value_get_value_ns_from_epoch(): Returns the value of a
+	clock value object in nanoseconds from Epoch.
+*/
+extern int bt_event_get_clock_value_ns_from_epoch(
+		struct bt_event *event,
+		struct bt_clock_class *clock_class, int64_t *ns_from_epoch);
+
+/**
+@brief	Sets the raw value (cycles), as of the CTF IR event \p event,
+	of the clock described by the
+	\link ctfirclockclass CTF IR clock class\endlink \p clock_class.
+
+Unlike bt_event_set_clock_value(), this function does not need a
+clock value object.
+
+@param[in] event	Event of which to set the value of the clock
+			described by \p clock_class.
+@param[in] clock_class	Class of the clock of which to set the value.
+			It must be part of the trace of \p event.
+@param[in] cycles	Raw value of the clock described by
+			\p clock_class as of \p event.
+@returns		0 on success, or a negative value on error.
+
+@prenotnull{event}
+@prenotnull{clock_class}
+@prehot{event}
+@postrefcountsame{event}
+@postrefcountsame{clock_class}
+
+@sa bt_event_get_clock_value_cycles(): Returns the raw clock value of
+	a given event.
+*/
+extern int bt_event_set_clock_value_cycles(
+		struct bt_event *event,
+		struct bt_clock_class *clock_class, uint64_t cycles);
+
 /** @} */
 
 /** @} */
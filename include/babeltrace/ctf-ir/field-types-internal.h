@@ -39,6 +39,8 @@
 #include <babeltrace/types.h>
 #include <glib.h>
 
+struct bt_field_structure_layout;
+
 typedef void (*type_freeze_func)(struct bt_field_type *);
 typedef int (*type_serialize_func)(struct bt_field_type *,
 		struct metadata_context *);
@@ -86,12 +88,55 @@ struct enumeration_mapping {
 	GQuark string;
 };
 
+/*
+ * Range of container values of an enumeration field type which all
+ * the same mappings contain.
+ *
+ * The values are stored as keys which have the order of the values:
+ * the value itself for an unsigned container, and the value with its
+ * sign bit flipped for a signed container.
+ */
+struct enumeration_index_interval {
+	uint64_t first_key;
+	uint64_t last_key;
+
+	/* Position of the first mapping in the index's mapping arrays */
+	guint first;
+
+	/* Number of mappings which contain this range (at least 1) */
+	guint count;
+};
+
+/*
+ * Mapping lookup index of an enumeration field type, built when it is
+ * frozen.
+ */
+struct enumeration_index {
+	/*
+	 * Array of struct enumeration_index_interval, sorted by key,
+	 * without overlaps. Values which no mapping contains are not
+	 * part of any interval.
+	 */
+	GArray *intervals;
+
+	/*
+	 * Indexes (guint) and names (const char *, static strings) of
+	 * the mappings of each interval, in the order of the
+	 * enumeration field type's entries.
+	 */
+	GArray *mapping_indexes;
+	GPtrArray *mapping_names;
+};
+
 struct bt_field_type_enumeration {
 	struct bt_field_type parent;
 	struct bt_field_type *container;
 	GPtrArray *entries; /* Array of ptrs to struct enumeration_mapping */
 	/* Only set during validation. */
 	bt_bool has_overlapping_ranges;
+
+	/* Owned by this; NULL until the field type is frozen */
+	struct enumeration_index *index;
 };
 
 enum bt_field_type_enumeration_mapping_iterator_type {
@@ -128,6 +173,9 @@ struct bt_field_type_structure {
 	struct bt_field_type parent;
 	GHashTable *field_name_to_index;
 	GPtrArray *fields; /* Array of pointers to struct structure_field */
+
+	/* Layout of this type's structure fields, set when frozen */
+	struct bt_field_structure_layout *field_layout;
 };
 
 struct bt_field_type_variant {
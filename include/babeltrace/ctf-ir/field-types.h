@@ -1231,6 +1231,14 @@ operations:
 Those functions return a @enumftiter on the result set of the find
 operation.
 
+Once an enumeration field type is frozen, you can also get the names of
+the mappings which contain a given value, without allocating anything,
+with bt_field_type_enumeration_get_mapping_names_by_unsigned_value() or
+bt_field_type_enumeration_get_mapping_names_by_signed_value(). The
+mappings of a frozen enumeration field type are indexed so that those
+functions, as well as the find operations by value, do not visit all
+its mappings.
+
 Many mappings can share the same name, and the ranges of a given
 enumeration field type are allowed to overlap. For example,
 this is a valid set of mappings:
@@ -1505,6 +1513,77 @@ bt_field_type_enumeration_find_mappings_by_unsigned_value(
 		struct bt_field_type *enum_field_type,
 		uint64_t value);
 
+/**
+@brief  Returns the names of the mappings of the frozen @enumft
+	\p enum_field_type which contain the signed value \p value in
+	their range.
+
+On success, \p *names is an array of the names of the mappings which
+contain \p value, in the order in which they were added to
+\p enum_field_type, of which the length is the returned value.
+\p enum_field_type remains the sole owner of this array, which remains
+valid as long as \p enum_field_type exists. \p *names is \c NULL if no
+mappings contain \p value.
+
+This function does not allocate memory.
+
+@param[in] enum_field_type	Enumeration field type of which to find
+				the mappings which contain \p value.
+@param[in] value		Value to find in the ranges of the
+				mappings of \p enum_field_type.
+@param[out] names		Returned names of the mappings of
+				\p enum_field_type which contain
+				\p value.
+@returns			Number of names in \p *names, or a
+				negative value on error.
+
+@prenotnull{enum_field_type}
+@prenotnull{names}
+@preisenumft{enum_field_type}
+@pre \p enum_field_type is frozen.
+@pre The wrapped @intft of \p enum_field_type is signed.
+@postrefcountsame{enum_field_type}
+
+@sa bt_field_type_enumeration_find_mappings_by_signed_value(): Finds
+	the mappings of a given enumeration field type which contain
+	a given signed value in their range.
+*/
+extern int64_t bt_field_type_enumeration_get_mapping_names_by_signed_value(
+		struct bt_field_type *enum_field_type, int64_t value,
+		const char * const **names);
+
+/**
+@brief  Returns the names of the mappings of the frozen @enumft
+	\p enum_field_type which contain the unsigned value \p value in
+	their range.
+
+See bt_field_type_enumeration_get_mapping_names_by_signed_value().
+
+@param[in] enum_field_type	Enumeration field type of which to find
+				the mappings which contain \p value.
+@param[in] value		Value to find in the ranges of the
+				mappings of \p enum_field_type.
+@param[out] names		Returned names of the mappings of
+				\p enum_field_type which contain
+				\p value.
+@returns			Number of names in \p *names, or a
+				negative value on error.
+
+@prenotnull{enum_field_type}
+@prenotnull{names}
+@preisenumft{enum_field_type}
+@pre \p enum_field_type is frozen.
+@pre The wrapped @intft of \p enum_field_type is unsigned.
+@postrefcountsame{enum_field_type}
+
+@sa bt_field_type_enumeration_find_mappings_by_unsigned_value(): Finds
+	the mappings of a given enumeration field type which contain
+	a given unsigned value in their range.
+*/
+extern int64_t bt_field_type_enumeration_get_mapping_names_by_unsigned_value(
+		struct bt_field_type *enum_field_type, uint64_t value,
+		const char * const **names);
+
 /**
 @brief  Adds a mapping to the @enumft \p enum_field_type which maps the
 	name \p name to the signed range \p range_begin (included) to
@@ -63,9 +63,43 @@ struct bt_field_floating_point {
 	double payload;
 };
 
+/*
+ * A structure field is allocated as a single block which also contains
+ * its array of member field pointers and, as laid out by its type's
+ * struct bt_field_structure_layout, its inline member fields.
+ *
+ * An inline member field is not allocated on its own: its reference
+ * count is 0 as long as it is only owned by its structure field, and
+ * it has the root of its field tree (the field which owns the block)
+ * as parent object, so that getting a reference on it keeps the whole
+ * block alive.
+ *
+ * A member can be replaced (see bt_field_structure_set_field_by_name()),
+ * in which case its inline field remains unused until the block is
+ * destroyed.
+ */
 struct bt_field_structure {
 	struct bt_field parent;
-	GPtrArray *fields; /* Array of pointers to struct bt_field */
+	struct bt_field **fields; /* Array of pointers to struct bt_field */
+	uint64_t field_count;
+};
+
+/*
+ * Layout of the structure fields of a given structure field type.
+ *
+ * Integer, floating point number, enumeration, string, and structure
+ * members are inline: they are part of their structure field's block.
+ * Array, sequence, and variant members are created on their own.
+ */
+struct bt_field_structure_layout {
+	/* Size of a structure field's block, inline members included */
+	size_t size;
+
+	/*
+	 * Offset of each member field within the block, 0 if the member
+	 * is not inline.
+	 */
+	size_t *member_offsets;
 };
 
 struct bt_field_variant {
@@ -74,20 +108,47 @@ struct bt_field_variant {
 	struct bt_field *payload;
 };
 
+/*
+ * Packed elements of an array or sequence field of which the element
+ * field type is an 8-bit, 16-bit, 32-bit, or 64-bit integer field type
+ * or a single or double precision floating point number field type.
+ *
+ * When packed elements are set, the array of element fields only
+ * contains NULL pointers: the element fields are created from the
+ * packed elements when one of them is first requested.
+ */
+struct bt_field_packed_elements {
+	/* Element values, in native byte order */
+	GByteArray *buf;
+
+	/* True if the elements are currently packed */
+	bool is_set;
+};
+
 struct bt_field_array {
 	struct bt_field parent;
 	GPtrArray *elements; /* Array of pointers to struct bt_field */
+	struct bt_field_packed_elements packed;
 };
 
 struct bt_field_sequence {
 	struct bt_field parent;
 	struct bt_field *length;
 	GPtrArray *elements; /* Array of pointers to struct bt_field */
+	struct bt_field_packed_elements packed;
 };
 
 struct bt_field_string {
 	struct bt_field parent;
 	GString *payload;
+
+	/*
+	 * Value set with bt_field_string_set_external_value(), which
+	 * takes precedence over `payload` when not NULL, and the
+	 * object which owns it (owned by this).
+	 */
+	const char *external_value;
+	void *external_owner;
 };
 
 /* Validate that the field's payload is set (returns 0 if set). */
@@ -102,4 +163,25 @@ int bt_field_serialize(struct bt_field *field,
 BT_HIDDEN
 void bt_field_freeze(struct bt_field *field);
 
+/*
+ * Thaws and resets a field so that it can be reused, for example by a
+ * recycled event. This only works if the caller is the only owner of
+ * the field and of its subfields: returns a negative value otherwise,
+ * in which case the field is partially reset and must be put.
+ */
+BT_HIDDEN
+int bt_field_recycle(struct bt_field *field);
+
+/*
+ * Computes the layout of the fields of a structure field type. All the
+ * member field types must be frozen.
+ */
+BT_HIDDEN
+struct bt_field_structure_layout *bt_field_structure_layout_create(
+		struct bt_field_type *type);
+
+BT_HIDDEN
+void bt_field_structure_layout_destroy(
+		struct bt_field_structure_layout *layout);
+
 #endif /* BABELTRACE_CTF_IR_FIELDS_INTERNAL_H */
@@ -703,11 +703,17 @@ of a string field object. You can also use bt_field_string_append()
 and bt_field_string_append_len() to append a string to the current
 value of a string field.
 
+You can also make a string field reference an existing string value,
+without copying it, with bt_field_string_set_external_value(). The
+string field then keeps a reference on the object which owns this
+value until its value changes. Appending a string to the value of such
+a string field copies its value first.
+
 After you create a string field with bt_field_create(), you
 \em must set a string value with
-bt_field_string_set_value(), bt_field_string_append(), or
-bt_field_string_append_len() before you can get the
-field's value with bt_field_string_get_value().
+bt_field_string_set_value(), bt_field_string_set_external_value(),
+bt_field_string_append(), or bt_field_string_append_len() before you
+can get the field's value with bt_field_string_get_value().
 
 @sa ctfirstringfieldtype
 @sa ctfirfields
@@ -763,6 +769,38 @@ extern const char *bt_field_string_get_value(
 extern int bt_field_string_set_value(struct bt_field *string_field,
 		const char *value);
 
+/**
+@brief	Sets the string value of the @stringfield \p string_field to
+	\p value without copying it.
+
+\p value must remain valid and unchanged as long as the object \p owner
+exists. On success, \p string_field keeps a reference on \p owner until
+its value is set again, it is reset, or it is destroyed.
+
+If \p owner is \c NULL, \p value must remain valid and unchanged as long
+as \p string_field exists.
+
+@param[in] string_field	String field of which to set
+			the string value.
+@param[in] value	New string value of \p string_field (\em not
+			copied).
+@param[in] owner	Object which owns \p value, or \c NULL.
+@returns		0 on success, or a negative value on error.
+
+@prenotnull{string_field}
+@prenotnull{value}
+@preisstringfield{string_field}
+@prehot{string_field}
+@postrefcountsame{string_field}
+@postsuccessrefcountinc{owner}
+
+@sa bt_field_string_set_value(): Sets the string value of a given
+	string field, copying it.
+*/
+extern int bt_field_string_set_external_value(
+		struct bt_field *string_field, const char *value,
+		void *owner);
+
 /**
 @brief	Appends the string \p value to the current string value of
 	the @stringfield \p string_field.
@@ -965,6 +1003,14 @@ and which is described by a @arrayft.
 To set the value of a specific field of an array field, you need to
 first get the field with bt_field_array_get_field().
 
+When the fields of an array field are 8-bit, 16-bit, 32-bit, or 64-bit
+@intfields, or single or double precision @floatfields, you can also
+set all their values at once with
+bt_field_array_set_packed_elements(). The array field then keeps the
+values in a single buffer, which you can get with
+bt_field_array_get_packed_elements(), until one of its fields is
+requested with bt_field_array_get_field().
+
 @sa ctfirarrayfieldtype
 @sa ctfirfields
 
@@ -995,6 +1041,69 @@ exist.
 extern struct bt_field *bt_field_array_get_field(
 		struct bt_field *array_field, uint64_t index);
 
+/**
+@brief	Sets the values of all the fields of the @arrayfield
+	\p array_field at once.
+
+\p elements contains \p count element values, in native byte order,
+each one having the size of the element field type of \p array_field:
+1, 2, 4, or 8 bytes for an @intft, or the size of a \c float or of a
+\c double for a @floatft. \p elements does not need to be aligned.
+
+The values are copied: the fields of \p array_field are created
+from them when one of them is requested.
+
+@param[in] array_field	Array field of which to set the values of
+			the fields.
+@param[in] elements	Element values.
+@param[in] count	Number of element values in \p elements.
+@returns		0 on success, or a negative value on error.
+
+@prenotnull{array_field}
+@preisarrayfield{array_field}
+@prehot{array_field}
+@pre The element field type of \p array_field is an 8-bit, 16-bit,
+	32-bit, or 64-bit @intft, or a single or double precision
+	@floatft.
+@pre \p count is equal to bt_field_type_array_get_length() called on
+	the field type of \p array_field.
+@postrefcountsame{array_field}
+
+@sa bt_field_array_get_packed_elements(): Returns the element values
+	of a given array field.
+*/
+extern int bt_field_array_set_packed_elements(struct bt_field *array_field,
+		const void *elements, uint64_t count);
+
+/**
+@brief	Returns the element values of the @arrayfield \p array_field,
+	as set by bt_field_array_set_packed_elements().
+
+The returned buffer contains \p *count element values, in native byte
+order. It remains valid as long as \p array_field exists and none of
+its fields is requested with bt_field_array_get_field().
+
+This function returns \c NULL if the values of \p array_field are
+not packed: you need to get each field with
+bt_field_array_get_field() in this case.
+
+@param[in] array_field	Array field of which to get the element
+			values.
+@param[out] count	Returned number of element values.
+@returns		Element values of \p array_field, or \c NULL
+			if they are not packed or on error.
+
+@prenotnull{array_field}
+@prenotnull{count}
+@preisarrayfield{array_field}
+@postrefcountsame{array_field}
+
+@sa bt_field_array_set_packed_elements(): Sets the element values
+	of a given array field.
+*/
+extern const void *bt_field_array_get_packed_elements(
+		struct bt_field *array_field, uint64_t *count);
+
 /** @} */
 
 /**
@@ -1016,6 +1125,11 @@ bt_field_sequence_get_field(), you need to set its current length
 the length field of a sequence field indicates the number of fields
 it contains.
 
+Like for an @arrayfield, you can set the values of all the fields of a
+sequence field of numbers at once with
+bt_field_sequence_set_packed_elements(), and get them with
+bt_field_sequence_get_packed_elements().
+
 @sa ctfirseqfieldtype
 @sa ctfirfields
 
@@ -1101,6 +1215,62 @@ fields contained in \p sequence_field.
 extern int bt_field_sequence_set_length(struct bt_field *sequence_field,
 		struct bt_field *length_field);
 
+/**
+@brief	Sets the values of all the fields of the @seqfield
+	\p sequence_field at once.
+
+See bt_field_array_set_packed_elements() for the format of
+\p elements.
+
+@param[in] sequence_field	Sequence field of which to set the values
+				of the fields.
+@param[in] elements		Element values.
+@param[in] count		Number of element values in \p elements.
+@returns			0 on success, or a negative value on error.
+
+@prenotnull{sequence_field}
+@preisseqfield{sequence_field}
+@prehot{sequence_field}
+@pre \p sequence_field has a length field previously set with
+	bt_field_sequence_set_length().
+@pre The element field type of \p sequence_field is an 8-bit, 16-bit,
+	32-bit, or 64-bit @intft, or a single or double precision
+	@floatft.
+@pre \p count is equal to the current integral value of the current
+	length field of \p sequence_field.
+@postrefcountsame{sequence_field}
+
+@sa bt_field_sequence_get_packed_elements(): Returns the element values
+	of a given sequence field.
+*/
+extern int bt_field_sequence_set_packed_elements(
+		struct bt_field *sequence_field, const void *elements,
+		uint64_t count);
+
+/**
+@brief	Returns the element values of the @seqfield \p sequence_field,
+	as set by bt_field_sequence_set_packed_elements().
+
+See bt_field_array_get_packed_elements().
+
+@param[in] sequence_field	Sequence field of which to get the
+				element values.
+@param[out] count		Returned number of element values.
+@returns			Element values of \p sequence_field, or
+				\c NULL if they are not packed or on
+				error.
+
+@prenotnull{sequence_field}
+@prenotnull{count}
+@preisseqfield{sequence_field}
+@postrefcountsame{sequence_field}
+
+@sa bt_field_sequence_set_packed_elements(): Sets the element values
+	of a given sequence field.
+*/
+extern const void *bt_field_sequence_get_packed_elements(
+		struct bt_field *sequence_field, uint64_t *count);
+
 /** @} */
 
 /**
@@ -83,6 +83,31 @@ struct bt_stream {
 	uint64_t discarded_events;
 	uint64_t size;
 
+	/*
+	 * Writer streaming mode (see bt_stream_set_serialize_on_append()):
+	 * events are serialized to the current packet when appended
+	 * instead of being kept in `events`.
+	 */
+	bool serialize_on_append;
+	/* True if the current packet is mapped and has room for its header */
+	bool packet_is_open;
+	/* Serialized size of the packet header and context fields (bits) */
+	uint64_t packet_header_context_size;
+	/* Number of events serialized to the current packet */
+	uint64_t packet_event_count;
+	/* Header fields of the current packet's first and last events */
+	struct bt_field *first_event_header;
+	struct bt_field *last_event_header;
+
+	/* Base name of the stream file within the trace directory */
+	GString *file_name;
+	/*
+	 * Packet index file (see bt_stream_enable_packet_index()), or
+	 * -1 if the stream has no packet index.
+	 */
+	int index_fd;
+	gchar *index_path;
+
 	/* Array of struct bt_stream_destroy_listener */
 	GArray *destroy_listeners;
 };
@@ -36,6 +36,7 @@
 #include <babeltrace/types.h>
 #include <glib.h>
 #include <sys/types.h>
+#include <assert.h>
 #include <babeltrace/compat/uuid-internal.h>
 
 enum field_type_alias {
@@ -56,7 +57,12 @@ struct bt_trace {
 	bt_bool uuid_set;
 	enum bt_byte_order native_byte_order;
 	struct bt_value *environment;
-	GPtrArray *clocks; /* Array of pointers to bt_clock_class */
+	/*
+	 * Array of pointers to bt_clock_class. A clock class's index
+	 * within this array never changes: events use it to index their
+	 * clock values.
+	 */
+	GPtrArray *clocks;
 	GPtrArray *stream_classes; /* Array of ptrs to bt_stream_class */
 	GPtrArray *streams; /* Array of ptrs to bt_stream */
 	struct bt_field_type *packet_header_type;
@@ -139,4 +145,28 @@ int bt_trace_add_listener(struct bt_trace *trace_class,
 BT_HIDDEN
 char *bt_trace_get_metadata_string(struct bt_trace *trace);
 
+/*
+ * Returns the index of a clock class within a trace, or -1 if the clock
+ * class is not part of the trace.
+ */
+static inline
+int64_t bt_trace_get_clock_class_index(struct bt_trace *trace,
+		struct bt_clock_class *clock_class)
+{
+	int64_t index;
+
+	assert(trace);
+
+	for (index = 0; index < trace->clocks->len; index++) {
+		if (trace->clocks->pdata[index] == clock_class) {
+			goto end;
+		}
+	}
+
+	index = -1;
+
+end:
+	return index;
+}
+
 #endif /* BABELTRACE_CTF_IR_TRACE_INTERNAL_H */
@@ -31,6 +31,7 @@
  */
 
 #include <babeltrace/ctf-ir/event.h>
+#include <babeltrace/types.h>
 #include <babeltrace/ctf-ir/stream.h>
 #include <babeltrace/ctf-writer/stream-class.h>
 
@@ -86,6 +87,73 @@ extern void bt_stream_append_discarded_events(struct bt_stream *stream,
 extern int bt_stream_append_event(struct bt_stream *stream,
 		struct bt_event *event);
 
+/*
+ * bt_stream_set_serialize_on_append: set a stream's streaming mode.
+ *
+ * When enabled, bt_stream_append_event serializes each event to the
+ * stream's current packet instead of keeping it until the next call to
+ * bt_stream_flush. The packet header and context are written when the
+ * packet is flushed, so they may still be modified until then.
+ *
+ * This mode requires the trace's packet header type and the stream
+ * class' packet context type to have a fixed size, that is, to contain
+ * no string, sequence, or variant field types. It can only be changed
+ * while the stream's current packet is empty.
+ *
+ * @param stream Stream instance.
+ * @param serialize_on_append BT_TRUE to serialize events when they are
+ *	appended.
+ *
+ * Returns 0 on success, a negative value on error.
+ */
+extern int bt_stream_set_serialize_on_append(struct bt_stream *stream,
+		bt_bool serialize_on_append);
+
+/*
+ * bt_stream_get_packet_event_count: get the number of events appended
+ * to a stream's current packet.
+ *
+ * @param stream Stream instance.
+ * @param count Returned number of events in the current packet.
+ *
+ * Returns 0 on success, a negative value on error.
+ */
+extern int bt_stream_get_packet_event_count(struct bt_stream *stream,
+		uint64_t *count);
+
+/*
+ * bt_stream_get_packet_content_size: get the current content size of
+ * a stream's current packet.
+ *
+ * The content size, in bits, includes the packet header and context.
+ * It is only known when the stream serializes events on append (see
+ * bt_stream_set_serialize_on_append); it is 0 when no event was
+ * appended to the current packet.
+ *
+ * @param stream Stream instance.
+ * @param size Returned content size of the current packet, in bits.
+ *
+ * Returns 0 on success, a negative value on error.
+ */
+extern int bt_stream_get_packet_content_size(struct bt_stream *stream,
+		uint64_t *size);
+
+/*
+ * bt_stream_enable_packet_index: write a packet index file for a stream.
+ *
+ * Each flushed packet of the stream gets an entry in the
+ * `index/STREAMFILE.idx` file of the trace directory, in the format of
+ * the LTTng packet index files. Readers can then locate the packets
+ * without reading the whole stream file.
+ *
+ * This must be called before the first packet of the stream is flushed.
+ *
+ * @param stream Stream instance.
+ *
+ * Returns 0 on success, a negative value on error.
+ */
+extern int bt_stream_enable_packet_index(struct bt_stream *stream);
+
 /*
  * bt_stream_get_packet_header: get a stream's packet header.
  *
@@ -57,4 +57,14 @@ void bt_clock_class_priority_map_freeze(
 	cc_prio_map->frozen = BT_TRUE;
 }
 
+static inline
+struct bt_clock_class *bt_clock_class_priority_map_borrow_clock_class_by_index(
+		struct bt_clock_class_priority_map *cc_prio_map,
+		uint64_t index)
+{
+	assert(cc_prio_map);
+	assert(index < cc_prio_map->entries->len);
+	return g_ptr_array_index(cc_prio_map->entries, index);
+}
+
 #endif /* BABELTRACE_GRAPH_CLOCK_CLASS_PRIORITY_MAP_INTERNAL_H */
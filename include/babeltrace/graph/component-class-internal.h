@@ -75,6 +75,9 @@ struct bt_component_class_notification_iterator_methods {
 	bt_component_class_notification_iterator_init_method init;
 	bt_component_class_notification_iterator_finalize_method finalize;
 	bt_component_class_notification_iterator_next_method next;
+
+	/* Optional: preferred over `next` when set */
+	bt_component_class_notification_iterator_next_batch_method next_batch;
 };
 
 struct bt_component_class_source {
@@ -73,6 +73,18 @@ struct bt_notification_iterator_next_method_return {
 	enum bt_notification_iterator_status status;
 };
 
+/*
+ * Return value of a "next batch" method: when the status is
+ * BT_NOTIFICATION_ITERATOR_STATUS_OK, the first `count` entries of the
+ * notification array passed to the method contain new notification
+ * references which are moved to the caller. `count` must be at least 1
+ * in this case.
+ */
+struct bt_notification_iterator_next_batch_method_return {
+	uint64_t count;
+	enum bt_notification_iterator_status status;
+};
+
 struct bt_component_class_query_method_return {
 	struct bt_value *result;
 	enum bt_query_status status;
@@ -97,6 +109,11 @@ typedef struct bt_notification_iterator_next_method_return
 (*bt_component_class_notification_iterator_next_method)(
 		struct bt_private_connection_private_notification_iterator *notification_iterator);
 
+typedef struct bt_notification_iterator_next_batch_method_return
+(*bt_component_class_notification_iterator_next_batch_method)(
+		struct bt_private_connection_private_notification_iterator *notification_iterator,
+		struct bt_notification **notifications, uint64_t capacity);
+
 typedef struct bt_component_class_query_method_return (*bt_component_class_query_method)(
 		struct bt_component_class *component_class,
 		struct bt_query_executor *query_executor,
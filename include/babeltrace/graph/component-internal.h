@@ -65,6 +65,12 @@ struct bt_component {
 	/* Array of struct bt_component_destroy_listener */
 	GArray *destroy_listeners;
 
+	/*
+	 * Array of file descriptors (int) which become readable when
+	 * this component has more data, see bt_graph_wait().
+	 */
+	GArray *wait_fds;
+
 	bool initialized;
 };
 
@@ -57,6 +57,12 @@ struct bt_graph {
 	GPtrArray *components;
 	/* Queue of pointers (weak references) to sink bt_components. */
 	GQueue *sinks_to_consume;
+	/*
+	 * Array of struct pollfd which bt_graph_wait() fills with the
+	 * wait file descriptors of the components, kept between calls
+	 * to avoid allocating it each time. NULL until the first call.
+	 */
+	GArray *wait_pollfds;
 
 	bt_bool canceled;
 	bt_bool in_remove_listener;
@@ -29,6 +29,7 @@
 
 /* For bt_bool */
 #include <babeltrace/types.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -109,6 +110,27 @@ extern enum bt_graph_status bt_graph_run(struct bt_graph *graph);
  */
 extern enum bt_graph_status bt_graph_consume(struct bt_graph *graph);
 
+/**
+ * Waits until one of the file descriptors which the graph's components
+ * added with bt_private_component_add_wait_fd() is readable, or until
+ * `timeout_us` microseconds elapse, or until a signal is caught.
+ *
+ * Call this after bt_graph_run() or bt_graph_consume() returns
+ * BT_GRAPH_STATUS_AGAIN instead of sleeping for a fixed duration: the
+ * graph can then make progress as soon as a component is ready.
+ *
+ * This function only waits for the file descriptors to be readable:
+ * it does not support a component which needs to wait for a file
+ * descriptor to be writable. A file descriptor which is hung up or in
+ * error is not waited for during the rest of the call, so that this
+ * function does not return immediately on each call: its component
+ * sees this condition the next time the graph consumes it.
+ *
+ * Returns BT_GRAPH_STATUS_CANCELED if the graph is canceled.
+ */
+extern enum bt_graph_status bt_graph_wait(struct bt_graph *graph,
+		uint64_t timeout_us);
+
 extern int bt_graph_add_port_added_listener(struct bt_graph *graph,
 		bt_graph_port_added_listener listener,
 		bt_graph_listener_removed listener_removed, void *data);
@@ -40,6 +40,12 @@
 struct bt_port;
 struct bt_graph;
 
+/*
+ * Maximum number of notifications requested from a user "next batch"
+ * method at once.
+ */
+#define BT_PRIVATE_CONNECTION_NOTIFICATION_ITERATOR_BATCH_CAPACITY	256
+
 enum bt_notification_iterator_type {
 	BT_NOTIFICATION_ITERATOR_TYPE_PRIVATE_CONNECTION,
 	BT_NOTIFICATION_ITERATOR_TYPE_OUTPUT_PORT,
@@ -134,6 +140,13 @@ struct bt_notification_iterator_private_connection {
 
 	enum bt_private_connection_notification_iterator_state state;
 	void *user_data;
+
+	/*
+	 * Notifications returned by the last call to the user's "next"
+	 * or "next batch" method which are not enqueued yet (owned by
+	 * this).
+	 */
+	struct bt_notification *batch[BT_PRIVATE_CONNECTION_NOTIFICATION_ITERATOR_BATCH_CAPACITY];
 };
 
 struct bt_notification_iterator_output_port {
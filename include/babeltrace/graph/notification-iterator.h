@@ -86,6 +86,29 @@ extern struct bt_notification *bt_notification_iterator_get_notification(
 extern enum bt_notification_iterator_status
 bt_notification_iterator_next(struct bt_notification_iterator *iterator);
 
+/**
+ * Advance the iterator's position forward by up to \p capacity
+ * notifications at once.
+ *
+ * On success, the first \p *count entries of \p notifications contain
+ * new notification references which the caller must put. \p *count is
+ * at least 1 when the returned status is
+ * BT_NOTIFICATION_ITERATOR_STATUS_OK, and 0 otherwise.
+ *
+ * This function does not change the iterator's current notification
+ * (see bt_notification_iterator_get_notification()).
+ *
+ * @param iterator	Iterator instance
+ * @param notifications	Array of at least \p capacity entries to fill
+ * @param capacity	Maximum number of notifications to return
+ * @param count		Returned number of notifications
+ * @returns		Iterator status
+ */
+extern enum bt_notification_iterator_status
+bt_notification_iterator_next_batch(struct bt_notification_iterator *iterator,
+		struct bt_notification **notifications, uint64_t capacity,
+		uint64_t *count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -40,6 +40,26 @@ extern enum bt_component_status bt_private_component_set_user_data(
 		struct bt_private_component *private_component,
 		void *user_data);
 
+/*
+ * Adds the file descriptor `fd` to the ones which bt_graph_wait()
+ * waits on: `fd` must become readable when the component can make
+ * progress after one of its notification iterators returned
+ * BT_NOTIFICATION_ITERATOR_STATUS_AGAIN.
+ *
+ * Waiting for `fd` to become writable is not supported: a component
+ * which waits for write readiness, for example to send data on a
+ * socket, must instead add a file descriptor which becomes readable at
+ * this point, like the read end of a pipe.
+ *
+ * The component remains the owner of `fd`, and must remove it with
+ * bt_private_component_remove_wait_fd() before closing it.
+ */
+extern enum bt_component_status bt_private_component_add_wait_fd(
+		struct bt_private_component *private_component, int fd);
+
+extern enum bt_component_status bt_private_component_remove_wait_fd(
+		struct bt_private_component *private_component, int fd);
+
 #ifdef __cplusplus
 }
 #endif
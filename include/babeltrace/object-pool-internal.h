@@ -0,0 +1,127 @@
+#ifndef BABELTRACE_OBJECT_POOL_INTERNAL_H
+#define BABELTRACE_OBJECT_POOL_INTERNAL_H
+
+/*
+ * Babeltrace - Object pool
+ *
+ * Copyright 2017 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * This is a generic object pool to avoid memory allocation/deallocation
+ * for objects of which the lifespan is typically short, but which are
+ * created a lot.
+ *
+ * The pool only keeps recycled objects: the user calls
+ * bt_object_pool_get_object() and creates a new object itself if it
+ * returns NULL. When the user is done with an object, it calls
+ * bt_object_pool_recycle_object() instead of destroying it. The pool
+ * owns the recycled objects: bt_object_pool_finalize() destroys them
+ * with the destroy function passed to bt_object_pool_initialize().
+ *
+ * The pool keeps at most a maximum number of recycled objects, so that
+ * a burst of live objects does not leave as many idle objects behind
+ * it: bt_object_pool_recycle_object() destroys the objects to recycle
+ * once the pool is full.
+ */
+
+#include <babeltrace/babeltrace-internal.h>
+#include <stddef.h>
+#include <assert.h>
+#include <glib.h>
+
+typedef void (*bt_object_pool_destroy_object_func)(void *obj, void *data);
+
+struct bt_object_pool {
+	/*
+	 * Recycled objects (owned by this). The array's length is the
+	 * number of available objects: the last one is the next object
+	 * to reuse.
+	 */
+	GPtrArray *objects;
+
+	/* Maximum number of recycled objects (length of `objects`) */
+	size_t max_count;
+
+	/* Object destruction function */
+	bt_object_pool_destroy_object_func destroy_object;
+
+	/* User data passed to the destroy function */
+	void *data;
+};
+
+/*
+ * Initializes an object pool which is already allocated and which
+ * keeps at most `max_count` (greater than 0) recycled objects.
+ */
+BT_HIDDEN
+int bt_object_pool_initialize(struct bt_object_pool *pool,
+		size_t max_count,
+		bt_object_pool_destroy_object_func destroy_object_func,
+		void *data);
+
+/*
+ * Finalizes an object pool without deallocating it, destroying all its
+ * recycled objects.
+ */
+BT_HIDDEN
+void bt_object_pool_finalize(struct bt_object_pool *pool);
+
+/*
+ * Returns a recycled object from an object pool, or NULL if the pool
+ * is empty, in which case the caller must create a new object.
+ */
+static inline
+void *bt_object_pool_get_object(struct bt_object_pool *pool)
+{
+	assert(pool);
+	assert(pool->objects);
+
+	if (pool->objects->len == 0) {
+		return NULL;
+	}
+
+	return g_ptr_array_remove_index_fast(pool->objects,
+		pool->objects->len - 1);
+}
+
+/*
+ * Recycles an object, that is, puts it back into the pool, or destroys
+ * it if the pool is full.
+ *
+ * The pool becomes the owner of the object to recycle.
+ */
+static inline
+void bt_object_pool_recycle_object(struct bt_object_pool *pool, void *obj)
+{
+	assert(pool);
+	assert(pool->objects);
+	assert(obj);
+
+	if (pool->objects->len >= pool->max_count) {
+		pool->destroy_object(obj, pool->data);
+		return;
+	}
+
+	g_ptr_array_add(pool->objects, obj);
+}
+
+#endif /* BABELTRACE_OBJECT_POOL_INTERNAL_H */
@@ -627,10 +627,12 @@ void bt_clock_value_destroy(struct bt_object *obj)
 	g_free(value);
 }
 
-static
-void set_ns_from_epoch(struct bt_clock_value *clock_value)
+BT_HIDDEN
+int bt_clock_class_cycles_to_ns_from_epoch(struct bt_clock_class *clock_class,
+		uint64_t value, int64_t *ns_from_epoch)
 {
-	struct bt_clock_class *clock_class = clock_value->clock_class;
+	int ret = 0;
+	int64_t ns = 0;
 	int64_t diff;
 	int64_t s_ns;
 	uint64_t u_ns;
@@ -643,11 +645,11 @@ void set_ns_from_epoch(struct bt_clock_value *clock_value)
 		 * Overflow: offset in seconds converted to nanoseconds
 		 * is outside the int64_t range.
 		 */
-		clock_value->ns_from_epoch_overflows = true;
+		ret = -1;
 		goto end;
 	}
 
-	clock_value->ns_from_epoch = clock_class->offset_s * (int64_t) 1000000000;
+	ns = clock_class->offset_s * (int64_t) 1000000000;
 
 	/* Add offset in cycles */
 	if (clock_class->offset < 0) {
@@ -663,7 +665,7 @@ void set_ns_from_epoch(struct bt_clock_value *clock_value)
 		 * Overflow: offset in cycles converted to nanoseconds
 		 * is outside the int64_t range.
 		 */
-		clock_value->ns_from_epoch_overflows = true;
+		ret = -1;
 		goto end;
 	}
 
@@ -671,7 +673,7 @@ void set_ns_from_epoch(struct bt_clock_value *clock_value)
 	assert(s_ns >= 0);
 
 	if (clock_class->offset < 0) {
-		if (clock_value->ns_from_epoch >= 0) {
+		if (ns >= 0) {
 			/*
 			 * Offset in cycles is negative so it must also
 			 * be negative once converted to nanoseconds.
@@ -680,7 +682,7 @@ void set_ns_from_epoch(struct bt_clock_value *clock_value)
 			goto offset_ok;
 		}
 
-		diff = clock_value->ns_from_epoch - INT64_MIN;
+		diff = ns - INT64_MIN;
 
 		if (s_ns >= diff) {
 			/*
@@ -688,7 +690,7 @@ void set_ns_from_epoch(struct bt_clock_value *clock_value)
 			 * plus the offset in cycles converted to
 			 * nanoseconds is outside the int64_t range.
 			 */
-			clock_value->ns_from_epoch_overflows = true;
+			ret = -1;
 			goto end;
 		}
 
@@ -698,11 +700,11 @@ void set_ns_from_epoch(struct bt_clock_value *clock_value)
 		 */
 		s_ns = -s_ns;
 	} else {
-		if (clock_value->ns_from_epoch <= 0) {
+		if (ns <= 0) {
 			goto offset_ok;
 		}
 
-		diff = INT64_MAX - clock_value->ns_from_epoch;
+		diff = INT64_MAX - ns;
 
 		if (s_ns >= diff) {
 			/*
@@ -710,23 +712,23 @@ void set_ns_from_epoch(struct bt_clock_value *clock_value)
 			 * plus the offset in cycles converted to
 			 * nanoseconds is outside the int64_t range.
 			 */
-			clock_value->ns_from_epoch_overflows = true;
+			ret = -1;
 			goto end;
 		}
 	}
 
 offset_ok:
-	clock_value->ns_from_epoch += s_ns;
+	ns += s_ns;
 
 	/* Add clock value (cycles) */
-	u_ns = ns_from_value(clock_class->frequency, clock_value->value);
+	u_ns = ns_from_value(clock_class->frequency, value);
 
 	if (u_ns == -1ULL || u_ns >= INT64_MAX) {
 		/*
 		 * Overflow: value converted to nanoseconds is outside
 		 * the int64_t range.
 		 */
-		clock_value->ns_from_epoch_overflows = true;
+		ret = -1;
 		goto end;
 	}
 
@@ -734,11 +736,11 @@ offset_ok:
 	assert(s_ns >= 0);
 
 	/* Clock value (cycles) is always positive */
-	if (clock_value->ns_from_epoch <= 0) {
+	if (ns <= 0) {
 		goto value_ok;
 	}
 
-	diff = INT64_MAX - clock_value->ns_from_epoch;
+	diff = INT64_MAX - ns;
 
 	if (s_ns >= diff) {
 		/*
@@ -746,17 +748,29 @@ offset_ok:
 		 * clock value converted to nanoseconds is outside the
 		 * int64_t range.
 		 */
-		clock_value->ns_from_epoch_overflows = true;
+		ret = -1;
 		goto end;
 	}
 
 value_ok:
-	clock_value->ns_from_epoch += s_ns;
+	ns += s_ns;
 
 end:
-	if (clock_value->ns_from_epoch_overflows) {
-		clock_value->ns_from_epoch = 0;
+	if (ret) {
+		ns = 0;
 	}
+
+	*ns_from_epoch = ns;
+	return ret;
+}
+
+static
+void set_ns_from_epoch(struct bt_clock_value *clock_value)
+{
+	clock_value->ns_from_epoch_overflows =
+		bt_clock_class_cycles_to_ns_from_epoch(
+			clock_value->clock_class, clock_value->value,
+			&clock_value->ns_from_epoch) != 0;
 }
 
 struct bt_clock_value *bt_clock_value_create(
@@ -33,6 +33,7 @@
 #include <babeltrace/ctf-ir/field-types-internal.h>
 #include <babeltrace/ctf-ir/event-class.h>
 #include <babeltrace/ctf-ir/event-class-internal.h>
+#include <babeltrace/ctf-ir/event-internal.h>
 #include <babeltrace/ctf-ir/stream-class.h>
 #include <babeltrace/ctf-ir/stream-class-internal.h>
 #include <babeltrace/ctf-ir/trace-internal.h>
@@ -50,6 +51,12 @@
 static
 void bt_event_class_destroy(struct bt_object *obj);
 
+static
+void destroy_recycled_event(void *obj, void *data)
+{
+	bt_event_destroy_recycled(obj);
+}
+
 struct bt_event_class *bt_event_class_create(const char *name)
 {
 	struct bt_value *obj = NULL;
@@ -90,6 +97,14 @@ struct bt_event_class *bt_event_class_create(const char *name)
 	}
 
 	event_class->log_level = BT_EVENT_CLASS_LOG_LEVEL_UNSPECIFIED;
+
+	if (bt_object_pool_initialize(&event_class->event_pool,
+			BT_EVENT_CLASS_EVENT_POOL_MAX_COUNT,
+			destroy_recycled_event, event_class)) {
+		BT_LOGE_STR("Failed to initialize event pool.");
+		goto error;
+	}
+
 	BT_PUT(obj);
 	BT_LOGD("Created event class object: addr=%p, name=\"%s\"",
 		event_class, bt_event_class_get_name(event_class));
@@ -343,6 +358,15 @@ int bt_event_class_set_payload_type(struct bt_event_class *event_class,
 		goto end;
 	}
 
+	if (event_class->frozen) {
+		BT_LOGW("Invalid parameter: event class is frozen: "
+			"addr=%p, name=\"%s\", id=%" PRId64,
+			event_class, bt_event_class_get_name(event_class),
+			bt_event_class_get_id(event_class));
+		ret = -1;
+		goto end;
+	}
+
 	if (payload && bt_field_type_get_type_id(payload) !=
 			BT_FIELD_TYPE_ID_STRUCT) {
 		BT_LOGW("Invalid parameter: event class's payload field type must be a structure: "
@@ -610,6 +634,13 @@ void bt_event_class_destroy(struct bt_object *obj)
 	BT_LOGD("Destroying event class: addr=%p, name=\"%s\", id=%" PRId64,
 		event_class, bt_event_class_get_name(event_class),
 		bt_event_class_get_id(event_class));
+	BT_LOGD_STR("Finalizing event pool.");
+	bt_object_pool_finalize(&event_class->event_pool);
+	BT_LOGD_STR("Putting event template's field types.");
+	bt_put(event_class->event_template.event_header_type);
+	bt_put(event_class->event_template.stream_event_ctx_type);
+	bt_put(event_class->event_template.event_context_type);
+	bt_put(event_class->event_template.event_payload_type);
 	g_string_free(event_class->name, TRUE);
 	g_string_free(event_class->emf_uri, TRUE);
 	BT_LOGD_STR("Putting context field type.");
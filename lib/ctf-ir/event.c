@@ -51,58 +51,49 @@
 #include <babeltrace/ref.h>
 #include <babeltrace/ctf-ir/attributes-internal.h>
 #include <babeltrace/compiler-internal.h>
+#include <babeltrace/object-pool-internal.h>
 #include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
 
 static
 void bt_event_destroy(struct bt_object *obj);
 
-struct bt_event *bt_event_create(struct bt_event_class *event_class)
+static
+void bt_event_release(struct bt_object *obj);
+
+/*
+ * Validates the trace (if any), the stream class, and the event class of
+ * an event class's first event, freezes them, and keeps the validated
+ * field types in the event class's event template.
+ */
+static
+int init_event_template(struct bt_event_class *event_class,
+		struct bt_stream_class *stream_class)
 {
 	int ret;
 	enum bt_validation_flag validation_flags =
 		BT_VALIDATION_FLAG_STREAM |
 		BT_VALIDATION_FLAG_EVENT;
-	struct bt_event *event = NULL;
+	struct bt_event_template *event_template =
+		&event_class->event_template;
 	struct bt_trace *trace = NULL;
-	struct bt_stream_class *stream_class = NULL;
 	struct bt_field_type *packet_header_type = NULL;
 	struct bt_field_type *packet_context_type = NULL;
 	struct bt_field_type *event_header_type = NULL;
 	struct bt_field_type *stream_event_ctx_type = NULL;
 	struct bt_field_type *event_context_type = NULL;
 	struct bt_field_type *event_payload_type = NULL;
-	struct bt_field *event_header = NULL;
-	struct bt_field *stream_event_context = NULL;
-	struct bt_field *event_context = NULL;
-	struct bt_field *event_payload = NULL;
 	struct bt_value *environment = NULL;
 	struct bt_validation_output validation_output = { 0 };
 	int trace_valid = 0;
 
-	BT_LOGD("Creating event object: event-class-addr=%p, "
-		"event-class-name=\"%s\", event-class-id=%" PRId64,
-		event_class, bt_event_class_get_name(event_class),
+	BT_LOGD("Initializing event class's event template: "
+		"event-class-addr=%p, event-class-name=\"%s\", "
+		"event-class-id=%" PRId64, event_class,
+		bt_event_class_get_name(event_class),
 		bt_event_class_get_id(event_class));
 
-	if (!event_class) {
-		BT_LOGW_STR("Invalid parameter: event class is NULL.");
-		goto error;
-	}
-
-	stream_class = bt_event_class_get_stream_class(event_class);
-
-	/*
-	 * We disallow the creation of an event if its event class has not been
-	 * associated to a stream class.
-	 */
-	if (!stream_class) {
-		BT_LOGW_STR("Event class is not part of a stream class.");
-		goto error;
-	}
-
-	/* The event class was frozen when added to its stream class */
-	assert(event_class->frozen);
-
 	/* Validate the trace (if any), the stream class, and the event class */
 	trace = bt_stream_class_get_trace(stream_class);
 	if (trace) {
@@ -138,7 +129,7 @@ struct bt_event *bt_event_create(struct bt_event_class *event_class)
 		 * process, not that the objects are invalid.
 		 */
 		BT_LOGE("Failed to validate event and parents: ret=%d", ret);
-		goto error;
+		goto end;
 	}
 
 	if ((validation_output.valid_flags & validation_flags) !=
@@ -146,112 +137,189 @@ struct bt_event *bt_event_create(struct bt_event_class *event_class)
 		/* Invalid trace/stream class/event class */
 		BT_LOGW("Invalid trace, stream class, or event class: "
 			"valid-flags=0x%x", validation_output.valid_flags);
-		goto error;
+		ret = -1;
+		goto end;
 	}
 
 	/*
 	 * At this point we know the trace (if associated to the stream
 	 * class), the stream class, and the event class, with their
-	 * current types, are valid. We may proceed with creating
-	 * the event.
+	 * current types, are valid: replace the types with their
+	 * validated copies in the stream class and event class.
 	 */
-	event = g_new0(struct bt_event, 1);
-	if (!event) {
-		BT_LOGE_STR("Failed to allocate one event.");
-		goto error;
-	}
+	bt_validation_replace_types(trace, stream_class,
+		event_class, &validation_output, validation_flags);
 
-	bt_object_init(event, bt_event_destroy);
+	/*
+	 * Freeze the stream class since the event header must not be changed
+	 * anymore. The event class is already frozen. The trace is not
+	 * frozen here: the event template contains none of its types.
+	 */
+	bt_stream_class_freeze(stream_class);
 
 	/*
-	 * event does not share a common ancestor with the event class; it has
-	 * to guarantee its existence by holding a reference. This reference
-	 * shall be released once the event is associated to a stream since,
-	 * from that point, the event and its class will share the same
-	 * lifetime.
+	 * Mark stream class, and event class as valid since
+	 * they're all frozen now.
 	 */
-	event->event_class = bt_get(event_class);
-	event->clock_values = g_hash_table_new_full(g_direct_hash,
-			g_direct_equal, bt_put, bt_put);
-
-	if (validation_output.event_header_type) {
-		BT_LOGD("Creating initial event header field: ft-addr=%p",
-			validation_output.event_header_type);
-		event_header =
-			bt_field_create(validation_output.event_header_type);
-		if (!event_header) {
-			BT_LOGE_STR("Cannot create initial event header field object.");
-			goto error;
-		}
-	}
+	stream_class->valid = 1;
+	event_class->valid = 1;
 
-	if (validation_output.stream_event_ctx_type) {
-		BT_LOGD("Creating initial stream event context field: ft-addr=%p",
-			validation_output.stream_event_ctx_type);
-		stream_event_context = bt_field_create(
-			validation_output.stream_event_ctx_type);
-		if (!stream_event_context) {
-			BT_LOGE_STR("Cannot create initial stream event context field object.");
-			goto error;
-		}
+	event_template->event_header_type =
+		bt_get(stream_class->event_header_type);
+	event_template->stream_event_ctx_type =
+		bt_get(stream_class->event_context_type);
+	event_template->event_context_type = bt_get(event_class->context);
+	event_template->event_payload_type = bt_get(event_class->fields);
+	event_template->is_set = true;
+
+end:
+	/*
+	 * Put what was not moved in bt_validation_replace_types().
+	 */
+	bt_validation_output_put_types(&validation_output);
+	bt_put(trace);
+	return ret;
+}
+
+static
+int create_event_field(struct bt_field_type *type, struct bt_field **field,
+		const char *name)
+{
+	int ret = 0;
+
+	/* A recycled event can still have this field */
+	if (!type || *field) {
+		goto end;
 	}
 
-	if (validation_output.event_context_type) {
-		BT_LOGD("Creating initial event context field: ft-addr=%p",
-			validation_output.event_context_type);
-		event_context = bt_field_create(
-			validation_output.event_context_type);
-		if (!event_context) {
-			BT_LOGE_STR("Cannot create initial event context field object.");
-			goto error;
-		}
+	BT_LOGD("Creating initial %s field: ft-addr=%p", name, type);
+	*field = bt_field_create(type);
+	if (!*field) {
+		BT_LOGE("Cannot create initial %s field object.", name);
+		ret = -1;
 	}
 
-	if (validation_output.event_payload_type) {
-		BT_LOGD("Creating initial event payload field: ft-addr=%p",
-			validation_output.event_payload_type);
-		event_payload = bt_field_create(
-			validation_output.event_payload_type);
-		if (!event_payload) {
-			BT_LOGE_STR("Cannot create initial event payload field object.");
-			goto error;
-		}
+end:
+	return ret;
+}
+
+static
+int create_event_fields(struct bt_event *event,
+		struct bt_event_template *event_template)
+{
+	return create_event_field(event_template->event_header_type,
+			&event->event_header, "event header") ||
+		create_event_field(event_template->stream_event_ctx_type,
+			&event->stream_event_context,
+			"stream event context") ||
+		create_event_field(event_template->event_context_type,
+			&event->context_payload, "event context") ||
+		create_event_field(event_template->event_payload_type,
+			&event->fields_payload, "event payload");
+}
+
+static
+void put_event_fields(struct bt_event *event)
+{
+	/* Reverse order: see recycle_event_fields() */
+	BT_PUT(event->fields_payload);
+	BT_PUT(event->context_payload);
+	BT_PUT(event->stream_event_context);
+	BT_PUT(event->event_header);
+}
+
+static
+struct bt_event *create_event(struct bt_event_class *event_class,
+		bool with_fields)
+{
+	struct bt_event *event = NULL;
+	struct bt_stream_class *stream_class;
+	struct bt_event_template *event_template;
+
+	BT_LOGD("Creating event object: event-class-addr=%p, "
+		"event-class-name=\"%s\", event-class-id=%" PRId64 ", "
+		"with-fields=%d",
+		event_class, bt_event_class_get_name(event_class),
+		bt_event_class_get_id(event_class), with_fields);
+
+	if (!event_class) {
+		BT_LOGW_STR("Invalid parameter: event class is NULL.");
+		goto error;
 	}
 
+	stream_class = bt_event_class_borrow_stream_class(event_class);
+
 	/*
-	 * At this point all the fields are created, potentially from
-	 * validated copies of field types, so that the field types and
-	 * fields can be replaced in the trace, stream class,
-	 * event class, and created event.
+	 * We disallow the creation of an event if its event class has not been
+	 * associated to a stream class.
 	 */
-	bt_validation_replace_types(trace, stream_class,
-		event_class, &validation_output, validation_flags);
-	BT_MOVE(event->event_header, event_header);
-	BT_MOVE(event->stream_event_context, stream_event_context);
-	BT_MOVE(event->context_payload, event_context);
-	BT_MOVE(event->fields_payload, event_payload);
+	if (!stream_class) {
+		BT_LOGW_STR("Event class is not part of a stream class.");
+		goto error;
+	}
+
+	/* The event class was frozen when added to its stream class */
+	assert(event_class->frozen);
+	event_template = &event_class->event_template;
 
 	/*
-	 * Put what was not moved in bt_validation_replace_types().
+	 * A recycled event was created from this event class before:
+	 * the classes and their types are therefore already validated
+	 * and frozen, and the fields it still has are already reset.
+	 * The fields which were shared when it was recycled are
+	 * missing.
 	 */
-	bt_validation_output_put_types(&validation_output);
+	event = bt_object_pool_get_object(&event_class->event_pool);
+	if (event) {
+		bt_object_init(event, bt_event_release);
+		event->event_class = bt_get(event_class);
+
+		if (with_fields) {
+			if (create_event_fields(event, event_template)) {
+				goto error;
+			}
+		} else {
+			put_event_fields(event);
+		}
+
+		BT_LOGD("Created event object from recycled event: addr=%p, "
+			"event-class-name=\"%s\", event-class-id=%" PRId64,
+			event, bt_event_class_get_name(event_class),
+			bt_event_class_get_id(event_class));
+		return event;
+	}
 
 	/*
-	 * Freeze the stream class since the event header must not be changed
-	 * anymore.
+	 * The classes are validated once, when their first event is
+	 * created: the event template then has their validated types.
 	 */
-	bt_stream_class_freeze(stream_class);
+	if (!event_template->is_set) {
+		if (init_event_template(event_class, stream_class)) {
+			goto error;
+		}
+	}
+
+	event = g_new0(struct bt_event, 1);
+	if (!event) {
+		BT_LOGE_STR("Failed to allocate one event.");
+		goto error;
+	}
+
+	bt_object_init(event, bt_event_release);
 
 	/*
-	 * Mark stream class, and event class as valid since
-	 * they're all frozen now.
+	 * event does not share a common ancestor with the event class; it has
+	 * to guarantee its existence by holding a reference. This reference
+	 * shall be released once the event is associated to a stream since,
+	 * from that point, the event and its class will share the same
+	 * lifetime.
 	 */
-	stream_class->valid = 1;
-	event_class->valid = 1;
+	event->event_class = bt_get(event_class);
+
+	if (with_fields && create_event_fields(event, event_template)) {
+		goto error;
+	}
 
-	/* Put stuff we borrowed from the event class */
-	BT_PUT(stream_class);
-	BT_PUT(trace);
 	BT_LOGD("Created event object: addr=%p, event-class-name=\"%s\", "
 		"event-class-id=%" PRId64,
 		event, bt_event_class_get_name(event->event_class),
@@ -259,24 +327,25 @@ struct bt_event *bt_event_create(struct bt_event_class *event_class)
 	return event;
 
 error:
-	bt_validation_output_put_types(&validation_output);
-	BT_PUT(event);
-	BT_PUT(stream_class);
-	BT_PUT(trace);
-	BT_PUT(event_header);
-	BT_PUT(stream_event_context);
-	BT_PUT(event_context);
-	BT_PUT(event_payload);
-	assert(!packet_header_type);
-	assert(!packet_context_type);
-	assert(!event_header_type);
-	assert(!stream_event_ctx_type);
-	assert(!event_context_type);
-	assert(!event_payload_type);
+	if (event) {
+		/* Do not recycle an event which misses some fields */
+		bt_event_destroy(&event->base);
+		event = NULL;
+	}
 
 	return event;
 }
 
+struct bt_event *bt_event_create(struct bt_event_class *event_class)
+{
+	return create_event(event_class, true);
+}
+
+struct bt_event *bt_event_create_empty(struct bt_event_class *event_class)
+{
+	return create_event(event_class, false);
+}
+
 struct bt_event_class *bt_event_get_class(struct bt_event *event)
 {
 	struct bt_event_class *event_class = NULL;
@@ -737,25 +806,95 @@ void bt_ctf_event_put(struct bt_event *event)
 	bt_put(event);
 }
 
-void bt_event_destroy(struct bt_object *obj)
+static
+void reset_clock_values(struct bt_event *event)
+{
+	memset(event->clock_values, 0, sizeof(event->clock_values));
+
+	if (event->extra_clock_values) {
+		g_array_set_size(event->extra_clock_values, 0);
+	}
+}
+
+/*
+ * Resets a field of an event to recycle, or drops it if it is not
+ * exclusively owned by the event since someone else could still read
+ * it: the next user of the event creates or sets it again.
+ */
+static
+void recycle_event_field(struct bt_field **field, const char *name)
+{
+	if (!*field) {
+		return;
+	}
+
+	if (bt_field_recycle(*field)) {
+		BT_LOGV("Dropping shared %s field of recycled event: "
+			"field-addr=%p", name, *field);
+		BT_PUT(*field);
+	}
+}
+
+static
+void recycle_event_fields(struct bt_event *event)
+{
+	/*
+	 * Recycle the fields in reverse order since a field can hold a
+	 * reference on a field of a preceding scope (sequence length,
+	 * variant tag).
+	 */
+	recycle_event_field(&event->fields_payload, "event payload");
+	recycle_event_field(&event->context_payload, "event context");
+	recycle_event_field(&event->stream_event_context,
+		"stream event context");
+	recycle_event_field(&event->event_header, "event header");
+}
+
+static
+void bt_event_release(struct bt_object *obj)
 {
 	struct bt_event *event;
+	struct bt_event_class *event_class;
 
 	event = container_of(obj, struct bt_event, base);
-	BT_LOGD("Destroying event: addr=%p, "
+	event_class = event->event_class;
+
+	/*
+	 * An event which belongs to a (CTF writer) stream is never
+	 * recycled.
+	 */
+	if (event->base.parent || !event_class) {
+		bt_event_destroy(obj);
+		return;
+	}
+
+	BT_LOGV("Recycling event: addr=%p, "
 		"event-class-name=\"%s\", event-class-id=%" PRId64,
-		event, bt_event_class_get_name(event->event_class),
-		bt_event_class_get_id(event->event_class));
+		event, bt_event_class_get_name(event_class),
+		bt_event_class_get_id(event_class));
+	recycle_event_fields(event);
+	reset_clock_values(event);
+	BT_PUT(event->packet);
+	event->frozen = 0;
 
-	if (!event->base.parent) {
-		/*
-		 * Event was keeping a reference to its class since it shared no
-		 * common ancestor with it to guarantee they would both have the
-		 * same lifetime.
-		 */
-		bt_put(event->event_class);
+	/*
+	 * A recycled event does not keep a reference on its class
+	 * since its class owns it through its event pool. Putting the
+	 * event class can destroy it, and thus this event, so do it
+	 * last.
+	 */
+	event->event_class = NULL;
+	bt_object_pool_recycle_object(&event_class->event_pool, event);
+	bt_put(event_class);
+}
+
+static
+void free_event(struct bt_event *event)
+{
+	if (event->extra_clock_values) {
+		g_array_free(event->extra_clock_values, TRUE);
 	}
-	g_hash_table_destroy(event->clock_values);
+
 	BT_LOGD_STR("Putting event's header field.");
 	bt_put(event->event_header);
 	BT_LOGD_STR("Putting event's stream event context field.");
@@ -769,10 +908,139 @@ void bt_event_destroy(struct bt_object *obj)
 	g_free(event);
 }
 
+void bt_event_destroy(struct bt_object *obj)
+{
+	struct bt_event *event;
+
+	event = container_of(obj, struct bt_event, base);
+	BT_LOGD("Destroying event: addr=%p, "
+		"event-class-name=\"%s\", event-class-id=%" PRId64,
+		event, bt_event_class_get_name(event->event_class),
+		bt_event_class_get_id(event->event_class));
+
+	if (!event->base.parent) {
+		/*
+		 * Event was keeping a reference to its class since it shared no
+		 * common ancestor with it to guarantee they would both have the
+		 * same lifetime.
+		 */
+		bt_put(event->event_class);
+	}
+
+	free_event(event);
+}
+
+BT_HIDDEN
+void bt_event_destroy_recycled(struct bt_event *event)
+{
+	assert(event);
+	assert(!event->event_class);
+	BT_LOGD("Destroying recycled event: addr=%p", event);
+	free_event(event);
+}
+
+/*
+ * Returns the clock value entry of an event for a given clock class,
+ * or NULL if the clock class is not part of the event's trace. If
+ * `create` is false, also returns NULL if the entry does not exist
+ * yet.
+ */
+static
+struct bt_event_clock_value *borrow_clock_value_entry(
+		struct bt_event *event, struct bt_clock_class *clock_class,
+		bool create)
+{
+	struct bt_event_clock_value *entry = NULL;
+	struct bt_stream_class *stream_class;
+	struct bt_trace *trace;
+	int64_t index;
+
+	assert(event->event_class);
+	stream_class = bt_event_class_borrow_stream_class(event->event_class);
+	assert(stream_class);
+	trace = bt_stream_class_borrow_trace(stream_class);
+	if (!trace) {
+		goto end;
+	}
+
+	index = bt_trace_get_clock_class_index(trace, clock_class);
+	if (index < 0) {
+		goto end;
+	}
+
+	if (index < BT_EVENT_INLINE_CLOCK_VALUE_COUNT) {
+		entry = &event->clock_values[index];
+		goto end;
+	}
+
+	index -= BT_EVENT_INLINE_CLOCK_VALUE_COUNT;
+
+	if (!event->extra_clock_values) {
+		if (!create) {
+			goto end;
+		}
+
+		event->extra_clock_values = g_array_new(FALSE, TRUE,
+			sizeof(struct bt_event_clock_value));
+		if (!event->extra_clock_values) {
+			BT_LOGE_STR("Failed to allocate a GArray.");
+			goto end;
+		}
+	}
+
+	if (index >= event->extra_clock_values->len) {
+		if (!create) {
+			goto end;
+		}
+
+		g_array_set_size(event->extra_clock_values, index + 1);
+	}
+
+	entry = &g_array_index(event->extra_clock_values,
+		struct bt_event_clock_value, index);
+
+end:
+	return entry;
+}
+
+static
+struct bt_event_clock_value *borrow_set_clock_value_entry(
+		struct bt_event *event, struct bt_clock_class *clock_class)
+{
+	struct bt_event_clock_value *entry;
+
+	entry = borrow_clock_value_entry(event, clock_class, false);
+	if (!entry || !entry->is_set) {
+		BT_LOGV("No clock value associated to the given clock class: "
+			"event-addr=%p, event-class-name=\"%s\", "
+			"event-class-id=%" PRId64 ", clock-class-addr=%p, "
+			"clock-class-name=\"%s\"", event,
+			bt_event_class_get_name(event->event_class),
+			bt_event_class_get_id(event->event_class),
+			clock_class, bt_clock_class_get_name(clock_class));
+		entry = NULL;
+	}
+
+	return entry;
+}
+
+BT_HIDDEN
+bt_bool bt_event_has_clock_value(struct bt_event *event,
+		struct bt_clock_class *clock_class)
+{
+	struct bt_event_clock_value *entry;
+
+	assert(event);
+	assert(clock_class);
+	entry = borrow_clock_value_entry(event, clock_class, false);
+	return entry && entry->is_set;
+}
+
 struct bt_clock_value *bt_event_get_clock_value(
 		struct bt_event *event, struct bt_clock_class *clock_class)
 {
 	struct bt_clock_value *clock_value = NULL;
+	struct bt_event_clock_value *entry;
 
 	if (!event || !clock_class) {
 		BT_LOGW("Invalid parameter: event or clock class is NULL: "
@@ -781,36 +1049,100 @@ struct bt_clock_value *bt_event_get_clock_value(
 		goto end;
 	}
 
-	clock_value = g_hash_table_lookup(event->clock_values, clock_class);
+	entry = borrow_set_clock_value_entry(event, clock_class);
+	if (!entry) {
+		goto end;
+	}
+
+	clock_value = bt_clock_value_create(clock_class, entry->cycles);
 	if (!clock_value) {
-		BT_LOGV("No clock value associated to the given clock class: "
-			"event-addr=%p, event-class-name=\"%s\", "
-			"event-class-id=%" PRId64 ", clock-class-addr=%p, "
-			"clock-class-name=\"%s\"", event,
-			bt_event_class_get_name(event->event_class),
-			bt_event_class_get_id(event->event_class),
-			clock_class, bt_clock_class_get_name(clock_class));
+		BT_LOGE("Cannot create clock value from clock class: "
+			"event-addr=%p, clock-class-addr=%p, "
+			"clock-class-name=\"%s\", clock-value-cycles=%" PRIu64,
+			event, clock_class,
+			bt_clock_class_get_name(clock_class), entry->cycles);
 		goto end;
 	}
 
-	bt_get(clock_value);
 end:
 	return clock_value;
 }
 
-int bt_event_set_clock_value(struct bt_event *event,
-		struct bt_clock_value *value)
+int bt_event_get_clock_value_cycles(struct bt_event *event,
+		struct bt_clock_class *clock_class, uint64_t *cycles)
 {
 	int ret = 0;
-	struct bt_trace *trace;
-	struct bt_stream_class *stream_class;
-	struct bt_event_class *event_class;
-	struct bt_clock_class *clock_class = NULL;
+	struct bt_event_clock_value *entry;
 
-	if (!event || !value) {
-		BT_LOGW("Invalid parameter: event or clock value is NULL: "
-			"event-addr=%p, clock-value-addr=%p",
-			event, value);
+	if (!event || !clock_class || !cycles) {
+		BT_LOGW("Invalid parameter: event, clock class, or cycles pointer is NULL: "
+			"event-addr=%p, clock-class-addr=%p, cycles-addr=%p",
+			event, clock_class, cycles);
+		ret = -1;
+		goto end;
+	}
+
+	entry = borrow_set_clock_value_entry(event, clock_class);
+	if (!entry) {
+		ret = -1;
+		goto end;
+	}
+
+	*cycles = entry->cycles;
+
+end:
+	return ret;
+}
+
+int bt_event_get_clock_value_ns_from_epoch(struct bt_event *event,
+		struct bt_clock_class *clock_class, int64_t *ns_from_epoch)
+{
+	int ret = 0;
+	struct bt_event_clock_value *entry;
+
+	if (!event || !clock_class || !ns_from_epoch) {
+		BT_LOGW("Invalid parameter: event, clock class, or nanoseconds pointer is NULL: "
+			"event-addr=%p, clock-class-addr=%p, ns-addr=%p",
+			event, clock_class, ns_from_epoch);
+		ret = -1;
+		goto end;
+	}
+
+	entry = borrow_set_clock_value_entry(event, clock_class);
+	if (!entry) {
+		ret = -1;
+		goto end;
+	}
+
+	ret = bt_clock_class_cycles_to_ns_from_epoch(clock_class,
+		entry->cycles, ns_from_epoch);
+	if (ret) {
+		BT_LOGW("Clock value converted to nanoseconds from Epoch overflows the signed 64-bit integer range: "
+			"event-addr=%p, clock-class-addr=%p, "
+			"clock-class-name=\"%s\", "
+			"clock-class-offset-s=%" PRId64 ", "
+			"clock-class-offset-cycles=%" PRId64 ", "
+			"value=%" PRIu64,
+			event, clock_class,
+			bt_clock_class_get_name(clock_class),
+			clock_class->offset_s, clock_class->offset,
+			entry->cycles);
+	}
+
+end:
+	return ret;
+}
+
+int bt_event_set_clock_value_cycles(struct bt_event *event,
+		struct bt_clock_class *clock_class, uint64_t cycles)
+{
+	int ret = 0;
+	struct bt_event_clock_value *entry;
+
+	if (!event || !clock_class) {
+		BT_LOGW("Invalid parameter: event or clock class is NULL: "
+			"event-addr=%p, clock-class-addr=%p",
+			event, clock_class);
 		ret = -1;
 		goto end;
 	}
@@ -824,15 +1156,8 @@ int bt_event_set_clock_value(struct bt_event *event,
 		goto end;
 	}
 
-	clock_class = bt_clock_value_get_class(value);
-	event_class = bt_event_borrow_event_class(event);
-	assert(event_class);
-	stream_class = bt_event_class_borrow_stream_class(event_class);
-	assert(stream_class);
-	trace = bt_stream_class_borrow_trace(stream_class);
-	assert(trace);
-
-	if (!bt_trace_has_clock_class(trace, clock_class)) {
+	entry = borrow_clock_value_entry(event, clock_class, true);
+	if (!entry) {
 		BT_LOGW("Invalid parameter: clock class is not part of event's trace: "
 			"event-addr=%p, event-class-name=\"%s\", "
 			"event-class-id=%" PRId64 ", clock-class-addr=%p, "
@@ -844,20 +1169,38 @@ int bt_event_set_clock_value(struct bt_event *event,
 		goto end;
 	}
 
-	g_hash_table_insert(event->clock_values, clock_class, bt_get(value));
+	bt_clock_class_freeze(clock_class);
+	entry->cycles = cycles;
+	entry->is_set = true;
 	BT_LOGV("Set event's clock value: "
 		"event-addr=%p, event-class-name=\"%s\", "
 		"event-class-id=%" PRId64 ", clock-class-addr=%p, "
-		"clock-class-name=\"%s\", clock-value-addr=%p, "
-		"clock-value-cycles=%" PRIu64,
+		"clock-class-name=\"%s\", clock-value-cycles=%" PRIu64,
 		event, bt_event_class_get_name(event->event_class),
 		bt_event_class_get_id(event->event_class),
-		clock_class, bt_clock_class_get_name(clock_class),
-		value, value->value);
-	clock_class = NULL;
+		clock_class, bt_clock_class_get_name(clock_class), cycles);
+
+end:
+	return ret;
+}
+
+int bt_event_set_clock_value(struct bt_event *event,
+		struct bt_clock_value *value)
+{
+	int ret = 0;
+
+	if (!event || !value) {
+		BT_LOGW("Invalid parameter: event or clock value is NULL: "
+			"event-addr=%p, clock-value-addr=%p",
+			event, value);
+		ret = -1;
+		goto end;
+	}
+
+	ret = bt_event_set_clock_value_cycles(event, value->clock_class,
+		value->value);
 
 end:
-	bt_put(clock_class);
 	return ret;
 }
 
@@ -30,6 +30,7 @@
 #include <babeltrace/lib-logging-internal.h>
 
 #include <babeltrace/ctf-ir/field-types-internal.h>
+#include <babeltrace/ctf-ir/fields-internal.h>
 #include <babeltrace/ctf-ir/field-path-internal.h>
 #include <babeltrace/ctf-ir/utils.h>
 #include <babeltrace/ref.h>
@@ -512,9 +513,310 @@ end:
 	return mapping;
 }
 
+/*
+ * Returns the index key of the signed enumeration container value
+ * `value`: flipping its sign bit gives keys which have the order of the
+ * values.
+ */
+static inline
+uint64_t enumeration_signed_key(int64_t value)
+{
+	return (uint64_t) value ^ (UINT64_C(1) << 63);
+}
+
+static
+void get_enumeration_mapping_keys(struct enumeration_mapping *mapping,
+		bt_bool is_signed, uint64_t *first_key, uint64_t *last_key)
+{
+	if (is_signed) {
+		*first_key = enumeration_signed_key(
+			mapping->range_start._signed);
+		*last_key = enumeration_signed_key(mapping->range_end._signed);
+	} else {
+		*first_key = mapping->range_start._unsigned;
+		*last_key = mapping->range_end._unsigned;
+	}
+}
+
+static
+gint compare_enumeration_keys(gconstpointer a, gconstpointer b)
+{
+	const uint64_t key_a = *((const uint64_t *) a);
+	const uint64_t key_b = *((const uint64_t *) b);
+
+	if (key_a < key_b) {
+		return -1;
+	} else if (key_a > key_b) {
+		return 1;
+	}
+
+	return 0;
+}
+
+/* Returns the position of the key `key` within the sorted keys `keys`. */
+static
+guint find_enumeration_key(GArray *keys, uint64_t key)
+{
+	guint low = 0;
+	guint high = keys->len;
+
+	while (high - low > 1) {
+		const guint mid = low + (high - low) / 2;
+
+		if (g_array_index(keys, uint64_t, mid) <= key) {
+			low = mid;
+		} else {
+			high = mid;
+		}
+	}
+
+	assert(g_array_index(keys, uint64_t, low) == key);
+	return low;
+}
+
+static
+void enumeration_index_destroy(struct enumeration_index *index)
+{
+	if (!index) {
+		return;
+	}
+
+	if (index->intervals) {
+		g_array_free(index->intervals, TRUE);
+	}
+
+	if (index->mapping_indexes) {
+		g_array_free(index->mapping_indexes, TRUE);
+	}
+
+	if (index->mapping_names) {
+		g_ptr_array_free(index->mapping_names, TRUE);
+	}
+
+	g_free(index);
+}
+
+/*
+ * Builds the mapping lookup index of the enumeration field type
+ * `enumeration_type`, of which the mappings cannot change anymore.
+ *
+ * The first keys of the mapping ranges and the keys following their
+ * last keys split the whole key space into elementary ranges of which
+ * all the values are contained in the same mappings: each one which is
+ * contained in at least one mapping becomes an interval of the index.
+ */
+static
+struct enumeration_index *enumeration_index_create(
+		struct bt_field_type_enumeration *enumeration_type)
+{
+	struct enumeration_index *index = NULL;
+	GArray *keys = NULL;
+	guint *counts = NULL;
+	guint *positions = NULL;
+	const guint mapping_count = enumeration_type->entries->len;
+	const bt_bool is_signed = bt_field_type_integer_is_signed(
+		enumeration_type->container);
+	guint i, k, pos;
+
+	BT_LOGD("Creating enumeration field type's index: addr=%p, "
+		"mapping-count=%u", enumeration_type, mapping_count);
+	index = g_new0(struct enumeration_index, 1);
+	if (!index) {
+		BT_LOGE_STR("Failed to allocate one enumeration field type index.");
+		goto error;
+	}
+
+	index->intervals = g_array_new(FALSE, FALSE,
+		sizeof(struct enumeration_index_interval));
+	index->mapping_indexes = g_array_new(FALSE, FALSE, sizeof(guint));
+	keys = g_array_sized_new(FALSE, FALSE, sizeof(uint64_t),
+		mapping_count * 2);
+	if (!index->intervals || !index->mapping_indexes || !keys) {
+		BT_LOGE_STR("Failed to allocate a GArray.");
+		goto error;
+	}
+
+	index->mapping_names = g_ptr_array_new();
+	if (!index->mapping_names) {
+		BT_LOGE_STR("Failed to allocate a GPtrArray.");
+		goto error;
+	}
+
+	if (mapping_count == 0) {
+		goto end;
+	}
+
+	/* Sorted, unique boundaries of the elementary ranges */
+	for (i = 0; i < mapping_count; i++) {
+		uint64_t first_key, last_key;
+
+		get_enumeration_mapping_keys(
+			g_ptr_array_index(enumeration_type->entries, i),
+			is_signed, &first_key, &last_key);
+		g_array_append_val(keys, first_key);
+		if (last_key != UINT64_MAX) {
+			last_key++;
+			g_array_append_val(keys, last_key);
+		}
+	}
+
+	g_array_sort(keys, compare_enumeration_keys);
+	for (i = 0, k = 0; i < keys->len; i++) {
+		const uint64_t key = g_array_index(keys, uint64_t, i);
+
+		if (k == 0 || key != g_array_index(keys, uint64_t, k - 1)) {
+			g_array_index(keys, uint64_t, k) = key;
+			k++;
+		}
+	}
+
+	g_array_set_size(keys, k);
+	counts = g_new0(guint, keys->len);
+	positions = g_new0(guint, keys->len);
+	if (!counts || !positions) {
+		BT_LOGE_STR("Failed to allocate enumeration field type index counters.");
+		goto error;
+	}
+
+	/* Count the mappings which contain each elementary range */
+	for (i = 0; i < mapping_count; i++) {
+		uint64_t first_key, last_key;
+
+		get_enumeration_mapping_keys(
+			g_ptr_array_index(enumeration_type->entries, i),
+			is_signed, &first_key, &last_key);
+		for (k = find_enumeration_key(keys, first_key);
+				k < keys->len &&
+				g_array_index(keys, uint64_t, k) <= last_key;
+				k++) {
+			counts[k]++;
+		}
+	}
+
+	/* Create the intervals */
+	for (k = 0, pos = 0; k < keys->len; k++) {
+		struct enumeration_index_interval interval;
+
+		if (counts[k] == 0) {
+			continue;
+		}
+
+		interval.first_key = g_array_index(keys, uint64_t, k);
+		interval.last_key = k + 1 < keys->len ?
+			g_array_index(keys, uint64_t, k + 1) - 1 : UINT64_MAX;
+		interval.first = pos;
+		interval.count = counts[k];
+		g_array_append_val(index->intervals, interval);
+		positions[k] = pos;
+		pos += counts[k];
+	}
+
+	/* Set the mappings of each interval, in entry order */
+	g_array_set_size(index->mapping_indexes, pos);
+	g_ptr_array_set_size(index->mapping_names, pos);
+	for (i = 0; i < mapping_count; i++) {
+		struct enumeration_mapping *mapping =
+			g_ptr_array_index(enumeration_type->entries, i);
+		uint64_t first_key, last_key;
+
+		get_enumeration_mapping_keys(mapping, is_signed, &first_key,
+			&last_key);
+		for (k = find_enumeration_key(keys, first_key);
+				k < keys->len &&
+				g_array_index(keys, uint64_t, k) <= last_key;
+				k++) {
+			g_array_index(index->mapping_indexes, guint,
+				positions[k]) = i;
+			g_ptr_array_index(index->mapping_names, positions[k]) =
+				(gpointer) g_quark_to_string(mapping->string);
+			positions[k]++;
+		}
+	}
+
+	BT_LOGD("Created enumeration field type's index: addr=%p, "
+		"interval-count=%u", enumeration_type,
+		index->intervals->len);
+	goto end;
+
+error:
+	enumeration_index_destroy(index);
+	index = NULL;
+
+end:
+	if (keys) {
+		g_array_free(keys, TRUE);
+	}
+
+	g_free(counts);
+	g_free(positions);
+	return index;
+}
+
+/*
+ * Returns the interval of the index `index` which contains the key
+ * `key`, or NULL if no mapping contains it.
+ */
+static
+const struct enumeration_index_interval *find_enumeration_index_interval(
+		const struct enumeration_index *index, uint64_t key)
+{
+	guint low = 0;
+	guint high = index->intervals->len;
+
+	while (low < high) {
+		const guint mid = low + (high - low) / 2;
+		const struct enumeration_index_interval *interval =
+			&g_array_index(index->intervals,
+				struct enumeration_index_interval, mid);
+
+		if (key < interval->first_key) {
+			high = mid;
+		} else if (key > interval->last_key) {
+			low = mid + 1;
+		} else {
+			return interval;
+		}
+	}
+
+	return NULL;
+}
+
+static
+bt_bool enumeration_index_has_overlaps(const struct enumeration_index *index)
+{
+	guint i;
+
+	for (i = 0; i < index->intervals->len; i++) {
+		if (g_array_index(index->intervals,
+				struct enumeration_index_interval, i).count > 1) {
+			return BT_TRUE;
+		}
+	}
+
+	return BT_FALSE;
+}
+
+/*
+ * Returns the key, within the index of the enumeration field type
+ * `enumeration_type`, of the container value `value` (reinterpreted
+ * as signed if the container is signed).
+ */
+static
+uint64_t get_enumeration_index_key(
+		struct bt_field_type_enumeration *enumeration_type,
+		uint64_t value)
+{
+	if (bt_field_type_integer_is_signed(enumeration_type->container)) {
+		return enumeration_signed_key((int64_t) value);
+	}
+
+	return value;
+}
+
 /*
  * Note: This algorithm is O(n^2) vs number of enumeration mappings.
- * Only used when freezing an enumeration.
+ * Only used to validate a variant field type's tag before it is frozen:
+ * a frozen enumeration gets this flag from its index.
  */
 static
 void set_enumeration_range_overlap(
@@ -1292,6 +1594,43 @@ error:
 	return NULL;
 }
 
+/*
+ * Moves the value iterator `iter` to the next mapping which contains
+ * its value with the index of its enumeration field type.
+ */
+static
+int enumeration_mapping_iterator_next_indexed(
+		struct bt_field_type_enumeration_mapping_iterator *iter)
+{
+	const struct enumeration_index *index = iter->enumeration_type->index;
+	const struct enumeration_index_interval *interval;
+	uint64_t key;
+	guint i;
+
+	if (iter->type == ITERATOR_BY_SIGNED_VALUE) {
+		key = enumeration_signed_key(iter->u.signed_value);
+	} else {
+		key = iter->u.unsigned_value;
+	}
+
+	interval = find_enumeration_index_interval(index, key);
+	if (!interval) {
+		return -1;
+	}
+
+	for (i = interval->first; i < interval->first + interval->count; i++) {
+		const guint mapping_index = g_array_index(
+			index->mapping_indexes, guint, i);
+
+		if ((int) mapping_index > iter->index) {
+			iter->index = (int) mapping_index;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
 int bt_field_type_enumeration_mapping_iterator_next(
 		struct bt_field_type_enumeration_mapping_iterator *iter)
 {
@@ -1307,6 +1646,12 @@ int bt_field_type_enumeration_mapping_iterator_next(
 
 	enumeration = iter->enumeration_type;
 	type = &enumeration->parent;
+
+	if (iter->type != ITERATOR_BY_NAME && enumeration->index) {
+		ret = enumeration_mapping_iterator_next_indexed(iter);
+		goto end;
+	}
+
 	len = enumeration->entries->len;
 	for (i = iter->index + 1; i < len; i++) {
 		struct enumeration_mapping *mapping =
@@ -1410,6 +1755,110 @@ error:
 	return NULL;
 }
 
+/*
+ * Returns the frozen enumeration field type `type`, checking that its
+ * container's signedness is `is_signed`, or NULL on error.
+ */
+static
+struct bt_field_type_enumeration *get_indexed_enumeration_type(
+		struct bt_field_type *type, bt_bool is_signed,
+		const char * const **names)
+{
+	struct bt_field_type_enumeration *enumeration_type = NULL;
+
+	if (!type) {
+		BT_LOGW_STR("Invalid parameter: field type is NULL.");
+		goto error;
+	}
+
+	if (!names) {
+		BT_LOGW_STR("Invalid parameter: names is NULL.");
+		goto error;
+	}
+
+	if (type->id != BT_FIELD_TYPE_ID_ENUM) {
+		BT_LOGW("Invalid parameter: field type is not an enumeration field type: "
+			"addr=%p, ft-id=%s", type,
+			bt_field_type_id_string(type->id));
+		goto error;
+	}
+
+	enumeration_type = container_of(type,
+		struct bt_field_type_enumeration, parent);
+	if (!enumeration_type->index) {
+		BT_LOGW("Invalid parameter: enumeration field type is not frozen: "
+			"addr=%p", type);
+		goto error;
+	}
+
+	if (bt_field_type_integer_is_signed(enumeration_type->container) !=
+			is_signed) {
+		BT_LOGW("Invalid parameter: enumeration field type is %s: "
+			"enum-ft-addr=%p, int-ft-addr=%p",
+			is_signed ? "unsigned" : "signed",
+			type, enumeration_type->container);
+		goto error;
+	}
+
+	goto end;
+
+error:
+	enumeration_type = NULL;
+
+end:
+	return enumeration_type;
+}
+
+static
+int64_t get_interval_mapping_names(const struct enumeration_index *index,
+		const struct enumeration_index_interval *interval,
+		const char * const **names)
+{
+	if (!interval) {
+		*names = NULL;
+		return 0;
+	}
+
+	*names = (const char * const *) &g_ptr_array_index(
+		index->mapping_names, interval->first);
+	return (int64_t) interval->count;
+}
+
+int64_t bt_field_type_enumeration_get_mapping_names_by_signed_value(
+		struct bt_field_type *type, int64_t value,
+		const char * const **names)
+{
+	struct bt_field_type_enumeration *enumeration_type;
+
+	enumeration_type = get_indexed_enumeration_type(type, BT_TRUE, names);
+	if (!enumeration_type) {
+		/* get_indexed_enumeration_type() logs errors */
+		return -1;
+	}
+
+	return get_interval_mapping_names(enumeration_type->index,
+		find_enumeration_index_interval(enumeration_type->index,
+			enumeration_signed_key(value)), names);
+}
+
+int64_t bt_field_type_enumeration_get_mapping_names_by_unsigned_value(
+		struct bt_field_type *type, uint64_t value,
+		const char * const **names)
+{
+	struct bt_field_type_enumeration *enumeration_type;
+
+	enumeration_type = get_indexed_enumeration_type(type, BT_FALSE,
+		names);
+	if (!enumeration_type) {
+		/* get_indexed_enumeration_type() logs errors */
+		return -1;
+	}
+
+	return get_interval_mapping_names(enumeration_type->index,
+		find_enumeration_index_interval(enumeration_type->index,
+			value), names);
+}
+
 int bt_field_type_enumeration_mapping_iterator_get_signed(
 		struct bt_field_type_enumeration_mapping_iterator *iter,
 		const char **mapping_name, int64_t *range_begin,
@@ -3241,6 +3690,30 @@ void bt_field_type_freeze(struct bt_field_type *type)
 	type->freeze(type);
 }
 
+/*
+ * Returns the name of the mapping of the frozen variant tag field type
+ * `tag` which contains the container value `value`, or 0 if there's
+ * none. The ranges of a variant tag field type do not overlap.
+ */
+static
+GQuark get_indexed_tag_mapping_name(struct bt_field_type_enumeration *tag,
+		uint64_t value)
+{
+	const struct enumeration_index_interval *interval;
+	struct enumeration_mapping *mapping;
+
+	interval = find_enumeration_index_interval(tag->index,
+		get_enumeration_index_key(tag, value));
+	if (!interval) {
+		return 0;
+	}
+
+	mapping = g_ptr_array_index(tag->entries,
+		g_array_index(tag->index->mapping_indexes, guint,
+			interval->first));
+	return mapping->string;
+}
+
 BT_HIDDEN
 struct bt_field_type *bt_field_type_variant_get_field_type_signed(
 		struct bt_field_type_variant *variant,
@@ -3257,13 +3730,22 @@ struct bt_field_type *bt_field_type_variant_get_field_type_signed(
 		.overlaps = 0,
 	};
 
-	g_ptr_array_foreach(variant->tag->entries, check_ranges_overlap,
-		&query);
-	if (!query.overlaps) {
-		goto end;
+	if (variant->tag->index) {
+		field_name_quark = get_indexed_tag_mapping_name(variant->tag,
+			(uint64_t) tag_value);
+		if (!field_name_quark) {
+			goto end;
+		}
+	} else {
+		g_ptr_array_foreach(variant->tag->entries,
+			check_ranges_overlap, &query);
+		if (!query.overlaps) {
+			goto end;
+		}
+
+		field_name_quark = query.mapping_name;
 	}
 
-	field_name_quark = query.mapping_name;
 	if (!g_hash_table_lookup_extended(variant->field_name_to_index,
 			GUINT_TO_POINTER(field_name_quark), NULL, &index)) {
 		goto end;
@@ -3291,14 +3773,22 @@ struct bt_field_type *bt_field_type_variant_get_field_type_unsigned(
 		.overlaps = 0,
 	};
 
-	g_ptr_array_foreach(variant->tag->entries,
-		check_ranges_overlap_unsigned,
-		&query);
-	if (!query.overlaps) {
-		goto end;
+	if (variant->tag->index) {
+		field_name_quark = get_indexed_tag_mapping_name(variant->tag,
+			tag_value);
+		if (!field_name_quark) {
+			goto end;
+		}
+	} else {
+		g_ptr_array_foreach(variant->tag->entries,
+			check_ranges_overlap_unsigned, &query);
+		if (!query.overlaps) {
+			goto end;
+		}
+
+		field_name_quark = query.mapping_name;
 	}
 
-	field_name_quark = query.mapping_name;
 	if (!g_hash_table_lookup_extended(variant->field_name_to_index,
 		GUINT_TO_POINTER(field_name_quark), NULL, &index)) {
 		goto end;
@@ -3592,6 +4082,7 @@ void bt_field_type_enumeration_destroy(struct bt_field_type *type)
 
 	BT_LOGD("Destroying enumeration field type object: addr=%p", type);
 	g_ptr_array_free(enumeration->entries, TRUE);
+	enumeration_index_destroy(enumeration->index);
 	BT_LOGD_STR("Putting container field type.");
 	bt_put(enumeration->container);
 	g_free(enumeration);
@@ -3624,6 +4115,7 @@ void bt_field_type_structure_destroy(struct bt_field_type *type)
 	BT_LOGD("Destroying structure field type object: addr=%p", type);
 	g_ptr_array_free(structure->fields, TRUE);
 	g_hash_table_destroy(structure->field_name_to_index);
+	bt_field_structure_layout_destroy(structure->field_layout);
 	g_free(structure);
 }
 
@@ -3725,7 +4217,16 @@ void bt_field_type_enumeration_freeze(struct bt_field_type *type)
 		type, struct bt_field_type_enumeration, parent);
 
 	BT_LOGD("Freezing enumeration field type object: addr=%p", type);
-	set_enumeration_range_overlap(type);
+
+	/* The mappings cannot change anymore: index them */
+	enumeration_type->index = enumeration_index_create(enumeration_type);
+	if (enumeration_type->index) {
+		enumeration_type->has_overlapping_ranges =
+			enumeration_index_has_overlaps(enumeration_type->index);
+	} else {
+		set_enumeration_range_overlap(type);
+	}
+
 	generic_field_type_freeze(type);
 	BT_LOGD("Freezing enumeration field type object's container field type: int-ft-addr=%p",
 		enumeration_type->container);
@@ -3753,6 +4254,9 @@ void bt_field_type_structure_freeze(struct bt_field_type *type)
 	generic_field_type_freeze(type);
 	g_ptr_array_foreach(structure_type->fields,
 		(GFunc) freeze_structure_field, NULL);
+
+	/* The members cannot change anymore: compute the fields' layout */
+	structure_type->field_layout = bt_field_structure_layout_create(type);
 }
 
 static
@@ -37,7 +37,10 @@
 #include <babeltrace/compiler-internal.h>
 #include <babeltrace/compat/fcntl-internal.h>
 #include <babeltrace/align-internal.h>
+#include <float.h>
 #include <inttypes.h>
+#include <limits.h>
+#include <string.h>
 
 static
 struct bt_field *bt_field_integer_create(struct bt_field_type *);
@@ -181,6 +184,10 @@ bt_bool bt_field_sequence_is_set(struct bt_field *);
 static
 int increase_packet_size(struct bt_stream_pos *pos);
 
+static
+bool structure_member_is_borrowed(struct bt_field_structure *structure,
+		struct bt_field *member);
+
 static
 struct bt_field *(* const field_create_funcs[])(
 		struct bt_field_type *) = {
@@ -311,13 +318,17 @@ struct bt_field *bt_field_create(struct bt_field_type *type)
 		goto error;
 	}
 
+	/*
+	 * The type's declaration can't change after this point. The
+	 * type is frozen before the field is created so that, for a
+	 * structure field type, the fields' layout is known.
+	 */
+	bt_field_type_freeze(type);
 	field = field_create_funcs[type_id](type);
 	if (!field) {
 		goto error;
 	}
 
-	/* The type's declaration can't change after this point */
-	bt_field_type_freeze(type);
 	bt_get(type);
 	bt_object_init(field, bt_field_destroy);
 	field->type = type;
@@ -501,6 +512,7 @@ int bt_field_sequence_set_length(struct bt_field *field,
 		bt_put(sequence->length);
 	}
 
+	sequence->packed.is_set = false;
 	sequence->elements = g_ptr_array_sized_new((size_t) sequence_length);
 	if (!sequence->elements) {
 		BT_LOGE_STR("Failed to allocate a GPtrArray.");
@@ -560,7 +572,7 @@ struct bt_field *bt_field_structure_get_field_by_name(
 		goto error;
 	}
 
-	ret = bt_get(structure->fields->pdata[index]);
+	ret = bt_get(structure->fields[index]);
 	assert(ret);
 error:
 	return ret;
@@ -587,14 +599,14 @@ struct bt_field *bt_field_structure_get_field_by_index(
 	}
 
 	structure = container_of(field, struct bt_field_structure, parent);
-	if (index >= structure->fields->len) {
+	if (index >= structure->field_count) {
 		BT_LOGW("Invalid parameter: index is out of bounds: "
-			"addr=%p, index=%" PRIu64 ", count=%u",
-			field, index, structure->fields->len);
+			"addr=%p, index=%" PRIu64 ", count=%" PRIu64,
+			field, index, structure->field_count);
 		goto end;
 	}
 
-	ret = bt_get(structure->fields->pdata[index]);
+	ret = bt_get(structure->fields[index]);
 end:
 	return ret;
 }
@@ -665,8 +677,18 @@ int bt_field_structure_set_field_by_name(struct bt_field *field,
 		ret = -1;
 		goto end;
 	}
-	bt_get(value);
-	BT_MOVE(structure->fields->pdata[index], value);
+
+	/* An inline field of the same tree lives as long as the structure */
+	if (!structure_member_is_borrowed(structure, value)) {
+		bt_get(value);
+	}
+
+	if (!structure_member_is_borrowed(structure,
+			structure->fields[index])) {
+		bt_put(structure->fields[index]);
+	}
+
+	structure->fields[index] = value;
 end:
 	if (expected_field_type) {
 		bt_put(expected_field_type);
@@ -674,6 +696,402 @@ end:
 	return ret;
 }
 
+/*
+ * Returns the size (bytes) of a packed element of type `element_type`,
+ * or 0 if the elements of this type cannot be packed.
+ */
+static
+size_t get_packed_element_size(struct bt_field_type *element_type)
+{
+	size_t size = 0;
+
+	switch (bt_field_type_get_type_id(element_type)) {
+	case BT_FIELD_TYPE_ID_INTEGER:
+	{
+		struct bt_field_type_integer *integer_type = container_of(
+			element_type, struct bt_field_type_integer, parent);
+
+		switch (integer_type->size) {
+		case 8:
+		case 16:
+		case 32:
+		case 64:
+			size = integer_type->size / CHAR_BIT;
+			break;
+		default:
+			break;
+		}
+
+		break;
+	}
+	case BT_FIELD_TYPE_ID_FLOAT:
+	{
+		struct bt_field_type_floating_point *float_type = container_of(
+			element_type, struct bt_field_type_floating_point,
+			parent);
+
+		if (float_type->mant_dig == FLT_MANT_DIG &&
+				float_type->exp_dig + float_type->mant_dig ==
+				sizeof(float) * CHAR_BIT) {
+			size = sizeof(float);
+		} else if (float_type->mant_dig == DBL_MANT_DIG &&
+				float_type->exp_dig + float_type->mant_dig ==
+				sizeof(double) * CHAR_BIT) {
+			size = sizeof(double);
+		}
+
+		break;
+	}
+	default:
+		break;
+	}
+
+	return size;
+}
+
+static
+void set_element_from_packed(struct bt_field *element,
+		const uint8_t *packed_element, size_t size)
+{
+	union {
+		uint8_t u8;
+		uint16_t u16;
+		uint32_t u32;
+		uint64_t u64;
+		float f;
+		double d;
+	} value;
+
+	memcpy(&value, packed_element, size);
+
+	if (bt_field_type_get_type_id(element->type) ==
+			BT_FIELD_TYPE_ID_FLOAT) {
+		struct bt_field_floating_point *floating_point = container_of(
+			element, struct bt_field_floating_point, parent);
+
+		floating_point->payload = size == sizeof(float) ?
+			(double) value.f : value.d;
+	} else {
+		struct bt_field_integer *integer = container_of(element,
+			struct bt_field_integer, parent);
+		bt_bool is_signed = container_of(element->type,
+			struct bt_field_type_integer, parent)->is_signed;
+
+		switch (size) {
+		case 1:
+			if (is_signed) {
+				integer->payload.signd = (int8_t) value.u8;
+			} else {
+				integer->payload.unsignd = value.u8;
+			}
+			break;
+		case 2:
+			if (is_signed) {
+				integer->payload.signd = (int16_t) value.u16;
+			} else {
+				integer->payload.unsignd = value.u16;
+			}
+			break;
+		case 4:
+			if (is_signed) {
+				integer->payload.signd = (int32_t) value.u32;
+			} else {
+				integer->payload.unsignd = value.u32;
+			}
+			break;
+		case 8:
+			integer->payload.unsignd = value.u64;
+			break;
+		default:
+			abort();
+		}
+	}
+
+	element->payload_set = true;
+}
+
+/*
+ * Creates the element fields of an array or sequence field from its
+ * packed elements.
+ *
+ * This is done even if the field is frozen: the values of its elements
+ * do not change, only their representation. The created element fields
+ * are then frozen too.
+ */
+static
+int unpack_elements(struct bt_field *field, GPtrArray *elements,
+		struct bt_field_packed_elements *packed,
+		struct bt_field_type *element_type)
+{
+	int ret = 0;
+	size_t size = get_packed_element_size(element_type);
+	size_t i;
+
+	BT_LOGV("Creating element fields from packed elements: "
+		"field-addr=%p, count=%u", field, elements->len);
+	assert(size > 0);
+	assert(packed->buf->len == elements->len * size);
+
+	for (i = 0; i < elements->len; i++) {
+		struct bt_field *element;
+
+		if (elements->pdata[i]) {
+			/* Created during a previous, failed call */
+			continue;
+		}
+
+		element = bt_field_create(element_type);
+		if (!element) {
+			BT_LOGE("Cannot create element field: "
+				"field-addr=%p, index=%zu", field, i);
+			ret = -1;
+			goto end;
+		}
+
+		set_element_from_packed(element, &packed->buf->data[i * size],
+			size);
+
+		if (field->frozen) {
+			bt_field_freeze(element);
+		}
+
+		elements->pdata[i] = element;
+	}
+
+	packed->is_set = false;
+
+end:
+	return ret;
+}
+
+static
+int set_packed_elements(struct bt_field *field, GPtrArray *elements,
+		struct bt_field_packed_elements *packed,
+		struct bt_field_type *element_type, const void *values,
+		uint64_t count)
+{
+	int ret = 0;
+	size_t size = get_packed_element_size(element_type);
+	size_t i;
+
+	if (size == 0) {
+		BT_LOGW("Invalid parameter: field's element field type cannot be packed: "
+			"field-addr=%p, element-ft-addr=%p, element-ft-id=%s",
+			field, element_type,
+			bt_field_type_id_string(element_type->id));
+		ret = -1;
+		goto end;
+	}
+
+	if (count != elements->len) {
+		BT_LOGW("Invalid parameter: element count does not match the field's length: "
+			"field-addr=%p, count=%" PRIu64 ", length=%u",
+			field, count, elements->len);
+		ret = -1;
+		goto end;
+	}
+
+	if (!packed->buf) {
+		packed->buf = g_byte_array_sized_new(count * size);
+		if (!packed->buf) {
+			BT_LOGE_STR("Failed to allocate a GByteArray.");
+			ret = -1;
+			goto end;
+		}
+	}
+
+	/* The packed elements replace the element fields */
+	for (i = 0; i < elements->len; i++) {
+		BT_PUT(elements->pdata[i]);
+	}
+
+	g_byte_array_set_size(packed->buf, count * size);
+	if (count > 0) {
+		memcpy(packed->buf->data, values, count * size);
+	}
+
+	packed->is_set = true;
+	BT_LOGV("Set packed elements: field-addr=%p, count=%" PRIu64,
+		field, count);
+
+end:
+	return ret;
+}
+
+int bt_field_array_set_packed_elements(struct bt_field *field,
+		const void *elements, uint64_t count)
+{
+	int ret = 0;
+	struct bt_field_array *array;
+
+	if (!field) {
+		BT_LOGW_STR("Invalid parameter: field is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (!elements && count > 0) {
+		BT_LOGW_STR("Invalid parameter: elements are NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (bt_field_type_get_type_id(field->type) !=
+			BT_FIELD_TYPE_ID_ARRAY) {
+		BT_LOGW("Invalid parameter: field's type is not an array field type: "
+			"field-addr=%p, ft-addr=%p, ft-id=%s", field,
+			field->type,
+			bt_field_type_id_string(field->type->id));
+		ret = -1;
+		goto end;
+	}
+
+	if (field->frozen) {
+		BT_LOGW("Invalid parameter: field is frozen: addr=%p",
+			field);
+		ret = -1;
+		goto end;
+	}
+
+	array = container_of(field, struct bt_field_array, parent);
+	ret = set_packed_elements(field, array->elements, &array->packed,
+		container_of(field->type, struct bt_field_type_array,
+			parent)->element_type, elements, count);
+
+end:
+	return ret;
+}
+
+const void *bt_field_array_get_packed_elements(struct bt_field *field,
+		uint64_t *count)
+{
+	const void *ret = NULL;
+	struct bt_field_array *array;
+
+	if (!field) {
+		BT_LOGW_STR("Invalid parameter: field is NULL.");
+		goto end;
+	}
+
+	if (!count) {
+		BT_LOGW_STR("Invalid parameter: count is NULL.");
+		goto end;
+	}
+
+	if (bt_field_type_get_type_id(field->type) !=
+			BT_FIELD_TYPE_ID_ARRAY) {
+		BT_LOGW("Invalid parameter: field's type is not an array field type: "
+			"field-addr=%p, ft-addr=%p, ft-id=%s", field,
+			field->type,
+			bt_field_type_id_string(field->type->id));
+		goto end;
+	}
+
+	array = container_of(field, struct bt_field_array, parent);
+	if (!array->packed.is_set) {
+		BT_LOGV("Array field's elements are not packed: addr=%p",
+			field);
+		goto end;
+	}
+
+	*count = array->elements->len;
+	ret = array->packed.buf->data;
+
+end:
+	return ret;
+}
+
+int bt_field_sequence_set_packed_elements(struct bt_field *field,
+		const void *elements, uint64_t count)
+{
+	int ret = 0;
+	struct bt_field_sequence *sequence;
+
+	if (!field) {
+		BT_LOGW_STR("Invalid parameter: field is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (!elements && count > 0) {
+		BT_LOGW_STR("Invalid parameter: elements are NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (bt_field_type_get_type_id(field->type) !=
+			BT_FIELD_TYPE_ID_SEQUENCE) {
+		BT_LOGW("Invalid parameter: field's type is not a sequence field type: "
+			"field-addr=%p, ft-addr=%p, ft-id=%s", field,
+			field->type,
+			bt_field_type_id_string(field->type->id));
+		ret = -1;
+		goto end;
+	}
+
+	if (field->frozen) {
+		BT_LOGW("Invalid parameter: field is frozen: addr=%p",
+			field);
+		ret = -1;
+		goto end;
+	}
+
+	sequence = container_of(field, struct bt_field_sequence, parent);
+	if (!sequence->elements) {
+		BT_LOGW("Invalid parameter: sequence field has no length field: "
+			"addr=%p", field);
+		ret = -1;
+		goto end;
+	}
+
+	ret = set_packed_elements(field, sequence->elements,
+		&sequence->packed,
+		container_of(field->type, struct bt_field_type_sequence,
+			parent)->element_type, elements, count);
+
+end:
+	return ret;
+}
+
+const void *bt_field_sequence_get_packed_elements(struct bt_field *field,
+		uint64_t *count)
+{
+	const void *ret = NULL;
+	struct bt_field_sequence *sequence;
+
+	if (!field) {
+		BT_LOGW_STR("Invalid parameter: field is NULL.");
+		goto end;
+	}
+
+	if (!count) {
+		BT_LOGW_STR("Invalid parameter: count is NULL.");
+		goto end;
+	}
+
+	if (bt_field_type_get_type_id(field->type) !=
+			BT_FIELD_TYPE_ID_SEQUENCE) {
+		BT_LOGW("Invalid parameter: field's type is not a sequence field type: "
+			"field-addr=%p, ft-addr=%p, ft-id=%s", field,
+			field->type,
+			bt_field_type_id_string(field->type->id));
+		goto end;
+	}
+
+	sequence = container_of(field, struct bt_field_sequence, parent);
+	if (!sequence->packed.is_set) {
+		BT_LOGV("Sequence field's elements are not packed: addr=%p",
+			field);
+		goto end;
+	}
+
+	*count = sequence->elements->len;
+	ret = sequence->packed.buf->data;
+
+end:
+	return ret;
+}
+
 struct bt_field *bt_field_array_get_field(struct bt_field *field,
 		uint64_t index)
 {
@@ -704,6 +1122,11 @@ struct bt_field *bt_field_array_get_field(struct bt_field *field,
 	}
 
 	field_type = bt_field_type_array_get_element_type(field->type);
+	if (array->packed.is_set && unpack_elements(field, array->elements,
+			&array->packed, field_type)) {
+		goto end;
+	}
+
 	if (array->elements->pdata[(size_t)index]) {
 		new_field = array->elements->pdata[(size_t)index];
 		goto end;
@@ -770,6 +1193,11 @@ struct bt_field *bt_field_sequence_get_field(struct bt_field *field,
 	}
 
 	field_type = bt_field_type_sequence_get_element_type(field->type);
+	if (sequence->packed.is_set && unpack_elements(field,
+			sequence->elements, &sequence->packed, field_type)) {
+		goto end;
+	}
+
 	if (sequence->elements->pdata[(size_t) index]) {
 		new_field = sequence->elements->pdata[(size_t) index];
 		goto end;
@@ -1394,6 +1822,45 @@ end:
 	return ret;
 }
 
+static
+void clear_string_external_value(struct bt_field_string *string)
+{
+	string->external_value = NULL;
+	BT_PUT(string->external_owner);
+}
+
+/*
+ * Copies the external value of `string`, if any, to its payload, so
+ * that it can be modified.
+ */
+static
+int copy_string_external_value(struct bt_field_string *string)
+{
+	int ret = 0;
+
+	if (!string->external_value) {
+		goto end;
+	}
+
+	BT_LOGV("Copying string field's external value: addr=%p",
+		&string->parent);
+	if (string->payload) {
+		g_string_assign(string->payload, string->external_value);
+	} else {
+		string->payload = g_string_new(string->external_value);
+		if (!string->payload) {
+			BT_LOGE_STR("Failed to allocate a GString.");
+			ret = -1;
+			goto end;
+		}
+	}
+
+	clear_string_external_value(string);
+
+end:
+	return ret;
+}
+
 const char *bt_field_string_get_value(struct bt_field *field)
 {
 	const char *ret = NULL;
@@ -1418,15 +1885,64 @@ const char *bt_field_string_get_value(struct bt_field *field)
 		goto end;
 	}
 
-	string = container_of(field,
-		struct bt_field_string, parent);
-	ret = string->payload->str;
+	string = container_of(field,
+		struct bt_field_string, parent);
+	ret = string->external_value ? string->external_value :
+		string->payload->str;
+end:
+	return ret;
+}
+
+int bt_field_string_set_value(struct bt_field *field,
+		const char *value)
+{
+	int ret = 0;
+	struct bt_field_string *string;
+
+	if (!field) {
+		BT_LOGW_STR("Invalid parameter: field is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (!value) {
+		BT_LOGW_STR("Invalid parameter: value is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (field->frozen) {
+		BT_LOGW("Invalid parameter: field is frozen: addr=%p",
+			field);
+		ret = -1;
+		goto end;
+	}
+
+	if (bt_field_type_get_type_id(field->type) !=
+			BT_FIELD_TYPE_ID_STRING) {
+		BT_LOGW("Invalid parameter: field's type is not a string field type: "
+			"field-addr=%p, ft-addr=%p, ft-id=%s", field,
+			field->type,
+			bt_field_type_id_string(field->type->id));
+		ret = -1;
+		goto end;
+	}
+
+	string = container_of(field, struct bt_field_string, parent);
+	clear_string_external_value(string);
+	if (string->payload) {
+		g_string_assign(string->payload, value);
+	} else {
+		string->payload = g_string_new(value);
+	}
+
+	string->parent.payload_set = true;
 end:
 	return ret;
 }
 
-int bt_field_string_set_value(struct bt_field *field,
-		const char *value)
+int bt_field_string_set_external_value(struct bt_field *field,
+		const char *value, void *owner)
 {
 	int ret = 0;
 	struct bt_field_string *string;
@@ -1461,13 +1977,14 @@ int bt_field_string_set_value(struct bt_field *field,
 	}
 
 	string = container_of(field, struct bt_field_string, parent);
-	if (string->payload) {
-		g_string_assign(string->payload, value);
-	} else {
-		string->payload = g_string_new(value);
-	}
 
+	/* Get the new owner first: it can be the current one */
+	bt_get(owner);
+	clear_string_external_value(string);
+	string->external_value = value;
+	string->external_owner = owner;
 	string->parent.payload_set = true;
+
 end:
 	return ret;
 }
@@ -1508,6 +2025,10 @@ int bt_field_string_append(struct bt_field *field,
 	}
 
 	string_field = container_of(field, struct bt_field_string, parent);
+	ret = copy_string_external_value(string_field);
+	if (ret) {
+		goto end;
+	}
 
 	if (string_field->payload) {
 		g_string_append(string_field->payload, value);
@@ -1559,6 +2080,10 @@ int bt_field_string_append_len(struct bt_field *field,
 	}
 
 	string_field = container_of(field, struct bt_field_string, parent);
+	ret = copy_string_external_value(string_field);
+	if (ret) {
+		goto end;
+	}
 
 	/* make sure no null bytes are appended */
 	for (i = 0; i < length; ++i) {
@@ -1784,27 +2309,161 @@ struct bt_field *bt_field_floating_point_create(
 }
 
 static
-struct bt_field *bt_field_structure_create(
-	struct bt_field_type *type)
+size_t get_inline_field_size(struct bt_field_type *type)
+{
+	size_t size = 0;
+
+	switch (bt_field_type_get_type_id(type)) {
+	case BT_FIELD_TYPE_ID_INTEGER:
+		size = sizeof(struct bt_field_integer);
+		break;
+	case BT_FIELD_TYPE_ID_FLOAT:
+		size = sizeof(struct bt_field_floating_point);
+		break;
+	case BT_FIELD_TYPE_ID_ENUM:
+		size = sizeof(struct bt_field_enumeration);
+		break;
+	case BT_FIELD_TYPE_ID_STRING:
+		size = sizeof(struct bt_field_string);
+		break;
+	case BT_FIELD_TYPE_ID_STRUCT:
+	{
+		struct bt_field_structure_layout *layout = container_of(type,
+			struct bt_field_type_structure, parent)->field_layout;
+
+		/* Not inline if its own layout is unknown */
+		if (layout) {
+			size = layout->size;
+		}
+
+		break;
+	}
+	default:
+		/* Not inline */
+		break;
+	}
+
+	return size;
+}
+
+BT_HIDDEN
+struct bt_field_structure_layout *bt_field_structure_layout_create(
+		struct bt_field_type *type)
 {
 	struct bt_field_type_structure *structure_type = container_of(type,
 		struct bt_field_type_structure, parent);
-	struct bt_field_structure *structure = g_new0(
-		struct bt_field_structure, 1);
-	struct bt_field *ret = NULL;
+	struct bt_field_structure_layout *layout;
 	size_t i;
 
-	BT_LOGD("Creating structure field object: ft-addr=%p", type);
-
-	if (!structure) {
-		BT_LOGE_STR("Failed to allocate one structure field.");
+	BT_LOGD("Computing structure fields' layout: ft-addr=%p", type);
+	layout = g_new0(struct bt_field_structure_layout, 1);
+	if (!layout) {
+		BT_LOGE_STR("Failed to allocate one structure fields' layout.");
 		goto end;
 	}
 
-	structure->fields = g_ptr_array_new_with_free_func(
-		(GDestroyNotify) bt_put);
-	g_ptr_array_set_size(structure->fields,
-		structure_type->fields->len);
+	layout->member_offsets = g_new0(size_t, structure_type->fields->len);
+
+	/* The array of member field pointers follows the structure field */
+	layout->size = sizeof(struct bt_field_structure) +
+		structure_type->fields->len * sizeof(struct bt_field *);
+
+	for (i = 0; i < structure_type->fields->len; i++) {
+		struct structure_field *field_type =
+			g_ptr_array_index(structure_type->fields, i);
+		size_t size = get_inline_field_size(field_type->type);
+
+		if (size == 0) {
+			continue;
+		}
+
+		layout->size = ALIGN(layout->size, G_MEM_ALIGN);
+		layout->member_offsets[i] = layout->size;
+		layout->size += size;
+	}
+
+	BT_LOGD("Computed structure fields' layout: ft-addr=%p, size=%zu",
+		type, layout->size);
+
+end:
+	return layout;
+}
+
+BT_HIDDEN
+void bt_field_structure_layout_destroy(
+		struct bt_field_structure_layout *layout)
+{
+	if (!layout) {
+		return;
+	}
+
+	g_free(layout->member_offsets);
+	g_free(layout);
+}
+
+static
+struct bt_field *get_field_root(struct bt_field *field)
+{
+	/* Only inline fields have a parent object: their root */
+	return field->base.parent ?
+		container_of(field->base.parent, struct bt_field, base) :
+		field;
+}
+
+/*
+ * Returns whether or not a member field of a structure field is one of
+ * the inline fields of the same field tree, in which case the structure
+ * field does not hold a reference on it.
+ */
+static
+bool structure_member_is_borrowed(struct bt_field_structure *structure,
+		struct bt_field *member)
+{
+	return member && member->base.parent ==
+		&get_field_root(&structure->parent)->base;
+}
+
+static
+int init_structure(struct bt_field_structure *structure,
+		struct bt_field_type *type, struct bt_field *root);
+
+static
+int init_inline_field(struct bt_field *field, struct bt_field_type *type,
+		struct bt_field *root)
+{
+	int ret = 0;
+
+	bt_object_init(field, bt_field_destroy);
+
+	/*
+	 * The field is owned by its structure field, without a
+	 * reference: the first reference taken on it is a reference on
+	 * the root, which destroys it with the whole block.
+	 */
+	field->base.ref_count.count = 0;
+	field->base.parent = &root->base;
+	field->type = bt_get(type);
+
+	if (bt_field_type_get_type_id(type) == BT_FIELD_TYPE_ID_STRUCT) {
+		ret = init_structure(container_of(field,
+			struct bt_field_structure, parent), type, root);
+	}
+
+	return ret;
+}
+
+static
+int init_structure(struct bt_field_structure *structure,
+		struct bt_field_type *type, struct bt_field *root)
+{
+	struct bt_field_type_structure *structure_type = container_of(type,
+		struct bt_field_type_structure, parent);
+	struct bt_field_structure_layout *layout = structure_type->field_layout;
+	int ret = 0;
+	size_t i;
+
+	structure->fields = (struct bt_field **) (structure + 1);
+	structure->field_count = structure_type->fields->len;
 
 	/* Create all fields contained by the structure field. */
 	for (i = 0; i < structure_type->fields->len; i++) {
@@ -1812,20 +2471,96 @@ struct bt_field *bt_field_structure_create(
 		struct structure_field *field_type =
 			g_ptr_array_index(structure_type->fields, i);
 
-		field = bt_field_create(field_type->type);
-		if (!field) {
+		if (layout->member_offsets[i]) {
+			field = (void *) ((char *) structure +
+				layout->member_offsets[i]);
+			structure->fields[i] = field;
+			ret = init_inline_field(field, field_type->type, root);
+		} else {
+			field = bt_field_create(field_type->type);
+			structure->fields[i] = field;
+			ret = field ? 0 : -1;
+		}
+
+		if (ret) {
 			BT_LOGE("Failed to create structure field's member: name=\"%s\", index=%zu",
 				g_quark_to_string(field_type->name), i);
-			bt_field_structure_destroy(&structure->parent);
 			goto end;
 		}
+	}
+
+end:
+	return ret;
+}
+
+static
+void fini_structure(struct bt_field_structure *structure,
+		struct bt_field_type *type)
+{
+	struct bt_field_structure_layout *layout = container_of(type,
+		struct bt_field_type_structure, parent)->field_layout;
+	uint64_t i;
+
+	for (i = 0; i < structure->field_count; i++) {
+		struct bt_field *member = structure->fields[i];
+
+		if (!structure_member_is_borrowed(structure, member)) {
+			bt_put(member);
+		}
+	}
+
+	/* Inline fields, including the ones which were replaced */
+	for (i = 0; i < structure->field_count; i++) {
+		struct bt_field *field;
+
+		if (!layout->member_offsets[i]) {
+			continue;
+		}
+
+		field = (void *) ((char *) structure + layout->member_offsets[i]);
+		if (!field->type) {
+			/* Not initialized */
+			continue;
+		}
+
+		field_destroy_funcs[bt_field_type_get_type_id(field->type)](
+			field);
+		bt_put(field->type);
+	}
+}
+
+static
+struct bt_field *bt_field_structure_create(
+	struct bt_field_type *type)
+{
+	struct bt_field_structure_layout *layout = container_of(type,
+		struct bt_field_type_structure, parent)->field_layout;
+	struct bt_field_structure *structure = NULL;
+	struct bt_field *ret = NULL;
+
+	BT_LOGD("Creating structure field object: ft-addr=%p", type);
+
+	if (!layout) {
+		BT_LOGE("Structure field type has no fields' layout: "
+			"ft-addr=%p", type);
+		goto end;
+	}
+
+	structure = g_malloc0(layout->size);
+	if (!structure) {
+		BT_LOGE_STR("Failed to allocate one structure field.");
+		goto end;
+	}
 
-		g_ptr_array_index(structure->fields, i) = field;
+	if (init_structure(structure, type, &structure->parent)) {
+		fini_structure(structure, type);
+		g_free(structure);
+		goto end;
 	}
 
 	ret = &structure->parent;
-	BT_LOGD("Created structure field object: addr=%p, ft-addr=%p", ret,
-		type);
+	BT_LOGD("Created structure field object: addr=%p, ft-addr=%p, "
+		"size=%zu", ret, type, layout->size);
 end:
 	return ret;
 }
@@ -1933,20 +2668,17 @@ void bt_field_destroy(struct bt_object *obj)
 	field_destroy_funcs[type_id](field);
 	BT_LOGD_STR("Putting field's type.");
 	bt_put(type);
+	g_free(field);
 }
 
 static
 void bt_field_integer_destroy(struct bt_field *field)
 {
-	struct bt_field_integer *integer;
-
 	if (!field) {
 		return;
 	}
 
 	BT_LOGD("Destroying integer field object: addr=%p", field);
-	integer = container_of(field, struct bt_field_integer, parent);
-	g_free(integer);
 }
 
 static
@@ -1963,22 +2695,16 @@ void bt_field_enumeration_destroy(struct bt_field *field)
 		parent);
 	BT_LOGD_STR("Putting payload field.");
 	bt_put(enumeration->payload);
-	g_free(enumeration);
 }
 
 static
 void bt_field_floating_point_destroy(struct bt_field *field)
 {
-	struct bt_field_floating_point *floating_point;
-
 	if (!field) {
 		return;
 	}
 
 	BT_LOGD("Destroying floating point number field object: addr=%p", field);
-	floating_point = container_of(field, struct bt_field_floating_point,
-		parent);
-	g_free(floating_point);
 }
 
 static
@@ -1992,8 +2718,7 @@ void bt_field_structure_destroy(struct bt_field *field)
 
 	BT_LOGD("Destroying structure field object: addr=%p", field);
 	structure = container_of(field, struct bt_field_structure, parent);
-	g_ptr_array_free(structure->fields, TRUE);
-	g_free(structure);
+	fini_structure(structure, field->type);
 }
 
 static
@@ -2011,7 +2736,6 @@ void bt_field_variant_destroy(struct bt_field *field)
 	bt_put(variant->tag);
 	BT_LOGD_STR("Putting payload field.");
 	bt_put(variant->payload);
-	g_free(variant);
 }
 
 static
@@ -2026,7 +2750,9 @@ void bt_field_array_destroy(struct bt_field *field)
 	BT_LOGD("Destroying array field object: addr=%p", field);
 	array = container_of(field, struct bt_field_array, parent);
 	g_ptr_array_free(array->elements, TRUE);
-	g_free(array);
+	if (array->packed.buf) {
+		g_byte_array_free(array->packed.buf, TRUE);
+	}
 }
 
 static
@@ -2043,9 +2769,11 @@ void bt_field_sequence_destroy(struct bt_field *field)
 	if (sequence->elements) {
 		g_ptr_array_free(sequence->elements, TRUE);
 	}
+	if (sequence->packed.buf) {
+		g_byte_array_free(sequence->packed.buf, TRUE);
+	}
 	BT_LOGD_STR("Putting length field.");
 	bt_put(sequence->length);
-	g_free(sequence);
 }
 
 static
@@ -2059,10 +2787,10 @@ void bt_field_string_destroy(struct bt_field *field)
 
 	BT_LOGD("Destroying string field object: addr=%p", field);
 	string = container_of(field, struct bt_field_string, parent);
+	clear_string_external_value(string);
 	if (string->payload) {
 		g_string_free(string->payload, TRUE);
 	}
-	g_free(string);
 }
 
 static
@@ -2111,8 +2839,8 @@ int bt_field_structure_validate(struct bt_field *field)
 	}
 
 	structure = container_of(field, struct bt_field_structure, parent);
-	for (i = 0; i < structure->fields->len; i++) {
-		struct bt_field *entry_field = structure->fields->pdata[i];
+	for (i = 0; i < structure->field_count; i++) {
+		struct bt_field *entry_field = structure->fields[i];
 		ret = bt_field_validate(entry_field);
 
 		if (ret) {
@@ -2173,6 +2901,10 @@ int bt_field_array_validate(struct bt_field *field)
 	}
 
 	array = container_of(field, struct bt_field_array, parent);
+	if (array->packed.is_set) {
+		goto end;
+	}
+
 	for (i = 0; i < array->elements->len; i++) {
 		struct bt_field *elem_field = array->elements->pdata[i];
 
@@ -2202,6 +2934,10 @@ int bt_field_sequence_validate(struct bt_field *field)
 	}
 
 	sequence = container_of(field, struct bt_field_sequence, parent);
+	if (sequence->packed.is_set) {
+		goto end;
+	}
+
 	for (i = 0; i < sequence->elements->len; i++) {
 		struct bt_field *elem_field = sequence->elements->pdata[i];
 
@@ -2270,8 +3006,8 @@ int bt_field_structure_reset(struct bt_field *field)
 	}
 
 	structure = container_of(field, struct bt_field_structure, parent);
-	for (i = 0; i < structure->fields->len; i++) {
-		struct bt_field *member = structure->fields->pdata[i];
+	for (i = 0; i < structure->field_count; i++) {
+		struct bt_field *member = structure->fields[i];
 
 		if (!member) {
 			/*
@@ -2326,6 +3062,10 @@ int bt_field_array_reset(struct bt_field *field)
 	}
 
 	array = container_of(field, struct bt_field_array, parent);
+
+	/* Keep the buffer of packed elements to reuse it */
+	array->packed.is_set = false;
+
 	for (i = 0; i < array->elements->len; i++) {
 		struct bt_field *member = array->elements->pdata[i];
 
@@ -2366,6 +3106,9 @@ int bt_field_sequence_reset(struct bt_field *field)
 		g_ptr_array_free(sequence->elements, TRUE);
 		sequence->elements = NULL;
 	}
+
+	/* Keep the buffer of packed elements to reuse it */
+	sequence->packed.is_set = false;
 	BT_PUT(sequence->length);
 end:
 	return ret;
@@ -2389,6 +3132,7 @@ int bt_field_string_reset(struct bt_field *field)
 	}
 
 	string = container_of(field, struct bt_field_string, parent);
+	clear_string_external_value(string);
 	if (string->payload) {
 		g_string_truncate(string->payload, 0);
 	}
@@ -2515,9 +3259,8 @@ int bt_field_structure_serialize(struct bt_field *field,
 		goto end;
 	}
 
-	for (i = 0; i < structure->fields->len; i++) {
-		struct bt_field *member = g_ptr_array_index(
-			structure->fields, i);
+	for (i = 0; i < structure->field_count; i++) {
+		struct bt_field *member = structure->fields[i];
 		const char *field_name = NULL;
 
 		if (BT_LOG_ON_WARN) {
@@ -2582,6 +3325,15 @@ int bt_field_array_serialize(struct bt_field *field,
 		"native-bo=%s", field, pos->offset,
 		bt_byte_order_string(native_byte_order));
 
+	if (array->packed.is_set) {
+		ret = unpack_elements(field, array->elements, &array->packed,
+			container_of(field->type, struct bt_field_type_array,
+				parent)->element_type);
+		if (ret) {
+			goto end;
+		}
+	}
+
 	for (i = 0; i < array->elements->len; i++) {
 		struct bt_field *elem_field =
 			g_ptr_array_index(array->elements, i);
@@ -2616,6 +3368,16 @@ int bt_field_sequence_serialize(struct bt_field *field,
 		"native-bo=%s", field, pos->offset,
 		bt_byte_order_string(native_byte_order));
 
+	if (sequence->packed.is_set) {
+		ret = unpack_elements(field, sequence->elements,
+			&sequence->packed,
+			container_of(field->type, struct bt_field_type_sequence,
+				parent)->element_type);
+		if (ret) {
+			goto end;
+		}
+	}
+
 	for (i = 0; i < sequence->elements->len; i++) {
 		struct bt_field *elem_field =
 			g_ptr_array_index(sequence->elements, i);
@@ -2645,6 +3407,11 @@ int bt_field_string_serialize(struct bt_field *field,
 	int ret = 0;
 	struct bt_field_string *string = container_of(field,
 		struct bt_field_string, parent);
+	const char *value = string->external_value ?
+		string->external_value : string->payload->str;
+	const int64_t len = string->external_value ?
+		(int64_t) strlen(string->external_value) :
+		(int64_t) string->payload->len;
 	struct bt_field_type *character_type =
 		get_field_type(FIELD_TYPE_ALIAS_UINT8_T);
 	struct bt_field *character;
@@ -2656,8 +3423,8 @@ int bt_field_string_serialize(struct bt_field *field,
 	BT_LOGV_STR("Creating character field from string field's character field type.");
 	character = bt_field_create(character_type);
 
-	for (i = 0; i < string->payload->len + 1; i++) {
-		const uint64_t chr = (uint64_t) string->payload->str[i];
+	for (i = 0; i < len + 1; i++) {
+		const uint64_t chr = (uint64_t) value[i];
 
 		ret = bt_field_unsigned_integer_set_value(character, chr);
 		if (ret) {
@@ -2757,13 +3524,32 @@ int bt_field_structure_copy(struct bt_field *src,
 	struct_src = container_of(src, struct bt_field_structure, parent);
 	struct_dst = container_of(dst, struct bt_field_structure, parent);
 
-	g_ptr_array_set_size(struct_dst->fields, struct_src->fields->len);
+	assert(struct_dst->field_count == struct_src->field_count);
 
-	for (i = 0; i < struct_src->fields->len; i++) {
-		struct bt_field *field =
-			g_ptr_array_index(struct_src->fields, i);
+	for (i = 0; i < struct_src->field_count; i++) {
+		struct bt_field *field = struct_src->fields[i];
+		struct bt_field *dst_field = struct_dst->fields[i];
 		struct bt_field *field_copy = NULL;
 
+		if (field && structure_member_is_borrowed(struct_dst,
+				dst_field) && field->type == dst_field->type) {
+			/* Copy to the destination's inline field */
+			BT_LOGD("Copying structure field's field in place: "
+				"src-field-addr=%p, dst-field-addr=%p, "
+				"index=%" PRId64, field, dst_field, i);
+			dst_field->payload_set = field->payload_set;
+			ret = field_copy_funcs[bt_field_get_type_id(field)](
+				field, dst_field);
+			if (ret) {
+				BT_LOGE("Cannot copy structure field's field: "
+					"src-field-addr=%p, index=%" PRId64,
+					field, i);
+				goto end;
+			}
+
+			continue;
+		}
+
 		if (field) {
 			BT_LOGD("Copying structure field's field: src-field-addr=%p"
 				"index=%" PRId64, field, i);
@@ -2777,7 +3563,11 @@ int bt_field_structure_copy(struct bt_field *src,
 			}
 		}
 
-		BT_MOVE(g_ptr_array_index(struct_dst->fields, i), field_copy);
+		if (!structure_member_is_borrowed(struct_dst, dst_field)) {
+			bt_put(dst_field);
+		}
+
+		struct_dst->fields[i] = field_copy;
 	}
 
 	BT_LOGD_STR("Copied structure field.");
@@ -2836,6 +3626,12 @@ int bt_field_array_copy(struct bt_field *src,
 	array_src = container_of(src, struct bt_field_array, parent);
 	array_dst = container_of(dst, struct bt_field_array, parent);
 
+	if (array_src->packed.is_set) {
+		ret = bt_field_array_set_packed_elements(dst,
+			array_src->packed.buf->data, array_src->elements->len);
+		goto end;
+	}
+
 	g_ptr_array_set_size(array_dst->elements, array_src->elements->len);
 	for (i = 0; i < array_src->elements->len; i++) {
 		struct bt_field *field =
@@ -2907,6 +3703,13 @@ int bt_field_sequence_copy(struct bt_field *src,
 
 	assert(sequence_dst->elements->len == sequence_src->elements->len);
 
+	if (sequence_src->packed.is_set) {
+		ret = bt_field_sequence_set_packed_elements(dst,
+			sequence_src->packed.buf->data,
+			sequence_src->elements->len);
+		goto end;
+	}
+
 	for (i = 0; i < sequence_src->elements->len; i++) {
 		struct bt_field *field =
 			g_ptr_array_index(sequence_src->elements, i);
@@ -2946,7 +3749,23 @@ int bt_field_string_copy(struct bt_field *src,
 	string_src = container_of(src, struct bt_field_string, parent);
 	string_dst = container_of(dst, struct bt_field_string, parent);
 
-	if (string_src->payload) {
+	if (string_src->external_value && string_src->external_owner) {
+		/* Share the external value and its owner */
+		string_dst->external_value = string_src->external_value;
+		string_dst->external_owner =
+			bt_get(string_src->external_owner);
+	} else if (string_src->external_value) {
+		/*
+		 * Without an owner, the external value is only valid as
+		 * long as the source field exists: copy it.
+		 */
+		string_dst->payload = g_string_new(string_src->external_value);
+		if (!string_dst->payload) {
+			BT_LOGE_STR("Failed to allocate a GString.");
+			ret = -1;
+			goto end;
+		}
+	} else if (string_src->payload) {
 		string_dst->payload = g_string_new(string_src->payload->str);
 		if (!string_dst->payload) {
 			BT_LOGE_STR("Failed to allocate a GString.");
@@ -3034,9 +3853,8 @@ void bt_field_structure_freeze(struct bt_field *field)
 
 	BT_LOGD("Freezing structure field object: addr=%p", field);
 
-	for (i = 0; i < structure_field->fields->len; i++) {
-		struct bt_field *field =
-			g_ptr_array_index(structure_field->fields, i);
+	for (i = 0; i < structure_field->field_count; i++) {
+		struct bt_field *field = structure_field->fields[i];
 
 		BT_LOGD("Freezing structure field's field: field-addr=%p, index=%" PRId64,
 			field, i);
@@ -3168,9 +3986,9 @@ bt_bool bt_field_structure_is_set(struct bt_field *field)
 	}
 
 	structure = container_of(field, struct bt_field_structure, parent);
-	for (i = 0; i < structure->fields->len; i++) {
+	for (i = 0; i < structure->field_count; i++) {
 		is_set = bt_field_is_set(
-			structure->fields->pdata[i]);
+			structure->fields[i]);
 		if (!is_set) {
 			goto end;
 		}
@@ -3207,6 +4025,11 @@ bt_bool bt_field_array_is_set(struct bt_field *field)
 	}
 
 	array = container_of(field, struct bt_field_array, parent);
+	if (array->packed.is_set) {
+		is_set = BT_TRUE;
+		goto end;
+	}
+
 	for (i = 0; i < array->elements->len; i++) {
 		is_set = bt_field_is_set(array->elements->pdata[i]);
 		if (!is_set) {
@@ -3233,6 +4056,11 @@ bt_bool bt_field_sequence_is_set(struct bt_field *field)
 		goto end;
 	}
 
+	if (sequence->packed.is_set) {
+		is_set = BT_TRUE;
+		goto end;
+	}
+
 	for (i = 0; i < sequence->elements->len; i++) {
 		is_set = bt_field_is_set(sequence->elements->pdata[i]);
 		if (!is_set) {
@@ -3242,3 +4070,123 @@ bt_bool bt_field_sequence_is_set(struct bt_field *field)
 end:
 	return is_set;
 }
+
+/*
+ * Thaws and resets a field and, recursively, the fields it keeps when
+ * it is reset, making sure that the caller is their only owner.
+ *
+ * Compound fields are visited in reverse order: a sequence or variant
+ * field holds a reference on its length or tag field, which always
+ * precedes it, and resetting it releases this reference.
+ *
+ * Returns BT_FALSE if any of those fields is shared with someone else,
+ * in which case the field tree cannot be reused.
+ */
+static
+bt_bool recycle_field(struct bt_field *field)
+{
+	bt_bool is_exclusive = BT_TRUE;
+	enum bt_field_type_id type_id;
+	struct bt_field **members = NULL;
+	size_t member_count = 0;
+	size_t i;
+
+	if (!field) {
+		goto end;
+	}
+
+	/* An inline field has no reference when only its structure owns it */
+	if (bt_object_get_ref_count(field) != (field->base.parent ? 0 : 1)) {
+		is_exclusive = BT_FALSE;
+		goto end;
+	}
+
+	field->frozen = false;
+	type_id = bt_field_get_type_id(field);
+
+	switch (type_id) {
+	case BT_FIELD_TYPE_ID_ENUM:
+	{
+		struct bt_field_enumeration *enumeration = container_of(
+			field, struct bt_field_enumeration, parent);
+
+		is_exclusive = recycle_field(enumeration->payload);
+		goto end;
+	}
+	case BT_FIELD_TYPE_ID_STRUCT:
+	{
+		struct bt_field_structure *structure = container_of(field,
+			struct bt_field_structure, parent);
+
+		members = structure->fields;
+		member_count = structure->field_count;
+		break;
+	}
+	case BT_FIELD_TYPE_ID_ARRAY:
+	{
+		struct bt_field_array *array = container_of(field,
+			struct bt_field_array, parent);
+
+		/*
+		 * Keep the buffer of packed elements to reuse it, but
+		 * not its values: they belong to the previous use.
+		 */
+		array->packed.is_set = false;
+		members = (struct bt_field **) array->elements->pdata;
+		member_count = array->elements->len;
+		break;
+	}
+	case BT_FIELD_TYPE_ID_STRING:
+	{
+		struct bt_field_string *string = container_of(field,
+			struct bt_field_string, parent);
+
+		/*
+		 * A pooled field must not keep the owner of its
+		 * external value, for example a mapped region of a
+		 * data stream file, alive until its next use.
+		 */
+		field->payload_set = false;
+		clear_string_external_value(string);
+		if (string->payload) {
+			g_string_truncate(string->payload, 0);
+		}
+
+		goto end;
+	}
+	default:
+		/*
+		 * Integer and floating point number fields have no
+		 * children. Resetting variant and sequence
+		 * fields releases their children.
+		 */
+		assert(type_id > BT_FIELD_TYPE_ID_UNKNOWN &&
+			type_id < BT_FIELD_TYPE_ID_NR);
+		is_exclusive = field_reset_funcs[type_id](field) == 0;
+		goto end;
+	}
+
+	for (i = member_count; i > 0; i--) {
+		is_exclusive = recycle_field(members[i - 1]);
+		if (!is_exclusive) {
+			goto end;
+		}
+	}
+
+end:
+	return is_exclusive;
+}
+
+BT_HIDDEN
+int bt_field_recycle(struct bt_field *field)
+{
+	int ret = 0;
+
+	if (!recycle_field(field)) {
+		BT_LOGV("Cannot recycle field: field or one of its fields is shared: "
+			"addr=%p", field);
+		ret = -1;
+	}
+
+	return ret;
+}
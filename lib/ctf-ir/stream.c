@@ -45,6 +45,8 @@
 #include <babeltrace/graph/component-internal.h>
 #include <babeltrace/ref.h>
 #include <babeltrace/ctf-writer/functor-internal.h>
+#include <babeltrace/ctf-writer/lttng-index-internal.h>
+#include <babeltrace/endian-internal.h>
 #include <babeltrace/compiler-internal.h>
 #include <babeltrace/align-internal.h>
 #include <inttypes.h>
@@ -468,7 +470,7 @@ end:
 
 static
 int set_packet_context_timestamp_field(struct bt_stream *stream,
-		const char *field_name, struct bt_event *event)
+		const char *field_name, struct bt_field *event_header)
 {
 	int ret = 0;
 	struct bt_field *field = bt_field_structure_get_field_by_name(
@@ -524,10 +526,10 @@ int set_packet_context_timestamp_field(struct bt_stream *stream,
 		goto end;
 	}
 
-	if (get_event_header_timestamp(stream, event->event_header, &ts)) {
+	if (get_event_header_timestamp(stream, event_header, &ts)) {
 		BT_LOGW("Cannot get event's timestamp: "
 			"event-header-field-addr=%p",
-			event->event_header);
+			event_header);
 		ret = -1;
 		goto end;
 	}
@@ -551,20 +553,39 @@ end:
 	return ret;
 }
 
+static
+uint64_t get_packet_event_count(struct bt_stream *stream)
+{
+	if (stream->serialize_on_append) {
+		return stream->packet_event_count;
+	}
+
+	return stream->events->len;
+}
+
 static
 int set_packet_context_timestamp_begin(struct bt_stream *stream)
 {
 	int ret = 0;
+	struct bt_field *event_header;
 
-	if (stream->events->len == 0) {
+	if (get_packet_event_count(stream) == 0) {
 		BT_LOGV("Current packet contains no events: skipping: "
 			"stream-addr=%p, stream-name=\"%s\"",
 			stream, bt_stream_get_name(stream));
 		goto end;
 	}
 
+	if (stream->serialize_on_append) {
+		event_header = stream->first_event_header;
+	} else {
+		struct bt_event *event = g_ptr_array_index(stream->events, 0);
+
+		event_header = event->event_header;
+	}
+
 	ret = set_packet_context_timestamp_field(stream, "timestamp_begin",
-		g_ptr_array_index(stream->events, 0));
+		event_header);
 
 end:
 	return ret;
@@ -574,16 +595,26 @@ static
 int set_packet_context_timestamp_end(struct bt_stream *stream)
 {
 	int ret = 0;
+	struct bt_field *event_header;
 
-	if (stream->events->len == 0) {
+	if (get_packet_event_count(stream) == 0) {
 		BT_LOGV("Current packet contains no events: skipping: "
 			"stream-addr=%p, stream-name=\"%s\"",
 			stream, bt_stream_get_name(stream));
 		goto end;
 	}
 
+	if (stream->serialize_on_append) {
+		event_header = stream->last_event_header;
+	} else {
+		struct bt_event *event = g_ptr_array_index(stream->events,
+			stream->events->len - 1);
+
+		event_header = event->event_header;
+	}
+
 	ret = set_packet_context_timestamp_field(stream, "timestamp_end",
-		g_ptr_array_index(stream->events, stream->events->len - 1));
+		event_header);
 
 end:
 	return ret;
@@ -741,9 +772,13 @@ append_ids:
 		"stream-addr=%p, stream-name=\"%s\", "
 		"filename=\"%s\", fd=%d", stream, bt_stream_get_name(stream),
 		filename->str, fd);
+	stream->file_name = filename;
+	filename = NULL;
 
 end:
-	g_string_free(filename, TRUE);
+	if (filename) {
+		g_string_free(filename, TRUE);
+	}
 	return fd;
 }
 
@@ -845,6 +880,7 @@ struct bt_stream *bt_stream_create_with_id_no_check(
 	bt_object_set_parent(stream, trace);
 	stream->stream_class = stream_class;
 	stream->pos.fd = -1;
+	stream->index_fd = -1;
 	stream->id = (int64_t) id;
 
 	stream->destroy_listeners = g_array_new(FALSE, TRUE,
@@ -1241,6 +1277,456 @@ end:
 	return ret;
 }
 
+/*
+ * Adds the size of a field of type `type`, serialized at `*offset`
+ * bits from the beginning of the packet, to `*offset`.
+ *
+ * Returns -1 if this size depends on the field's value.
+ */
+static
+int add_fixed_field_type_size(struct bt_field_type *type, uint64_t *offset)
+{
+	int ret = 0;
+	uint64_t i;
+
+	switch (type->id) {
+	case BT_FIELD_TYPE_ID_INTEGER:
+	{
+		struct bt_field_type_integer *int_type = (void *) type;
+
+		*offset += offset_align(*offset, type->alignment);
+		*offset += int_type->size;
+		break;
+	}
+	case BT_FIELD_TYPE_ID_FLOAT:
+	{
+		struct bt_field_type_floating_point *flt_type = (void *) type;
+
+		*offset += offset_align(*offset, type->alignment);
+		*offset += flt_type->exp_dig + flt_type->mant_dig;
+		break;
+	}
+	case BT_FIELD_TYPE_ID_ENUM:
+	{
+		struct bt_field_type_enumeration *enum_type = (void *) type;
+
+		ret = add_fixed_field_type_size(enum_type->container, offset);
+		break;
+	}
+	case BT_FIELD_TYPE_ID_STRUCT:
+	{
+		struct bt_field_type_structure *struct_type = (void *) type;
+
+		*offset += offset_align(*offset, type->alignment);
+
+		for (i = 0; i < struct_type->fields->len; i++) {
+			struct structure_field *field = g_ptr_array_index(
+				struct_type->fields, i);
+
+			ret = add_fixed_field_type_size(field->type, offset);
+			if (ret) {
+				break;
+			}
+		}
+		break;
+	}
+	case BT_FIELD_TYPE_ID_ARRAY:
+	{
+		struct bt_field_type_array *array_type = (void *) type;
+
+		for (i = 0; i < array_type->length; i++) {
+			ret = add_fixed_field_type_size(
+				array_type->element_type, offset);
+			if (ret) {
+				break;
+			}
+		}
+		break;
+	}
+	default:
+		ret = -1;
+		break;
+	}
+
+	return ret;
+}
+
+static
+int get_packet_header_context_size(struct bt_stream *stream, uint64_t *size)
+{
+	int ret = 0;
+
+	*size = 0;
+
+	if (stream->packet_header) {
+		ret = add_fixed_field_type_size(stream->packet_header->type,
+			size);
+		if (ret) {
+			BT_LOGW("Packet header field type has no fixed size: "
+				"stream-addr=%p, stream-name=\"%s\"",
+				stream, bt_stream_get_name(stream));
+			goto end;
+		}
+	}
+
+	if (stream->packet_context) {
+		ret = add_fixed_field_type_size(stream->packet_context->type,
+			size);
+		if (ret) {
+			BT_LOGW("Packet context field type has no fixed size: "
+				"stream-addr=%p, stream-name=\"%s\"",
+				stream, bt_stream_get_name(stream));
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
+static
+int serialize_event(struct bt_stream *stream, struct bt_event *event,
+		enum bt_byte_order native_byte_order)
+{
+	int ret = 0;
+
+	/* Write event header */
+	if (event->event_header) {
+		BT_LOGV_STR("Serializing event's header field.");
+		ret = bt_field_serialize(event->event_header,
+				&stream->pos, native_byte_order);
+		if (ret) {
+			BT_LOGW("Cannot serialize event's header field: "
+					"field-addr=%p", event->event_header);
+			goto end;
+		}
+	}
+
+	/* Write stream event context */
+	if (event->stream_event_context) {
+		BT_LOGV_STR("Serializing event's stream event context field.");
+		ret = bt_field_serialize(
+			event->stream_event_context, &stream->pos,
+			native_byte_order);
+		if (ret) {
+			BT_LOGW("Cannot serialize event's stream event context field: "
+				"field-addr=%p", event->stream_event_context);
+			goto end;
+		}
+	}
+
+	/* Write event content */
+	ret = bt_event_serialize(event, &stream->pos, native_byte_order);
+	if (ret) {
+		/* bt_event_serialize() logs errors */
+		goto end;
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Maps the stream's next packet and skips the space of its packet
+ * header and context fields, which bt_stream_flush() writes once the
+ * packet is complete.
+ */
+static
+int open_packet(struct bt_stream *stream)
+{
+	int ret = 0;
+
+	BT_LOGV("Seeking to the next packet: pos-offset=%" PRId64,
+		stream->pos.offset);
+	bt_stream_pos_packet_seek(&stream->pos, 0, SEEK_CUR);
+	assert(stream->pos.packet_size % 8 == 0);
+
+	if (stream->packet_header_context_size > stream->pos.packet_size) {
+		BT_LOGW("Packet header and context fields are larger than the initial packet size: "
+			"stream-addr=%p, stream-name=\"%s\", "
+			"size=%" PRIu64 ", packet-size=%" PRIu64,
+			stream, bt_stream_get_name(stream),
+			stream->packet_header_context_size,
+			stream->pos.packet_size);
+		ret = -1;
+		goto end;
+	}
+
+	stream->pos.offset = stream->packet_header_context_size;
+	stream->packet_is_open = true;
+
+end:
+	return ret;
+}
+
+static
+void reset_packet_events(struct bt_stream *stream)
+{
+	stream->packet_is_open = false;
+	stream->packet_event_count = 0;
+	BT_PUT(stream->first_event_header);
+	BT_PUT(stream->last_event_header);
+}
+
+static
+int serialize_appended_event(struct bt_stream *stream,
+		struct bt_event *event)
+{
+	int ret = 0;
+	int64_t event_offset;
+	struct bt_trace *trace;
+
+	if (!stream->packet_is_open) {
+		ret = open_packet(stream);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	trace = bt_stream_class_borrow_trace(stream->stream_class);
+	assert(trace);
+	event_offset = stream->pos.offset;
+	BT_LOGV("Serializing event: event-addr=%p, pos-offset=%" PRId64 ", "
+		"packet-size=%" PRIu64, event, stream->pos.offset,
+		stream->pos.packet_size);
+	ret = serialize_event(stream, event,
+		bt_trace_get_native_byte_order(trace));
+	if (ret) {
+		/* Overwrite the partially serialized event next time */
+		stream->pos.offset = event_offset;
+		goto end;
+	}
+
+	if (!stream->first_event_header) {
+		stream->first_event_header = bt_get(event->event_header);
+	}
+
+	bt_put(stream->last_event_header);
+	stream->last_event_header = bt_get(event->event_header);
+	stream->packet_event_count++;
+
+end:
+	return ret;
+}
+
+int bt_stream_set_serialize_on_append(struct bt_stream *stream,
+		bt_bool serialize_on_append)
+{
+	int ret = 0;
+
+	if (!stream) {
+		BT_LOGW_STR("Invalid parameter: stream is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (stream->pos.fd < 0) {
+		BT_LOGW_STR("Invalid parameter: stream is not a CTF writer stream.");
+		ret = -1;
+		goto end;
+	}
+
+	if (stream->events->len > 0 || stream->packet_is_open) {
+		BT_LOGW("Invalid parameter: stream's current packet is not empty: "
+			"stream-addr=%p, stream-name=\"%s\"",
+			stream, bt_stream_get_name(stream));
+		ret = -1;
+		goto end;
+	}
+
+	if (serialize_on_append) {
+		ret = get_packet_header_context_size(stream,
+			&stream->packet_header_context_size);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	stream->serialize_on_append = (bool) serialize_on_append;
+	BT_LOGV("Set stream's serialize-on-append mode: "
+		"stream-addr=%p, stream-name=\"%s\", value=%d, "
+		"packet-header-context-size=%" PRIu64,
+		stream, bt_stream_get_name(stream), serialize_on_append,
+		stream->packet_header_context_size);
+
+end:
+	return ret;
+}
+
+int bt_stream_get_packet_event_count(struct bt_stream *stream,
+		uint64_t *count)
+{
+	int ret = 0;
+
+	if (!stream) {
+		BT_LOGW_STR("Invalid parameter: stream is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (!count) {
+		BT_LOGW_STR("Invalid parameter: count is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (stream->pos.fd < 0) {
+		BT_LOGW_STR("Invalid parameter: stream is not a CTF writer stream.");
+		ret = -1;
+		goto end;
+	}
+
+	*count = get_packet_event_count(stream);
+
+end:
+	return ret;
+}
+
+int bt_stream_get_packet_content_size(struct bt_stream *stream,
+		uint64_t *size)
+{
+	int ret = 0;
+
+	if (!stream) {
+		BT_LOGW_STR("Invalid parameter: stream is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (!size) {
+		BT_LOGW_STR("Invalid parameter: size is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (!stream->serialize_on_append) {
+		BT_LOGW("Invalid parameter: stream does not serialize events on append: "
+			"stream-addr=%p, stream-name=\"%s\"",
+			stream, bt_stream_get_name(stream));
+		ret = -1;
+		goto end;
+	}
+
+	*size = stream->packet_is_open ? stream->pos.offset : 0;
+
+end:
+	return ret;
+}
+
+static
+int write_index_data(int fd, const void *buf, size_t len)
+{
+	size_t written = 0;
+
+	while (written < len) {
+		ssize_t ret = write(fd, (const char *) buf + written,
+			len - written);
+
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		written += ret;
+	}
+
+	return 0;
+}
+
+int bt_stream_enable_packet_index(struct bt_stream *stream)
+{
+	int ret = 0;
+	int fd = -1;
+	struct bt_trace *trace;
+	struct bt_ctf_writer *writer = NULL;
+	struct ctf_packet_index_file_hdr hdr;
+	gchar *index_dir = NULL;
+	gchar *index_name = NULL;
+	gchar *index_path = NULL;
+
+	if (!stream) {
+		BT_LOGW_STR("Invalid parameter: stream is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (stream->pos.fd < 0) {
+		BT_LOGW_STR("Invalid parameter: stream is not a CTF writer stream.");
+		ret = -1;
+		goto end;
+	}
+
+	if (stream->index_fd >= 0) {
+		BT_LOGV("Stream's packet index is already enabled: "
+			"stream-addr=%p, stream-name=\"%s\"",
+			stream, bt_stream_get_name(stream));
+		goto end;
+	}
+
+	if (stream->flushed_packet_count > 0) {
+		BT_LOGW("Invalid parameter: stream already has flushed packets: "
+			"stream-addr=%p, stream-name=\"%s\", "
+			"flushed-packet-count=%u", stream,
+			bt_stream_get_name(stream),
+			stream->flushed_packet_count);
+		ret = -1;
+		goto end;
+	}
+
+	trace = bt_stream_class_borrow_trace(stream->stream_class);
+	assert(trace);
+	writer = (struct bt_ctf_writer *) bt_object_get_parent(trace);
+	assert(writer);
+	assert(stream->file_name);
+
+	index_dir = g_build_filename(writer->path->str, "index", NULL);
+	if (g_mkdir_with_parents(index_dir, S_IRWXU | S_IRWXG)) {
+		BT_LOGW_ERRNO("Cannot create packet index directory",
+			": path=\"%s\"", index_dir);
+		ret = -1;
+		goto end;
+	}
+
+	index_name = g_strconcat(stream->file_name->str, ".idx", NULL);
+	index_path = g_build_filename(index_dir, index_name, NULL);
+	fd = open(index_path, O_WRONLY | O_CREAT | O_TRUNC,
+		S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+	if (fd < 0) {
+		BT_LOGW_ERRNO("Cannot open packet index file for writing",
+			": path=\"%s\"", index_path);
+		ret = -1;
+		goto end;
+	}
+
+	hdr.magic = htobe32(CTF_INDEX_MAGIC);
+	hdr.index_major = htobe32(CTF_INDEX_MAJOR);
+	hdr.index_minor = htobe32(CTF_INDEX_MINOR);
+	hdr.packet_index_len = htobe32(sizeof(struct ctf_packet_index));
+	if (write_index_data(fd, &hdr, sizeof(hdr))) {
+		BT_LOGW_ERRNO("Cannot write packet index file's header",
+			": path=\"%s\"", index_path);
+		(void) close(fd);
+		(void) unlink(index_path);
+		ret = -1;
+		goto end;
+	}
+
+	stream->index_fd = fd;
+	stream->index_path = index_path;
+	index_path = NULL;
+	BT_LOGV("Enabled stream's packet index: "
+		"stream-addr=%p, stream-name=\"%s\", path=\"%s\"",
+		stream, bt_stream_get_name(stream), stream->index_path);
+
+end:
+	bt_put(writer);
+	g_free(index_dir);
+	g_free(index_name);
+	g_free(index_path);
+	return ret;
+}
+
 int bt_stream_append_event(struct bt_stream *stream,
 		struct bt_event *event)
 {
@@ -1284,6 +1770,18 @@ int bt_stream_append_event(struct bt_stream *stream,
 		goto end;
 	}
 
+	/*
+	 * In streaming mode, an appended event is orphaned once
+	 * serialized: make sure it is not appended again.
+	 */
+	if (stream->serialize_on_append && event->frozen) {
+		BT_LOGW("Invalid parameter: event is frozen: "
+			"stream-addr=%p, stream-name=\"%s\", event-addr=%p",
+			stream, bt_stream_get_name(stream), event);
+		ret = -1;
+		goto end;
+	}
+
 	bt_object_set_parent(event, stream);
 	BT_LOGV_STR("Automatically populating the header of the event to append.");
 	ret = auto_populate_event_header(stream, event);
@@ -1299,19 +1797,35 @@ int bt_stream_append_event(struct bt_stream *stream,
 		goto error;
 	}
 
-	/* Save the new event and freeze it */
 	BT_LOGV_STR("Freezing the event to append.");
 	bt_event_freeze(event);
-	g_ptr_array_add(stream->events, event);
 
-	/*
-	 * Event had to hold a reference to its event class as long as it wasn't
-	 * part of the same trace hierarchy. From now on, the event and its
-	 * class share the same lifetime guarantees and the reference is no
-	 * longer needed.
-	 */
-	BT_LOGV_STR("Putting the event's class.");
-	bt_put(event->event_class);
+	if (stream->serialize_on_append) {
+		/*
+		 * The stream does not keep the serialized event: it
+		 * keeps its own reference to its event class.
+		 */
+		ret = serialize_appended_event(stream, event);
+		if (ret) {
+			goto error;
+		}
+
+		bt_object_set_parent(event, NULL);
+	} else {
+		/* Save the new event */
+		g_ptr_array_add(stream->events, event);
+
+		/*
+		 * Event had to hold a reference to its event class as
+		 * long as it wasn't part of the same trace hierarchy.
+		 * From now on, the event and its class share the same
+		 * lifetime guarantees and the reference is no longer
+		 * needed.
+		 */
+		BT_LOGV_STR("Putting the event's class.");
+		bt_put(event->event_class);
+	}
+
 	BT_LOGV("Appended event to stream: "
 		"stream-addr=%p, stream-name=\"%s\", event-addr=%p, "
 		"event-class-name=\"%s\", event-class-id=%" PRId64,
@@ -1485,6 +1999,73 @@ end:
 	return ret;
 }
 
+static
+uint64_t get_structure_field_uint(struct bt_field *structure,
+		const char *name, uint64_t default_value)
+{
+	struct bt_field *member = NULL;
+	uint64_t value = default_value;
+
+	if (!structure) {
+		goto end;
+	}
+
+	member = bt_field_structure_get_field_by_name(structure, name);
+	if (!member || !bt_field_is_integer(member) ||
+			!bt_field_is_set(member)) {
+		goto end;
+	}
+
+	if (bt_field_unsigned_integer_get_value(member, &value)) {
+		value = default_value;
+	}
+
+end:
+	bt_put(member);
+	return value;
+}
+
+/*
+ * Appends the index entry of the packet which was just written to the
+ * stream's packet index file. On error, the index file is removed, as
+ * a partial index is of no use to readers.
+ */
+static
+void write_packet_index_entry(struct bt_stream *stream)
+{
+	struct ctf_packet_index entry;
+
+	entry.offset = htobe64(stream->size);
+	entry.packet_size = htobe64(stream->pos.packet_size);
+	entry.content_size = htobe64(stream->pos.offset);
+	entry.timestamp_begin = htobe64(get_structure_field_uint(
+		stream->packet_context, "timestamp_begin", 0));
+	entry.timestamp_end = htobe64(get_structure_field_uint(
+		stream->packet_context, "timestamp_end", 0));
+	entry.events_discarded = htobe64(get_structure_field_uint(
+		stream->packet_context, "events_discarded",
+		stream->discarded_events));
+	entry.stream_id = htobe64(get_structure_field_uint(
+		stream->packet_header, "stream_id",
+		(uint64_t) bt_stream_class_get_id(stream->stream_class)));
+	entry.stream_instance_id = htobe64(get_structure_field_uint(
+		stream->packet_header, "stream_instance_id",
+		(uint64_t) stream->id));
+	entry.packet_seq_num = htobe64(get_structure_field_uint(
+		stream->packet_context, "packet_seq_num",
+		stream->flushed_packet_count));
+
+	if (write_index_data(stream->index_fd, &entry, sizeof(entry))) {
+		BT_LOGW_ERRNO("Cannot write packet index entry: removing packet index file",
+			": stream-addr=%p, stream-name=\"%s\", path=\"%s\"",
+			stream, bt_stream_get_name(stream),
+			stream->index_path);
+		(void) close(stream->index_fd);
+		(void) unlink(stream->index_path);
+		stream->index_fd = -1;
+	}
+}
+
 static
 void reset_structure_field(struct bt_field *structure, const char *name)
 {
@@ -1497,6 +2078,49 @@ void reset_structure_field(struct bt_field *structure, const char *name)
 	}
 }
 
+/*
+ * Writes the packet header and context fields in the space which
+ * open_packet() reserved at the beginning of the current packet.
+ */
+static
+int write_packet_header_context(struct bt_stream *stream,
+		enum bt_byte_order native_byte_order)
+{
+	int ret = 0;
+	struct bt_stream_pos pos;
+
+	memcpy(&pos, &stream->pos, sizeof(pos));
+	pos.offset = 0;
+
+	if (stream->packet_header) {
+		BT_LOGV_STR("Serializing packet header field.");
+		ret = bt_field_serialize(stream->packet_header, &pos,
+			native_byte_order);
+		if (ret) {
+			BT_LOGW("Cannot serialize stream's packet header field: "
+				"field-addr=%p", stream->packet_header);
+			goto end;
+		}
+	}
+
+	if (stream->packet_context) {
+		BT_LOGV_STR("Serializing packet context field.");
+		ret = bt_field_serialize(stream->packet_context, &pos,
+			native_byte_order);
+		if (ret) {
+			BT_LOGW("Cannot serialize stream's packet context field: "
+				"field-addr=%p", stream->packet_context);
+			goto end;
+		}
+	}
+
+	/* Field type sizes are fixed: this is the space open_packet() left */
+	assert(pos.offset == stream->packet_header_context_size);
+
+end:
+	return ret;
+}
+
 int bt_stream_flush(struct bt_stream *stream)
 {
 	int ret = 0;
@@ -1562,6 +2186,22 @@ int bt_stream_flush(struct bt_stream *stream)
 		goto end;
 	}
 
+	if (stream->serialize_on_append) {
+		/*
+		 * The events are already serialized: the packet header
+		 * and context fields are written once the packet is
+		 * complete.
+		 */
+		if (!stream->packet_is_open) {
+			ret = open_packet(stream);
+			if (ret) {
+				goto end;
+			}
+		}
+
+		goto events_serialized;
+	}
+
 	/* mmap the next packet */
 	BT_LOGV("Seeking to the next packet: pos-offset=%" PRId64,
 		stream->pos.offset);
@@ -1608,40 +2248,13 @@ int bt_stream_flush(struct bt_stream *stream)
 			bt_event_class_get_id(event_class),
 			stream->pos.offset, stream->pos.packet_size);
 
-		/* Write event header */
-		if (event->event_header) {
-			BT_LOGV_STR("Serializing event's header field.");
-			ret = bt_field_serialize(event->event_header,
-					&stream->pos, native_byte_order);
-			if (ret) {
-				BT_LOGW("Cannot serialize event's header field: "
-						"field-addr=%p", event->event_header);
-				goto end;
-			}
-		}
-
-		/* Write stream event context */
-		if (event->stream_event_context) {
-			BT_LOGV_STR("Serializing event's stream event context field.");
-			ret = bt_field_serialize(
-				event->stream_event_context, &stream->pos,
-				native_byte_order);
-			if (ret) {
-				BT_LOGW("Cannot serialize event's stream event context field: "
-					"field-addr=%p", event->stream_event_context);
-				goto end;
-			}
-		}
-
-		/* Write event content */
-		ret = bt_event_serialize(event, &stream->pos,
-			native_byte_order);
+		ret = serialize_event(stream, event, native_byte_order);
 		if (ret) {
-			/* bt_event_serialize() logs errors */
 			goto end;
 		}
 	}
 
+events_serialized:
 	if (!has_packet_size && stream->pos.offset % 8 != 0) {
 		BT_LOGW("Stream's packet context field type has no `packet_size` field, "
 			"but current content size is not a multiple of 8 bits: "
@@ -1683,6 +2296,20 @@ int bt_stream_flush(struct bt_stream *stream)
 			}
 		}
 
+		ret = auto_populate_packet_context(stream);
+		if (ret) {
+			BT_LOGW_STR("Cannot automatically populate the stream's packet context field.");
+			ret = -1;
+			goto end;
+		}
+	}
+
+	if (stream->serialize_on_append) {
+		ret = write_packet_header_context(stream, native_byte_order);
+		if (ret) {
+			goto end;
+		}
+	} else if (stream->packet_context) {
 		/*
 		 * Overwrite the packet context now that the stream
 		 * position's packet and content sizes have the correct
@@ -1692,13 +2319,6 @@ int bt_stream_flush(struct bt_stream *stream)
 		 * (e.g. when a packet is resized).
 		 */
 		packet_context_pos.base_mma = stream->pos.base_mma;
-		ret = auto_populate_packet_context(stream);
-		if (ret) {
-			BT_LOGW_STR("Cannot automatically populate the stream's packet context field.");
-			ret = -1;
-			goto end;
-		}
-
 		BT_LOGV("Rewriting (serializing) packet context field.");
 		ret = bt_field_serialize(stream->packet_context,
 			&packet_context_pos, native_byte_order);
@@ -1709,6 +2329,10 @@ int bt_stream_flush(struct bt_stream *stream)
 		}
 	}
 
+	if (stream->index_fd >= 0) {
+		write_packet_index_entry(stream);
+	}
+
 	g_ptr_array_set_size(stream->events, 0);
 	stream->flushed_packet_count++;
 	stream->size += stream->pos.packet_size / CHAR_BIT;
@@ -1731,12 +2355,23 @@ end:
 		 * leave a corrupted packet in the trace.
 		 */
 		stream->pos.packet_size = 0;
+
+		if (stream->packet_event_count > 0) {
+			BT_LOGW("Dropping the events of the packet which could not be written: "
+				"stream-addr=%p, stream-name=\"%s\", "
+				"event-count=%" PRIu64, stream,
+				bt_stream_get_name(stream),
+				stream->packet_event_count);
+		}
 	} else {
 		BT_LOGV("Flushed stream's current packet: content-size=%" PRId64 ", "
 			"packet-size=%" PRIu64,
 			stream->pos.offset, stream->pos.packet_size);
 	}
 
+	/* The next appended event opens a new packet. */
+	reset_packet_events(stream);
+
 end_no_stream:
 	return ret;
 }
@@ -1798,11 +2433,25 @@ void bt_stream_destroy(struct bt_object *obj)
 		}
 	}
 
+	if (stream->index_fd >= 0 && close(stream->index_fd)) {
+		BT_LOGE_ERRNO("Failed to close packet index file",
+			": path=\"%s\"", stream->index_path);
+	}
+
+	g_free(stream->index_path);
+
+	if (stream->file_name) {
+		g_string_free(stream->file_name, TRUE);
+	}
+
 	if (stream->events) {
 		BT_LOGD_STR("Putting events.");
 		g_ptr_array_free(stream->events, TRUE);
 	}
 
+	bt_put(stream->first_event_header);
+	bt_put(stream->last_event_header);
+
 	if (stream->name) {
 		g_string_free(stream->name, TRUE);
 	}
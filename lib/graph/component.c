@@ -134,6 +134,10 @@ void bt_component_destroy(struct bt_object *obj)
 		g_array_free(component->destroy_listeners, TRUE);
 	}
 
+	if (component->wait_fds) {
+		g_array_free(component->wait_fds, TRUE);
+	}
+
 	if (component->name) {
 		g_string_free(component->name, TRUE);
 	}
@@ -299,6 +303,13 @@ enum bt_component_status bt_component_create(
 		goto end;
 	}
 
+	component->wait_fds = g_array_new(FALSE, FALSE, sizeof(int));
+	if (!component->wait_fds) {
+		BT_LOGE_STR("Failed to allocate one GArray.");
+		status = BT_COMPONENT_STATUS_NOMEM;
+		goto end;
+	}
+
 	BT_LOGD("Created empty component from component class: "
 		"comp-cls-addr=%p, comp-cls-type=%s, name=\"%s\", comp-addr=%p",
 		component_class, bt_component_class_type_string(type), name,
@@ -363,6 +374,70 @@ end:
 	return ret;
 }
 
+enum bt_component_status bt_private_component_add_wait_fd(
+		struct bt_private_component *private_component, int fd)
+{
+	struct bt_component *component =
+		bt_component_borrow_from_private(private_component);
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+
+	if (!component) {
+		BT_LOGW_STR("Invalid parameter: component is NULL.");
+		ret = BT_COMPONENT_STATUS_INVALID;
+		goto end;
+	}
+
+	if (fd < 0) {
+		BT_LOGW("Invalid parameter: file descriptor is negative: "
+			"comp-addr=%p, comp-name=\"%s\", fd=%d",
+			component, bt_component_get_name(component), fd);
+		ret = BT_COMPONENT_STATUS_INVALID;
+		goto end;
+	}
+
+	g_array_append_val(component->wait_fds, fd);
+	BT_LOGV("Added component's wait file descriptor: "
+		"comp-addr=%p, comp-name=\"%s\", fd=%d",
+		component, bt_component_get_name(component), fd);
+
+end:
+	return ret;
+}
+
+enum bt_component_status bt_private_component_remove_wait_fd(
+		struct bt_private_component *private_component, int fd)
+{
+	struct bt_component *component =
+		bt_component_borrow_from_private(private_component);
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	guint i;
+
+	if (!component) {
+		BT_LOGW_STR("Invalid parameter: component is NULL.");
+		ret = BT_COMPONENT_STATUS_INVALID;
+		goto end;
+	}
+
+	for (i = 0; i < component->wait_fds->len; i++) {
+		if (g_array_index(component->wait_fds, int, i) == fd) {
+			g_array_remove_index_fast(component->wait_fds, i);
+			BT_LOGV("Removed component's wait file descriptor: "
+				"comp-addr=%p, comp-name=\"%s\", fd=%d",
+				component, bt_component_get_name(component),
+				fd);
+			goto end;
+		}
+	}
+
+	BT_LOGW("Invalid parameter: unknown wait file descriptor: "
+		"comp-addr=%p, comp-name=\"%s\", fd=%d",
+		component, bt_component_get_name(component), fd);
+	ret = BT_COMPONENT_STATUS_INVALID;
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 void bt_component_set_graph(struct bt_component *component,
 		struct bt_graph *graph)
@@ -40,8 +40,15 @@
 #include <babeltrace/values.h>
 #include <babeltrace/values-internal.h>
 #include <unistd.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <errno.h>
 #include <glib.h>
 
+#ifndef __MINGW32__
+#include <poll.h>
+#endif
+
 struct bt_graph_listener {
 	void *func;
 	bt_graph_listener_removed removed;
@@ -139,6 +146,10 @@ void bt_graph_destroy(struct bt_object *obj)
 		g_queue_free(graph->sinks_to_consume);
 	}
 
+	if (graph->wait_pollfds) {
+		g_array_free(graph->wait_pollfds, TRUE);
+	}
+
 	if (graph->listeners.port_added) {
 		g_array_free(graph->listeners.port_added, TRUE);
 	}
@@ -652,6 +663,170 @@ end:
 	return status;
 }
 
+#ifdef __MINGW32__
+static
+enum bt_graph_status wait_components(struct bt_graph *graph,
+		uint64_t timeout_us)
+{
+	/* Wait file descriptors are not supported: just sleep. */
+	g_usleep(timeout_us);
+	return BT_GRAPH_STATUS_OK;
+}
+#else
+static
+enum bt_graph_status wait_components(struct bt_graph *graph,
+		uint64_t timeout_us)
+{
+	enum bt_graph_status status = BT_GRAPH_STATUS_OK;
+	GArray *pollfds;
+	gint64 deadline_us;
+	uint64_t timeout_ms;
+	guint i;
+	int ret;
+
+	if (!graph->wait_pollfds) {
+		graph->wait_pollfds = g_array_new(FALSE, TRUE,
+			sizeof(struct pollfd));
+		if (!graph->wait_pollfds) {
+			BT_LOGE_STR("Failed to allocate one GArray.");
+			status = BT_GRAPH_STATUS_NOMEM;
+			goto end;
+		}
+	}
+
+	/*
+	 * The components can add and remove wait file descriptors
+	 * between two calls: rebuild the array, reusing its storage.
+	 */
+	pollfds = graph->wait_pollfds;
+	g_array_set_size(pollfds, 0);
+
+	for (i = 0; i < graph->components->len; i++) {
+		struct bt_component *component =
+			g_ptr_array_index(graph->components, i);
+		guint j;
+
+		for (j = 0; j < component->wait_fds->len; j++) {
+			/*
+			 * Only readability is waited for: see
+			 * bt_private_component_add_wait_fd().
+			 */
+			struct pollfd pollfd = {
+				.fd = g_array_index(component->wait_fds,
+					int, j),
+				.events = POLLIN,
+			};
+
+			g_array_append_val(pollfds, pollfd);
+		}
+	}
+
+	deadline_us = g_get_monotonic_time() + (gint64) MIN(timeout_us,
+		(uint64_t) G_MAXINT64 / 2);
+
+	for (;;) {
+		gint64 remaining_us = deadline_us - g_get_monotonic_time();
+		bt_bool is_ready = BT_FALSE;
+
+		if (remaining_us < 0) {
+			remaining_us = 0;
+		}
+
+		/* Round up so that a non-zero timeout does not busy-wait. */
+		timeout_ms = ((uint64_t) remaining_us + 999) / 1000;
+		if (timeout_ms > INT_MAX) {
+			timeout_ms = INT_MAX;
+		}
+
+		BT_LOGV("Waiting for the graph's components: addr=%p, "
+			"wait-fd-count=%u, timeout-ms=%" PRIu64,
+			graph, pollfds->len, timeout_ms);
+		ret = poll((struct pollfd *) pollfds->data, pollfds->len,
+			(int) timeout_ms);
+		if (ret < 0) {
+			if (errno != EINTR) {
+				BT_LOGE("Cannot wait for the graph's components: "
+					"addr=%p, errno=%d", graph, errno);
+				status = BT_GRAPH_STATUS_ERROR;
+			}
+
+			goto end;
+		}
+
+		if (ret == 0) {
+			/* Timed out */
+			goto end;
+		}
+
+		/*
+		 * A file descriptor which is hung up, in error, or
+		 * invalid stays so: waiting for it again would return
+		 * immediately, and the caller would busy-wait. Stop
+		 * waiting for it until the next call, letting its
+		 * component handle this condition when it is consumed.
+		 */
+		i = 0;
+		while (i < pollfds->len) {
+			struct pollfd *pollfd = &g_array_index(pollfds,
+				struct pollfd, i);
+
+			if (pollfd->revents & (POLLERR | POLLHUP | POLLNVAL)) {
+				BT_LOGD("Not waiting for a graph's component's file descriptor anymore: "
+					"addr=%p, fd=%d, revents=%#x",
+					graph, pollfd->fd,
+					(unsigned int) pollfd->revents);
+				g_array_remove_index_fast(pollfds, i);
+				continue;
+			}
+
+			if (pollfd->revents & POLLIN) {
+				is_ready = BT_TRUE;
+			}
+
+			pollfd->revents = 0;
+			i++;
+		}
+
+		if (is_ready) {
+			goto end;
+		}
+	}
+
+end:
+	return status;
+}
+#endif /* __MINGW32__ */
+
+enum bt_graph_status bt_graph_wait(struct bt_graph *graph,
+		uint64_t timeout_us)
+{
+	enum bt_graph_status status;
+
+	if (!graph) {
+		BT_LOGW_STR("Invalid parameter: graph is NULL.");
+		status = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	if (graph->canceled) {
+		BT_LOGD("Not waiting: graph is canceled: graph-addr=%p",
+			graph);
+		status = BT_GRAPH_STATUS_CANCELED;
+		goto end;
+	}
+
+	status = wait_components(graph, timeout_us);
+	if (status == BT_GRAPH_STATUS_OK && graph->canceled) {
+		/* Canceled by a signal handler or by another thread. */
+		BT_LOGD("Stopped waiting: graph is canceled: graph-addr=%p",
+			graph);
+		status = BT_GRAPH_STATUS_CANCELED;
+	}
+
+end:
+	return status;
+}
+
 static
 int add_listener(GArray *listeners, void *func, void *removed, void *data)
 {
@@ -2044,17 +2044,25 @@ end:
 	return ret;
 }
 
+static
+void put_batch_notifications(
+		struct bt_notification_iterator_private_connection *iterator,
+		uint64_t begin, uint64_t end)
+{
+	uint64_t i;
+
+	for (i = begin; i < end; i++) {
+		BT_PUT(iterator->batch[i]);
+	}
+}
+
 static
 enum bt_notification_iterator_status ensure_queue_has_notifications(
 		struct bt_notification_iterator_private_connection *iterator)
 {
 	struct bt_private_connection_private_notification_iterator *priv_iterator =
 		bt_private_connection_private_notification_iterator_from_notification_iterator(iterator);
-	bt_component_class_notification_iterator_next_method next_method = NULL;
-	struct bt_notification_iterator_next_method_return next_return = {
-		.status = BT_NOTIFICATION_ITERATOR_STATUS_OK,
-		.notification = NULL,
-	};
+	struct bt_component_class_notification_iterator_methods *methods = NULL;
 	enum bt_notification_iterator_status status =
 		BT_NOTIFICATION_ITERATOR_STATUS_OK;
 	int ret;
@@ -2094,7 +2102,7 @@ enum bt_notification_iterator_status ensure_queue_has_notifications(
 	assert(iterator->upstream_component);
 	assert(iterator->upstream_component->class);
 
-	/* Pick the appropriate "next" method */
+	/* Pick the appropriate "next" methods */
 	switch (iterator->upstream_component->class->type) {
 	case BT_COMPONENT_CLASS_TYPE_SOURCE:
 	{
@@ -2102,8 +2110,7 @@ enum bt_notification_iterator_status ensure_queue_has_notifications(
 			container_of(iterator->upstream_component->class,
 				struct bt_component_class_source, parent);
 
-		assert(source_class->methods.iterator.next);
-		next_method = source_class->methods.iterator.next;
+		methods = &source_class->methods.iterator;
 		break;
 	}
 	case BT_COMPONENT_CLASS_TYPE_FILTER:
@@ -2112,8 +2119,7 @@ enum bt_notification_iterator_status ensure_queue_has_notifications(
 			container_of(iterator->upstream_component->class,
 				struct bt_component_class_filter, parent);
 
-		assert(filter_class->methods.iterator.next);
-		next_method = filter_class->methods.iterator.next;
+		methods = &filter_class->methods.iterator;
 		break;
 	}
 	default:
@@ -2121,22 +2127,64 @@ enum bt_notification_iterator_status ensure_queue_has_notifications(
 	}
 
 	/*
-	 * Call the user's "next" method to get the next notification
-	 * and status.
+	 * Call the user's "next batch" method, if available, or "next"
+	 * method otherwise, to get the next notifications and status.
 	 */
-	assert(next_method);
+	assert(methods);
+	assert(methods->next);
 
 	while (iterator->queue->length == 0) {
-		BT_LOGD_STR("Calling user's \"next\" method.");
-		next_return = next_method(priv_iterator);
-		BT_LOGD("User method returned: status=%s",
-			bt_notification_iterator_status_string(next_return.status));
-		if (next_return.status < 0) {
+		enum bt_notification_iterator_status user_status;
+		uint64_t count = 0;
+		uint64_t i;
+
+		if (methods->next_batch) {
+			struct bt_notification_iterator_next_batch_method_return batch_return;
+
+			BT_LOGD_STR("Calling user's \"next batch\" method.");
+			batch_return = methods->next_batch(priv_iterator,
+				iterator->batch,
+				BT_PRIVATE_CONNECTION_NOTIFICATION_ITERATOR_BATCH_CAPACITY);
+			user_status = batch_return.status;
+
+			if (user_status == BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+				count = batch_return.count;
+			}
+		} else {
+			struct bt_notification_iterator_next_method_return next_return;
+
+			BT_LOGD_STR("Calling user's \"next\" method.");
+			next_return = methods->next(priv_iterator);
+			user_status = next_return.status;
+
+			/*
+			 * Only take the returned notification if the
+			 * status is BT_NOTIFICATION_ITERATOR_STATUS_OK
+			 * because otherwise this field could be
+			 * garbage.
+			 */
+			if (user_status == BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+				iterator->batch[0] = next_return.notification;
+				count = 1;
+			}
+		}
+
+		BT_LOGD("User method returned: status=%s, count=%" PRIu64,
+			bt_notification_iterator_status_string(user_status),
+			count);
+		if (user_status < 0) {
 			BT_LOGW_STR("User method failed.");
-			status = next_return.status;
+			status = user_status;
 			goto end;
 		}
 
+		if (count > BT_PRIVATE_CONNECTION_NOTIFICATION_ITERATOR_BATCH_CAPACITY) {
+			BT_LOGF("User \"next batch\" method returned more notifications than the requested capacity: "
+				"count=%" PRIu64 ", capacity=%u", count,
+				BT_PRIVATE_CONNECTION_NOTIFICATION_ITERATOR_BATCH_CAPACITY);
+			abort();
+		}
+
 		if (iterator->state == BT_PRIVATE_CONNECTION_NOTIFICATION_ITERATOR_STATE_FINALIZED ||
 				iterator->state == BT_PRIVATE_CONNECTION_NOTIFICATION_ITERATOR_STATE_FINALIZED_AND_ENDED) {
 			/*
@@ -2148,22 +2196,13 @@ enum bt_notification_iterator_status ensure_queue_has_notifications(
 			 * created. In this case, said connection is
 			 * ended, and all its notification iterators are
 			 * finalized.
-			 *
-			 * Only bt_put() the returned notification if
-			 * the status is
-			 * BT_NOTIFICATION_ITERATOR_STATUS_OK because
-			 * otherwise this field could be garbage.
 			 */
-			if (next_return.status ==
-					BT_NOTIFICATION_ITERATOR_STATUS_OK) {
-				bt_put(next_return.notification);
-			}
-
+			put_batch_notifications(iterator, 0, count);
 			status = BT_NOTIFICATION_ITERATOR_STATUS_CANCELED;
 			goto end;
 		}
 
-		switch (next_return.status) {
+		switch (user_status) {
 		case BT_NOTIFICATION_ITERATOR_STATUS_END:
 			ret = handle_end(iterator);
 			if (ret) {
@@ -2187,41 +2226,61 @@ enum bt_notification_iterator_status ensure_queue_has_notifications(
 			status = BT_NOTIFICATION_ITERATOR_STATUS_AGAIN;
 			goto end;
 		case BT_NOTIFICATION_ITERATOR_STATUS_OK:
-			if (!next_return.notification) {
-				BT_LOGW_STR("User method returned BT_NOTIFICATION_ITERATOR_STATUS_OK, but notification is NULL.");
+			if (count == 0) {
+				BT_LOGW_STR("User method returned BT_NOTIFICATION_ITERATOR_STATUS_OK, but no notifications.");
 				status = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
 				goto end;
 			}
 
-			/*
-			 * Ignore some notifications which are always
-			 * automatically generated by the notification
-			 * iterator to make sure they have valid values.
-			 */
-			switch (next_return.notification->type) {
-			case BT_NOTIFICATION_TYPE_DISCARDED_PACKETS:
-			case BT_NOTIFICATION_TYPE_DISCARDED_EVENTS:
-				BT_LOGV("Ignoring discarded elements notification returned by notification iterator's \"next\" method: "
-					"notif-type=%s",
-					bt_notification_type_string(next_return.notification->type));
-				BT_PUT(next_return.notification);
-				continue;
-			default:
-				break;
-			}
-
-			/*
-			 * We know the notification is valid. Before we
-			 * push it to the head of the queue, push the
-			 * appropriate automatic notifications if any.
-			 */
-			ret = enqueue_notification_and_automatic(iterator,
-				next_return.notification);
-			BT_PUT(next_return.notification);
-			if (ret) {
-				BT_LOGW("Cannot enqueue notification and automatic notifications.");
-				status = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
-				goto end;
+			for (i = 0; i < count; i++) {
+				struct bt_notification *notif =
+					iterator->batch[i];
+
+				iterator->batch[i] = NULL;
+
+				if (!notif) {
+					BT_LOGW("User method returned BT_NOTIFICATION_ITERATOR_STATUS_OK, but notification is NULL: "
+						"index=%" PRIu64, i);
+					put_batch_notifications(iterator,
+						i + 1, count);
+					status = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+					goto end;
+				}
+
+				/*
+				 * Ignore some notifications which are
+				 * always automatically generated by the
+				 * notification iterator to make sure
+				 * they have valid values.
+				 */
+				switch (notif->type) {
+				case BT_NOTIFICATION_TYPE_DISCARDED_PACKETS:
+				case BT_NOTIFICATION_TYPE_DISCARDED_EVENTS:
+					BT_LOGV("Ignoring discarded elements notification returned by notification iterator's \"next\" method: "
+						"notif-type=%s",
+						bt_notification_type_string(notif->type));
+					BT_PUT(notif);
+					continue;
+				default:
+					break;
+				}
+
+				/*
+				 * We know the notification is valid.
+				 * Before we push it to the head of the
+				 * queue, push the appropriate automatic
+				 * notifications if any.
+				 */
+				ret = enqueue_notification_and_automatic(
+					iterator, notif);
+				BT_PUT(notif);
+				if (ret) {
+					BT_LOGW("Cannot enqueue notification and automatic notifications.");
+					put_batch_notifications(iterator,
+						i + 1, count);
+					status = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+					goto end;
+				}
 			}
 			break;
 		default:
@@ -2340,6 +2399,108 @@ end:
 	return status;
 }
 
+enum bt_notification_iterator_status
+bt_notification_iterator_next_batch(struct bt_notification_iterator *iterator,
+		struct bt_notification **notifications, uint64_t capacity,
+		uint64_t *count)
+{
+	enum bt_notification_iterator_status status;
+
+	if (!iterator) {
+		BT_LOGW_STR("Invalid parameter: notification iterator is NULL.");
+		status = BT_NOTIFICATION_ITERATOR_STATUS_INVALID;
+		goto end;
+	}
+
+	if (!notifications) {
+		BT_LOGW_STR("Invalid parameter: notification array is NULL.");
+		status = BT_NOTIFICATION_ITERATOR_STATUS_INVALID;
+		goto end;
+	}
+
+	if (capacity == 0) {
+		BT_LOGW_STR("Invalid parameter: capacity is 0.");
+		status = BT_NOTIFICATION_ITERATOR_STATUS_INVALID;
+		goto end;
+	}
+
+	if (!count) {
+		BT_LOGW_STR("Invalid parameter: count is NULL.");
+		status = BT_NOTIFICATION_ITERATOR_STATUS_INVALID;
+		goto end;
+	}
+
+	*count = 0;
+	BT_LOGD("Notification iterator's \"next batch\": iter-addr=%p, "
+		"capacity=%" PRIu64, iterator, capacity);
+
+	switch (iterator->type) {
+	case BT_NOTIFICATION_ITERATOR_TYPE_PRIVATE_CONNECTION:
+	{
+		struct bt_notification_iterator_private_connection *priv_conn_iter =
+			(void *) iterator;
+
+		/*
+		 * Make sure that the iterator's queue contains at least
+		 * one notification, then move as many notifications as
+		 * possible from the tail of the queue to the user's
+		 * array without calling the upstream component again.
+		 */
+		status = ensure_queue_has_notifications(priv_conn_iter);
+		if (status != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+			goto end;
+		}
+
+		assert(priv_conn_iter->queue->length > 0);
+
+		while (*count < capacity && priv_conn_iter->queue->length > 0) {
+			notifications[*count] =
+				g_queue_pop_tail(priv_conn_iter->queue);
+			(*count)++;
+		}
+
+		break;
+	}
+	case BT_NOTIFICATION_ITERATOR_TYPE_OUTPUT_PORT:
+	{
+		/*
+		 * The colander sink only gets one notification per
+		 * consuming call: use the regular "next" path, and then
+		 * restore the current notification so that it is not
+		 * changed from the user's point of view.
+		 */
+		struct bt_notification *old_notif =
+			bt_get(bt_notification_iterator_borrow_current_notification(iterator));
+
+		status = bt_notification_iterator_next(iterator);
+		if (status == BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+			notifications[0] = bt_get(
+				bt_notification_iterator_borrow_current_notification(iterator));
+			*count = 1;
+			bt_notification_iterator_replace_current_notification(
+				iterator, old_notif);
+		}
+
+		bt_put(old_notif);
+		if (status != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+			goto end;
+		}
+
+		break;
+	}
+	default:
+		BT_LOGF("Unknown notification iterator type: addr=%p, type=%d",
+			iterator, iterator->type);
+		abort();
+	}
+
+	BT_LOGD("Got notifications from notification iterator: iter-addr=%p, "
+		"count=%" PRIu64, iterator, *count);
+
+end:
+	return status;
+}
+
 struct bt_component *bt_private_connection_notification_iterator_get_component(
 		struct bt_notification_iterator *iterator)
 {
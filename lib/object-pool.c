@@ -0,0 +1,86 @@
+/*
+ * object-pool.c: object pool
+ *
+ * Babeltrace Library
+ *
+ * Copyright (c) 2017 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_LOG_TAG "OBJECT-POOL"
+#include <babeltrace/lib-logging-internal.h>
+
+#include <babeltrace/object-pool-internal.h>
+#include <assert.h>
+#include <glib.h>
+
+int bt_object_pool_initialize(struct bt_object_pool *pool,
+		size_t max_count,
+		bt_object_pool_destroy_object_func destroy_object_func,
+		void *data)
+{
+	int ret = 0;
+
+	assert(pool);
+	assert(max_count > 0);
+	assert(destroy_object_func);
+	BT_LOGD("Initializing object pool: addr=%p, max-count=%zu, "
+		"data-addr=%p", pool, max_count, data);
+	pool->objects = g_ptr_array_sized_new(max_count);
+	if (!pool->objects) {
+		BT_LOGE_STR("Failed to allocate a GPtrArray.");
+		ret = -1;
+		goto end;
+	}
+
+	pool->max_count = max_count;
+	pool->destroy_object = destroy_object_func;
+	pool->data = data;
+	BT_LOGD("Initialized object pool: addr=%p", pool);
+
+end:
+	return ret;
+}
+
+void bt_object_pool_finalize(struct bt_object_pool *pool)
+{
+	guint i;
+
+	assert(pool);
+	BT_LOGD("Finalizing object pool: addr=%p", pool);
+
+	if (!pool->objects) {
+		goto end;
+	}
+
+	for (i = 0; i < pool->objects->len; i++) {
+		void *obj = pool->objects->pdata[i];
+
+		if (obj) {
+			pool->destroy_object(obj, pool->data);
+		}
+	}
+
+	g_ptr_array_free(pool->objects, TRUE);
+	pool->objects = NULL;
+
+end:
+	return;
+}
@@ -466,6 +466,10 @@ enum bt_plugin_status bt_plugin_so_init(
 					cc_full_descr->iterator_methods.finalize =
 						cur_cc_descr_attr->value.notif_iter_finalize_method;
 					break;
+				case BT_PLUGIN_COMPONENT_CLASS_DESCRIPTOR_ATTRIBUTE_TYPE_NOTIF_ITER_NEXT_BATCH_METHOD:
+					cc_full_descr->iterator_methods.next_batch =
+						cur_cc_descr_attr->value.notif_iter_next_batch_method;
+					break;
 				default:
 					/*
 					 * WARN-level logging because
@@ -686,6 +690,18 @@ enum bt_plugin_status bt_plugin_so_init(
 					goto end;
 				}
 			}
+
+			if (cc_full_descr->iterator_methods.next_batch) {
+				ret = bt_component_class_source_set_notification_iterator_next_batch_method(
+					comp_class,
+					cc_full_descr->iterator_methods.next_batch);
+				if (ret) {
+					BT_LOGE_STR("Cannot set source component class's notification iterator \"next batch\" method.");
+					status = BT_PLUGIN_STATUS_ERROR;
+					BT_PUT(comp_class);
+					goto end;
+				}
+			}
 			break;
 		case BT_COMPONENT_CLASS_TYPE_FILTER:
 			if (cc_full_descr->iterator_methods.init) {
@@ -711,6 +727,18 @@ enum bt_plugin_status bt_plugin_so_init(
 					goto end;
 				}
 			}
+
+			if (cc_full_descr->iterator_methods.next_batch) {
+				ret = bt_component_class_filter_set_notification_iterator_next_batch_method(
+					comp_class,
+					cc_full_descr->iterator_methods.next_batch);
+				if (ret) {
+					BT_LOGE_STR("Cannot set filter component class's notification iterator \"next batch\" method.");
+					status = BT_PLUGIN_STATUS_ERROR;
+					BT_PUT(comp_class);
+					goto end;
+				}
+			}
 			break;
 		case BT_COMPONENT_CLASS_TYPE_SINK:
 			break;
@@ -39,6 +39,7 @@
 #include <babeltrace/ctf-ir/field-types-internal.h>
 #include <babeltrace/ref.h>
 #include <babeltrace/align-internal.h>
+#include <babeltrace/endian-internal.h>
 #include <glib.h>
 
 #include "btr.h"
@@ -59,7 +60,9 @@ struct stack_entry {
 	 *   * Sequence
 	 *   * Variant
 	 *
-	 * Owned by this.
+	 * Weak: the root type is owned by the user during the whole
+	 * decoding process, and each other base type is owned by its
+	 * parent type.
 	 */
 	struct bt_field_type *base_type;
 
@@ -70,10 +73,92 @@ struct stack_entry {
 	int64_t index;
 };
 
-/* Visit stack */
+/*
+ * Visit stack.
+ *
+ * Entries are never freed when popped: the array only grows to the
+ * maximum depth of the decoded types, so that pushing and popping
+ * entries does not allocate anything once this depth is reached.
+ */
 struct stack {
-	/* Entries (struct stack_entry *) (top is last element) */
-	GPtrArray *entries;
+	/* Entries (struct stack_entry) (top is at index size - 1) */
+	GArray *entries;
+
+	/* Number of entries in the stack */
+	size_t size;
+};
+
+/*
+ * Maximum number of operations of a fixed-layout decoding program.
+ *
+ * Arrays are unrolled when compiling a program, so this limits the
+ * memory used by the program of a type containing large arrays.
+ */
+#define BTR_PROG_MAX_OPS		1024
+
+/* Fixed-layout decoding program operation types */
+enum btr_prog_op_type {
+	BTR_PROG_OP_COMPOUND_BEGIN,
+	BTR_PROG_OP_COMPOUND_END,
+	BTR_PROG_OP_UNSIGNED_INT,
+	BTR_PROG_OP_SIGNED_INT,
+	BTR_PROG_OP_FLOAT32,
+	BTR_PROG_OP_FLOAT64,
+	BTR_PROG_OP_PACKED_ELEMENTS,
+};
+
+/* A fixed-layout decoding program operation */
+struct btr_prog_op {
+	enum btr_prog_op_type type;
+
+	/* Offset of the field from the beginning of the root type (bits) */
+	size_t offset;
+
+	/*
+	 * Size of the field (bits, 0 for compound types), or of one
+	 * element for packed elements.
+	 */
+	unsigned int size;
+
+	/* Number of elements (packed elements only) */
+	uint64_t count;
+
+	/*
+	 * True if the field is a byte-aligned 8-bit, 16-bit, 32-bit or
+	 * 64-bit number which can be loaded directly.
+	 */
+	bool byte_aligned;
+
+	/* Byte order (big endian or little endian) */
+	enum bt_byte_order bo;
+
+	/* Field type passed to the user callback function (weak) */
+	struct bt_field_type *field_type;
+};
+
+/*
+ * Decoding program of a field type.
+ *
+ * A field type containing only integers, enumerations, floating point
+ * numbers, structures and arrays always has the same layout, relative
+ * to the beginning of the field, as long as this beginning is aligned.
+ * Its program is a flat list of operations, in decoding order, which
+ * BTR executes with straight-line loads when the whole field is
+ * available in the current buffer, instead of going through the state
+ * machine for each basic field.
+ */
+struct btr_prog {
+	/* False if this field type has no fixed layout */
+	bool fixed;
+
+	/* Alignment of the root type (bits) */
+	unsigned int alignment;
+
+	/* Total size of the field (bits) */
+	size_t size;
+
+	/* Array of struct btr_prog_op */
+	GArray *ops;
 };
 
 /* Reading states */
@@ -97,6 +182,21 @@ struct bt_btr {
 	/* Current state */
 	enum btr_state state;
 
+	/*
+	 * Decoding programs: struct bt_field_type * (owned by this) to
+	 * struct btr_prog * (owned by this).
+	 */
+	GHashTable *progs;
+
+	/* True to decode fixed-layout compound types with `progs` */
+	bool use_progs;
+
+	/*
+	 * Packed elements converted to the native byte order, passed to
+	 * the user function (reused from one call to the other).
+	 */
+	GByteArray *packed_elements;
+
 	/*
 	 * Last basic field type's byte order.
 	 *
@@ -176,15 +276,6 @@ const char *btr_state_string(enum btr_state state)
 	}
 }
 
-static
-void stack_entry_free_func(gpointer data)
-{
-	struct stack_entry *entry = data;
-
-	BT_PUT(entry->base_type);
-	g_free(entry);
-}
-
 static
 struct stack *stack_new(void)
 {
@@ -196,9 +287,10 @@ struct stack *stack_new(void)
 		goto error;
 	}
 
-	stack->entries = g_ptr_array_new_with_free_func(stack_entry_free_func);
+	stack->entries = g_array_sized_new(FALSE, TRUE,
+		sizeof(struct stack_entry), 16);
 	if (!stack->entries) {
-		BT_LOGE_STR("Failed to allocate a GPtrArray.");
+		BT_LOGE_STR("Failed to allocate a GArray.");
 		goto error;
 	}
 
@@ -219,7 +311,7 @@ void stack_destroy(struct stack *stack)
 	}
 
 	BT_LOGD("Destroying stack: addr=%p", stack);
-	g_ptr_array_free(stack->entries, TRUE);
+	g_array_free(stack->entries, TRUE);
 	g_free(stack);
 }
 
@@ -261,7 +353,6 @@ static
 int stack_push(struct stack *stack, struct bt_field_type *base_type,
 	size_t base_len)
 {
-	int ret = 0;
 	struct stack_entry *entry;
 
 	assert(stack);
@@ -269,25 +360,22 @@ int stack_push(struct stack *stack, struct bt_field_type *base_type,
 
 	BT_LOGV("Pushing field type on stack: stack-addr=%p, "
 		"ft-addr=%p, ft-id=%s, base-length=%zu, "
-		"stack-size-before=%u, stack-size-after=%u",
+		"stack-size-before=%zu, stack-size-after=%zu",
 		stack, base_type, bt_field_type_id_string(
 			bt_field_type_get_type_id(base_type)),
-		base_len, stack->entries->len, stack->entries->len + 1);
-	entry = g_new0(struct stack_entry, 1);
-	if (!entry) {
-		BT_LOGE("Failed to allocate one stack entry: stack-addr=%p",
-			stack);
-		ret = BT_BTR_STATUS_ERROR;
-		goto end;
+		base_len, stack->size, stack->size + 1);
+
+	if (stack->size == stack->entries->len) {
+		g_array_set_size(stack->entries, stack->size + 1);
 	}
 
+	entry = &g_array_index(stack->entries, struct stack_entry,
+		stack->size);
 	entry->base_type = base_type;
-	bt_get(entry->base_type);
 	entry->base_len = base_len;
-	g_ptr_array_add(stack->entries, entry);
-
-end:
-	return ret;
+	entry->index = 0;
+	stack->size++;
+	return 0;
 }
 
 static
@@ -313,11 +401,11 @@ end:
 }
 
 static inline
-unsigned int stack_size(struct stack *stack)
+size_t stack_size(struct stack *stack)
 {
 	assert(stack);
 
-	return stack->entries->len;
+	return stack->size;
 }
 
 static
@@ -326,9 +414,9 @@ void stack_pop(struct stack *stack)
 	assert(stack);
 	assert(stack_size(stack));
 	BT_LOGV("Popping from stack: "
-		"stack-addr=%p, stack-size-before=%u, stack-size-after=%u",
-		stack, stack->entries->len, stack->entries->len - 1);
-	g_ptr_array_remove_index(stack->entries, stack->entries->len - 1);
+		"stack-addr=%p, stack-size-before=%zu, stack-size-after=%zu",
+		stack, stack->size, stack->size - 1);
+	stack->size--;
 }
 
 static inline
@@ -342,11 +430,7 @@ void stack_clear(struct stack *stack)
 {
 	assert(stack);
 
-	if (!stack_empty(stack)) {
-		g_ptr_array_remove_range(stack->entries, 0, stack_size(stack));
-	}
-
-	assert(stack_empty(stack));
+	stack->size = 0;
 }
 
 static inline
@@ -355,7 +439,8 @@ struct stack_entry *stack_top(struct stack *stack)
 	assert(stack);
 	assert(stack_size(stack));
 
-	return g_ptr_array_index(stack->entries, stack->entries->len - 1);
+	return &g_array_index(stack->entries, struct stack_entry,
+		stack->size - 1);
 }
 
 static inline
@@ -1010,6 +1095,26 @@ enum bt_btr_status read_basic_string_type_and_call(
 	first_chr = &btr->buf.addr[buf_at_bytes];
 	result = memchr(first_chr, '\0', available_bytes);
 
+	if (begin && result && btr->user.cbs.types.whole_string) {
+		/* Whole string in the current buffer */
+		size_t result_len = (size_t) (result - first_chr);
+
+		BT_LOGV("Calling user function (whole string).");
+		status = btr->user.cbs.types.whole_string(
+			(const char *) first_chr, result_len,
+			btr->cur_basic_field_type, btr->user.data);
+		BT_LOGV("User function returned: status=%s",
+			bt_btr_status_string(status));
+		if (status != BT_BTR_STATUS_OK) {
+			BT_LOGW("User function failed: btr-addr=%p, status=%s",
+				btr, bt_btr_status_string(status));
+			goto end;
+		}
+
+		consume_bits(btr, BYTES_TO_BITS(result_len + 1));
+		goto string_done;
+	}
+
 	if (begin && btr->user.cbs.types.string_begin) {
 		BT_LOGV("Calling user function (string, beginning).");
 		status = btr->user.cbs.types.string_begin(
@@ -1079,16 +1184,20 @@ enum bt_btr_status read_basic_string_type_and_call(
 		}
 
 		consume_bits(btr, BYTES_TO_BITS(result_len + 1));
+		goto string_done;
+	}
 
-		if (stack_empty(btr->stack)) {
-			/* Root is a basic type */
-			btr->state = BTR_STATE_DONE;
-		} else {
-			/* Go to next field */
-			stack_top(btr->stack)->index++;
-			btr->state = BTR_STATE_NEXT_FIELD;
-			btr->last_bo = btr->cur_bo;
-		}
+	goto end;
+
+string_done:
+	if (stack_empty(btr->stack)) {
+		/* Root is a basic type */
+		btr->state = BTR_STATE_DONE;
+	} else {
+		/* Go to next field */
+		stack_top(btr->stack)->index++;
+		btr->state = BTR_STATE_NEXT_FIELD;
+		btr->last_bo = btr->cur_bo;
 	}
 
 end:
@@ -1241,6 +1350,721 @@ bool is_compound_type(struct bt_field_type *field_type)
 		id == BT_FIELD_TYPE_ID_SEQUENCE || id == BT_FIELD_TYPE_ID_VARIANT;
 }
 
+/*
+ * Returns whether or not the elements of the array or sequence type
+ * `field_type` can be passed all at once to the user with
+ * bt_btr_cbs::types::packed_elements(), setting `*size` to the size
+ * of one element (bits) and `*bo` to its byte order.
+ *
+ * The elements must be contiguous bytes: an element's size must be a
+ * multiple of its alignment, which must be a multiple of 8. The values
+ * of integer elements mapped to a clock class are needed one by one
+ * by the user to update this clock's value, so they are not packed.
+ */
+static
+bool get_packed_element_info(struct bt_btr *btr,
+		struct bt_field_type *field_type, unsigned int *size,
+		enum bt_byte_order *bo)
+{
+	bool is_packable = false;
+	struct bt_field_type *elem_type = NULL;
+	struct bt_clock_class *clock_class = NULL;
+	int elem_size;
+	int alignment;
+
+	if (!btr->user.cbs.types.packed_elements) {
+		goto end;
+	}
+
+	switch (bt_field_type_get_type_id(field_type)) {
+	case BT_FIELD_TYPE_ID_ARRAY:
+		elem_type = bt_field_type_array_get_element_type(field_type);
+		break;
+	case BT_FIELD_TYPE_ID_SEQUENCE:
+		elem_type = bt_field_type_sequence_get_element_type(field_type);
+		break;
+	default:
+		goto end;
+	}
+
+	assert(elem_type);
+
+	switch (bt_field_type_get_type_id(elem_type)) {
+	case BT_FIELD_TYPE_ID_INTEGER:
+		clock_class = bt_field_type_integer_get_mapped_clock_class(
+			elem_type);
+		if (clock_class) {
+			goto end;
+		}
+
+		break;
+	case BT_FIELD_TYPE_ID_FLOAT:
+		break;
+	default:
+		goto end;
+	}
+
+	elem_size = get_basic_field_type_size(btr, elem_type);
+	switch (elem_size) {
+	case 8:
+	case 16:
+		if (bt_field_type_get_type_id(elem_type) ==
+				BT_FIELD_TYPE_ID_FLOAT) {
+			goto end;
+		}
+		break;
+	case 32:
+	case 64:
+		break;
+	default:
+		goto end;
+	}
+
+	alignment = bt_field_type_get_alignment(elem_type);
+	if (alignment <= 0 || alignment % 8 != 0 ||
+			elem_size % alignment != 0) {
+		goto end;
+	}
+
+	switch (bt_field_type_get_byte_order(elem_type)) {
+	case BT_BYTE_ORDER_BIG_ENDIAN:
+	case BT_BYTE_ORDER_NETWORK:
+		*bo = BT_BYTE_ORDER_BIG_ENDIAN;
+		break;
+	case BT_BYTE_ORDER_LITTLE_ENDIAN:
+		*bo = BT_BYTE_ORDER_LITTLE_ENDIAN;
+		break;
+	default:
+		goto end;
+	}
+
+	*size = (unsigned int) elem_size;
+	is_packable = true;
+
+end:
+	bt_put(clock_class);
+	bt_put(elem_type);
+	return is_packable;
+}
+
+/*
+ * Returns the `count` elements of `size` bits, in byte order `bo`, at
+ * `addr` in the native byte order: either `addr` itself or the BTR's
+ * packed elements buffer.
+ */
+static
+const void *get_native_packed_elements(struct bt_btr *btr,
+		const uint8_t *addr, uint64_t count, unsigned int size,
+		enum bt_byte_order bo)
+{
+	const enum bt_byte_order native_bo = BYTE_ORDER == BIG_ENDIAN ?
+		BT_BYTE_ORDER_BIG_ENDIAN : BT_BYTE_ORDER_LITTLE_ENDIAN;
+	uint8_t *dst;
+	uint64_t i;
+
+	if (size == 8 || bo == native_bo) {
+		return addr;
+	}
+
+	g_byte_array_set_size(btr->packed_elements, count * DIV8(size));
+	dst = btr->packed_elements->data;
+
+	/*
+	 * One simple loop per element size, so that the compiler can
+	 * vectorize it.
+	 */
+	switch (size) {
+	case 16:
+		for (i = 0; i < count; i++) {
+			uint16_t v;
+
+			memcpy(&v, &addr[i * sizeof(v)], sizeof(v));
+			v = GUINT16_SWAP_LE_BE(v);
+			memcpy(&dst[i * sizeof(v)], &v, sizeof(v));
+		}
+		break;
+	case 32:
+		for (i = 0; i < count; i++) {
+			uint32_t v;
+
+			memcpy(&v, &addr[i * sizeof(v)], sizeof(v));
+			v = GUINT32_SWAP_LE_BE(v);
+			memcpy(&dst[i * sizeof(v)], &v, sizeof(v));
+		}
+		break;
+	case 64:
+		for (i = 0; i < count; i++) {
+			uint64_t v;
+
+			memcpy(&v, &addr[i * sizeof(v)], sizeof(v));
+			v = GUINT64_SWAP_LE_BE(v);
+			memcpy(&dst[i * sizeof(v)], &v, sizeof(v));
+		}
+		break;
+	default:
+		abort();
+	}
+
+	return dst;
+}
+
+static
+void btr_prog_destroy(struct btr_prog *prog)
+{
+	if (!prog) {
+		return;
+	}
+
+	if (prog->ops) {
+		g_array_free(prog->ops, TRUE);
+	}
+
+	g_free(prog);
+}
+
+static
+int btr_prog_append_op(struct btr_prog *prog, enum btr_prog_op_type type,
+		size_t offset, unsigned int size, enum bt_byte_order bo,
+		struct bt_field_type *field_type)
+{
+	struct btr_prog_op op = {
+		.type = type,
+		.offset = offset,
+		.size = size,
+		.bo = bo,
+		.field_type = field_type,
+	};
+
+	if (prog->ops->len == BTR_PROG_MAX_OPS) {
+		BT_LOGV("Decoding program has too many operations: "
+			"max-op-count=%d", BTR_PROG_MAX_OPS);
+		return -1;
+	}
+
+	op.byte_aligned = offset % 8 == 0 &&
+		(size == 8 || size == 16 || size == 32 || size == 64);
+	g_array_append_val(prog->ops, op);
+	return 0;
+}
+
+/*
+ * Appends the operations to decode a field of type `field_type` to
+ * `prog`, `*at` being the current offset from the beginning of the
+ * root type, and updates `*at` and `*last_bo`.
+ *
+ * Returns -1 if this field type has no fixed layout.
+ */
+static
+int btr_prog_compile_field_type(struct bt_btr *btr, struct btr_prog *prog,
+		struct bt_field_type *field_type, size_t *at,
+		enum bt_byte_order *last_bo)
+{
+	int ret = 0;
+	int alignment;
+	int64_t i;
+	int64_t len;
+	struct bt_field_type *int_type = NULL;
+	struct bt_field_type *child_type = NULL;
+	enum bt_field_type_id type_id = bt_field_type_get_type_id(field_type);
+
+	alignment = bt_field_type_get_alignment(field_type);
+	if (alignment <= 0) {
+		goto error;
+	}
+
+	*at = ALIGN(*at, alignment);
+
+	switch (type_id) {
+	case BT_FIELD_TYPE_ID_INTEGER:
+	case BT_FIELD_TYPE_ID_ENUM:
+	case BT_FIELD_TYPE_ID_FLOAT:
+	{
+		enum btr_prog_op_type op_type;
+		enum bt_byte_order bo;
+		int size;
+
+		if (type_id == BT_FIELD_TYPE_ID_ENUM) {
+			int_type = bt_field_type_enumeration_get_container_type(
+				field_type);
+			assert(int_type);
+		} else {
+			int_type = bt_get(field_type);
+		}
+
+		size = get_basic_field_type_size(btr, int_type);
+		if (size < 1) {
+			goto error;
+		}
+
+		if (type_id == BT_FIELD_TYPE_ID_FLOAT) {
+			if (size == 32) {
+				op_type = BTR_PROG_OP_FLOAT32;
+			} else if (size == 64) {
+				op_type = BTR_PROG_OP_FLOAT64;
+			} else {
+				goto error;
+			}
+		} else if (bt_field_type_integer_is_signed(int_type)) {
+			op_type = BTR_PROG_OP_SIGNED_INT;
+		} else {
+			op_type = BTR_PROG_OP_UNSIGNED_INT;
+		}
+
+		bo = bt_field_type_get_byte_order(int_type);
+		switch (bo) {
+		case BT_BYTE_ORDER_BIG_ENDIAN:
+		case BT_BYTE_ORDER_NETWORK:
+			bo = BT_BYTE_ORDER_BIG_ENDIAN;
+			break;
+		case BT_BYTE_ORDER_LITTLE_ENDIAN:
+			break;
+		default:
+			goto error;
+		}
+
+		/*
+		 * Let the state machine report two contiguous basic
+		 * fields with different byte orders.
+		 */
+		if (*at % 8 != 0 && *last_bo != BT_BYTE_ORDER_UNKNOWN &&
+				*last_bo != bo) {
+			goto error;
+		}
+
+		if (btr_prog_append_op(prog, op_type, *at, size, bo,
+				field_type)) {
+			goto error;
+		}
+
+		*at += size;
+		*last_bo = bo;
+		break;
+	}
+	case BT_FIELD_TYPE_ID_STRUCT:
+	case BT_FIELD_TYPE_ID_ARRAY:
+	{
+		unsigned int elem_size;
+		enum bt_byte_order elem_bo;
+
+		if (type_id == BT_FIELD_TYPE_ID_STRUCT) {
+			len = bt_field_type_structure_get_field_count(
+				field_type);
+		} else {
+			len = bt_field_type_array_get_length(field_type);
+			child_type = bt_field_type_array_get_element_type(
+				field_type);
+			assert(child_type);
+		}
+
+		if (len < 0) {
+			goto error;
+		}
+
+		if (btr_prog_append_op(prog, BTR_PROG_OP_COMPOUND_BEGIN,
+				*at, 0, BT_BYTE_ORDER_UNKNOWN, field_type)) {
+			goto error;
+		}
+
+		if (type_id == BT_FIELD_TYPE_ID_ARRAY && len > 0 &&
+				get_packed_element_info(btr, field_type,
+					&elem_size, &elem_bo)) {
+			/* One operation for all the elements */
+			if (btr_prog_append_op(prog,
+					BTR_PROG_OP_PACKED_ELEMENTS, *at,
+					elem_size, elem_bo, field_type)) {
+				goto error;
+			}
+
+			g_array_index(prog->ops, struct btr_prog_op,
+				prog->ops->len - 1).count = (uint64_t) len;
+			*at += (size_t) len * elem_size;
+			*last_bo = elem_bo;
+			len = 0;
+		}
+
+		for (i = 0; i < len; i++) {
+			if (type_id == BT_FIELD_TYPE_ID_STRUCT) {
+				BT_PUT(child_type);
+				ret = bt_field_type_structure_get_field_by_index(
+					field_type, NULL, &child_type, i);
+				if (ret) {
+					goto error;
+				}
+			}
+
+			/*
+			 * The parent field type owns the child field
+			 * type, so the weak reference of its operation
+			 * remains valid.
+			 */
+			ret = btr_prog_compile_field_type(btr, prog,
+				child_type, at, last_bo);
+			if (ret) {
+				goto error;
+			}
+		}
+
+		if (btr_prog_append_op(prog, BTR_PROG_OP_COMPOUND_END,
+				*at, 0, BT_BYTE_ORDER_UNKNOWN, field_type)) {
+			goto error;
+		}
+
+		break;
+	}
+	default:
+		/* Strings, sequences and variants have no fixed layout */
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	bt_put(int_type);
+	bt_put(child_type);
+	return ret;
+}
+
+static
+struct btr_prog *btr_prog_create(struct bt_btr *btr,
+		struct bt_field_type *field_type)
+{
+	struct btr_prog *prog;
+	enum bt_byte_order last_bo = BT_BYTE_ORDER_UNKNOWN;
+	size_t at = 0;
+
+	prog = g_new0(struct btr_prog, 1);
+	if (!prog) {
+		BT_LOGE_STR("Failed to allocate one decoding program.");
+		goto error;
+	}
+
+	prog->ops = g_array_new(FALSE, FALSE, sizeof(struct btr_prog_op));
+	if (!prog->ops) {
+		BT_LOGE_STR("Failed to allocate a GArray.");
+		goto error;
+	}
+
+	if (btr_prog_compile_field_type(btr, prog, field_type, &at,
+			&last_bo) == 0) {
+		prog->fixed = true;
+		prog->alignment = bt_field_type_get_alignment(field_type);
+		prog->size = at;
+	} else {
+		/* Keep an empty program to avoid compiling it again */
+		g_array_set_size(prog->ops, 0);
+	}
+
+	BT_LOGD("Compiled field type's decoding program: "
+		"btr-addr=%p, ft-addr=%p, ft-id=%s, is-fixed=%d, "
+		"op-count=%u, size=%zu",
+		btr, field_type, bt_field_type_id_string(
+			bt_field_type_get_type_id(field_type)),
+		prog->fixed, prog->ops->len, prog->size);
+	return prog;
+
+error:
+	btr_prog_destroy(prog);
+	return NULL;
+}
+
+static inline
+struct btr_prog *get_prog(struct bt_btr *btr,
+		struct bt_field_type *field_type)
+{
+	struct btr_prog *prog;
+
+	prog = g_hash_table_lookup(btr->progs, field_type);
+	if (prog) {
+		goto end;
+	}
+
+	prog = btr_prog_create(btr, field_type);
+	if (!prog) {
+		goto end;
+	}
+
+	g_hash_table_insert(btr->progs, bt_get(field_type), prog);
+
+end:
+	return prog;
+}
+
+static inline
+uint64_t btr_prog_read_unsigned(const uint8_t *buf, size_t at,
+		struct btr_prog_op *op)
+{
+	uint64_t v;
+
+	if (op->byte_aligned) {
+		const uint8_t *addr = &buf[BITS_TO_BYTES_FLOOR(at)];
+		bool be = op->bo == BT_BYTE_ORDER_BIG_ENDIAN;
+
+		switch (op->size) {
+		case 8:
+			return *addr;
+		case 16:
+		{
+			uint16_t v16;
+
+			memcpy(&v16, addr, sizeof(v16));
+			return be ? be16toh(v16) : le16toh(v16);
+		}
+		case 32:
+		{
+			uint32_t v32;
+
+			memcpy(&v32, addr, sizeof(v32));
+			return be ? be32toh(v32) : le32toh(v32);
+		}
+		case 64:
+			memcpy(&v, addr, sizeof(v));
+			return be ? be64toh(v) : le64toh(v);
+		default:
+			abort();
+		}
+	}
+
+	read_unsigned_bitfield(buf, at, op->size, op->bo, &v);
+	return v;
+}
+
+static inline
+int64_t btr_prog_read_signed(const uint8_t *buf, size_t at,
+		struct btr_prog_op *op)
+{
+	int64_t v;
+
+	if (op->byte_aligned) {
+		uint64_t uv = btr_prog_read_unsigned(buf, at, op);
+
+		switch (op->size) {
+		case 8:
+			return (int8_t) uv;
+		case 16:
+			return (int16_t) uv;
+		case 32:
+			return (int32_t) uv;
+		case 64:
+			return (int64_t) uv;
+		default:
+			abort();
+		}
+	}
+
+	read_signed_bitfield(buf, at, op->size, op->bo, &v);
+	return v;
+}
+
+static
+enum bt_btr_status btr_prog_exec(struct bt_btr *btr, struct btr_prog *prog,
+		const uint8_t *buf, size_t base_at)
+{
+	guint i;
+	enum bt_btr_status status = BT_BTR_STATUS_OK;
+	struct bt_btr_cbs *cbs = &btr->user.cbs;
+
+	for (i = 0; i < prog->ops->len; i++) {
+		struct btr_prog_op *op = &g_array_index(prog->ops,
+			struct btr_prog_op, i);
+		size_t at = base_at + op->offset;
+
+		switch (op->type) {
+		case BTR_PROG_OP_COMPOUND_BEGIN:
+			if (cbs->types.compound_begin) {
+				status = cbs->types.compound_begin(
+					op->field_type, btr->user.data);
+			}
+			break;
+		case BTR_PROG_OP_COMPOUND_END:
+			if (cbs->types.compound_end) {
+				status = cbs->types.compound_end(
+					op->field_type, btr->user.data);
+			}
+			break;
+		case BTR_PROG_OP_UNSIGNED_INT:
+			if (cbs->types.unsigned_int) {
+				status = cbs->types.unsigned_int(
+					btr_prog_read_unsigned(buf, at, op),
+					op->field_type, btr->user.data);
+			}
+			break;
+		case BTR_PROG_OP_SIGNED_INT:
+			if (cbs->types.signed_int) {
+				status = cbs->types.signed_int(
+					btr_prog_read_signed(buf, at, op),
+					op->field_type, btr->user.data);
+			}
+			break;
+		case BTR_PROG_OP_FLOAT32:
+			if (cbs->types.floating_point) {
+				union {
+					uint32_t u;
+					float f;
+				} f32;
+
+				f32.u = (uint32_t) btr_prog_read_unsigned(buf,
+					at, op);
+				status = cbs->types.floating_point(
+					(double) f32.f, op->field_type,
+					btr->user.data);
+			}
+			break;
+		case BTR_PROG_OP_FLOAT64:
+			if (cbs->types.floating_point) {
+				union {
+					uint64_t u;
+					double d;
+				} f64;
+
+				f64.u = btr_prog_read_unsigned(buf, at, op);
+				status = cbs->types.floating_point(f64.d,
+					op->field_type, btr->user.data);
+			}
+			break;
+		case BTR_PROG_OP_PACKED_ELEMENTS:
+			/* Only compiled when the user function exists */
+			status = cbs->types.packed_elements(
+				get_native_packed_elements(btr,
+					&buf[BITS_TO_BYTES_FLOOR(at)],
+					op->count, op->size, op->bo),
+				op->count, op->field_type, btr->user.data);
+			break;
+		default:
+			abort();
+		}
+
+		if (status != BT_BTR_STATUS_OK) {
+			BT_LOGW("User function failed: btr-addr=%p, "
+				"ft-addr=%p, status=%s",
+				btr, op->field_type,
+				bt_btr_status_string(status));
+			goto end;
+		}
+
+		if (op->size > 0) {
+			btr->cur_bo = op->bo;
+		}
+	}
+
+end:
+	return status;
+}
+
+/*
+ * Decodes a whole field of compound type `field_type`, at the current
+ * position, with its decoding program, calling the user functions for
+ * the compound type itself and for all its subfields.
+ *
+ * Sets `*done` to false, without consuming anything nor calling any
+ * user function, if this field type has no fixed layout or if the
+ * current buffer does not contain the whole field: the caller must
+ * then use the state machine.
+ */
+static
+enum bt_btr_status read_fixed_compound(struct bt_btr *btr,
+		struct bt_field_type *field_type, bool *done)
+{
+	struct btr_prog *prog;
+	size_t skip_bits;
+	enum bt_btr_status status = BT_BTR_STATUS_OK;
+
+	*done = false;
+	if (!btr->use_progs) {
+		goto end;
+	}
+
+	prog = get_prog(btr, field_type);
+	if (!prog || !prog->fixed) {
+		goto end;
+	}
+
+	skip_bits = bits_to_skip_to_align_to(btr, prog->alignment);
+	if (!has_enough_bits(btr, skip_bits + prog->size)) {
+		goto end;
+	}
+
+	if ((packet_at(btr) + skip_bits) % 8 != 0 ||
+			(buf_at_from_addr(btr) + skip_bits) % 8 != 0) {
+		goto end;
+	}
+
+	BT_LOGV("Decoding fixed-layout compound field: "
+		"btr-addr=%p, ft-addr=%p, op-count=%u, size=%zu",
+		btr, field_type, prog->ops->len, prog->size);
+	consume_bits(btr, skip_bits);
+	assert(btr->buf.addr);
+	status = btr_prog_exec(btr, prog, btr->buf.addr,
+		buf_at_from_addr(btr));
+	if (status != BT_BTR_STATUS_OK) {
+		/* btr_prog_exec() logs errors */
+		goto end;
+	}
+
+	consume_bits(btr, prog->size);
+	btr->last_bo = btr->cur_bo;
+	*done = true;
+
+end:
+	return status;
+}
+
+/*
+ * Decodes all the elements of the array or sequence field of the stack
+ * entry `top`, which must not have any decoded element, in one go with
+ * bt_btr_cbs::types::packed_elements().
+ *
+ * Sets `*done` to false, without consuming anything nor calling any
+ * user function, if those elements cannot be passed as is to the user
+ * or if the current buffer does not contain all of them: the caller
+ * must then decode them one by one.
+ */
+static
+enum bt_btr_status read_packed_elements(struct bt_btr *btr,
+		struct stack_entry *top, bool *done)
+{
+	unsigned int size;
+	enum bt_byte_order bo;
+	const uint8_t *addr;
+	enum bt_btr_status status = BT_BTR_STATUS_OK;
+
+	*done = false;
+	if (!get_packed_element_info(btr, top->base_type, &size, &bo)) {
+		goto end;
+	}
+
+	if (packet_at(btr) % 8 != 0 || buf_at_from_addr(btr) % 8 != 0 ||
+			!has_enough_bits(btr, (size_t) top->base_len * size)) {
+		goto end;
+	}
+
+	addr = &btr->buf.addr[BITS_TO_BYTES_FLOOR(buf_at_from_addr(btr))];
+	BT_LOGV("Calling user function (packed elements): "
+		"btr-addr=%p, ft-addr=%p, count=%" PRId64 ", elem-size=%u",
+		btr, top->base_type, top->base_len, size);
+	status = btr->user.cbs.types.packed_elements(
+		get_native_packed_elements(btr, addr,
+			(uint64_t) top->base_len, size, bo),
+		(uint64_t) top->base_len, top->base_type, btr->user.data);
+	BT_LOGV("User function returned: status=%s",
+		bt_btr_status_string(status));
+	if (status != BT_BTR_STATUS_OK) {
+		BT_LOGW("User function failed: btr-addr=%p, status=%s",
+			btr, bt_btr_status_string(status));
+		goto end;
+	}
+
+	consume_bits(btr, (size_t) top->base_len * size);
+	btr->last_bo = bo;
+	top->index = top->base_len;
+	*done = true;
+
+end:
+	return status;
+}
+
 static inline
 enum bt_btr_status next_field_state(struct bt_btr *btr)
 {
@@ -1282,6 +2106,23 @@ enum bt_btr_status next_field_state(struct bt_btr *btr)
 		top->index++;
 	}
 
+	if (top->index == 0 && top->base_len > 0) {
+		bool done;
+
+		/* Fast path: decode all the numeric elements in one go */
+		status = read_packed_elements(btr, top, &done);
+		if (status != BT_BTR_STATUS_OK) {
+			/* read_packed_elements() logs errors */
+			goto end;
+		}
+
+		if (done) {
+			/* Next state: end of this compound field */
+			btr->state = BTR_STATE_NEXT_FIELD;
+			goto end;
+		}
+	}
+
 	/* Get next field's type */
 	switch (bt_field_type_get_type_id(top->base_type)) {
 	case BT_FIELD_TYPE_ID_STRUCT:
@@ -1325,6 +2166,22 @@ enum bt_btr_status next_field_state(struct bt_btr *btr)
 	}
 
 	if (is_compound_type(next_field_type)) {
+		bool done;
+
+		/* Fast path: decode a fixed-layout field in one go */
+		status = read_fixed_compound(btr, next_field_type, &done);
+		if (status != BT_BTR_STATUS_OK) {
+			/* read_fixed_compound() logs errors */
+			goto end;
+		}
+
+		if (done) {
+			/* Go to next field */
+			top->index++;
+			btr->state = BTR_STATE_NEXT_FIELD;
+			goto end;
+		}
+
 		if (btr->user.cbs.types.compound_begin) {
 			BT_LOGV("Calling user function (compound, begin).");
 			status = btr->user.cbs.types.compound_begin(
@@ -1419,6 +2276,24 @@ struct bt_btr *bt_btr_create(struct bt_btr_cbs cbs, void *data)
 		goto end;
 	}
 
+	btr->progs = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+		(GDestroyNotify) bt_put, (GDestroyNotify) btr_prog_destroy);
+	if (!btr->progs) {
+		BT_LOGE_STR("Failed to allocate a GHashTable.");
+		bt_btr_destroy(btr);
+		btr = NULL;
+		goto end;
+	}
+
+	btr->packed_elements = g_byte_array_new();
+	if (!btr->packed_elements) {
+		BT_LOGE_STR("Failed to allocate a GByteArray.");
+		bt_btr_destroy(btr);
+		btr = NULL;
+		goto end;
+	}
+
+	btr->use_progs = true;
 	btr->state = BTR_STATE_NEXT_FIELD;
 	btr->user.cbs = cbs;
 	btr->user.data = data;
@@ -1434,11 +2309,27 @@ void bt_btr_destroy(struct bt_btr *btr)
 		stack_destroy(btr->stack);
 	}
 
+	if (btr->progs) {
+		g_hash_table_destroy(btr->progs);
+	}
+
+	if (btr->packed_elements) {
+		g_byte_array_free(btr->packed_elements, TRUE);
+	}
+
 	BT_LOGD("Destroying BTR: addr=%p", btr);
 	BT_PUT(btr->cur_basic_field_type);
 	g_free(btr);
 }
 
+void bt_btr_set_use_progs(struct bt_btr *btr, bool use_progs)
+{
+	assert(btr);
+	BT_LOGD("Setting BTR's decoding program usage: addr=%p, use-progs=%d",
+		btr, use_progs);
+	btr->use_progs = use_progs;
+}
+
 static
 void reset(struct bt_btr *btr)
 {
@@ -1485,6 +2376,20 @@ size_t bt_btr_start(struct bt_btr *btr,
 	if (is_compound_type(type)) {
 		/* Compound type: push on visit stack */
 		int stack_ret;
+		bool done;
+
+		/* Fast path: decode a fixed-layout root field in one go */
+		*status = read_fixed_compound(btr, type, &done);
+		if (*status != BT_BTR_STATUS_OK) {
+			/* read_fixed_compound() logs errors */
+			goto end;
+		}
+
+		if (done) {
+			btr->state = BTR_STATE_DONE;
+			update_packet_offset(btr);
+			goto end;
+		}
 
 		if (btr->user.cbs.types.compound_begin) {
 			BT_LOGV("Calling user function (compound, begin).");
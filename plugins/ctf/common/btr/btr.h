@@ -29,6 +29,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdbool.h>
 #include <babeltrace/babeltrace.h>
 #include <babeltrace/babeltrace-internal.h>
 
@@ -201,6 +202,31 @@ struct bt_btr_cbs {
 		enum bt_btr_status (* string_end)(
 				struct bt_field_type *type, void *data);
 
+		/**
+		 * Called, instead of bt_btr_cbs::types::string_begin(),
+		 * bt_btr_cbs::types::string(), and
+		 * bt_btr_cbs::types::string_end(), when a whole string,
+		 * including its terminating null character, is within
+		 * the current buffer.
+		 *
+		 * \p value points within the buffer passed to
+		 * bt_btr_start() or bt_btr_continue(), and is
+		 * null-terminated.
+		 *
+		 * If this function is \c NULL, the type reader calls
+		 * the three string type callback functions instead.
+		 *
+		 * @param value		String value (null-terminated)
+		 * @param len		String value length
+		 * @param type		String type (weak reference)
+		 * @param data		User data
+		 * @returns		#BT_BTR_STATUS_OK or
+		 *			#BT_BTR_STATUS_ERROR
+		 */
+		enum bt_btr_status (* whole_string)(const char *value,
+				size_t len, struct bt_field_type *type,
+				void *data);
+
 		/**
 		 * Called when a compound type begins.
 		 *
@@ -233,6 +259,38 @@ struct bt_btr_cbs {
 		 */
 		enum bt_btr_status (* compound_end)(
 				struct bt_field_type *type, void *data);
+
+		/**
+		 * Called, between the calls to
+		 * bt_btr_cbs::types::compound_begin() and
+		 * bt_btr_cbs::types::compound_end() of an array or
+		 * sequence type, instead of the type callback function
+		 * calls of all its elements.
+		 *
+		 * The type reader only calls this function when the
+		 * elements are byte-aligned 8-bit, 16-bit, 32-bit, or
+		 * 64-bit integers (not mapped to a clock class) or
+		 * 32-bit or 64-bit floating point numbers which are
+		 * all available in the current buffer.
+		 *
+		 * \p elements contains \p count contiguous elements in
+		 * the native byte order. It is not necessarily aligned
+		 * and is only valid during this call.
+		 *
+		 * If this function is \c NULL, the type reader calls
+		 * the type callback function of each element.
+		 *
+		 * @param elements	Elements
+		 * @param count		Number of elements
+		 * @param type		Array or sequence type (weak
+		 *			reference)
+		 * @param data		User data
+		 * @returns		#BT_BTR_STATUS_OK or
+		 *			#BT_BTR_STATUS_ERROR
+		 */
+		enum bt_btr_status (* packed_elements)(
+				const void *elements, uint64_t count,
+				struct bt_field_type *type, void *data);
 	} types;
 
 	/**
@@ -286,6 +344,19 @@ struct bt_btr *bt_btr_create(struct bt_btr_cbs cbs, void *data);
  */
 void bt_btr_destroy(struct bt_btr *btr);
 
+/**
+ * Sets whether or not a CTF binary type reader decodes the compound
+ * types which have a fixed layout with precompiled decoding programs
+ * (the default), instead of with its state machine.
+ *
+ * Both methods call the same user callback functions with the same
+ * values: this is only useful to compare them in tests and benchmarks.
+ *
+ * @param btr		Binary type reader
+ * @param use_progs	True to use decoding programs
+ */
+void bt_btr_set_use_progs(struct bt_btr *btr, bool use_progs);
+
 /**
  * Decodes a given CTF type from a buffer of bytes.
  *
@@ -308,7 +379,9 @@ void bt_btr_destroy(struct bt_btr *btr);
  * be called next, \em not bt_btr_decode().
  *
  * @param btr			Binary type reader
- * @param type			Type to decode (weak reference)
+ * @param type			Type to decode (weak reference; must
+ *				exist until the decoding process is
+ *				done)
  * @param buf			Buffer
  * @param offset		Offset of first bit from \p buf (bits)
  * @param packet_offset		Offset of \p offset within the CTF
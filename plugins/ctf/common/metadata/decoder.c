@@ -38,6 +38,12 @@ int yydebug;
 
 struct ctf_metadata_decoder {
 	struct ctf_visitor_generate_ir *visitor;
+
+	/*
+	 * Kept between decoding calls so that the type names declared
+	 * by previous metadata chunks remain known to the lexer.
+	 */
+	struct ctf_scanner *scanner;
 	uint8_t uuid[16];
 	bool is_uuid_set;
 	int bo;
@@ -402,6 +408,10 @@ void ctf_metadata_decoder_destroy(struct ctf_metadata_decoder *mdec)
 	}
 
 	BT_LOGD("Destroying CTF metadata decoder: addr=%p", mdec);
+	if (mdec->scanner) {
+		ctf_scanner_free(mdec->scanner);
+	}
+
 	ctf_visitor_generate_ir_destroy(mdec->visitor);
 	g_free(mdec);
 }
@@ -413,7 +423,6 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_decode(
 	enum ctf_metadata_decoder_status status =
 		CTF_METADATA_DECODER_STATUS_OK;
 	int ret;
-	struct ctf_scanner *scanner = NULL;
 	char *buf = NULL;
 	bool close_fp = false;
 
@@ -444,7 +453,11 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_decode(
 			status = CTF_METADATA_DECODER_STATUS_ERROR;
 			goto end;
 		}
-	} else {
+	} else if (!mdec->scanner) {
+		/*
+		 * Plain text metadata: only its first chunk begins with
+		 * the version signature.
+		 */
 		unsigned int major, minor;
 		ssize_t nr_items;
 		const long init_pos = ftell(fp);
@@ -486,25 +499,50 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_decode(
 		yydebug = 1;
 	}
 
-	/* Allocate a scanner and append the metadata text content */
-	scanner = ctf_scanner_alloc();
-	if (!scanner) {
-		BT_LOGE("Cannot allocate a metadata lexical scanner: "
-			"mdec-addr=%p", mdec);
-		status = CTF_METADATA_DECODER_STATUS_ERROR;
-		goto end;
+	/*
+	 * Only parse the new chunk: the AST of the previous chunks was
+	 * already visited, and the IR visitor adds the new objects to
+	 * the existing trace.
+	 */
+	if (!mdec->scanner) {
+		mdec->scanner = ctf_scanner_alloc();
+		if (!mdec->scanner) {
+			BT_LOGE("Cannot allocate a metadata lexical scanner: "
+				"mdec-addr=%p", mdec);
+			status = CTF_METADATA_DECODER_STATUS_ERROR;
+			goto end;
+		}
+	} else {
+		ret = ctf_scanner_reset_ast(mdec->scanner);
+		if (ret) {
+			BT_LOGE("Cannot reset the metadata AST: "
+				"mdec-addr=%p, ret=%d", mdec, ret);
+			status = CTF_METADATA_DECODER_STATUS_ERROR;
+			goto end;
+		}
 	}
 
 	assert(fp);
-	ret = ctf_scanner_append_ast(scanner, fp);
+	ret = ctf_scanner_append_ast(mdec->scanner, fp);
 	if (ret) {
-		BT_LOGE("Cannot create the metadata AST out of the metadata text: "
-			"mdec-addr=%p", mdec);
-		status = CTF_METADATA_DECODER_STATUS_INCOMPLETE;
+		/*
+		 * Only a parser which stopped at the end of the text
+		 * could succeed with more text.
+		 */
+		if (mdec->scanner->at_eof) {
+			BT_LOGD("Metadata text ends within a block: incomplete data: "
+				"mdec-addr=%p", mdec);
+			status = CTF_METADATA_DECODER_STATUS_INCOMPLETE;
+		} else {
+			BT_LOGE("Cannot create the metadata AST out of the metadata text: "
+				"mdec-addr=%p", mdec);
+			status = CTF_METADATA_DECODER_STATUS_ERROR;
+		}
+
 		goto end;
 	}
 
-	ret = ctf_visitor_semantic_check(0, &scanner->ast->root);
+	ret = ctf_visitor_semantic_check(0, &mdec->scanner->ast->root);
 	if (ret) {
 		BT_LOGE("Validation of the metadata semantics failed: "
 			"mdec-addr=%p", mdec);
@@ -513,7 +551,7 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_decode(
 	}
 
 	ret = ctf_visitor_generate_ir_visit_node(mdec->visitor,
-		&scanner->ast->root);
+		&mdec->scanner->ast->root);
 	switch (ret) {
 	case 0:
 		/* Success */
@@ -531,10 +569,6 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_decode(
 	}
 
 end:
-	if (scanner) {
-		ctf_scanner_free(scanner);
-	}
-
 	yydebug = 0;
 
 	if (fp && close_fp) {
@@ -68,9 +68,13 @@ void ctf_metadata_decoder_destroy(
  *
  * The metadata can be packetized or not.
  *
+ * Only the new chunk is parsed: the type names and type aliases which
+ * previous chunks declared remain available to it.
+ *
  * The metadata chunk needs to be complete and scannable, that is,
- * zero or more complete top-level blocks. If it's incomplete, this
- * function returns `CTF_METADATA_DECODER_STATUS_INCOMPLETE`. If this
+ * zero or more complete top-level blocks. If it's incomplete, even
+ * within a token like a string literal or a comment, this function
+ * returns `CTF_METADATA_DECODER_STATUS_INCOMPLETE`. If this
  * function returns `CTF_METADATA_DECODER_STATUS_INCOMPLETE`, then you
  * need to call it again with the same metadata and more to make it
  * complete. For example:
@@ -78,6 +82,10 @@ void ctf_metadata_decoder_destroy(
  *     First call:  event { name = hell
  *     Second call: event { name = hello_world; ... };
  *
+ * If the metadata text is invalid before its end, more metadata cannot
+ * make it valid: this function returns
+ * `CTF_METADATA_DECODER_STATUS_ERROR`.
+ *
  * If the conversion from the metadata text to CTF IR objects fails,
  * this function returns `CTF_METADATA_DECODER_STATUS_IR_VISITOR_ERROR`.
  *
@@ -304,7 +304,7 @@ static void init_scope(struct ctf_scanner_scope *scope,
 {
 	scope->parent = parent;
 	scope->types = g_hash_table_new_full(g_str_hash, g_str_equal,
-					     NULL, NULL);
+					     g_free, NULL);
 }
 
 static void finalize_scope(struct ctf_scanner_scope *scope)
@@ -362,11 +362,19 @@ int is_type(struct ctf_scanner *scanner, const char *id)
 
 static void add_type(struct ctf_scanner *scanner, char *id)
 {
+	char *id_copy;
+
 	BT_LOGV("Adding type: scanner-addr=%p, id=\"%s\"",
 		scanner, id);
 	if (lookup_type(scanner->cs, id))
 		return;
-	g_hash_table_insert(scanner->cs->types, id, id);
+
+	/*
+	 * The scope owns a copy of the name, as the root scope outlives
+	 * the object stack of the AST which declares it.
+	 */
+	id_copy = g_strdup(id);
+	g_hash_table_insert(scanner->cs->types, id_copy, id_copy);
 }
 
 static struct ctf_node *make_node(struct ctf_scanner *scanner,
@@ -979,9 +987,39 @@ static struct ctf_ast *ctf_ast_alloc(struct ctf_scanner *scanner)
 	return ast;
 }
 
+int ctf_scanner_reset_ast(struct ctf_scanner *scanner)
+{
+	struct objstack *objstack;
+	struct ctf_ast *ast;
+
+	/*
+	 * A previous parse can stop within a nested scope: go back to
+	 * the root scope, which keeps the type names declared so far.
+	 */
+	while (scanner->cs != &scanner->root_scope)
+		pop_scope(scanner);
+
+	/*
+	 * The previous AST was already visited: free its nodes and
+	 * strings instead of growing the object stack with each chunk.
+	 */
+	objstack = objstack_create();
+	if (!objstack)
+		return -ENOMEM;
+	objstack_destroy(scanner->objstack);
+	scanner->objstack = objstack;
+	scanner->ast = NULL;
+	ast = ctf_ast_alloc(scanner);
+	if (!ast)
+		return -ENOMEM;
+	scanner->ast = ast;
+	return 0;
+}
+
 int ctf_scanner_append_ast(struct ctf_scanner *scanner, FILE *input)
 {
 	/* Start processing new stream */
+	scanner->at_eof = false;
 	yyrestart(input, scanner->scanner);
 	return yyparse(scanner, scanner->scanner);
 }
@@ -18,6 +18,7 @@
  */
 
 #include <stdio.h>
+#include <stdbool.h>
 #include "ast.h"
 
 #ifndef YY_TYPEDEF_YY_SCANNER_T
@@ -37,12 +38,29 @@ struct ctf_scanner {
 	struct ctf_scanner_scope root_scope;
 	struct ctf_scanner_scope *cs;
 	struct objstack *objstack;
+
+	/*
+	 * True if the lexer reached the end of the input of the last
+	 * ctf_scanner_append_ast() call.
+	 */
+	bool at_eof;
 };
 
 struct ctf_scanner *ctf_scanner_alloc(void);
 void ctf_scanner_free(struct ctf_scanner *scanner);
 int ctf_scanner_append_ast(struct ctf_scanner *scanner, FILE *input);
 
+/*
+ * Replaces the scanner's AST with an empty one, keeping the type names
+ * of its root scope, so that the next ctf_scanner_append_ast() call
+ * only produces the nodes of the new metadata fragment.
+ *
+ * This frees the nodes and strings of the previous AST: the memory of
+ * a scanner which decodes metadata chunks is bounded by the largest
+ * chunk, plus the type names of its root scope.
+ */
+int ctf_scanner_reset_ast(struct ctf_scanner *scanner);
+
 static inline
 struct ctf_ast *ctf_scanner_get_ast(struct ctf_scanner *scanner)
 {
@@ -36,6 +36,7 @@
 #include <babeltrace/babeltrace.h>
 #include <babeltrace/ctf-ir/field-types-internal.h>
 #include <babeltrace/ctf-ir/field-path-internal.h>
+#include <babeltrace/align-internal.h>
 #include <glib.h>
 #include <stdlib.h>
 
@@ -55,7 +56,8 @@ struct stack_entry {
 	 *   * sequence
 	 *   * variant
 	 *
-	 * Field is owned by this.
+	 * Weak: the root field is owned by the current dynamic scope,
+	 * and each other base field is owned by its parent field.
 	 */
 	struct bt_field *base;
 
@@ -63,10 +65,19 @@ struct stack_entry {
 	size_t index;
 };
 
-/* Visit stack */
+/*
+ * Visit stack.
+ *
+ * Entries are never freed when popped: the array only grows to the
+ * maximum depth of the decoded fields, so that pushing and popping
+ * entries does not allocate anything once this depth is reached.
+ */
 struct stack {
-	/* Entries (struct stack_entry *) (top is last element) */
-	GPtrArray *entries;
+	/* Entries (struct stack_entry) (top is at index size - 1) */
+	GArray *entries;
+
+	/* Number of entries in the stack */
+	size_t size;
 };
 
 /* State */
@@ -91,6 +102,7 @@ enum state {
 	STATE_EMIT_NOTIF_EVENT,
 	STATE_EMIT_NOTIF_END_OF_PACKET,
 	STATE_SKIP_PACKET_PADDING,
+	STATE_SKIP_EVENT_FIELDS,
 };
 
 struct trace_field_path_cache {
@@ -120,6 +132,31 @@ struct stream_class_field_path_cache {
 	int content_size;
 };
 
+/*
+ * Part of the fields following the event header of an event of a
+ * rejected class: `size` bits, starting at a position aligned to
+ * `alignment` bits, without any inner padding.
+ */
+struct event_skip_chunk {
+	uint64_t alignment;
+	uint64_t size;
+};
+
+/* How to handle the events of a given class */
+struct event_class_filter_entry {
+	/* True if the events of this class are emitted */
+	bool accepted;
+
+	/*
+	 * Array of struct event_skip_chunk: layout of the stream event
+	 * context, event context, and event payload fields of a
+	 * rejected event class, or NULL if those fields do not have a
+	 * fixed layout (in which case they are decoded, but the event
+	 * is not emitted).
+	 */
+	GArray *skip_chunks;
+};
+
 struct field_cb_override {
 	enum bt_btr_status (* func)(void *value,
 			struct bt_field_type *type, void *data);
@@ -153,12 +190,28 @@ struct bt_notif_iter {
 	/* Current stream (NULL if not set yet) */
 	struct bt_stream *stream;
 
+	/*
+	 * Current event (NULL if not created yet).
+	 *
+	 * This is created as soon as the event class is known, so that
+	 * the stream event context, event context, and event payload
+	 * fields are decoded directly into the event's own (possibly
+	 * recycled) fields.
+	 */
+	struct bt_event *event;
+
 	/*
 	 * Current timestamp_end field (to consider before switching packets).
 	 */
 	struct bt_field *cur_timestamp_end;
 
-	/* Database of current dynamic scopes (owned by this) */
+	/*
+	 * Database of current dynamic scopes (owned by this).
+	 *
+	 * When a dynamic scope field is already set when its decoding
+	 * begins, btr_compound_begin_cb() decodes into it instead of
+	 * creating a new field.
+	 */
 	struct {
 		struct bt_field *trace_packet_header;
 		struct bt_field *stream_packet_context;
@@ -243,6 +296,24 @@ struct bt_notif_iter {
 
 	/* bt_stream_class to struct stream_class_field_path_cache. */
 	GHashTable *sc_field_path_caches;
+
+	/*
+	 * Names (gchar *) of the event classes of which to emit the
+	 * events, or NULL to emit all the events.
+	 */
+	GHashTable *event_names;
+
+	/* bt_event_class to struct event_class_filter_entry. */
+	GHashTable *event_class_filter;
+
+	/* True if the current event is decoded, but not emitted */
+	bool cur_event_rejected;
+
+	/*
+	 * Position, within the current packet, of the end of the
+	 * current rejected event being skipped (bits).
+	 */
+	size_t skip_event_end;
 };
 
 static inline
@@ -289,6 +360,8 @@ const char *state_string(enum state state)
 		return "STATE_EMIT_NOTIF_END_OF_PACKET";
 	case STATE_SKIP_PACKET_PADDING:
 		return "STATE_SKIP_PACKET_PADDING";
+	case STATE_SKIP_EVENT_FIELDS:
+		return "STATE_SKIP_EVENT_FIELDS";
 	default:
 		return "(unknown)";
 	}
@@ -301,15 +374,6 @@ static
 enum bt_btr_status btr_timestamp_end_cb(void *value,
 		struct bt_field_type *type, void *data);
 
-static
-void stack_entry_free_func(gpointer data)
-{
-	struct stack_entry *entry = data;
-
-	bt_put(entry->base);
-	g_free(entry);
-}
-
 static
 struct stack *stack_new(struct bt_notif_iter *notit)
 {
@@ -321,9 +385,10 @@ struct stack *stack_new(struct bt_notif_iter *notit)
 		goto error;
 	}
 
-	stack->entries = g_ptr_array_new_with_free_func(stack_entry_free_func);
+	stack->entries = g_array_sized_new(FALSE, TRUE,
+		sizeof(struct stack_entry), 16);
 	if (!stack->entries) {
-		BT_LOGE_STR("Failed to allocate a GPtrArray.");
+		BT_LOGE_STR("Failed to allocate a GArray.");
 		goto error;
 	}
 
@@ -340,41 +405,39 @@ void stack_destroy(struct stack *stack)
 {
 	assert(stack);
 	BT_LOGD("Destroying stack: addr=%p", stack);
-	g_ptr_array_free(stack->entries, TRUE);
+	g_array_free(stack->entries, TRUE);
 	g_free(stack);
 }
 
 static
 int stack_push(struct stack *stack, struct bt_field *base)
 {
-	int ret = 0;
 	struct stack_entry *entry;
 
 	assert(stack);
 	assert(base);
 	BT_LOGV("Pushing base field on stack: stack-addr=%p, "
-		"stack-size-before=%u, stack-size-after=%u",
-		stack, stack->entries->len, stack->entries->len + 1);
-	entry = g_new0(struct stack_entry, 1);
-	if (!entry) {
-		BT_LOGE_STR("Failed to allocate one stack entry.");
-		ret = -1;
-		goto end;
-	}
+		"stack-size-before=%zu, stack-size-after=%zu",
+		stack, stack->size, stack->size + 1);
 
-	entry->base = bt_get(base);
-	g_ptr_array_add(stack->entries, entry);
+	if (stack->size == stack->entries->len) {
+		g_array_set_size(stack->entries, stack->size + 1);
+	}
 
-end:
-	return ret;
+	entry = &g_array_index(stack->entries, struct stack_entry,
+		stack->size);
+	entry->base = base;
+	entry->index = 0;
+	stack->size++;
+	return 0;
 }
 
 static inline
-unsigned int stack_size(struct stack *stack)
+size_t stack_size(struct stack *stack)
 {
 	assert(stack);
 
-	return stack->entries->len;
+	return stack->size;
 }
 
 static
@@ -383,9 +446,9 @@ void stack_pop(struct stack *stack)
 	assert(stack);
 	assert(stack_size(stack));
 	BT_LOGV("Popping from stack: "
-		"stack-addr=%p, stack-size-before=%u, stack-size-after=%u",
-		stack, stack->entries->len, stack->entries->len - 1);
-	g_ptr_array_remove_index(stack->entries, stack->entries->len - 1);
+		"stack-addr=%p, stack-size-before=%zu, stack-size-after=%zu",
+		stack, stack->size, stack->size - 1);
+	stack->size--;
 }
 
 static inline
@@ -394,7 +457,8 @@ struct stack_entry *stack_top(struct stack *stack)
 	assert(stack);
 	assert(stack_size(stack));
 
-	return g_ptr_array_index(stack->entries, stack->entries->len - 1);
+	return &g_array_index(stack->entries, struct stack_entry,
+		stack->size - 1);
 }
 
 static inline
@@ -409,9 +473,9 @@ void stack_clear(struct stack *stack)
 	assert(stack);
 
 	if (!stack_empty(stack)) {
-		BT_LOGV("Clearing stack: stack-addr=%p, stack-size=%u",
-			stack, stack->entries->len);
-		g_ptr_array_remove_range(stack->entries, 0, stack_size(stack));
+		BT_LOGV("Clearing stack: stack-addr=%p, stack-size=%zu",
+			stack, stack->size);
+		stack->size = 0;
 	}
 
 	assert(stack_empty(stack));
@@ -556,7 +620,6 @@ enum bt_notif_iter_status read_dscope_begin_state(
 	enum bt_btr_status btr_status;
 	size_t consumed_bits;
 
-	bt_put(*dscope_field);
 	notit->cur_dscope_field = dscope_field;
 	BT_LOGV("Starting BTR: notit-addr=%p, btr-addr=%p, ft-addr=%p",
 		notit, notit->btr, dscope_field_type);
@@ -646,10 +709,8 @@ end:
 }
 
 static
-void put_event_dscopes(struct bt_notif_iter *notit)
+void put_event_fields(struct bt_notif_iter *notit)
 {
-	BT_LOGV_STR("Putting event header field.");
-	BT_PUT(notit->dscopes.stream_event_header);
 	BT_LOGV_STR("Putting stream event context field.");
 	BT_PUT(notit->dscopes.stream_event_context);
 	BT_LOGV_STR("Putting event context field.");
@@ -658,6 +719,16 @@ void put_event_dscopes(struct bt_notif_iter *notit)
 	BT_PUT(notit->dscopes.event_payload);
 }
 
+static
+void put_event_dscopes(struct bt_notif_iter *notit)
+{
+	BT_LOGV_STR("Putting event header field.");
+	BT_PUT(notit->dscopes.stream_event_header);
+	put_event_fields(notit);
+	BT_LOGV_STR("Putting current event.");
+	BT_PUT(notit->event);
+}
+
 static
 void put_all_dscopes(struct bt_notif_iter *notit)
 {
@@ -668,6 +739,27 @@ void put_all_dscopes(struct bt_notif_iter *notit)
 	put_event_dscopes(notit);
 }
 
+/*
+ * Prepares the event header field to decode the next event header: the
+ * previous event's header field is moved into its event by
+ * create_event(), which gives back the event's (recycled) header field
+ * to reuse.
+ */
+static
+void reset_event_header_dscope(struct bt_notif_iter *notit)
+{
+	if (!notit->dscopes.stream_event_header) {
+		return;
+	}
+
+	if (bt_field_reset(notit->dscopes.stream_event_header)) {
+		BT_LOGV("Cannot reset event header field: putting it: "
+			"notit-addr=%p, field-addr=%p", notit,
+			notit->dscopes.stream_event_header);
+		BT_PUT(notit->dscopes.stream_event_header);
+	}
+}
+
 static
 enum bt_notif_iter_status read_packet_header_begin_state(
 		struct bt_notif_iter *notit)
@@ -1186,6 +1278,10 @@ enum bt_notif_iter_status read_event_header_begin_state(
 	/* Reset the position of the last event header */
 	notit->buf.last_eh_at = notit->buf.at;
 
+	/* Drop the previous event if it was not emitted */
+	BT_PUT(notit->event);
+	put_event_fields(notit);
+
 	/* Check if we have some content left */
 	if (notit->cur_content_size >= 0) {
 		if (packet_at(notit) == notit->cur_content_size) {
@@ -1212,7 +1308,7 @@ enum bt_notif_iter_status read_event_header_begin_state(
 		goto end;
 	}
 
-	put_event_dscopes(notit);
+	reset_event_header_dscope(notit);
 	BT_LOGV("Decoding event header field: "
 		"notit-addr=%p, stream-class-addr=%p, "
 		"stream-class-name=\"%s\", stream-class-id=%" PRId64 ", "
@@ -1409,6 +1505,268 @@ end:
 	return status;
 }
 
+static
+enum bt_notif_iter_status set_current_event(struct bt_notif_iter *notit)
+{
+	enum bt_notif_iter_status status = BT_NOTIF_ITER_STATUS_OK;
+
+	/*
+	 * bt_event_create() reuses an event of this class which was
+	 * released since, if any: its fields are reset and can be
+	 * decoded into directly, so that decoding an event does not
+	 * allocate anything in the steady state.
+	 */
+	assert(!notit->event);
+	notit->event = bt_event_create(notit->meta.event_class);
+	if (!notit->event) {
+		BT_LOGE("Cannot create event: "
+			"notit-addr=%p, event-class-addr=%p, "
+			"event-class-name=\"%s\", "
+			"event-class-id=%" PRId64,
+			notit, notit->meta.event_class,
+			bt_event_class_get_name(notit->meta.event_class),
+			bt_event_class_get_id(notit->meta.event_class));
+		status = BT_NOTIF_ITER_STATUS_ERROR;
+		goto end;
+	}
+
+	BT_LOGV("Created current event: notit-addr=%p, event-addr=%p, "
+		"event-class-addr=%p, event-class-name=\"%s\", "
+		"event-class-id=%" PRId64,
+		notit, notit->event, notit->meta.event_class,
+		bt_event_class_get_name(notit->meta.event_class),
+		bt_event_class_get_id(notit->meta.event_class));
+	assert(!notit->dscopes.stream_event_context);
+	assert(!notit->dscopes.event_context);
+	assert(!notit->dscopes.event_payload);
+	notit->dscopes.stream_event_context =
+		bt_event_get_stream_event_context(notit->event);
+	notit->dscopes.event_context =
+		bt_event_get_event_context(notit->event);
+	notit->dscopes.event_payload =
+		bt_event_get_event_payload(notit->event);
+
+end:
+	return status;
+}
+
+static
+void add_event_skip_chunk(GArray *chunks, uint64_t alignment, uint64_t size)
+{
+	struct event_skip_chunk *last = NULL;
+
+	if (chunks->len > 0) {
+		last = &g_array_index(chunks, struct event_skip_chunk,
+			chunks->len - 1);
+	}
+
+	/*
+	 * The last chunk starts at a position aligned to its alignment,
+	 * so the new field immediately follows it if its own alignment
+	 * divides both the last chunk's alignment and size.
+	 */
+	if (last && last->alignment % alignment == 0 &&
+			last->size % alignment == 0) {
+		last->size += size;
+	} else {
+		struct event_skip_chunk chunk = {
+			.alignment = alignment,
+			.size = size,
+		};
+
+		g_array_append_val(chunks, chunk);
+	}
+}
+
+/*
+ * Appends the layout of a field of type `ft` to `chunks`. Returns -1
+ * if this field does not have a fixed layout, or if it contains an
+ * integer field mapped to a clock class (its value is needed to update
+ * the clock states).
+ */
+static
+int add_event_skip_chunks(GArray *chunks, struct bt_field_type *ft)
+{
+	int ret = 0;
+	int alignment = bt_field_type_get_alignment(ft);
+	struct bt_field_type *child_ft = NULL;
+	struct bt_clock_class *clock_class = NULL;
+	int64_t i;
+
+	assert(alignment > 0);
+
+	switch (bt_field_type_get_type_id(ft)) {
+	case BT_FIELD_TYPE_ID_INTEGER:
+		clock_class = bt_field_type_integer_get_mapped_clock_class(ft);
+		if (clock_class) {
+			goto error;
+		}
+
+		add_event_skip_chunk(chunks, alignment,
+			bt_field_type_integer_get_size(ft));
+		break;
+	case BT_FIELD_TYPE_ID_ENUM:
+		child_ft = bt_field_type_enumeration_get_container_type(ft);
+		assert(child_ft);
+		ret = add_event_skip_chunks(chunks, child_ft);
+		break;
+	case BT_FIELD_TYPE_ID_FLOAT:
+		add_event_skip_chunk(chunks, alignment,
+			bt_field_type_floating_point_get_exponent_digits(ft) +
+			bt_field_type_floating_point_get_mantissa_digits(ft));
+		break;
+	case BT_FIELD_TYPE_ID_STRUCT:
+	{
+		int64_t count = bt_field_type_structure_get_field_count(ft);
+
+		assert(count >= 0);
+		add_event_skip_chunk(chunks, alignment, 0);
+
+		for (i = 0; i < count; i++) {
+			ret = bt_field_type_structure_get_field_by_index(ft,
+				NULL, &child_ft, i);
+			assert(ret == 0);
+			ret = add_event_skip_chunks(chunks, child_ft);
+			BT_PUT(child_ft);
+			if (ret) {
+				goto end;
+			}
+		}
+
+		break;
+	}
+	case BT_FIELD_TYPE_ID_ARRAY:
+	{
+		int64_t length = bt_field_type_array_get_length(ft);
+
+		assert(length >= 0);
+		child_ft = bt_field_type_array_get_element_type(ft);
+		assert(child_ft);
+		add_event_skip_chunk(chunks, alignment, 0);
+
+		for (i = 0; i < length; i++) {
+			ret = add_event_skip_chunks(chunks, child_ft);
+			if (ret) {
+				goto end;
+			}
+		}
+
+		break;
+	}
+	default:
+		/* String, sequence, or variant: no fixed layout */
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	bt_put(child_ft);
+	bt_put(clock_class);
+	return ret;
+}
+
+static
+void destroy_event_class_filter_entry(
+		struct event_class_filter_entry *entry)
+{
+	if (!entry) {
+		return;
+	}
+
+	if (entry->skip_chunks) {
+		g_array_free(entry->skip_chunks, TRUE);
+	}
+
+	g_free(entry);
+}
+
+/*
+ * Creates the skip layout of the fields following the event header of
+ * the events of the current event class.
+ */
+static
+GArray *create_event_skip_chunks(struct bt_notif_iter *notit)
+{
+	int ret = 0;
+	GArray *chunks;
+	struct bt_field_type *scope_fts[3];
+	size_t i;
+
+	chunks = g_array_new(FALSE, FALSE, sizeof(struct event_skip_chunk));
+	if (!chunks) {
+		BT_LOGE_STR("Failed to allocate a GArray.");
+		goto end;
+	}
+
+	scope_fts[0] = bt_stream_class_get_event_context_type(
+		notit->meta.stream_class);
+	scope_fts[1] = bt_event_class_get_context_type(
+		notit->meta.event_class);
+	scope_fts[2] = bt_event_class_get_payload_type(
+		notit->meta.event_class);
+
+	for (i = 0; i < 3; i++) {
+		if (ret == 0 && scope_fts[i]) {
+			ret = add_event_skip_chunks(chunks, scope_fts[i]);
+		}
+
+		bt_put(scope_fts[i]);
+	}
+
+	if (ret) {
+		g_array_free(chunks, TRUE);
+		chunks = NULL;
+	}
+
+end:
+	return chunks;
+}
+
+static
+struct event_class_filter_entry *get_event_class_filter_entry(
+		struct bt_notif_iter *notit)
+{
+	struct event_class_filter_entry *entry;
+	const char *name;
+
+	entry = g_hash_table_lookup(notit->event_class_filter,
+		notit->meta.event_class);
+	if (entry) {
+		goto end;
+	}
+
+	entry = g_new0(struct event_class_filter_entry, 1);
+	if (!entry) {
+		BT_LOGE_STR("Failed to allocate one event class filter entry.");
+		goto end;
+	}
+
+	name = bt_event_class_get_name(notit->meta.event_class);
+	entry->accepted = name &&
+		g_hash_table_lookup_extended(notit->event_names, name,
+			NULL, NULL);
+	if (!entry->accepted) {
+		entry->skip_chunks = create_event_skip_chunks(notit);
+	}
+
+	BT_LOGD("Created event class filter entry: notit-addr=%p, "
+		"event-class-addr=%p, event-class-name=\"%s\", "
+		"event-class-id=%" PRId64 ", accepted=%d, "
+		"skip-fixed-layout=%d",
+		notit, notit->meta.event_class, name,
+		bt_event_class_get_id(notit->meta.event_class),
+		entry->accepted, entry->skip_chunks != NULL);
+	g_hash_table_insert(notit->event_class_filter,
+		bt_get(notit->meta.event_class), entry);
+
+end:
+	return entry;
+}
+
 static
 enum bt_notif_iter_status after_event_header_state(
 		struct bt_notif_iter *notit)
@@ -1420,6 +1778,56 @@ enum bt_notif_iter_status after_event_header_state(
 		goto end;
 	}
 
+	notit->cur_event_rejected = false;
+
+	if (notit->event_names) {
+		struct event_class_filter_entry *entry =
+			get_event_class_filter_entry(notit);
+
+		if (!entry) {
+			status = BT_NOTIF_ITER_STATUS_ERROR;
+			goto end;
+		}
+
+		if (!entry->accepted && entry->skip_chunks) {
+			/*
+			 * Skip the remaining fields of this event
+			 * without creating any field.
+			 */
+			size_t at = packet_at(notit);
+			guint i;
+
+			for (i = 0; i < entry->skip_chunks->len; i++) {
+				struct event_skip_chunk *chunk =
+					&g_array_index(entry->skip_chunks,
+						struct event_skip_chunk, i);
+
+				at = ALIGN(at, chunk->alignment) + chunk->size;
+			}
+
+			if (notit->cur_content_size >= 0 &&
+					at > notit->cur_content_size) {
+				BT_LOGW("Rejected event's fields exceed the packet's content: "
+					"notit-addr=%p, content-size=%" PRId64 ", "
+					"event-end=%zu",
+					notit, notit->cur_content_size, at);
+				status = BT_NOTIF_ITER_STATUS_ERROR;
+				goto end;
+			}
+
+			notit->skip_event_end = at;
+			notit->state = STATE_SKIP_EVENT_FIELDS;
+			goto end;
+		}
+
+		notit->cur_event_rejected = !entry->accepted;
+	}
+
+	status = set_current_event(notit);
+	if (status != BT_NOTIF_ITER_STATUS_OK) {
+		goto end;
+	}
+
 	notit->state = STATE_DSCOPE_STREAM_EVENT_CONTEXT_BEGIN;
 
 end:
@@ -1615,6 +2023,38 @@ end:
 	return status;
 }
 
+static
+enum bt_notif_iter_status skip_event_fields_state(
+		struct bt_notif_iter *notit)
+{
+	enum bt_notif_iter_status status = BT_NOTIF_ITER_STATUS_OK;
+	size_t bits_to_skip;
+
+	assert(notit->skip_event_end >= packet_at(notit));
+	bits_to_skip = notit->skip_event_end - packet_at(notit);
+	if (bits_to_skip > 0) {
+		size_t bits_to_consume;
+
+		status = buf_ensure_available_bits(notit);
+		if (status != BT_NOTIF_ITER_STATUS_OK) {
+			goto end;
+		}
+
+		bits_to_consume = MIN(buf_available_bits(notit), bits_to_skip);
+		BT_LOGV("Skipping %zu bits of rejected event: notit-addr=%p",
+			bits_to_consume, notit);
+		buf_consume_bits(notit, bits_to_consume);
+		bits_to_skip -= bits_to_consume;
+	}
+
+	if (bits_to_skip == 0) {
+		notit->state = STATE_DSCOPE_STREAM_EVENT_HEADER_BEGIN;
+	}
+
+end:
+	return status;
+}
+
 static inline
 enum bt_notif_iter_status handle_state(struct bt_notif_iter *notit)
 {
@@ -1683,6 +2123,9 @@ enum bt_notif_iter_status handle_state(struct bt_notif_iter *notit)
 	case STATE_SKIP_PACKET_PADDING:
 		status = skip_packet_padding_state(notit);
 		break;
+	case STATE_SKIP_EVENT_FIELDS:
+		status = skip_event_fields_state(notit);
+		break;
 	case STATE_EMIT_NOTIF_END_OF_PACKET:
 		notit->state = STATE_SKIP_PACKET_PADDING;
 		break;
@@ -1719,6 +2162,7 @@ void bt_notif_iter_reset(struct bt_notif_iter *notit)
 	notit->buf.last_eh_at = SIZE_MAX;
 	notit->buf.packet_offset = 0;
 	notit->state = STATE_INIT;
+	notit->cur_event_rejected = false;
 	notit->cur_content_size = -1;
 	notit->cur_packet_size = -1;
 	notit->cur_packet_offset = -1;
@@ -2222,6 +2666,61 @@ end:
 	return status;
 }
 
+static
+enum bt_btr_status btr_whole_string_cb(const char *value,
+		size_t len, struct bt_field_type *type, void *data)
+{
+	enum bt_btr_status status = BT_BTR_STATUS_OK;
+	struct bt_field *field = NULL;
+	struct bt_notif_iter *notit = data;
+	void *buf_owner = NULL;
+	int ret;
+
+	BT_LOGV("Whole string function called from BTR: "
+		"notit-addr=%p, btr-addr=%p, ft-addr=%p, "
+		"ft-id=%s, string-length=%zu",
+		notit, notit->btr, type,
+		bt_field_type_id_string(
+			bt_field_type_get_type_id(type)),
+		len);
+
+	/* Create next field */
+	field = get_next_field(notit);
+	if (!field) {
+		BT_LOGW("Cannot get next field: notit-addr=%p", notit);
+		status = BT_BTR_STATUS_ERROR;
+		goto end;
+	}
+
+	if (notit->medium.medops.borrow_buffer_owner) {
+		buf_owner = notit->medium.medops.borrow_buffer_owner(
+			notit->medium.data);
+	}
+
+	if (buf_owner) {
+		/* Reference the medium's bytes */
+		ret = bt_field_string_set_external_value(field, value,
+			buf_owner);
+	} else {
+		ret = bt_field_string_set_value(field, value);
+	}
+
+	if (ret) {
+		BT_LOGE("Cannot set string field's value: "
+			"notit-addr=%p, field-addr=%p, string-length=%zu, "
+			"ret=%d", notit, field, len, ret);
+		status = BT_BTR_STATUS_ERROR;
+		goto end;
+	}
+
+	/* Go to next field */
+	stack_top(notit->stack)->index++;
+
+end:
+	BT_PUT(field);
+	return status;
+}
+
 static
 enum bt_btr_status btr_string_end_cb(
 		struct bt_field_type *type, void *data)
@@ -2260,15 +2759,30 @@ enum bt_btr_status btr_compound_begin_cb(
 
 	/* Create field */
 	if (stack_empty(notit->stack)) {
-		/* Root: create dynamic scope field */
-		*notit->cur_dscope_field = bt_field_create(type);
+		/*
+		 * Root: reuse the current dynamic scope field if it has
+		 * the right type, otherwise create it.
+		 */
+		if (*notit->cur_dscope_field) {
+			struct bt_field_type *cur_type =
+				bt_field_get_type(*notit->cur_dscope_field);
+
+			bt_put(cur_type);
+			if (cur_type != type) {
+				BT_PUT(*notit->cur_dscope_field);
+			}
+		}
+
+		if (!*notit->cur_dscope_field) {
+			*notit->cur_dscope_field = bt_field_create(type);
+		}
+
 		field = *notit->cur_dscope_field;
 
 		/*
-		 * Field will be put at the end of this function
-		 * (stack_push() will take one reference, but this
-		 * reference is lost upon the equivalent stack_pop()
-		 * later), so also get it for our context to own it.
+		 * Field will be put at the end of this function, but
+		 * the current dynamic scope field owns it (the stack
+		 * only borrows it), so get it here.
 		 */
 		bt_get(*notit->cur_dscope_field);
 
@@ -2334,6 +2848,50 @@ enum bt_btr_status btr_compound_end_cb(
 	return BT_BTR_STATUS_OK;
 }
 
+static
+enum bt_btr_status btr_packed_elements_cb(const void *elements,
+		uint64_t count, struct bt_field_type *type, void *data)
+{
+	struct bt_notif_iter *notit = data;
+	struct bt_field *field;
+	enum bt_btr_status status = BT_BTR_STATUS_OK;
+	int ret;
+
+	BT_LOGV("Packed elements function called from BTR: "
+		"notit-addr=%p, btr-addr=%p, ft-addr=%p, "
+		"ft-id=%s, count=%" PRIu64,
+		notit, notit->btr, type,
+		bt_field_type_id_string(
+			bt_field_type_get_type_id(type)),
+		count);
+	assert(!stack_empty(notit->stack));
+	field = stack_top(notit->stack)->base;
+	assert(field);
+
+	if (bt_field_type_get_type_id(type) == BT_FIELD_TYPE_ID_ARRAY) {
+		ret = bt_field_array_set_packed_elements(field, elements,
+			count);
+	} else {
+		assert(bt_field_type_get_type_id(type) ==
+			BT_FIELD_TYPE_ID_SEQUENCE);
+		ret = bt_field_sequence_set_packed_elements(field, elements,
+			count);
+	}
+
+	if (ret) {
+		BT_LOGE("Cannot set packed elements of field: "
+			"notit-addr=%p, field-addr=%p, count=%" PRIu64
+			", ret=%d", notit, field, count, ret);
+		status = BT_BTR_STATUS_ERROR;
+		goto end;
+	}
+
+	stack_top(notit->stack)->index = count;
+
+end:
+	return status;
+}
+
 static
 struct bt_field *resolve_field(struct bt_notif_iter *notit,
 		struct bt_field_path *path)
@@ -2530,7 +3088,7 @@ static
 int set_event_clocks(struct bt_event *event,
 		struct bt_notif_iter *notit)
 {
-	int ret;
+	int ret = 0;
 	GHashTableIter iter;
 	struct bt_clock_class *clock_class;
 	uint64_t *clock_state;
@@ -2539,21 +3097,8 @@ int set_event_clocks(struct bt_event *event,
 
 	while (g_hash_table_iter_next(&iter, (gpointer) &clock_class,
 		        (gpointer) &clock_state)) {
-		struct bt_clock_value *clock_value;
-
-		clock_value = bt_clock_value_create(clock_class,
+		ret = bt_event_set_clock_value_cycles(event, clock_class,
 			*clock_state);
-		if (!clock_value) {
-			BT_LOGE("Cannot create clock value from clock class: "
-				"notit-addr=%p, clock-class-addr=%p, "
-				"clock-class-name=\"%s\"",
-				notit, clock_class,
-				bt_clock_class_get_name(clock_class));
-			ret = -1;
-			goto end;
-		}
-		ret = bt_event_set_clock_value(event, clock_value);
-		bt_put(clock_value);
 		if (ret) {
 			struct bt_event_class *event_class =
 				bt_event_get_class(event);
@@ -2565,51 +3110,54 @@ int set_event_clocks(struct bt_event *event,
 				"event-class-id=%" PRId64 ", "
 				"clock-class-addr=%p, "
 				"clock-class-name=\"%s\", "
-				"clock-value-addr=%p",
+				"clock-value-cycles=%" PRIu64,
 				notit, event,
 				bt_event_class_get_name(event_class),
 				bt_event_class_get_id(event_class),
 				clock_class,
 				bt_clock_class_get_name(clock_class),
-				clock_value);
+				*clock_state);
 			bt_put(event_class);
 			goto end;
 		}
 	}
 
-	ret = 0;
 end:
 	return ret;
 }
 
 static
-struct bt_event *create_event(struct bt_notif_iter *notit)
+struct bt_event *complete_event(struct bt_notif_iter *notit)
 {
 	int ret;
 	struct bt_event *event;
+	struct bt_field *recycled_header = NULL;
 
-	BT_LOGV("Creating event for event notification: "
-		"notit-addr=%p, event-class-addr=%p, "
+	BT_LOGV("Completing event for event notification: "
+		"notit-addr=%p, event-addr=%p, event-class-addr=%p, "
 		"event-class-name=\"%s\", "
 		"event-class-id=%" PRId64,
-		notit, notit->meta.event_class,
+		notit, notit->event, notit->meta.event_class,
 		bt_event_class_get_name(notit->meta.event_class),
 		bt_event_class_get_id(notit->meta.event_class));
 
-	/* Create event object. */
-	event = bt_event_create(notit->meta.event_class);
-	if (!event) {
-		BT_LOGE("Cannot create event: "
-			"notit-addr=%p, event-class-addr=%p, "
-			"event-class-name=\"%s\", "
-			"event-class-id=%" PRId64,
-			notit, notit->meta.event_class,
-			bt_event_class_get_name(notit->meta.event_class),
-			bt_event_class_get_id(notit->meta.event_class));
-		goto error;
-	}
+	/* Take the current event: the caller owns it from now on. */
+	assert(notit->event);
+	event = notit->event;
+	notit->event = NULL;
 
-	/* Set header, stream event context, context, and payload fields. */
+	/*
+	 * The event header field was decoded before the event class
+	 * was known, so it is not the event's own header field: keep
+	 * the event's header field to decode the next event header.
+	 */
+	recycled_header = bt_event_get_header(event);
+
+	/*
+	 * Set header, stream event context, context, and payload
+	 * fields. The last three are usually the event's own fields
+	 * already.
+	 */
 	ret = bt_event_set_header(event,
 		notit->dscopes.stream_event_header);
 	if (ret) {
@@ -2693,12 +3241,19 @@ struct bt_event *create_event(struct bt_notif_iter *notit)
 		goto error;
 	}
 
+	/*
+	 * The event owns its fields now: put them so that the event
+	 * can be recycled as soon as its last reference is dropped.
+	 */
+	BT_MOVE(notit->dscopes.stream_event_header, recycled_header);
+	put_event_fields(notit);
 	goto end;
 
 error:
 	BT_PUT(event);
 
 end:
+	bt_put(recycled_header);
 	return event;
 }
 
@@ -2913,10 +3468,10 @@ void notify_event(struct bt_notif_iter *notit,
 		goto end;
 	}
 
-	/* Create event */
-	event = create_event(notit);
+	/* Complete current event */
+	event = complete_event(notit);
 	if (!event) {
-		BT_LOGE("Cannot create event for event notification: "
+		BT_LOGE("Cannot complete event for event notification: "
 			"notit-addr=%p", notit);
 		goto end;
 	}
@@ -2985,7 +3540,8 @@ end:
 BT_HIDDEN
 struct bt_notif_iter *bt_notif_iter_create(struct bt_trace *trace,
 		size_t max_request_sz,
-		struct bt_notif_iter_medium_ops medops, void *data)
+		struct bt_notif_iter_medium_ops medops, void *data,
+		const char * const *event_names)
 {
 	struct bt_notif_iter *notit = NULL;
 	struct bt_btr_cbs cbs = {
@@ -2996,8 +3552,10 @@ struct bt_notif_iter *bt_notif_iter_create(struct bt_trace *trace,
 			.string_begin = btr_string_begin_cb,
 			.string = btr_string_cb,
 			.string_end = btr_string_end_cb,
+			.whole_string = btr_whole_string_cb,
 			.compound_begin = btr_compound_begin_cb,
 			.compound_end = btr_compound_end_cb,
+			.packed_elements = btr_packed_elements_cb,
 		},
 		.query = {
 			.get_sequence_length = btr_get_sequence_length_cb,
@@ -3055,6 +3613,30 @@ struct bt_notif_iter *bt_notif_iter_create(struct bt_trace *trace,
 		goto error;
 	}
 
+	if (event_names) {
+		const char * const *name;
+
+		notit->event_names = g_hash_table_new_full(g_str_hash,
+			g_str_equal, g_free, NULL);
+		if (!notit->event_names) {
+			BT_LOGE_STR("Failed to allocate a GHashTable.");
+			goto error;
+		}
+
+		for (name = event_names; *name; name++) {
+			g_hash_table_insert(notit->event_names,
+				g_strdup(*name), NULL);
+		}
+
+		notit->event_class_filter = g_hash_table_new_full(
+			g_direct_hash, g_direct_equal, bt_put,
+			(GDestroyNotify) destroy_event_class_filter_entry);
+		if (!notit->event_class_filter) {
+			BT_LOGE_STR("Failed to allocate a GHashTable.");
+			goto error;
+		}
+	}
+
 	BT_LOGD("Created CTF plugin notification iterator: "
 		"trace-addr=%p, trace-name=\"%s\", max-request-size=%zu, "
 		"data=%p, notit-addr=%p",
@@ -3105,6 +3687,14 @@ void bt_notif_iter_destroy(struct bt_notif_iter *notit)
 		g_hash_table_destroy(notit->field_overrides);
 	}
 
+	if (notit->event_names) {
+		g_hash_table_destroy(notit->event_names);
+	}
+
+	if (notit->event_class_filter) {
+		g_hash_table_destroy(notit->event_class_filter);
+	}
+
 	g_free(notit);
 }
 
@@ -3147,6 +3737,11 @@ enum bt_notif_iter_status bt_notif_iter_get_next_notification(
 			}
 			goto end;
 		case STATE_EMIT_NOTIF_EVENT:
+			if (notit->cur_event_rejected) {
+				/* Decoded, but filtered out */
+				break;
+			}
+
 			/* notify_event() logs errors */
 			notify_event(notit, cc_prio_map, notification);
 			if (!*notification) {
@@ -229,6 +229,22 @@ struct bt_notif_iter_medium_ops {
 	struct bt_stream * (* get_stream)(
 			struct bt_stream_class *stream_class,
 			uint64_t stream_id, void *data);
+
+	/**
+	 * Returns the object which owns the last buffer returned by
+	 * bt_notif_iter_medium_ops::request_bytes(), that is, which
+	 * keeps this buffer valid and unchanged as long as it exists.
+	 *
+	 * This *optional* method makes the string fields reference
+	 * the bytes of this buffer, with a reference on this object,
+	 * instead of copying them. If it is not defined or if it
+	 * returns \c NULL, the string values are copied.
+	 *
+	 * @param data		User data
+	 * @returns		Buffer owner (weak reference) or
+	 *			\c NULL
+	 */
+	void * (* borrow_buffer_owner)(void *data);
 };
 
 /** CTF notification iterator. */
@@ -273,13 +289,17 @@ struct bt_notif_iter_notif_event {
  * 				at a time
  * @param medops		Medium operations
  * @param medops_data		User data (passed to medium operations)
+ * @param event_names		\c NULL-terminated array of the names of
+ *				the event classes of which to emit the
+ *				events, or \c NULL to emit all the
+ *				events
  * @returns			New CTF notification iterator on
  *				success, or \c NULL on error
  */
 BT_HIDDEN
 struct bt_notif_iter *bt_notif_iter_create(struct bt_trace *trace,
 	size_t max_request_sz, struct bt_notif_iter_medium_ops medops,
-	void *medops_data);
+	void *medops_data, const char * const *event_names);
 
 /**
  * Destroys a CTF notification iterator, freeing all internal resources.
@@ -31,6 +31,8 @@
 
 #include <babeltrace/babeltrace.h>
 #include <assert.h>
+#include <inttypes.h>
+#include <limits.h>
 #include <glib.h>
 
 #include <ctfcopytrace.h>
@@ -74,6 +76,15 @@ void destroy_stream_state_key(gpointer key)
 	g_free((enum fs_writer_stream_state *) key);
 }
 
+static
+void destroy_packet_cut(gpointer data)
+{
+	struct fs_writer_packet_cut *cut = data;
+
+	bt_put(cut->clock_class);
+	g_free(cut);
+}
+
 static
 void check_completed_trace(gpointer key, gpointer value, gpointer user_data)
 {
@@ -335,6 +346,8 @@ struct fs_writer *insert_new_writer(
 			g_direct_equal, NULL, (GDestroyNotify) unref_stream);
 	fs_writer->stream_states = g_hash_table_new_full(g_direct_hash,
 			g_direct_equal, NULL, destroy_stream_state_key);
+	fs_writer->packet_cuts = g_hash_table_new_full(g_direct_hash,
+			g_direct_equal, NULL, destroy_packet_cut);
 
 	/* Set all the existing streams in the unknown state. */
 	nr_stream = bt_trace_get_stream_count(trace);
@@ -443,6 +456,7 @@ struct bt_stream *insert_new_stream(
 	struct bt_stream *writer_stream = NULL;
 	struct bt_stream_class *writer_stream_class = NULL;
 	struct bt_ctf_writer *ctf_writer = bt_get(fs_writer->writer);
+	bool serialize_on_append;
 
 	writer_stream_class = lookup_stream_class(writer_component,
 			stream_class);
@@ -460,6 +474,45 @@ struct bt_stream *insert_new_stream(
 		bt_stream_get_name(stream));
 	assert(writer_stream);
 
+	/*
+	 * Serialize the events as they are received instead of keeping
+	 * a whole packet of events in memory. This is not possible if
+	 * the packet header or context has a variable size.
+	 */
+	serialize_on_append = !bt_stream_set_serialize_on_append(
+			writer_stream, BT_TRUE);
+	if (!serialize_on_append) {
+		BT_LOGI("Cannot serialize events on append: keeping the events until the end of each packet: "
+			"stream-name=\"%s\"", bt_stream_get_name(stream));
+	}
+
+	/* Let readers locate the packets without scanning the stream file. */
+	if (bt_stream_enable_packet_index(writer_stream)) {
+		BT_LOGW("Cannot write a packet index for stream: "
+			"stream-name=\"%s\"", bt_stream_get_name(stream));
+	}
+
+	if (writer_component->max_packet_size ||
+			writer_component->max_packet_events) {
+		struct fs_writer_packet_cut *cut;
+
+		cut = g_new0(struct fs_writer_packet_cut, 1);
+		if (!cut) {
+			BT_LOGE_STR("Failed to allocate fs_writer_packet_cut.");
+			goto error;
+		}
+
+		/* The content size is only known when serializing on append. */
+		cut->check_size = writer_component->max_packet_size &&
+			serialize_on_append;
+		if (writer_component->max_packet_size && !cut->check_size) {
+			BT_LOGW("Cannot limit the size of the packets of a stream with a variable-size packet header or context: "
+				"stream-name=\"%s\"", bt_stream_get_name(stream));
+		}
+		g_hash_table_insert(fs_writer->packet_cuts, (gpointer) stream,
+				cut);
+	}
+
 	g_hash_table_insert(fs_writer->stream_map, (gpointer) stream,
 			writer_stream);
 
@@ -504,6 +557,277 @@ end:
 	return writer_stream;
 }
 
+static
+struct fs_writer_packet_cut *lookup_packet_cut(
+		struct writer_component *writer_component,
+		struct bt_stream *stream)
+{
+	struct fs_writer *fs_writer = get_fs_writer_from_stream(
+			writer_component, stream);
+	assert(fs_writer);
+	return (struct fs_writer_packet_cut *) g_hash_table_lookup(
+			fs_writer->packet_cuts, (gpointer) stream);
+}
+
+/*
+ * Get the value of the unsigned integer field `name` of the writer
+ * stream's packet context.
+ *
+ * Return true if the field exists and is set, false otherwise.
+ */
+static
+bool get_packet_context_uint(struct bt_stream *writer_stream,
+		const char *name, uint64_t *value)
+{
+	struct bt_field *packet_context = NULL, *field = NULL;
+	bool found = false;
+
+	packet_context = bt_stream_get_packet_context(writer_stream);
+	if (!packet_context) {
+		goto end;
+	}
+
+	field = bt_field_structure_get_field_by_name(packet_context, name);
+	if (!field || !bt_field_is_integer(field) ||
+			!bt_field_is_set(field)) {
+		goto end;
+	}
+
+	if (bt_field_unsigned_integer_get_value(field, value)) {
+		goto end;
+	}
+	found = true;
+
+end:
+	bt_put(field);
+	bt_put(packet_context);
+	return found;
+}
+
+/*
+ * Set the unsigned integer field `name` of the writer stream's packet
+ * context, if it exists. The value is truncated to the field's size,
+ * as clock values are.
+ *
+ * Return 0 on success, -1 on error.
+ */
+static
+int set_packet_context_uint(struct bt_stream *writer_stream,
+		const char *name, uint64_t value)
+{
+	struct bt_field *packet_context = NULL, *field = NULL;
+	struct bt_field_type *field_type = NULL;
+	int size, ret = 0;
+
+	packet_context = bt_stream_get_packet_context(writer_stream);
+	if (!packet_context) {
+		goto end;
+	}
+
+	field = bt_field_structure_get_field_by_name(packet_context, name);
+	if (!field || !bt_field_is_integer(field)) {
+		goto end;
+	}
+
+	field_type = bt_field_get_type(field);
+	assert(field_type);
+	size = bt_field_type_integer_get_size(field_type);
+	if (size > 0 && size < 64) {
+		value &= (UINT64_C(1) << size) - 1;
+	}
+
+	ret = bt_field_unsigned_integer_set_value(field, value);
+	if (ret) {
+		BT_LOGE("Failed to set packet context field: name=\"%s\", "
+			"value=%" PRIu64, name, value);
+		ret = -1;
+	}
+
+end:
+	bt_put(field_type);
+	bt_put(field);
+	bt_put(packet_context);
+	return ret;
+}
+
+/* Clock class of the timestamps of a source packet's context. */
+static
+struct bt_clock_class *get_packet_clock_class(struct bt_packet *packet)
+{
+	struct bt_field *packet_context = NULL, *field = NULL;
+	struct bt_field_type *field_type = NULL;
+	struct bt_clock_class *clock_class = NULL;
+
+	packet_context = bt_packet_get_context(packet);
+	if (!packet_context) {
+		goto end;
+	}
+
+	field = bt_field_structure_get_field_by_name(packet_context,
+			"timestamp_end");
+	if (!field) {
+		goto end;
+	}
+
+	field_type = bt_field_get_type(field);
+	assert(field_type);
+	if (!bt_field_type_is_integer(field_type)) {
+		goto end;
+	}
+
+	clock_class = bt_field_type_integer_get_mapped_clock_class(field_type);
+
+end:
+	bt_put(field_type);
+	bt_put(field);
+	bt_put(packet_context);
+	return clock_class;
+}
+
+/*
+ * Start a new source packet: remember its timestamps, and make its
+ * sequence number account for the packets cut so far so that the
+ * output sequence numbers keep increasing.
+ */
+static
+int packet_cut_begin(struct fs_writer_packet_cut *cut,
+		struct bt_packet *packet, struct bt_stream *writer_stream)
+{
+	uint64_t seq_num;
+	int ret = 0;
+
+	cut->has_timestamp_begin = get_packet_context_uint(writer_stream,
+			"timestamp_begin", &cut->timestamp_begin);
+	cut->has_timestamp_end = get_packet_context_uint(writer_stream,
+			"timestamp_end", &cut->timestamp_end);
+	cut->has_last_event_ts = false;
+	BT_PUT(cut->clock_class);
+	cut->clock_class = get_packet_clock_class(packet);
+
+	if (cut->count > 0 && get_packet_context_uint(writer_stream,
+			"packet_seq_num", &seq_num)) {
+		ret = set_packet_context_uint(writer_stream, "packet_seq_num",
+				seq_num + cut->count);
+	}
+
+	return ret;
+}
+
+/* Return 1 if the writer stream's current packet must be cut. */
+static
+int packet_cut_needed(struct writer_component *writer_component,
+		struct fs_writer_packet_cut *cut,
+		struct bt_stream *writer_stream)
+{
+	uint64_t value;
+
+	if (writer_component->max_packet_events) {
+		if (bt_stream_get_packet_event_count(writer_stream, &value)) {
+			return -1;
+		}
+		if (value >= writer_component->max_packet_events) {
+			return 1;
+		}
+	}
+
+	if (cut->check_size) {
+		if (bt_stream_get_packet_content_size(writer_stream, &value)) {
+			return -1;
+		}
+		if (value / CHAR_BIT >= writer_component->max_packet_size) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Flush the writer stream's current packet in the middle of a source
+ * packet.
+ *
+ * The flushed packet ends, and the next one begins, at the time of
+ * the last event appended to the writer stream, when it is known.
+ * Otherwise both packets keep the source packet's timestamps.
+ */
+static
+int packet_cut(struct fs_writer_packet_cut *cut,
+		struct bt_stream *writer_stream)
+{
+	uint64_t seq_num;
+	bool has_seq_num;
+	int ret;
+
+	if (cut->has_last_event_ts) {
+		ret = set_packet_context_uint(writer_stream, "timestamp_end",
+				cut->last_event_ts);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	has_seq_num = get_packet_context_uint(writer_stream, "packet_seq_num",
+			&seq_num);
+
+	ret = bt_stream_flush(writer_stream);
+	if (ret) {
+		BT_LOGE_STR("Failed to flush stream.");
+		goto end;
+	}
+	cut->count++;
+
+	/* Flushing resets the packet context's timestamps. */
+	if (cut->has_last_event_ts) {
+		ret = set_packet_context_uint(writer_stream, "timestamp_begin",
+				cut->last_event_ts);
+	} else if (cut->has_timestamp_begin) {
+		ret = set_packet_context_uint(writer_stream, "timestamp_begin",
+				cut->timestamp_begin);
+	}
+	if (ret) {
+		goto end;
+	}
+
+	if (cut->has_timestamp_end) {
+		ret = set_packet_context_uint(writer_stream, "timestamp_end",
+				cut->timestamp_end);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	if (has_seq_num) {
+		ret = set_packet_context_uint(writer_stream, "packet_seq_num",
+				seq_num + 1);
+	}
+
+end:
+	return ret;
+}
+
+/* Remember the clock value of the event appended to the writer stream. */
+static
+void packet_cut_update_last_event_ts(struct fs_writer_packet_cut *cut,
+		struct bt_event *event)
+{
+	struct bt_clock_value *clock_value = NULL;
+
+	if (!cut->clock_class) {
+		goto end;
+	}
+
+	clock_value = bt_event_get_clock_value(event, cut->clock_class);
+	if (!clock_value) {
+		goto end;
+	}
+
+	cut->has_last_event_ts = !bt_clock_value_get_value(clock_value,
+			&cut->last_event_ts);
+
+end:
+	bt_put(clock_value);
+}
+
 BT_HIDDEN
 void writer_close(struct writer_component *writer_component,
 		struct fs_writer *fs_writer)
@@ -527,6 +851,8 @@ void writer_close(struct writer_component *writer_component,
 	g_hash_table_foreach_remove(fs_writer->stream_states,
 			empty_ht, NULL);
 	g_hash_table_destroy(fs_writer->stream_states);
+
+	g_hash_table_destroy(fs_writer->packet_cuts);
 }
 
 BT_HIDDEN
@@ -609,6 +935,7 @@ enum bt_component_status writer_stream_end(
 	*state = FS_WRITER_COMPLETED_STREAM;
 
 	g_hash_table_remove(fs_writer->stream_map, stream);
+	g_hash_table_remove(fs_writer->packet_cuts, stream);
 
 	if (fs_writer->trace_static) {
 		int trace_completed = 1;
@@ -638,6 +965,7 @@ enum bt_component_status writer_new_packet(
 		struct bt_packet *packet)
 {
 	struct bt_stream *stream = NULL, *writer_stream = NULL;
+	struct fs_writer_packet_cut *cut;
 	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
 	int int_ret;
 
@@ -649,7 +977,6 @@ enum bt_component_status writer_new_packet(
 		BT_LOGE_STR("Failed to get writer_stream.");
 		goto error;
 	}
-	BT_PUT(stream);
 
 	int_ret = ctf_stream_copy_packet_context(
 			writer_component->err, packet, writer_stream);
@@ -665,6 +992,15 @@ enum bt_component_status writer_new_packet(
 		goto error;
 	}
 
+	cut = lookup_packet_cut(writer_component, stream);
+	if (cut) {
+		int_ret = packet_cut_begin(cut, packet, writer_stream);
+		if (int_ret) {
+			BT_LOGE_STR("Failed to update packet_context.");
+			goto error;
+		}
+	}
+
 	goto end;
 
 error:
@@ -724,6 +1060,7 @@ enum bt_component_status writer_output_event(
 	struct bt_stream *stream = NULL, *writer_stream = NULL;
 	struct bt_stream_class *stream_class = NULL, *writer_stream_class = NULL;
 	struct bt_event *writer_event = NULL;
+	struct fs_writer_packet_cut *cut;
 	int int_ret;
 
 	event_class = bt_event_get_class(event);
@@ -773,6 +1110,24 @@ enum bt_component_status writer_output_event(
 		goto error;
 	}
 
+	/*
+	 * Cut the current packet before appending an event to it
+	 * once it is full, so that the cut never leaves an empty
+	 * packet at the end of a source packet.
+	 */
+	cut = lookup_packet_cut(writer_component, stream);
+	if (cut) {
+		int_ret = packet_cut_needed(writer_component, cut,
+				writer_stream);
+		if (int_ret > 0) {
+			int_ret = packet_cut(cut, writer_stream);
+		}
+		if (int_ret < 0) {
+			BT_LOGE_STR("Failed to cut packet.");
+			goto error;
+		}
+	}
+
 	int_ret = bt_stream_append_event(writer_stream, writer_event);
 	if (int_ret < 0) {
 		BT_LOGE("Failed to append event: event_class=\"%s\"",
@@ -780,6 +1135,10 @@ enum bt_component_status writer_output_event(
 		goto error;
 	}
 
+	if (cut) {
+		packet_cut_update_last_event_ts(cut, event);
+	}
+
 	ret = BT_COMPONENT_STATUS_OK;
 	goto end;
 
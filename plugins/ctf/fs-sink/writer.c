@@ -301,6 +301,34 @@ end:
 	return ret;
 }
 
+static
+enum bt_component_status apply_one_uint(const char *key,
+		struct bt_value *params,
+		uint64_t *option)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct bt_value *value = NULL;
+	enum bt_value_status status;
+	int64_t int_val;
+
+	value = bt_value_map_get(params, key);
+	if (!value) {
+		goto end;
+	}
+	status = bt_value_integer_get(value, &int_val);
+	if (status != BT_VALUE_STATUS_OK || int_val < 0) {
+		BT_LOGE("Invalid parameter: expecting a non-negative integer: "
+			"key=\"%s\"", key);
+		ret = BT_COMPONENT_STATUS_INVALID;
+		goto end;
+	}
+
+	*option = (uint64_t) int_val;
+end:
+	bt_put(value);
+	return ret;
+}
+
 BT_HIDDEN
 enum bt_component_status writer_component_init(
 	struct bt_private_component *component, struct bt_value *params,
@@ -350,6 +378,18 @@ enum bt_component_status writer_component_init(
 		goto end;
 	}
 
+	ret = apply_one_uint("max-packet-size", params,
+			&writer_component->max_packet_size);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto error;
+	}
+
+	ret = apply_one_uint("max-packet-events", params,
+			&writer_component->max_packet_events);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto error;
+	}
+
 	ret = bt_private_component_set_user_data(component, writer_component);
 	if (ret != BT_COMPONENT_STATUS_OK) {
 		goto error;
@@ -43,6 +43,12 @@ struct writer_component {
 	bool error;
 	bool single_trace;
 	unsigned int nr_traces;
+	/*
+	 * Maximum size (bytes) and number of events of an output
+	 * packet, 0 if unlimited: bigger source packets are cut.
+	 */
+	uint64_t max_packet_size;
+	uint64_t max_packet_events;
 };
 
 enum fs_writer_stream_state {
@@ -57,6 +63,27 @@ enum fs_writer_stream_state {
 	FS_WRITER_COMPLETED_STREAM,
 };
 
+/*
+ * State of a writer stream whose source packets are cut when they
+ * exceed the component's maximum packet size or event count.
+ */
+struct fs_writer_packet_cut {
+	/* Number of packets cut so far in this stream. */
+	uint64_t count;
+	/* False if the writer stream's content size is unknown. */
+	bool check_size;
+	/* Current source packet's timestamps. */
+	uint64_t timestamp_begin;
+	uint64_t timestamp_end;
+	bool has_timestamp_begin;
+	bool has_timestamp_end;
+	/* Clock class of the source packet context's timestamps. */
+	struct bt_clock_class *clock_class;
+	/* Clock value of the last event appended to the writer stream. */
+	uint64_t last_event_ts;
+	bool has_last_event_ts;
+};
+
 struct fs_writer {
 	struct bt_ctf_writer *writer;
 	struct bt_trace *trace;
@@ -69,6 +96,8 @@ struct fs_writer {
 	/* Map between reader and writer stream class. */
 	GHashTable *stream_class_map;
 	GHashTable *stream_states;
+	/* Map between reader stream and struct fs_writer_packet_cut. */
+	GHashTable *packet_cuts;
 };
 
 BT_HIDDEN
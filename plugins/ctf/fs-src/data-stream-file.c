@@ -33,11 +33,13 @@
 #include <babeltrace/endian-internal.h>
 #include <babeltrace/babeltrace.h>
 #include <babeltrace/common-internal.h>
+#include <babeltrace/compiler-internal.h>
 #include "file.h"
 #include "metadata.h"
 #include "../common/notif-iter/notif-iter.h"
 #include <assert.h>
 #include "data-stream-file.h"
+#include "index-cache.h"
 #include <string.h>
 
 #define BT_LOG_TAG "PLUGIN-CTF-FS-SRC-DS"
@@ -50,28 +52,33 @@ size_t remaining_mmap_bytes(struct ctf_fs_ds_file *ds_file)
 }
 
 static
-int ds_file_munmap(struct ctf_fs_ds_file *ds_file)
+void ds_file_mapping_release(struct bt_object *obj)
 {
-	int ret = 0;
+	struct ctf_fs_ds_file_mapping *mapping =
+		container_of(obj, struct ctf_fs_ds_file_mapping, obj);
 
-	if (!ds_file || !ds_file->mmap_addr) {
-		goto end;
+	if (bt_munmap(mapping->addr, mapping->len)) {
+		BT_LOGE_ERRNO("Cannot memory-unmap file",
+			": address=%p, size=%zu", mapping->addr,
+			mapping->len);
 	}
 
-	if (bt_munmap(ds_file->mmap_addr, ds_file->mmap_len)) {
-		BT_LOGE_ERRNO("Cannot memory-unmap file",
-			": address=%p, size=%zu, file_path=\"%s\", file=%p",
-			ds_file->mmap_addr, ds_file->mmap_len,
-			ds_file->file ? ds_file->file->path->str : "NULL",
-			ds_file->file ? ds_file->file->fp : NULL);
-		ret = -1;
-		goto end;
+	g_free(mapping);
+}
+
+static
+void ds_file_munmap(struct ctf_fs_ds_file *ds_file)
+{
+	if (!ds_file || !ds_file->mapping) {
+		return;
 	}
 
+	/*
+	 * The region is unmapped when the last string field which
+	 * references its bytes releases it.
+	 */
+	BT_PUT(ds_file->mapping);
 	ds_file->mmap_addr = NULL;
-
-end:
-	return ret;
 }
 
 static
@@ -83,9 +90,7 @@ enum bt_notif_iter_medium_status ds_file_mmap_next(
 
 	/* Unmap old region */
 	if (ds_file->mmap_addr) {
-		if (ds_file_munmap(ds_file)) {
-			goto error;
-		}
+		ds_file_munmap(ds_file);
 
 		/*
 		 * mmap_len is guaranteed to be page-aligned except on the
@@ -104,17 +109,28 @@ enum bt_notif_iter_medium_status ds_file_mmap_next(
 	}
 	/* Map new region */
 	assert(ds_file->mmap_len);
-	ds_file->mmap_addr = bt_mmap((void *) 0, ds_file->mmap_len,
+	ds_file->mapping = g_new0(struct ctf_fs_ds_file_mapping, 1);
+	if (!ds_file->mapping) {
+		BT_LOGE_STR("Failed to allocate one file mapping.");
+		goto error;
+	}
+
+	ds_file->mapping->addr = bt_mmap((void *) 0, ds_file->mmap_len,
 			PROT_READ, MAP_PRIVATE, fileno(ds_file->file->fp),
 			ds_file->mmap_offset);
-	if (ds_file->mmap_addr == MAP_FAILED) {
+	if (ds_file->mapping->addr == MAP_FAILED) {
 		BT_LOGE("Cannot memory-map address (size %zu) of file \"%s\" (%p) at offset %jd: %s",
 				ds_file->mmap_len, ds_file->file->path->str,
 				ds_file->file->fp, (intmax_t) ds_file->mmap_offset,
 				strerror(errno));
+		g_free(ds_file->mapping);
+		ds_file->mapping = NULL;
 		goto error;
 	}
 
+	ds_file->mapping->len = ds_file->mmap_len;
+	bt_object_init(ds_file->mapping, ds_file_mapping_release);
+	ds_file->mmap_addr = ds_file->mapping->addr;
 	goto end;
 error:
 	ds_file_munmap(ds_file);
@@ -172,6 +188,14 @@ end:
 	return status;
 }
 
+static
+void *medop_borrow_buffer_owner(void *data)
+{
+	struct ctf_fs_ds_file *ds_file = data;
+
+	return ds_file->mapping;
+}
+
 static
 struct bt_stream *medop_get_stream(
 		struct bt_stream_class *stream_class, uint64_t stream_id,
@@ -219,23 +243,18 @@ enum bt_notif_iter_medium_status medop_seek(
 
 	/*
 	 * Determine whether or not the destination is contained within the
-	 * current mapping.
+	 * current mapping, if any (there's none if nothing was read from
+	 * this file yet).
 	 */
-	if (ds_file->mmap_addr && (offset < ds_file->mmap_offset ||
-			offset >= ds_file->mmap_offset + ds_file->mmap_len)) {
-		int unmap_ret;
+	if (!ds_file->mmap_addr || offset < ds_file->mmap_offset ||
+			offset >= ds_file->mmap_offset + ds_file->mmap_len) {
 		off_t offset_in_mapping = offset % bt_common_get_page_size();
 
 		BT_LOGD("Medium seek request cannot be accomodated by the current "
 				"file mapping: offset=%jd, mmap-offset=%jd, "
 				"mmap-len=%zu", offset, ds_file->mmap_offset,
 				ds_file->mmap_len);
-		unmap_ret = ds_file_munmap(ds_file);
-		if (unmap_ret) {
-			ret = BT_NOTIF_ITER_MEDIUM_STATUS_ERROR;
-			goto end;
-		}
-
+		ds_file_munmap(ds_file);
 		ds_file->mmap_offset = offset - offset_in_mapping;
 		ds_file->request_offset = offset_in_mapping;
 		ret = ds_file_mmap_next(ds_file);
@@ -256,6 +275,7 @@ struct bt_notif_iter_medium_ops ctf_fs_ds_file_medops = {
 	.request_bytes = medop_request_bytes,
 	.get_stream = medop_get_stream,
 	.seek = medop_seek,
+	.borrow_buffer_owner = medop_borrow_buffer_owner,
 };
 
 static
@@ -421,8 +441,8 @@ end:
 	return ret;
 }
 
-static
-struct ctf_fs_ds_index *build_index_from_idx_file(
+BT_HIDDEN
+struct ctf_fs_ds_index *ctf_fs_ds_file_build_index_from_idx_file(
 		struct ctf_fs_ds_file *ds_file)
 {
 	int ret;
@@ -664,8 +684,8 @@ end:
 	return ret;
 }
 
-static
-struct ctf_fs_ds_index *build_index_from_stream_file(
+BT_HIDDEN
+struct ctf_fs_ds_index *ctf_fs_ds_file_build_index_from_stream_file(
 		struct ctf_fs_ds_file *ds_file)
 {
 	int ret;
@@ -760,6 +780,743 @@ error:
 	goto end;
 }
 
+static
+gchar *get_index_cache_file_path(const char *cache_dir, const char *path)
+{
+	gchar *checksum;
+	gchar *basename = NULL;
+	gchar *cache_file_path = NULL;
+
+	checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA1, path, -1);
+	if (!checksum) {
+		goto end;
+	}
+
+	basename = g_strconcat(checksum, CTF_FS_INDEX_CACHE_FILE_SUFFIX, NULL);
+	if (!basename) {
+		goto end;
+	}
+
+	cache_file_path = g_build_filename(cache_dir, basename, NULL);
+
+end:
+	g_free(checksum);
+	g_free(basename);
+	return cache_file_path;
+}
+
+BT_HIDDEN
+struct ctf_fs_ds_index *ctf_fs_ds_file_build_index_from_cache(
+		struct ctf_fs_ds_file *ds_file)
+{
+	int ret;
+	GString *cache_dir = ds_file->ctf_fs_trace->index_cache_dir;
+	gchar *cache_file_path = NULL;
+	GMappedFile *mapped_file = NULL;
+	const struct ctf_fs_index_cache_file_hdr *header;
+	const struct ctf_fs_index_cache_entry *file_entry;
+	struct ctf_fs_ds_index *index = NULL;
+	struct ctf_fs_ds_index_entry *index_entry;
+	struct bt_clock_class *timestamp_begin_cc = NULL;
+	struct bt_clock_class *timestamp_end_cc = NULL;
+	uint64_t entry_count;
+	uint64_t total_packets_size = 0;
+	size_t filesize;
+	size_t i;
+
+	if (!cache_dir) {
+		goto error;
+	}
+
+	cache_file_path = get_index_cache_file_path(cache_dir->str,
+		ds_file->file->path->str);
+	if (!cache_file_path) {
+		BT_LOGE("Cannot get cached index file path of stream file %s",
+			ds_file->file->path->str);
+		goto error;
+	}
+
+	BT_LOGD("Building index from cached index file: "
+		"stream-file-path=\"%s\", cache-file-path=\"%s\"",
+		ds_file->file->path->str, cache_file_path);
+	mapped_file = g_mapped_file_new(cache_file_path, FALSE, NULL);
+	if (!mapped_file) {
+		BT_LOGD("Cannot create new mapped file %s", cache_file_path);
+		goto error;
+	}
+
+	filesize = g_mapped_file_get_length(mapped_file);
+	if (filesize < sizeof(*header)) {
+		BT_LOGW("Invalid cached index file: "
+			"file size (%zu bytes) < header size (%zu bytes)",
+			filesize, sizeof(*header));
+		goto error;
+	}
+
+	header = (const void *) g_mapped_file_get_contents(mapped_file);
+	if (be32toh(header->magic) != CTF_FS_INDEX_CACHE_MAGIC ||
+			be32toh(header->version) != CTF_FS_INDEX_CACHE_VERSION ||
+			be32toh(header->entry_len) != sizeof(*file_entry)) {
+		BT_LOGW("Invalid or unsupported cached index file: %s",
+			cache_file_path);
+		goto error;
+	}
+
+	if (be64toh(header->file_size) != ds_file->file->size ||
+			(int64_t) be64toh(header->file_mtime_ns) !=
+			ds_file->file->mtime_ns ||
+			be64toh(header->file_inode) != ds_file->file->inode) {
+		BT_LOGD("Stale cached index file: stream file's size, "
+			"modification time, or inode changed: path=\"%s\"",
+			cache_file_path);
+		goto error;
+	}
+
+	entry_count = be64toh(header->entry_count);
+	if ((filesize - sizeof(*header)) % sizeof(*file_entry) != 0 ||
+			(filesize - sizeof(*header)) / sizeof(*file_entry) !=
+			entry_count) {
+		BT_LOGW("Invalid cached index file: the index's size after the header "
+			"(%zu bytes) is not the size of %" PRIu64 " entries",
+			filesize - sizeof(*header), entry_count);
+		goto error;
+	}
+
+	ret = get_ds_file_packet_bounds_clock_classes(ds_file,
+			&timestamp_begin_cc, &timestamp_end_cc);
+	if (ret) {
+		BT_LOGD_STR("Cannot get clock classes of \"timestamp_begin\" "
+				"and \"timestamp_end\" fields");
+		goto error;
+	}
+
+	index = ctf_fs_ds_index_create(entry_count);
+	if (!index) {
+		goto error;
+	}
+
+	file_entry = (const void *) (header + 1);
+	for (i = 0; i < entry_count; i++, file_entry++) {
+		index_entry = &g_array_index(index->entries,
+			struct ctf_fs_ds_index_entry, i);
+		index_entry->offset = be64toh(file_entry->offset);
+		index_entry->packet_size = be64toh(file_entry->packet_size);
+		index_entry->timestamp_begin =
+			be64toh(file_entry->timestamp_begin);
+		index_entry->timestamp_end = be64toh(file_entry->timestamp_end);
+		if (index_entry->offset != total_packets_size) {
+			BT_LOGW("Invalid cached index file: packet offset is not "
+				"the end of the previous packet: "
+				"offset=%" PRIu64 ", expected-offset=%" PRIu64,
+				index_entry->offset, total_packets_size);
+			goto error;
+		}
+
+		ret = convert_cycles_to_ns(timestamp_begin_cc,
+				index_entry->timestamp_begin,
+				&index_entry->timestamp_begin_ns);
+		if (ret) {
+			BT_LOGD_STR("Failed to convert raw timestamp to nanoseconds since Epoch during cached index parsing");
+			goto error;
+		}
+
+		ret = convert_cycles_to_ns(timestamp_end_cc,
+				index_entry->timestamp_end,
+				&index_entry->timestamp_end_ns);
+		if (ret) {
+			BT_LOGD_STR("Failed to convert raw timestamp to nanoseconds since Epoch during cached index parsing");
+			goto error;
+		}
+
+		total_packets_size += index_entry->packet_size;
+	}
+
+	if (ds_file->file->size != total_packets_size) {
+		BT_LOGW("Invalid cached index file; indexed size != stream file size: "
+			"file-size=%" PRIu64 ", total-packets-size=%" PRIu64,
+			ds_file->file->size, total_packets_size);
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ctf_fs_ds_index_destroy(index);
+	index = NULL;
+
+end:
+	g_free(cache_file_path);
+	if (mapped_file) {
+		g_mapped_file_unref(mapped_file);
+	}
+	bt_put(timestamp_begin_cc);
+	bt_put(timestamp_end_cc);
+	return index;
+}
+
+BT_HIDDEN
+int ctf_fs_ds_index_cache_save(const char *cache_dir, const char *path,
+		uint64_t file_size, int64_t file_mtime_ns, uint64_t file_inode,
+		const struct ctf_fs_ds_index *index)
+{
+	int ret = 0;
+	gchar *cache_file_path = NULL;
+	gchar *contents = NULL;
+	struct ctf_fs_index_cache_file_hdr *header;
+	struct ctf_fs_index_cache_entry *file_entry;
+	size_t contents_len;
+	size_t i;
+	GError *error = NULL;
+
+	if (!cache_dir) {
+		goto end;
+	}
+
+	if (g_mkdir_with_parents(cache_dir, 0755)) {
+		BT_LOGW("Cannot create index cache directory: "
+			"path=\"%s\", errno=%d", cache_dir, errno);
+		goto error;
+	}
+
+	cache_file_path = get_index_cache_file_path(cache_dir, path);
+	if (!cache_file_path) {
+		goto error;
+	}
+
+	contents_len = sizeof(*header) +
+		index->entries->len * sizeof(*file_entry);
+	contents = g_malloc(contents_len);
+	if (!contents) {
+		BT_LOGE_STR("Failed to allocate cached index file contents.");
+		goto error;
+	}
+
+	header = (void *) contents;
+	header->magic = htobe32(CTF_FS_INDEX_CACHE_MAGIC);
+	header->version = htobe32(CTF_FS_INDEX_CACHE_VERSION);
+	header->entry_len = htobe32(sizeof(*file_entry));
+	header->reserved = 0;
+	header->file_size = htobe64(file_size);
+	header->file_mtime_ns = htobe64((uint64_t) file_mtime_ns);
+	header->file_inode = htobe64(file_inode);
+	header->entry_count = htobe64((uint64_t) index->entries->len);
+	file_entry = (void *) (header + 1);
+
+	for (i = 0; i < index->entries->len; i++, file_entry++) {
+		struct ctf_fs_ds_index_entry *index_entry = &g_array_index(
+			index->entries, struct ctf_fs_ds_index_entry, i);
+
+		file_entry->offset = htobe64(index_entry->offset);
+		file_entry->packet_size = htobe64(index_entry->packet_size);
+		file_entry->timestamp_begin =
+			htobe64(index_entry->timestamp_begin);
+		file_entry->timestamp_end = htobe64(index_entry->timestamp_end);
+	}
+
+	/* Atomic: a concurrent reader never sees a partial file */
+	if (!g_file_set_contents(cache_file_path, contents, contents_len,
+			&error)) {
+		BT_LOGW("Cannot write cached index file: path=\"%s\": %s",
+			cache_file_path, error->message);
+		g_error_free(error);
+		goto error;
+	}
+
+	BT_LOGD("Wrote cached index file: stream-file-path=\"%s\", "
+		"cache-file-path=\"%s\", entry-count=%u",
+		path, cache_file_path, index->entries->len);
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	g_free(cache_file_path);
+	g_free(contents);
+	return ret;
+}
+
+static
+void init_index_layout_field(struct ctf_fs_ds_index_layout_field *field)
+{
+	field->offset = -1;
+	field->size = 0;
+	field->is_big_endian = false;
+}
+
+/*
+ * Returns the index layout field to set for the member named `name` of
+ * the packet header (`is_context` is false) or packet context
+ * (`is_context` is true) structure, or NULL if this member is not
+ * needed to index packets.
+ */
+static
+struct ctf_fs_ds_index_layout_field *borrow_index_layout_field_by_name(
+		struct ctf_fs_ds_index_layout *layout, bool is_context,
+		const char *name)
+{
+	struct ctf_fs_ds_index_layout_field *field = NULL;
+
+	if (!is_context) {
+		if (strcmp(name, "magic") == 0) {
+			field = &layout->magic;
+		} else if (strcmp(name, "stream_id") == 0) {
+			field = &layout->stream_id;
+		}
+	} else {
+		if (strcmp(name, "packet_size") == 0) {
+			field = &layout->packet_size;
+		} else if (strcmp(name, "content_size") == 0) {
+			field = &layout->content_size;
+		} else if (strcmp(name, "timestamp_begin") == 0) {
+			field = &layout->timestamp_begin;
+		} else if (strcmp(name, "timestamp_end") == 0) {
+			field = &layout->timestamp_end;
+		}
+	}
+
+	return field;
+}
+
+/*
+ * Aligns *at (bits) for a field of type `ft` and adds its size to it.
+ * If `layout_field` is not NULL, it is set with the location of this
+ * field.
+ *
+ * Returns -1 if the field type does not have a fixed size (string,
+ * sequence, variant), or if `layout_field` is not NULL and the field is
+ * not a byte-aligned, 8-bit, 16-bit, 32-bit, or 64-bit unsigned
+ * integer.
+ */
+static
+int add_fixed_field_type_size(struct bt_field_type *ft,
+		enum bt_byte_order native_bo,
+		struct ctf_fs_ds_index_layout_field *layout_field,
+		uint64_t *at)
+{
+	int ret = 0;
+	int alignment;
+	int64_t size;
+	int64_t i;
+	enum bt_field_type_id type_id = bt_field_type_get_type_id(ft);
+	enum bt_byte_order bo;
+	struct bt_field_type *child_ft = NULL;
+
+	alignment = bt_field_type_get_alignment(ft);
+	assert(alignment > 0);
+	*at = (*at + alignment - 1) & ~((uint64_t) alignment - 1);
+
+	if (layout_field && type_id != BT_FIELD_TYPE_ID_INTEGER) {
+		goto error;
+	}
+
+	switch (type_id) {
+	case BT_FIELD_TYPE_ID_INTEGER:
+		size = bt_field_type_integer_get_size(ft);
+		assert(size > 0);
+
+		if (!layout_field) {
+			*at += size;
+			break;
+		}
+
+		if (bt_field_type_integer_is_signed(ft) ||
+				(*at % CHAR_BIT) != 0 ||
+				(size != 8 && size != 16 && size != 32 &&
+				size != 64)) {
+			goto error;
+		}
+
+		bo = bt_field_type_get_byte_order(ft);
+		if (bo == BT_BYTE_ORDER_NATIVE) {
+			bo = native_bo;
+		}
+
+		switch (bo) {
+		case BT_BYTE_ORDER_BIG_ENDIAN:
+		case BT_BYTE_ORDER_NETWORK:
+			layout_field->is_big_endian = true;
+			break;
+		case BT_BYTE_ORDER_LITTLE_ENDIAN:
+			layout_field->is_big_endian = false;
+			break;
+		default:
+			goto error;
+		}
+
+		layout_field->offset = *at / CHAR_BIT;
+		layout_field->size = size / CHAR_BIT;
+		*at += size;
+		break;
+	case BT_FIELD_TYPE_ID_ENUM:
+		child_ft = bt_field_type_enumeration_get_container_type(ft);
+		assert(child_ft);
+		ret = add_fixed_field_type_size(child_ft, native_bo, NULL, at);
+		break;
+	case BT_FIELD_TYPE_ID_FLOAT:
+		size = bt_field_type_floating_point_get_exponent_digits(ft) +
+			bt_field_type_floating_point_get_mantissa_digits(ft);
+		assert(size > 0);
+		*at += size;
+		break;
+	case BT_FIELD_TYPE_ID_STRUCT:
+	{
+		int64_t count = bt_field_type_structure_get_field_count(ft);
+
+		assert(count >= 0);
+
+		for (i = 0; i < count; i++) {
+			ret = bt_field_type_structure_get_field_by_index(ft,
+				NULL, &child_ft, i);
+			assert(ret == 0);
+			ret = add_fixed_field_type_size(child_ft, native_bo,
+				NULL, at);
+			BT_PUT(child_ft);
+			if (ret) {
+				goto end;
+			}
+		}
+
+		break;
+	}
+	case BT_FIELD_TYPE_ID_ARRAY:
+	{
+		int64_t length = bt_field_type_array_get_length(ft);
+
+		assert(length >= 0);
+		child_ft = bt_field_type_array_get_element_type(ft);
+		assert(child_ft);
+
+		for (i = 0; i < length; i++) {
+			ret = add_fixed_field_type_size(child_ft, native_bo,
+				NULL, at);
+			if (ret) {
+				goto end;
+			}
+		}
+
+		break;
+	}
+	default:
+		/* String, sequence, or variant: not a fixed size */
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	bt_put(child_ft);
+	return ret;
+}
+
+/*
+ * Adds the packet header (`is_context` is false) or packet context
+ * (`is_context` is true) structure field type `scope_ft` to `layout`,
+ * aligning and incrementing *at (bits).
+ */
+static
+int add_index_layout_scope(struct ctf_fs_ds_index_layout *layout,
+		struct bt_field_type *scope_ft, bool is_context,
+		enum bt_byte_order native_bo, uint64_t *at)
+{
+	int ret = 0;
+	int alignment;
+	int64_t count;
+	int64_t i;
+
+	if (bt_field_type_get_type_id(scope_ft) != BT_FIELD_TYPE_ID_STRUCT) {
+		ret = -1;
+		goto end;
+	}
+
+	alignment = bt_field_type_get_alignment(scope_ft);
+	assert(alignment > 0);
+	*at = (*at + alignment - 1) & ~((uint64_t) alignment - 1);
+	count = bt_field_type_structure_get_field_count(scope_ft);
+	assert(count >= 0);
+
+	for (i = 0; i < count; i++) {
+		const char *name;
+		struct bt_field_type *member_ft;
+
+		ret = bt_field_type_structure_get_field_by_index(scope_ft,
+			&name, &member_ft, i);
+		assert(ret == 0);
+		ret = add_fixed_field_type_size(member_ft, native_bo,
+			borrow_index_layout_field_by_name(layout, is_context,
+				name), at);
+		bt_put(member_ft);
+		if (ret) {
+			BT_LOGD("Packet header or context member has no fixed layout: "
+				"name=\"%s\"", name);
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_fs_ds_file_get_index_layout(struct ctf_fs_ds_file *ds_file,
+		struct ctf_fs_ds_index_layout *layout)
+{
+	int ret;
+	struct bt_field *packet_header = NULL;
+	struct bt_field *packet_context = NULL;
+	struct bt_field *stream_id = NULL;
+	struct bt_field_type *ft = NULL;
+	enum bt_byte_order native_bo;
+	uint64_t at = 0;
+
+	memset(layout, 0, sizeof(*layout));
+	init_index_layout_field(&layout->magic);
+	init_index_layout_field(&layout->stream_id);
+	init_index_layout_field(&layout->packet_size);
+	init_index_layout_field(&layout->content_size);
+	init_index_layout_field(&layout->timestamp_begin);
+	init_index_layout_field(&layout->timestamp_end);
+	native_bo = bt_trace_get_native_byte_order(
+		ds_file->ctf_fs_trace->metadata->trace);
+	ret = ctf_fs_ds_file_get_packet_header_context_fields(ds_file,
+		&packet_header, &packet_context);
+	if (ret || !packet_context) {
+		goto error;
+	}
+
+	if (packet_header) {
+		ft = bt_field_get_type(packet_header);
+		assert(ft);
+		ret = add_index_layout_scope(layout, ft, false, native_bo, &at);
+		BT_PUT(ft);
+		if (ret) {
+			goto error;
+		}
+
+		stream_id = bt_field_structure_get_field_by_name(packet_header,
+			"stream_id");
+		if (stream_id) {
+			ret = bt_field_unsigned_integer_get_value(stream_id,
+				&layout->stream_id_value);
+			if (ret) {
+				goto error;
+			}
+		}
+	}
+
+	ft = bt_field_get_type(packet_context);
+	assert(ft);
+	ret = add_index_layout_scope(layout, ft, true, native_bo, &at);
+	BT_PUT(ft);
+	if (ret) {
+		goto error;
+	}
+
+	if (layout->packet_size.offset < 0 ||
+			layout->timestamp_begin.offset < 0 ||
+			layout->timestamp_end.offset < 0) {
+		BT_LOGD_STR("Packet context has no `packet_size`, `timestamp_begin`, or `timestamp_end` field.");
+		goto error;
+	}
+
+	ret = get_packet_bounds_from_packet_context(packet_context,
+		&layout->timestamp_begin_cc, NULL,
+		&layout->timestamp_end_cc, NULL);
+	if (ret || !layout->timestamp_begin_cc ||
+			!layout->timestamp_end_cc) {
+		goto error;
+	}
+
+	layout->header_context_size = (at + CHAR_BIT - 1) / CHAR_BIT;
+	BT_LOGD("Found fixed packet header and context layout: "
+		"path=\"%s\", header-context-size=%" PRIu64,
+		ds_file->file->path->str, layout->header_context_size);
+	goto end;
+
+error:
+	ctf_fs_ds_index_layout_fini(layout);
+	ret = -1;
+
+end:
+	bt_put(packet_header);
+	bt_put(packet_context);
+	bt_put(stream_id);
+	return ret;
+}
+
+BT_HIDDEN
+void ctf_fs_ds_index_layout_fini(struct ctf_fs_ds_index_layout *layout)
+{
+	BT_PUT(layout->timestamp_begin_cc);
+	BT_PUT(layout->timestamp_end_cc);
+}
+
+static
+uint64_t read_index_layout_field(const char *packet,
+		const struct ctf_fs_ds_index_layout_field *field)
+{
+	const char *addr = packet + field->offset;
+
+	switch (field->size) {
+	case 1:
+		return (uint8_t) *addr;
+	case 2:
+	{
+		uint16_t v;
+
+		memcpy(&v, addr, sizeof(v));
+		return field->is_big_endian ? be16toh(v) : le16toh(v);
+	}
+	case 4:
+	{
+		uint32_t v;
+
+		memcpy(&v, addr, sizeof(v));
+		return field->is_big_endian ? be32toh(v) : le32toh(v);
+	}
+	case 8:
+	{
+		uint64_t v;
+
+		memcpy(&v, addr, sizeof(v));
+		return field->is_big_endian ? be64toh(v) : le64toh(v);
+	}
+	default:
+		abort();
+	}
+}
+
+BT_HIDDEN
+struct ctf_fs_ds_index *ctf_fs_ds_index_build_with_layout(const char *path,
+		const struct ctf_fs_ds_index_layout *layout)
+{
+	struct ctf_fs_ds_index *index = NULL;
+	GMappedFile *mapped_file = NULL;
+	const char *contents;
+	uint64_t file_size;
+	uint64_t offset = 0;
+
+	mapped_file = g_mapped_file_new(path, FALSE, NULL);
+	if (!mapped_file) {
+		BT_LOGD("Cannot map data stream file: path=\"%s\"", path);
+		goto error;
+	}
+
+	contents = g_mapped_file_get_contents(mapped_file);
+	file_size = g_mapped_file_get_length(mapped_file);
+	index = ctf_fs_ds_index_create(0);
+	if (!index) {
+		goto error;
+	}
+
+	while (offset < file_size) {
+		const char *packet = contents + offset;
+		struct ctf_fs_ds_index_entry *entry;
+		uint64_t packet_size;
+
+		if (file_size - offset < layout->header_context_size) {
+			BT_LOGD("Truncated packet header or context: "
+				"path=\"%s\", packet-offset=%" PRIu64,
+				path, offset);
+			goto error;
+		}
+
+		if (layout->magic.offset >= 0 &&
+				read_index_layout_field(packet,
+					&layout->magic) != 0xc1fc1fc1) {
+			BT_LOGD("Invalid packet magic number: "
+				"path=\"%s\", packet-offset=%" PRIu64,
+				path, offset);
+			goto error;
+		}
+
+		if (layout->stream_id.offset >= 0 &&
+				read_index_layout_field(packet,
+					&layout->stream_id) !=
+					layout->stream_id_value) {
+			BT_LOGD("Packet's stream class ID is not the first packet's: "
+				"path=\"%s\", packet-offset=%" PRIu64,
+				path, offset);
+			goto error;
+		}
+
+		packet_size = read_index_layout_field(packet,
+			&layout->packet_size);
+		if (packet_size == 0 || (packet_size % CHAR_BIT) != 0 ||
+				(layout->content_size.offset >= 0 &&
+				read_index_layout_field(packet,
+					&layout->content_size) > packet_size)) {
+			BT_LOGD("Invalid packet or content size: "
+				"path=\"%s\", packet-offset=%" PRIu64,
+				path, offset);
+			goto error;
+		}
+
+		packet_size /= CHAR_BIT;
+		if (packet_size < layout->header_context_size ||
+				packet_size > file_size - offset) {
+			BT_LOGD("Invalid packet size: path=\"%s\", "
+				"packet-offset=%" PRIu64 ", "
+				"packet-size-bytes=%" PRIu64 ", "
+				"file-size=%" PRIu64,
+				path, offset, packet_size, file_size);
+			goto error;
+		}
+
+		entry = ctf_fs_ds_index_add_new_entry(index);
+		entry->offset = offset;
+		entry->packet_size = packet_size;
+		entry->timestamp_begin = read_index_layout_field(packet,
+			&layout->timestamp_begin);
+		entry->timestamp_end = read_index_layout_field(packet,
+			&layout->timestamp_end);
+		offset += packet_size;
+	}
+
+	goto end;
+
+error:
+	ctf_fs_ds_index_destroy(index);
+	index = NULL;
+
+end:
+	if (mapped_file) {
+		g_mapped_file_unref(mapped_file);
+	}
+
+	return index;
+}
+
+BT_HIDDEN
+int ctf_fs_ds_index_set_timestamps_ns(struct ctf_fs_ds_index *index,
+		const struct ctf_fs_ds_index_layout *layout)
+{
+	int ret = 0;
+	size_t i;
+
+	for (i = 0; i < index->entries->len; i++) {
+		struct ctf_fs_ds_index_entry *entry = &g_array_index(
+			index->entries, struct ctf_fs_ds_index_entry, i);
+
+		ret = convert_cycles_to_ns(layout->timestamp_begin_cc,
+			entry->timestamp_begin, &entry->timestamp_begin_ns);
+		if (ret) {
+			break;
+		}
+
+		ret = convert_cycles_to_ns(layout->timestamp_end_cc,
+			entry->timestamp_end, &entry->timestamp_end_ns);
+		if (ret) {
+			break;
+		}
+	}
+
+	return ret;
+}
+
 BT_HIDDEN
 struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 		struct ctf_fs_trace *ctf_fs_trace,
@@ -779,6 +1536,7 @@ struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 		goto error;
 	}
 
+	ds_file->ctf_fs_trace = ctf_fs_trace;
 	ds_file->stream = bt_get(stream);
 	ds_file->cc_prio_map = bt_get(ctf_fs_trace->cc_prio_map);
 	g_string_assign(ds_file->file->path, path);
@@ -812,14 +1570,26 @@ struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
 {
 	struct ctf_fs_ds_index *index;
 
-	index = build_index_from_idx_file(ds_file);
+	index = ctf_fs_ds_file_build_index_from_idx_file(ds_file);
+	if (index) {
+		goto end;
+	}
+
+	index = ctf_fs_ds_file_build_index_from_cache(ds_file);
 	if (index) {
 		goto end;
 	}
 
 	BT_LOGD("Failed to build index from .index file; "
 		"falling back to stream indexing.");
-	index = build_index_from_stream_file(ds_file);
+	index = ctf_fs_ds_file_build_index_from_stream_file(ds_file);
+	if (index && ds_file->ctf_fs_trace->index_cache_dir) {
+		(void) ctf_fs_ds_index_cache_save(
+			ds_file->ctf_fs_trace->index_cache_dir->str,
+			ds_file->file->path->str, ds_file->file->size,
+			ds_file->file->mtime_ns, ds_file->file->inode, index);
+	}
+
 end:
 	return index;
 }
@@ -833,7 +1603,7 @@ void ctf_fs_ds_file_destroy(struct ctf_fs_ds_file *ds_file)
 
 	bt_put(ds_file->cc_prio_map);
 	bt_put(ds_file->stream);
-	(void) ds_file_munmap(ds_file);
+	ds_file_munmap(ds_file);
 
 	if (ds_file->file) {
 		ctf_fs_file_destroy(ds_file->file);
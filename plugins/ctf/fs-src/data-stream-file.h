@@ -28,9 +28,10 @@
 #include <glib.h>
 #include <babeltrace/babeltrace-internal.h>
 #include <babeltrace/babeltrace.h>
+#include <babeltrace/object-internal.h>
+#include <babeltrace/ctf-writer/lttng-index-internal.h>
 
 #include "../common/notif-iter/notif-iter.h"
-#include "lttng-index.h"
 
 struct ctf_fs_component;
 struct ctf_fs_file;
@@ -62,6 +63,46 @@ struct ctf_fs_ds_index {
 	GArray *entries;
 };
 
+/* Fixed location of an unsigned integer field within a packet. */
+struct ctf_fs_ds_index_layout_field {
+	/*
+	 * Offset, in bytes, of the field from the beginning of the
+	 * packet, or -1 if the field does not exist.
+	 */
+	int64_t offset;
+
+	/* Size, in bytes: 1, 2, 4, or 8 */
+	unsigned int size;
+
+	bool is_big_endian;
+};
+
+/*
+ * Layout of the packet header and context of a data stream file when
+ * all their fields have a fixed size. In this case, the packets of the
+ * file can be indexed by reading a few integers at fixed offsets
+ * (ctf_fs_ds_index_build_with_layout()) instead of decoding them with
+ * a CTF notification iterator.
+ */
+struct ctf_fs_ds_index_layout {
+	struct ctf_fs_ds_index_layout_field magic;
+	struct ctf_fs_ds_index_layout_field stream_id;
+	struct ctf_fs_ds_index_layout_field packet_size;
+	struct ctf_fs_ds_index_layout_field content_size;
+	struct ctf_fs_ds_index_layout_field timestamp_begin;
+	struct ctf_fs_ds_index_layout_field timestamp_end;
+
+	/* Size, in bytes, of the packet header and context */
+	uint64_t header_context_size;
+
+	/* Value of the first packet's `stream_id` field, if any */
+	uint64_t stream_id_value;
+
+	/* Owned by this */
+	struct bt_clock_class *timestamp_begin_cc;
+	struct bt_clock_class *timestamp_end_cc;
+};
+
 struct ctf_fs_ds_file_info {
 	/*
 	 * Owned by this. May be NULL.
@@ -84,7 +125,23 @@ struct ctf_fs_ds_file_info {
 	uint64_t begin_ns;
 };
 
+/*
+ * Memory mapping of a region of a data stream file.
+ *
+ * String fields can reference the bytes of a mapping instead of copying
+ * them, so that a mapping remains until the data stream file and all
+ * those fields release it.
+ */
+struct ctf_fs_ds_file_mapping {
+	struct bt_object obj;
+	void *addr;
+	size_t len;
+};
+
 struct ctf_fs_ds_file {
+	/* Weak */
+	struct ctf_fs_trace *ctf_fs_trace;
+
 	/* Owned by this */
 	struct ctf_fs_file *file;
 
@@ -97,6 +154,10 @@ struct ctf_fs_ds_file {
 	/* Weak */
 	struct bt_notif_iter *notif_iter;
 
+	/* Owned by this */
+	struct ctf_fs_ds_file_mapping *mapping;
+
+	/* Address of the current mapping (NULL if none) */
 	void *mmap_addr;
 
 	/*
@@ -143,6 +204,64 @@ BT_HIDDEN
 struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
 		struct ctf_fs_ds_file *ds_file);
 
+BT_HIDDEN
+struct ctf_fs_ds_index *ctf_fs_ds_file_build_index_from_idx_file(
+		struct ctf_fs_ds_file *ds_file);
+
+BT_HIDDEN
+struct ctf_fs_ds_index *ctf_fs_ds_file_build_index_from_stream_file(
+		struct ctf_fs_ds_file *ds_file);
+
+/*
+ * Builds the index of a data stream file from its cached index file,
+ * if the trace has an index cache directory and the cached index is
+ * not stale.
+ */
+BT_HIDDEN
+struct ctf_fs_ds_index *ctf_fs_ds_file_build_index_from_cache(
+		struct ctf_fs_ds_file *ds_file);
+
+/*
+ * Writes `index`, the index of the data stream file at `path` of which
+ * the size, modification time, and inode number are `file_size`,
+ * `file_mtime_ns`, and `file_inode`, to the index cache directory
+ * `cache_dir`. Does nothing if `cache_dir` is NULL.
+ */
+BT_HIDDEN
+int ctf_fs_ds_index_cache_save(const char *cache_dir, const char *path,
+		uint64_t file_size, int64_t file_mtime_ns, uint64_t file_inode,
+		const struct ctf_fs_ds_index *index);
+
+/*
+ * Sets *layout from the first packet of `ds_file` and returns 0 if
+ * the packets of this file can be indexed with
+ * ctf_fs_ds_index_build_with_layout(). Call
+ * ctf_fs_ds_index_layout_fini() to finalize *layout on success.
+ */
+BT_HIDDEN
+int ctf_fs_ds_file_get_index_layout(struct ctf_fs_ds_file *ds_file,
+		struct ctf_fs_ds_index_layout *layout);
+
+BT_HIDDEN
+void ctf_fs_ds_index_layout_fini(struct ctf_fs_ds_index_layout *layout);
+
+/*
+ * Indexes the packets of the data stream file at `path` with `layout`.
+ * The returned index entries only have their offset, size, and
+ * timestamps in cycles: call ctf_fs_ds_index_set_timestamps_ns()
+ * to complete them.
+ *
+ * This function does not use any Babeltrace object, so that it is safe
+ * to call it from any thread.
+ */
+BT_HIDDEN
+struct ctf_fs_ds_index *ctf_fs_ds_index_build_with_layout(const char *path,
+		const struct ctf_fs_ds_index_layout *layout);
+
+BT_HIDDEN
+int ctf_fs_ds_index_set_timestamps_ns(struct ctf_fs_ds_index *index,
+		const struct ctf_fs_ds_index_layout *layout);
+
 BT_HIDDEN
 void ctf_fs_ds_index_destroy(struct ctf_fs_ds_index *index);
 
@@ -21,6 +21,7 @@
  */
 
 #include <stdio.h>
+#include <stdint.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -79,6 +80,25 @@ end:
 	return file;
 }
 
+/*
+ * Returns the modification time of a file with the best resolution
+ * available: a file which is rewritten within the same second must not
+ * have the same modification time.
+ */
+static
+int64_t get_stat_mtime_ns(const struct stat *stat)
+{
+	int64_t mtime_ns = (int64_t) stat->st_mtime * INT64_C(1000000000);
+
+#if defined(HAVE_STRUCT_STAT_ST_MTIM)
+	mtime_ns += (int64_t) stat->st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+	mtime_ns += (int64_t) stat->st_mtimespec.tv_nsec;
+#endif
+
+	return mtime_ns;
+}
+
 BT_HIDDEN
 int ctf_fs_file_open(struct ctf_fs_file *file, const char *mode)
 {
@@ -101,6 +121,8 @@ int ctf_fs_file_open(struct ctf_fs_file *file, const char *mode)
 	}
 
 	file->size = stat.st_size;
+	file->mtime_ns = get_stat_mtime_ns(&stat);
+	file->inode = (uint64_t) stat.st_ino;
 	BT_LOGD("File is %jd bytes", (intmax_t) file->size);
 	goto end;
 
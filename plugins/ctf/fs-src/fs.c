@@ -32,6 +32,7 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <stdbool.h>
+#include <limits.h>
 #include "fs.h"
 #include "metadata.h"
 #include "data-stream-file.h"
@@ -69,6 +70,111 @@ int notif_iter_data_set_current_ds_file(struct ctf_fs_notif_iter_data *notif_ite
 	return ret;
 }
 
+/*
+ * Returns the index of the first entry of `index` of which the packet
+ * ends at or after `ns`, or the index of the last entry if they all
+ * end before `ns`.
+ */
+static
+size_t find_ds_index_entry_by_ns(struct ctf_fs_ds_index *index, int64_t ns)
+{
+	size_t low = 0;
+	size_t high = index->entries->len - 1;
+
+	assert(index->entries->len > 0);
+
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+		struct ctf_fs_ds_index_entry *entry = &g_array_index(
+			index->entries, struct ctf_fs_ds_index_entry, mid);
+
+		if (entry->timestamp_end_ns < ns) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+/*
+ * Makes the current data stream file of `notif_iter_data` the first
+ * one of its group which has packets ending at or after `begin_ns`,
+ * and seeks to the first such packet within this file, so that the
+ * notification iterator does not decode the packets which cannot
+ * contain events at or after `begin_ns`.
+ *
+ * The indexes are needed to do this: a data stream file without an
+ * index is decoded from its beginning.
+ */
+static
+int notif_iter_data_seek_ns(struct ctf_fs_notif_iter_data *notif_iter_data,
+		int64_t begin_ns)
+{
+	int ret = 0;
+	GPtrArray *ds_file_infos = notif_iter_data->ds_file_group->ds_file_infos;
+	struct ctf_fs_ds_file_info *ds_file_info;
+	struct ctf_fs_ds_index_entry *entry;
+	size_t entry_index;
+	enum bt_notif_iter_status iter_status;
+
+	/* Skip whole data stream files, but keep the last one */
+	while (notif_iter_data->ds_file_info_index < ds_file_infos->len - 1) {
+		ds_file_info = g_ptr_array_index(ds_file_infos,
+			notif_iter_data->ds_file_info_index);
+		if (!ds_file_info->index ||
+				ds_file_info->index->entries->len == 0) {
+			break;
+		}
+
+		entry = &g_array_index(ds_file_info->index->entries,
+			struct ctf_fs_ds_index_entry,
+			ds_file_info->index->entries->len - 1);
+		if (entry->timestamp_end_ns >= begin_ns) {
+			break;
+		}
+
+		notif_iter_data->ds_file_info_index++;
+	}
+
+	ret = notif_iter_data_set_current_ds_file(notif_iter_data);
+	if (ret) {
+		goto end;
+	}
+
+	ds_file_info = g_ptr_array_index(ds_file_infos,
+		notif_iter_data->ds_file_info_index);
+	if (!ds_file_info->index || ds_file_info->index->entries->len == 0) {
+		goto end;
+	}
+
+	entry_index = find_ds_index_entry_by_ns(ds_file_info->index, begin_ns);
+	if (entry_index == 0) {
+		goto end;
+	}
+
+	entry = &g_array_index(ds_file_info->index->entries,
+		struct ctf_fs_ds_index_entry, entry_index);
+	BT_LOGD("Seeking to first packet ending at or after time: "
+		"path=\"%s\", begin-ns=%" PRId64 ", "
+		"packet-index=%zu, packet-offset=%" PRIu64,
+		ds_file_info->path->str, begin_ns, entry_index, entry->offset);
+	iter_status = bt_notif_iter_seek(notif_iter_data->notif_iter,
+		(off_t) entry->offset);
+	if (iter_status != BT_NOTIF_ITER_STATUS_OK) {
+		BT_LOGE("Cannot seek CTF notification iterator: "
+			"path=\"%s\", offset=%" PRIu64 ", status=%d",
+			ds_file_info->path->str, entry->offset,
+			iter_status);
+		ret = -1;
+		goto end;
+	}
+
+end:
+	return ret;
+}
+
 static
 void ctf_fs_notif_iter_data_destroy(
 		struct ctf_fs_notif_iter_data *notif_iter_data)
@@ -136,6 +242,54 @@ end:
 	return next_ret;
 }
 
+struct bt_notification_iterator_next_batch_method_return ctf_fs_iterator_next_batch(
+		struct bt_private_connection_private_notification_iterator *iterator,
+		struct bt_notification **notifications, uint64_t capacity)
+{
+	struct bt_notification_iterator_next_batch_method_return batch_ret = {
+		.count = 0,
+		.status = BT_NOTIFICATION_ITERATOR_STATUS_OK,
+	};
+	struct ctf_fs_notif_iter_data *notif_iter_data =
+		bt_private_connection_private_notification_iterator_get_user_data(iterator);
+
+	assert(capacity > 0);
+
+	if (notif_iter_data->pending_status !=
+			BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		batch_ret.status = notif_iter_data->pending_status;
+		notif_iter_data->pending_status =
+			BT_NOTIFICATION_ITERATOR_STATUS_OK;
+		goto end;
+	}
+
+	while (batch_ret.count < capacity) {
+		struct bt_notification_iterator_next_method_return next_ret =
+			ctf_fs_iterator_next(iterator);
+
+		if (next_ret.status != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+			if (batch_ret.count == 0) {
+				batch_ret.status = next_ret.status;
+			} else {
+				/*
+				 * Return the notifications we have now
+				 * and this status on the next call.
+				 */
+				notif_iter_data->pending_status =
+					next_ret.status;
+			}
+
+			break;
+		}
+
+		notifications[batch_ret.count] = next_ret.notification;
+		batch_ret.count++;
+	}
+
+end:
+	return batch_ret;
+}
+
 void ctf_fs_iterator_finalize(struct bt_private_connection_private_notification_iterator *it)
 {
 	void *notif_iter_data =
@@ -169,7 +323,8 @@ enum bt_notification_iterator_status ctf_fs_iterator_init(
 	notif_iter_data->notif_iter = bt_notif_iter_create(
 		port_data->ds_file_group->ctf_fs_trace->metadata->trace,
 		bt_common_get_page_size() * 8,
-		ctf_fs_ds_file_medops, NULL);
+		ctf_fs_ds_file_medops, NULL,
+		(const char * const *) port_data->ctf_fs->event_names);
 	if (!notif_iter_data->notif_iter) {
 		BT_LOGE_STR("Cannot create a CTF notification iterator.");
 		ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
@@ -177,7 +332,13 @@ enum bt_notification_iterator_status ctf_fs_iterator_init(
 	}
 
 	notif_iter_data->ds_file_group = port_data->ds_file_group;
-	iret = notif_iter_data_set_current_ds_file(notif_iter_data);
+	if (port_data->ctf_fs->has_begin_ns) {
+		iret = notif_iter_data_seek_ns(notif_iter_data,
+			port_data->ctf_fs->begin_ns);
+	} else {
+		iret = notif_iter_data_set_current_ds_file(notif_iter_data);
+	}
+
 	if (iret) {
 		ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
 		goto error;
@@ -214,6 +375,12 @@ void ctf_fs_destroy(struct ctf_fs_component *ctf_fs)
 		g_ptr_array_free(ctf_fs->port_data, TRUE);
 	}
 
+	if (ctf_fs->index_cache_dir) {
+		g_string_free(ctf_fs->index_cache_dir, TRUE);
+	}
+
+	g_strfreev(ctf_fs->event_names);
+
 	g_free(ctf_fs);
 }
 
@@ -236,6 +403,10 @@ void ctf_fs_trace_destroy(struct ctf_fs_trace *ctf_fs_trace)
 		g_string_free(ctf_fs_trace->name, TRUE);
 	}
 
+	if (ctf_fs_trace->index_cache_dir) {
+		g_string_free(ctf_fs_trace->index_cache_dir, TRUE);
+	}
+
 	if (ctf_fs_trace->metadata) {
 		ctf_fs_metadata_fini(ctf_fs_trace->metadata);
 		g_free(ctf_fs_trace->metadata);
@@ -318,6 +489,7 @@ int create_one_port_for_trace(struct ctf_fs_component *ctf_fs,
 	}
 
 	port_data->ds_file_group = ds_file_group;
+	port_data->ctf_fs = ctf_fs;
 	ret = bt_private_component_source_add_output_private_port(
 		ctf_fs->priv_comp, port_name->str, port_data, NULL);
 	if (ret) {
@@ -568,7 +740,8 @@ static
 int ctf_fs_ds_file_group_add_ds_file_info(
 		struct ctf_fs_ds_file_group *ds_file_group,
 		const char *path, uint64_t begin_ns,
-		struct ctf_fs_ds_index *index)
+		struct ctf_fs_ds_index *index,
+		struct ctf_fs_ds_file_info **added_ds_file_info)
 {
 	struct ctf_fs_ds_file_info *ds_file_info;
 	gint i = 0;
@@ -592,6 +765,11 @@ int ctf_fs_ds_file_group_add_ds_file_info(
 	}
 
 	array_insert(ds_file_group->ds_file_infos, ds_file_info, i);
+
+	if (added_ds_file_info) {
+		*added_ds_file_info = ds_file_info;
+	}
+
 	ds_file_info = NULL;
 	goto end;
 
@@ -603,9 +781,180 @@ end:
 	return ret;
 }
 
+/*
+ * Deferred indexing of a data stream file which has no usable index
+ * file, executed by a worker thread of the indexing thread pool.
+ *
+ * The worker thread only reads the packet header and context integers
+ * located by `layout`: it does not use any Babeltrace object, as their
+ * reference counts are not thread-safe.
+ */
+struct ds_file_index_job {
+	/* Owned by this */
+	GString *path;
+
+	/* Owned by this */
+	struct ctf_fs_ds_index_layout layout;
+
+	/* Owned by this; set by the worker thread, NULL on failure */
+	struct ctf_fs_ds_index *index;
+
+	/* Weak, belongs to its DS file group */
+	struct ctf_fs_ds_file_info *ds_file_info;
+
+	/* Data stream file's size, modification time, and inode number */
+	uint64_t file_size;
+	int64_t file_mtime_ns;
+	uint64_t file_inode;
+};
+
+static
+void ds_file_index_job_destroy(struct ds_file_index_job *job)
+{
+	if (!job) {
+		return;
+	}
+
+	if (job->path) {
+		g_string_free(job->path, TRUE);
+	}
+
+	ctf_fs_ds_index_layout_fini(&job->layout);
+	ctf_fs_ds_index_destroy(job->index);
+	g_free(job);
+}
+
+static
+struct ds_file_index_job *ds_file_index_job_create(
+		struct ctf_fs_ds_file *ds_file)
+{
+	struct ds_file_index_job *job = g_new0(struct ds_file_index_job, 1);
+
+	if (!job) {
+		goto error;
+	}
+
+	if (ctf_fs_ds_file_get_index_layout(ds_file, &job->layout)) {
+		/* Not an error: index this file serially */
+		g_free(job);
+		job = NULL;
+		goto end;
+	}
+
+	job->path = g_string_new(ds_file->file->path->str);
+	if (!job->path) {
+		goto error;
+	}
+
+	job->file_size = ds_file->file->size;
+	job->file_mtime_ns = ds_file->file->mtime_ns;
+	job->file_inode = ds_file->file->inode;
+
+	goto end;
+
+error:
+	ds_file_index_job_destroy(job);
+	job = NULL;
+
+end:
+	return job;
+}
+
+static
+void ds_file_index_job_func(gpointer data, gpointer user_data)
+{
+	struct ds_file_index_job *job = data;
+
+	job->index = ctf_fs_ds_index_build_with_layout(job->path->str,
+		&job->layout);
+}
+
+static
+struct ctf_fs_ds_index *build_ds_file_index_from_stream_file(
+		struct ctf_fs_trace *ctf_fs_trace, const char *path)
+{
+	struct ctf_fs_ds_file *ds_file = NULL;
+	struct ctf_fs_ds_index *index = NULL;
+	struct bt_notif_iter *notif_iter = NULL;
+
+	notif_iter = bt_notif_iter_create(ctf_fs_trace->metadata->trace,
+		bt_common_get_page_size() * 8, ctf_fs_ds_file_medops, NULL,
+		NULL);
+	if (!notif_iter) {
+		BT_LOGE_STR("Cannot create a CTF notification iterator.");
+		goto end;
+	}
+
+	ds_file = ctf_fs_ds_file_create(ctf_fs_trace, notif_iter, NULL, path);
+	if (!ds_file) {
+		goto end;
+	}
+
+	index = ctf_fs_ds_file_build_index_from_stream_file(ds_file);
+
+end:
+	ctf_fs_ds_file_destroy(ds_file);
+
+	if (notif_iter) {
+		bt_notif_iter_destroy(notif_iter);
+	}
+
+	return index;
+}
+
+/*
+ * Waits for the indexing jobs of `index_jobs` to complete and moves
+ * their index to their DS file info. If a worker thread could not
+ * index its data stream file, it is indexed again serially.
+ */
+static
+void complete_ds_file_index_jobs(struct ctf_fs_trace *ctf_fs_trace,
+		GThreadPool *index_pool, GPtrArray *index_jobs)
+{
+	size_t i;
+
+	g_thread_pool_free(index_pool, FALSE, TRUE);
+
+	for (i = 0; i < index_jobs->len; i++) {
+		struct ds_file_index_job *job =
+			g_ptr_array_index(index_jobs, i);
+
+		if (job->index && ctf_fs_ds_index_set_timestamps_ns(
+				job->index, &job->layout)) {
+			ctf_fs_ds_index_destroy(job->index);
+			job->index = NULL;
+		}
+
+		if (!job->index) {
+			BT_LOGD("Failed to index data stream file from its packet header and context layout; "
+				"falling back to stream indexing: path=\"%s\"",
+				job->path->str);
+			job->index = build_ds_file_index_from_stream_file(
+				ctf_fs_trace, job->path->str);
+			if (!job->index) {
+				BT_LOGW("Failed to index CTF stream file \'%s\'",
+					job->path->str);
+			}
+		}
+
+		if (job->index && ctf_fs_trace->index_cache_dir) {
+			(void) ctf_fs_ds_index_cache_save(
+				ctf_fs_trace->index_cache_dir->str,
+				job->path->str, job->file_size,
+				job->file_mtime_ns, job->file_inode,
+				job->index);
+		}
+
+		assert(!job->ds_file_info->index);
+		job->ds_file_info->index = job->index;
+		job->index = NULL;
+	}
+}
+
 static
 int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
-		const char *path)
+		const char *path, GThreadPool *index_pool,
+		GPtrArray *index_jobs)
 {
 	struct bt_field *packet_header_field = NULL;
 	struct bt_field *packet_context_field = NULL;
@@ -619,9 +968,12 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 	struct ctf_fs_ds_file *ds_file = NULL;
 	struct ctf_fs_ds_index *index = NULL;
 	struct bt_notif_iter *notif_iter = NULL;
+	struct ds_file_index_job *index_job = NULL;
+	struct ctf_fs_ds_file_info *ds_file_info = NULL;
 
 	notif_iter = bt_notif_iter_create(ctf_fs_trace->metadata->trace,
-		bt_common_get_page_size() * 8, ctf_fs_ds_file_medops, NULL);
+		bt_common_get_page_size() * 8, ctf_fs_ds_file_medops, NULL,
+		NULL);
 	if (!notif_iter) {
 		BT_LOGE_STR("Cannot create a CTF notification iterator.");
 		goto error;
@@ -650,10 +1002,29 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		goto error;
 	}
 
-	index = ctf_fs_ds_file_build_index(ds_file);
-	if (!index) {
-		BT_LOGW("Failed to index CTF stream file \'%s\'",
-			ds_file->file->path->str);
+	if (index_pool) {
+		/*
+		 * Use the index file or the cached index if there's
+		 * one; otherwise defer
+		 * the indexing of this file to the thread pool if its
+		 * packet header and context have a fixed layout.
+		 */
+		index = ctf_fs_ds_file_build_index_from_idx_file(ds_file);
+		if (!index) {
+			index = ctf_fs_ds_file_build_index_from_cache(ds_file);
+		}
+
+		if (!index) {
+			index_job = ds_file_index_job_create(ds_file);
+		}
+	}
+
+	if (!index && !index_job) {
+		index = ctf_fs_ds_file_build_index(ds_file);
+		if (!index) {
+			BT_LOGW("Failed to index CTF stream file \'%s\'",
+				ds_file->file->path->str);
+		}
 	}
 
 	if (begin_ns == -1ULL) {
@@ -680,7 +1051,7 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		}
 
 		ret = ctf_fs_ds_file_group_add_ds_file_info(ds_file_group,
-			path, begin_ns, index);
+			path, begin_ns, index, &ds_file_info);
 		/* Ownership of index is transferred. */
 		index = NULL;
 		if (ret) {
@@ -688,7 +1059,7 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		}
 
 		add_group = true;
-		goto end;
+		goto push_index_job;
 	}
 
 	assert(stream_instance_id != -1ULL);
@@ -719,12 +1090,31 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 	}
 
 	ret = ctf_fs_ds_file_group_add_ds_file_info(ds_file_group, path,
-		begin_ns, index);
+		begin_ns, index, &ds_file_info);
 	index = NULL;
 	if (ret) {
 		goto error;
 	}
 
+push_index_job:
+	if (index_job) {
+		GError *error = NULL;
+
+		index_job->ds_file_info = ds_file_info;
+		g_ptr_array_add(index_jobs, index_job);
+		if (!g_thread_pool_push(index_pool, index_job, &error)) {
+			/*
+			 * The job is in `index_jobs`: it will be indexed
+			 * serially by complete_ds_file_index_jobs().
+			 */
+			BT_LOGW("Cannot push indexing job to thread pool: %s",
+				error->message);
+			g_error_free(error);
+		}
+
+		index_job = NULL;
+	}
+
 	goto end;
 
 error:
@@ -743,6 +1133,7 @@ end:
 	}
 
 	ctf_fs_ds_index_destroy(index);
+	ds_file_index_job_destroy(index_job);
 	bt_put(packet_header_field);
 	bt_put(packet_context_field);
 	bt_put(stream_class);
@@ -750,14 +1141,46 @@ end:
 }
 
 static
-int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
+int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace,
+		unsigned int index_thread_count)
 {
 	int ret = 0;
 	const char *basename;
 	GError *error = NULL;
 	GDir *dir = NULL;
+	GThreadPool *index_pool = NULL;
+	GPtrArray *index_jobs = NULL;
 	size_t i;
 
+	if (index_thread_count > 1) {
+#if !GLIB_CHECK_VERSION(2, 32, 0)
+		if (!g_thread_supported()) {
+			g_thread_init(NULL);
+		}
+#endif
+
+		index_jobs = g_ptr_array_new_with_free_func(
+			(GDestroyNotify) ds_file_index_job_destroy);
+		if (!index_jobs) {
+			BT_LOGE_STR("Failed to allocate a GPtrArray.");
+			goto error;
+		}
+
+		index_pool = g_thread_pool_new(ds_file_index_job_func, NULL,
+			index_thread_count, FALSE, &error);
+		if (!index_pool) {
+			BT_LOGW("Cannot create indexing thread pool; "
+				"indexing data stream files serially: %s",
+				error->message);
+			g_error_free(error);
+			error = NULL;
+		} else {
+			BT_LOGD("Created indexing thread pool: "
+				"trace-path=\"%s\", thread-count=%u",
+				ctf_fs_trace->path->str, index_thread_count);
+		}
+	}
+
 	/* Check each file in the path directory, except specific ones */
 	dir = g_dir_open(ctf_fs_trace->path->str, 0, &error);
 	if (!dir) {
@@ -816,7 +1239,7 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 		}
 
 		ret = add_ds_file_to_ds_file_group(ctf_fs_trace,
-			file->path->str);
+			file->path->str, index_pool, index_jobs);
 		if (ret) {
 			BT_LOGE("Cannot add stream file `%s` to stream file group",
 				file->path->str);
@@ -827,6 +1250,12 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 		ctf_fs_file_destroy(file);
 	}
 
+	if (index_pool) {
+		complete_ds_file_index_jobs(ctf_fs_trace, index_pool,
+			index_jobs);
+		index_pool = NULL;
+	}
+
 	/*
 	 * At this point, DS file groupes are created, but their
 	 * associated stream objects do not exist yet. This is because
@@ -870,6 +1299,15 @@ error:
 	ret = -1;
 
 end:
+	if (index_pool) {
+		/* Error: do not start the remaining jobs */
+		g_thread_pool_free(index_pool, TRUE, TRUE);
+	}
+
+	if (index_jobs) {
+		g_ptr_array_free(index_jobs, TRUE);
+	}
+
 	if (dir) {
 		g_dir_close(dir);
 		dir = NULL;
@@ -921,7 +1359,8 @@ end:
 
 BT_HIDDEN
 struct ctf_fs_trace *ctf_fs_trace_create(const char *path, const char *name,
-		struct ctf_fs_metadata_config *metadata_config)
+		struct ctf_fs_metadata_config *metadata_config,
+		unsigned int index_thread_count, const char *index_cache_dir)
 {
 	struct ctf_fs_trace *ctf_fs_trace;
 	int ret;
@@ -941,6 +1380,13 @@ struct ctf_fs_trace *ctf_fs_trace_create(const char *path, const char *name,
 		goto error;
 	}
 
+	if (index_cache_dir) {
+		ctf_fs_trace->index_cache_dir = g_string_new(index_cache_dir);
+		if (!ctf_fs_trace->index_cache_dir) {
+			goto error;
+		}
+	}
+
 	ctf_fs_trace->metadata = g_new0(struct ctf_fs_metadata, 1);
 	if (!ctf_fs_trace->metadata) {
 		goto error;
@@ -957,7 +1403,7 @@ struct ctf_fs_trace *ctf_fs_trace_create(const char *path, const char *name,
 		goto error;
 	}
 
-	ret = create_ds_file_groups(ctf_fs_trace);
+	ret = create_ds_file_groups(ctf_fs_trace, index_thread_count);
 	if (ret) {
 		goto error;
 	}
@@ -1205,7 +1651,10 @@ int create_ctf_fs_traces(struct ctf_fs_component *ctf_fs,
 		GString *trace_name = tn_node->data;
 
 		ctf_fs_trace = ctf_fs_trace_create(trace_path->str,
-				trace_name->str, &ctf_fs->metadata_config);
+				trace_name->str, &ctf_fs->metadata_config,
+				ctf_fs->index_thread_count,
+				ctf_fs->index_cache_dir ?
+					ctf_fs->index_cache_dir->str : NULL);
 		if (!ctf_fs_trace) {
 			BT_LOGE("Cannot create trace for `%s`.",
 				trace_path->str);
@@ -1311,6 +1760,74 @@ struct ctf_fs_component *ctf_fs_create(struct bt_private_component *priv_comp,
 		BT_PUT(value);
 	}
 
+	ctf_fs->index_thread_count = bt_common_get_online_cpu_count();
+	value = bt_value_map_get(params, "index-thread-count");
+	if (value) {
+		int64_t index_thread_count;
+
+		if (!bt_value_is_integer(value)) {
+			BT_LOGE("index-thread-count should be an integer");
+			goto error;
+		}
+		value_ret = bt_value_integer_get(value, &index_thread_count);
+		assert(value_ret == BT_VALUE_STATUS_OK);
+		BT_PUT(value);
+
+		if (index_thread_count < 1 || index_thread_count > UINT_MAX) {
+			BT_LOGE("index-thread-count is out of range: "
+				"value=%" PRId64, index_thread_count);
+			goto error;
+		}
+
+		ctf_fs->index_thread_count = (unsigned int) index_thread_count;
+	}
+
+	value = bt_value_map_get(params, "begin-ns");
+	if (value) {
+		if (!bt_value_is_integer(value)) {
+			BT_LOGE("begin-ns should be an integer");
+			goto error;
+		}
+		value_ret = bt_value_integer_get(value, &ctf_fs->begin_ns);
+		assert(value_ret == BT_VALUE_STATUS_OK);
+		ctf_fs->has_begin_ns = true;
+		BT_PUT(value);
+	}
+
+	value = bt_value_map_get(params, "event-names");
+	if (value) {
+		const char *event_names;
+
+		if (!bt_value_is_string(value)) {
+			BT_LOGE("event-names should be a string");
+			goto error;
+		}
+		value_ret = bt_value_string_get(value, &event_names);
+		assert(value_ret == BT_VALUE_STATUS_OK);
+		ctf_fs->event_names = g_strsplit(event_names, ",", -1);
+		BT_PUT(value);
+	}
+
+	value = bt_value_map_get(params, "index-cache-dir");
+	if (value) {
+		const char *index_cache_dir;
+
+		if (!bt_value_is_string(value)) {
+			BT_LOGE("index-cache-dir should be a string");
+			goto error;
+		}
+		value_ret = bt_value_string_get(value, &index_cache_dir);
+		assert(value_ret == BT_VALUE_STATUS_OK);
+		ctf_fs->index_cache_dir = bt_common_normalize_path(
+			index_cache_dir, NULL);
+		if (!ctf_fs->index_cache_dir) {
+			BT_LOGE("Failed to normalize path: `%s`.",
+				index_cache_dir);
+			goto error;
+		}
+		BT_PUT(value);
+	}
+
 	ctf_fs->port_data = g_ptr_array_new_with_free_func(port_data_destroy);
 	if (!ctf_fs->port_data) {
 		goto error;
@@ -45,6 +45,12 @@ struct ctf_fs_file {
 	FILE *fp;
 
 	off_t size;
+
+	/* Last modification time (nanoseconds since Epoch) */
+	int64_t mtime_ns;
+
+	/* Inode number */
+	uint64_t inode;
 };
 
 struct ctf_fs_metadata {
@@ -70,6 +76,30 @@ struct ctf_fs_component {
 	GPtrArray *traces;
 
 	struct ctf_fs_metadata_config metadata_config;
+
+	/*
+	 * Maximum number of threads to use to index the data stream
+	 * files of a trace; 1 means index them serially.
+	 */
+	unsigned int index_thread_count;
+
+	/* Owned by this; NULL means no index cache */
+	GString *index_cache_dir;
+
+	/*
+	 * If `has_begin_ns` is true, the notification iterators skip,
+	 * using the data stream file indexes, the packets which end
+	 * before `begin_ns` (ns since Epoch).
+	 */
+	bool has_begin_ns;
+	int64_t begin_ns;
+
+	/*
+	 * NULL-terminated array of the names of the event classes of
+	 * which to emit the events, or NULL to emit all the events
+	 * (owned by this).
+	 */
+	gchar **event_names;
 };
 
 struct ctf_fs_trace {
@@ -87,6 +117,12 @@ struct ctf_fs_trace {
 
 	/* Owned by this */
 	GString *name;
+
+	/*
+	 * Owned by this; directory of the cached data stream file
+	 * indexes, or NULL to not use an index cache
+	 */
+	GString *index_cache_dir;
 };
 
 struct ctf_fs_ds_file_group {
@@ -117,6 +153,9 @@ struct ctf_fs_ds_file_group {
 struct ctf_fs_port_data {
 	/* Weak, belongs to ctf_fs_trace */
 	struct ctf_fs_ds_file_group *ds_file_group;
+
+	/* Weak */
+	struct ctf_fs_component *ctf_fs;
 };
 
 struct ctf_fs_notif_iter_data {
@@ -131,6 +170,12 @@ struct ctf_fs_notif_iter_data {
 
 	/* Owned by this */
 	struct bt_notif_iter *notif_iter;
+
+	/*
+	 * Status to return by the next call of the "next batch" method
+	 * (BT_NOTIFICATION_ITERATOR_STATUS_OK means none).
+	 */
+	enum bt_notification_iterator_status pending_status;
 };
 
 BT_HIDDEN
@@ -148,7 +193,8 @@ struct bt_component_class_query_method_return ctf_fs_query(
 
 BT_HIDDEN
 struct ctf_fs_trace *ctf_fs_trace_create(const char *path, const char *name,
-		struct ctf_fs_metadata_config *config);
+		struct ctf_fs_metadata_config *config,
+		unsigned int index_thread_count, const char *index_cache_dir);
 
 BT_HIDDEN
 void ctf_fs_trace_destroy(struct ctf_fs_trace *trace);
@@ -170,4 +216,9 @@ BT_HIDDEN
 struct bt_notification_iterator_next_method_return ctf_fs_iterator_next(
 		struct bt_private_connection_private_notification_iterator *iterator);
 
+BT_HIDDEN
+struct bt_notification_iterator_next_batch_method_return ctf_fs_iterator_next_batch(
+		struct bt_private_connection_private_notification_iterator *iterator,
+		struct bt_notification **notifications, uint64_t capacity);
+
 #endif /* BABELTRACE_PLUGIN_CTF_FS_H */
@@ -0,0 +1,69 @@
+#ifndef CTF_FS_INDEX_CACHE_H
+#define CTF_FS_INDEX_CACHE_H
+
+/*
+ * Copyright 2017 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+
+/*
+ * A cached data stream file index is named after the SHA-1 checksum
+ * of the data stream file's absolute path, with this suffix, within
+ * the index cache directory.
+ */
+#define CTF_FS_INDEX_CACHE_FILE_SUFFIX	".btidx"
+
+#define CTF_FS_INDEX_CACHE_MAGIC	0xB7C1DCC1
+#define CTF_FS_INDEX_CACHE_VERSION	2
+
+/*
+ * Header at the beginning of each cached index file.
+ * All integer fields are stored in big endian.
+ *
+ * The cached index is only valid if the current size, modification
+ * time, and inode number of the data stream file are `file_size`,
+ * `file_mtime_ns`, and `file_inode`.
+ */
+struct ctf_fs_index_cache_file_hdr {
+	uint32_t magic;
+	uint32_t version;
+	/* size of struct ctf_fs_index_cache_entry, in bytes. */
+	uint32_t entry_len;
+	uint32_t reserved;
+	uint64_t file_size;		/* data stream file size, in bytes */
+	int64_t file_mtime_ns;		/* nanoseconds since Epoch */
+	uint64_t file_inode;		/* data stream file inode number */
+	uint64_t entry_count;
+} __attribute__((__packed__));
+
+/*
+ * Cached index entry of a packet.
+ * All integer fields are stored in big endian.
+ */
+struct ctf_fs_index_cache_entry {
+	uint64_t offset;		/* offset of the packet in the file, in bytes */
+	uint64_t packet_size;		/* packet size, in bytes */
+	uint64_t timestamp_begin;	/* cycles */
+	uint64_t timestamp_end;		/* cycles */
+} __attribute__((__packed__));
+
+#endif /* CTF_FS_INDEX_CACHE_H */
@@ -344,7 +344,7 @@ end:
 
 static
 int populate_trace_info(const char *trace_path, const char *trace_name,
-		struct bt_value *trace_info)
+		const char *index_cache_dir, struct bt_value *trace_info)
 {
 	int ret = 0;
 	size_t group_idx;
@@ -380,7 +380,8 @@ int populate_trace_info(const char *trace_path, const char *trace_name,
 		goto end;
 	}
 
-	trace = ctf_fs_trace_create(trace_path, trace_name, NULL);
+	trace = ctf_fs_trace_create(trace_path, trace_name, NULL, 1,
+		index_cache_dir);
 	if (!trace) {
 		BT_LOGE("Failed to create fs trace at \'%s\'", trace_path);
 		ret = -1;
@@ -471,6 +472,7 @@ struct bt_component_class_query_method_return trace_info_query(
 	};
 
 	struct bt_value *path_value = NULL;
+	struct bt_value *index_cache_dir_value = NULL;
 	int ret = 0;
 	const char *path = NULL;
 	GList *trace_paths = NULL;
@@ -478,6 +480,7 @@ struct bt_component_class_query_method_return trace_info_query(
 	GList *tp_node = NULL;
 	GList *tn_node = NULL;
 	GString *normalized_path = NULL;
+	GString *normalized_index_cache_dir = NULL;
 
 	if (!bt_value_is_map(params)) {
 		BT_LOGE("Query parameters is not a map value object.");
@@ -500,6 +503,27 @@ struct bt_component_class_query_method_return trace_info_query(
 	}
 	assert(path);
 
+	index_cache_dir_value = bt_value_map_get(params, "index-cache-dir");
+	if (index_cache_dir_value) {
+		const char *index_cache_dir;
+
+		ret = bt_value_string_get(index_cache_dir_value,
+			&index_cache_dir);
+		if (ret) {
+			BT_LOGE("Cannot get `index-cache-dir` string parameter.");
+			query_ret.status = BT_QUERY_STATUS_INVALID_PARAMS;
+			goto error;
+		}
+
+		normalized_index_cache_dir = bt_common_normalize_path(
+			index_cache_dir, NULL);
+		if (!normalized_index_cache_dir) {
+			BT_LOGE("Failed to normalize path: `%s`.",
+				index_cache_dir);
+			goto error;
+		}
+	}
+
 	ret = ctf_fs_find_traces(&trace_paths, normalized_path->str);
 	if (ret) {
 		goto error;
@@ -534,6 +558,8 @@ struct bt_component_class_query_method_return trace_info_query(
 		}
 
 		ret = populate_trace_info(trace_path->str, trace_name->str,
+			normalized_index_cache_dir ?
+				normalized_index_cache_dir->str : NULL,
 			trace_info);
 		if (ret) {
 			bt_put(trace_info);
@@ -560,6 +586,9 @@ end:
 	if (normalized_path) {
 		g_string_free(normalized_path, TRUE);
 	}
+	if (normalized_index_cache_dir) {
+		g_string_free(normalized_index_cache_dir, TRUE);
+	}
 	if (trace_paths) {
 		for (tp_node = trace_paths; tp_node; tp_node = g_list_next(tp_node)) {
 			if (tp_node->data) {
@@ -578,5 +607,6 @@ end:
 	}
 	/* "path" becomes invalid with the release of path_value. */
 	bt_put(path_value);
+	bt_put(index_cache_dir_value);
 	return query_ret;
 }
@@ -130,7 +130,8 @@ enum bt_lttng_live_iterator_status lttng_live_lazy_notif_init(
 			}
 			stream->notif_iter = bt_notif_iter_create(trace->trace,
 					lttng_live->max_query_size, medops,
-					stream);
+					stream, (const char * const *)
+						lttng_live->event_names);
 			if (!stream->notif_iter) {
 				goto error;
 			}
@@ -157,6 +158,11 @@ struct lttng_live_stream_iterator *lttng_live_stream_iterator_create(
 	struct lttng_live_trace *trace;
 	int ret;
 
+	stream->prefetched_packets = g_queue_new();
+	if (!stream->prefetched_packets) {
+		goto error;
+	}
+
 	trace = lttng_live_ref_trace(session, ctf_trace_id);
 	if (!trace) {
 		goto error;
@@ -172,7 +178,8 @@ struct lttng_live_stream_iterator *lttng_live_stream_iterator_create(
 	if (trace->trace) {
 		stream->notif_iter = bt_notif_iter_create(trace->trace,
 				lttng_live->max_query_size, medops,
-				stream);
+				stream,
+				(const char * const *) lttng_live->event_names);
 		if (!stream->notif_iter) {
 			goto error;
 		}
@@ -215,6 +222,13 @@ void lttng_live_stream_iterator_destroy(struct lttng_live_stream_iterator *strea
 	if (stream->notif_iter) {
 		bt_notif_iter_destroy(stream->notif_iter);
 	}
+	if (lttng_live->viewer_connection) {
+		lttng_live_cancel_stream_requests(lttng_live->viewer_connection,
+			stream);
+	}
+	if (stream->prefetched_packets) {
+		g_queue_free(stream->prefetched_packets);
+	}
 	g_free(stream->buf);
 	BT_PUT(stream->packet_end_notif_queue);
 	bt_list_del(&stream->node);
@@ -33,18 +33,26 @@
 #include <babeltrace/babeltrace-internal.h>
 #include <babeltrace/babeltrace.h>
 #include "viewer-connection.h"
+#include "lttng-viewer-abi.h"
 
 //TODO: this should not be used by plugins. Should copy code into plugin
 //instead.
 #include "babeltrace/object-internal.h"
 #include "babeltrace/list-internal.h"
 #include "../common/metadata/decoder.h"
+#include "../common/notif-iter/notif-iter.h"
 
 #define STREAM_NAME_PREFIX	"stream-"
 /* Account for u64 max string length. */
 #define U64_STR_MAX_LEN		20
 #define STREAM_NAME_MAX_LEN	(sizeof(STREAM_NAME_PREFIX) + U64_STR_MAX_LEN)
 
+/*
+ * Maximum number of pipelined GET_PACKET requests of a stream of which
+ * the replies are not consumed yet.
+ */
+#define LTTNG_LIVE_MAX_PREFETCHED_PACKETS	8
+
 struct lttng_live_component;
 struct lttng_live_session;
 
@@ -65,6 +73,14 @@ struct lttng_live_stream_iterator_generic {
 	enum live_stream_type type;
 };
 
+/* Reply to a pipelined GET_PACKET request. */
+struct lttng_live_prefetched_packet {
+	enum bt_notif_iter_medium_status status;
+	uint64_t offset;	/* offset of `data` in the stream, in bytes */
+	size_t pos;		/* consumed bytes of `data` */
+	GByteArray *data;
+};
+
 /* Iterator over a live stream. */
 struct lttng_live_stream_iterator {
 	struct lttng_live_stream_iterator_generic p;
@@ -100,6 +116,33 @@ struct lttng_live_stream_iterator {
 	uint8_t *buf;
 	size_t buflen;
 
+	/*
+	 * Received replies to the pipelined GET_PACKET requests of this
+	 * stream, in stream order (struct lttng_live_prefetched_packet *).
+	 */
+	GQueue *prefetched_packets;
+	/* Number of sent GET_PACKET requests of which the reply is pending. */
+	unsigned int pending_packet_requests;
+	/* Offset of the next GET_PACKET request, in bytes. */
+	uint64_t prefetch_offset;
+	/*
+	 * Incremented when the prefetched packets are dropped: the
+	 * replies to the requests sent before are then discarded.
+	 */
+	uint64_t prefetch_gen;
+
+	/*
+	 * The last data request returned "try again" because the reply
+	 * to a pipelined request is not received yet.
+	 */
+	bool waiting_for_data;
+
+	/* A GET_NEXT_INDEX request is sent and its reply is pending. */
+	bool next_index_requested;
+	/* `prefetched_index` is a reply to a pipelined GET_NEXT_INDEX. */
+	bool has_prefetched_index;
+	struct lttng_viewer_index prefetched_index;
+
 	char name[STREAM_NAME_MAX_LEN];
 };
 
@@ -120,7 +163,10 @@ struct lttng_live_metadata {
 	uint8_t uuid[16];
 	bool is_uuid_set;
 	int bo;
+
+	/* Received metadata which is not decoded yet (incomplete). */
 	char *text;
+	size_t text_len;
 
 	struct ctf_metadata_decoder *decoder;
 
@@ -182,6 +228,13 @@ struct lttng_live_component {
 
 	GString *url;
 	size_t max_query_size;
+
+	/*
+	 * NULL-terminated array of the names of the event classes of
+	 * which to emit the events, or NULL to emit all the events
+	 * (owned by this).
+	 */
+	gchar **event_names;
 	struct lttng_live_component_options options;
 
 	struct bt_private_port *no_stream_port;	/* weak */
@@ -254,6 +307,9 @@ enum bt_notif_iter_medium_status lttng_live_get_stream_bytes(
 		struct lttng_live_component *lttng_live,
 		struct lttng_live_stream_iterator *stream, uint8_t *buf, uint64_t offset,
 		uint64_t req_len, uint64_t *recv_len);
+void lttng_live_cancel_stream_requests(
+		struct bt_live_viewer_connection *viewer_connection,
+		struct lttng_live_stream_iterator *stream);
 
 int lttng_live_add_port(struct lttng_live_component *lttng_live,
 		struct lttng_live_stream_iterator *stream_iter);
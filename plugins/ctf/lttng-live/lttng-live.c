@@ -689,6 +689,16 @@ enum bt_lttng_live_iterator_status lttng_live_iterator_next_handle_one_active_da
 		ret = BT_LTTNG_LIVE_ITERATOR_STATUS_OK;
 		break;
 	case BT_NOTIF_ITER_STATUS_AGAIN:
+		if (lttng_live_stream->waiting_for_data) {
+			/*
+			 * The requested data is on its way: let the
+			 * graph wait for the viewer socket.
+			 */
+			lttng_live_stream->waiting_for_data = false;
+			ret = BT_LTTNG_LIVE_ITERATOR_STATUS_AGAIN;
+			break;
+		}
+
 		/*
 		 * Continue immediately (end of packet). The next
 		 * get_index may return AGAIN to delay the following
@@ -1032,10 +1042,18 @@ void lttng_live_component_destroy_data(struct lttng_live_component *lttng_live)
 	bt_list_for_each_entry_safe(session, s, &lttng_live->sessions, node) {
 		lttng_live_destroy_session(session);
 	}
+#ifndef __MINGW32__
+	if (lttng_live->private_component && lttng_live->viewer_connection) {
+		(void) bt_private_component_remove_wait_fd(
+			lttng_live->private_component,
+			lttng_live->viewer_connection->control_sock);
+	}
+#endif
 	BT_PUT(lttng_live->viewer_connection);
 	if (lttng_live->url) {
 		g_string_free(lttng_live->url, TRUE);
 	}
+	g_strfreev(lttng_live->event_names);
 	if (lttng_live->no_stream_port) {
 		bt_get(lttng_live->no_stream_port);
 		ret = bt_private_port_remove_from_component(lttng_live->no_stream_port);
@@ -1090,6 +1108,18 @@ struct lttng_live_component *lttng_live_component_create(struct bt_value *params
 		goto error;
 	}
 	BT_PUT(value);
+	value = bt_value_map_get(params, "event-names");
+	if (value) {
+		const char *event_names;
+
+		ret = bt_value_string_get(value, &event_names);
+		if (ret != BT_VALUE_STATUS_OK) {
+			BT_LOGW("\"event-names\" parameter is required to be a string value");
+			goto error;
+		}
+		lttng_live->event_names = g_strsplit(event_names, ",", -1);
+		BT_PUT(value);
+	}
 	lttng_live->viewer_connection =
 		bt_live_viewer_connection_create(lttng_live->url->str, lttng_live);
 	if (!lttng_live->viewer_connection) {
@@ -1100,6 +1130,14 @@ struct lttng_live_component *lttng_live_component_create(struct bt_value *params
 	}
 	lttng_live->private_component = private_component;
 
+#ifndef __MINGW32__
+	/* The graph can wait for the replies of the relay daemon. */
+	if (bt_private_component_add_wait_fd(private_component,
+			lttng_live->viewer_connection->control_sock)) {
+		goto error;
+	}
+#endif
+
 	goto end;
 
 error:
@@ -40,6 +40,13 @@
 
 #define TSDL_MAGIC	0x75d11d57
 
+/*
+ * Maximum length of received metadata which the decoder reports as
+ * incomplete: a single metadata block is never this large, so larger
+ * pending metadata means that it cannot be decoded.
+ */
+#define MAX_PENDING_METADATA_LEN	(16 * 1024 * 1024)
+
 struct packet_header {
 	uint32_t magic;
 	uint8_t  uuid[16];
@@ -62,15 +69,26 @@ enum bt_lttng_live_iterator_status lttng_live_update_clock_map(
 	size_t i;
 	int count, ret;
 
+	count = bt_trace_get_clock_class_count(trace->trace);
+	assert(count >= 0);
+
+	/*
+	 * Clock classes are never removed from a trace: keep the
+	 * current map, which notifications can share, if the new
+	 * metadata did not add any.
+	 */
+	if (trace->cc_prio_map &&
+			bt_clock_class_priority_map_get_clock_class_count(
+				trace->cc_prio_map) == count) {
+		goto end;
+	}
+
 	BT_PUT(trace->cc_prio_map);
 	trace->cc_prio_map = bt_clock_class_priority_map_create();
 	if (!trace->cc_prio_map) {
 		goto error;
 	}
 
-	count = bt_trace_get_clock_class_count(trace->trace);
-	assert(count >= 0);
-
 	for (i = 0; i < count; i++) {
 		struct bt_clock_class *clock_class =
 			bt_trace_get_clock_class_by_index(trace->trace, i);
@@ -132,6 +150,16 @@ enum bt_lttng_live_iterator_status lttng_live_metadata_update(
 		goto error;
 	}
 
+	/* Start with the incomplete metadata of the previous update. */
+	if (metadata->text_len > 0) {
+		if (fwrite(metadata->text, 1, metadata->text_len, fp) !=
+				metadata->text_len) {
+			BT_LOGE("Cannot write pending metadata: %s",
+				strerror(errno));
+			goto error;
+		}
+	}
+
 	/* Grab all available metadata. */
 	do {
 		/*
@@ -185,7 +213,7 @@ enum bt_lttng_live_iterator_status lttng_live_metadata_update(
 		goto end;
 	}
 
-	fp = bt_fmemopen(metadata_buf, len_read, "rb");
+	fp = bt_fmemopen(metadata_buf, metadata->text_len + len_read, "rb");
 	if (!fp) {
 		BT_LOGE("Cannot memory-open metadata buffer: %s",
 			strerror(errno));
@@ -195,8 +223,18 @@ enum bt_lttng_live_iterator_status lttng_live_metadata_update(
 	decoder_status = ctf_metadata_decoder_decode(metadata->decoder, fp);
 	switch (decoder_status) {
 	case CTF_METADATA_DECODER_STATUS_OK:
-		BT_PUT(trace->trace);
-		trace->trace = ctf_metadata_decoder_get_trace(metadata->decoder);
+		free(metadata->text);
+		metadata->text = NULL;
+		metadata->text_len = 0;
+
+		/*
+		 * The decoder adds the new classes to its trace, which
+		 * remains the same object.
+		 */
+		if (!trace->trace) {
+			trace->trace = ctf_metadata_decoder_get_trace(
+				metadata->decoder);
+		}
 		trace->new_metadata_needed = false;
 		status = lttng_live_update_clock_map(trace);
 		if (status != BT_LTTNG_LIVE_ITERATOR_STATUS_OK) {
@@ -204,6 +242,19 @@ enum bt_lttng_live_iterator_status lttng_live_metadata_update(
 		}
 		break;
 	case CTF_METADATA_DECODER_STATUS_INCOMPLETE:
+		if (metadata->text_len + len_read > MAX_PENDING_METADATA_LEN) {
+			BT_LOGE("Incomplete metadata is too large: "
+				"len=%zu, max-len=%d",
+				metadata->text_len + len_read,
+				MAX_PENDING_METADATA_LEN);
+			goto error;
+		}
+
+		/* Decode it again with the next received metadata. */
+		free(metadata->text);
+		metadata->text = metadata_buf;
+		metadata->text_len += len_read;
+		metadata_buf = NULL;
 		status = BT_LTTNG_LIVE_ITERATOR_STATUS_AGAIN;
 		break;
 	case CTF_METADATA_DECODER_STATUS_ERROR:
@@ -45,59 +45,512 @@
 #include "data-stream.h"
 #include "metadata.h"
 
+/*
+ * Returns whether or not an I/O operation on the viewer socket which
+ * failed can be tried again, waiting for the socket to be ready first
+ * if it is non-blocking.
+ */
+static bool lttng_live_retry_io(struct bt_live_viewer_connection *viewer_connection,
+		bool writable)
+{
+	if (bt_socket_would_block()) {
+		if (bt_socket_wait(viewer_connection->control_sock,
+				writable) != BT_SOCKET_ERROR) {
+			return true;
+		}
+	}
+
+	return bt_socket_interrupted() &&
+		!lttng_live_is_canceled(viewer_connection->lttng_live);
+}
+
+/*
+ * Receives exactly `len` bytes, waiting for them if needed.
+ */
 static ssize_t lttng_live_recv(struct bt_live_viewer_connection *viewer_connection,
 		void *buf, size_t len)
 {
-	ssize_t ret;
+	ssize_t ret = BT_SOCKET_ERROR;
 	size_t copied = 0, to_copy = len;
-	struct lttng_live_component *lttng_live =
-			viewer_connection->lttng_live;
 	BT_SOCKET sock = viewer_connection->control_sock;
 
-	do {
+	while (to_copy > 0) {
 		ret = bt_socket_recv(sock, buf + copied, to_copy, 0);
 		if (ret > 0) {
 			assert(ret <= to_copy);
 			copied += ret;
 			to_copy -= ret;
+			continue;
 		}
-		if (ret == BT_SOCKET_ERROR && bt_socket_interrupted()) {
-			if (lttng_live_is_canceled(lttng_live)) {
-				break;
-			} else {
-				continue;
-			}
+		if (ret == BT_SOCKET_ERROR &&
+				lttng_live_retry_io(viewer_connection, false)) {
+			continue;
 		}
-	} while (ret > 0 && to_copy > 0);
+		break;
+	}
 	if (ret > 0)
 		ret = copied;
 	/* ret = 0 means orderly shutdown, ret == BT_SOCKET_ERROR is error. */
 	return ret;
 }
 
-static ssize_t lttng_live_send(struct bt_live_viewer_connection *viewer_connection,
+/*
+ * Sends exactly `len` bytes, without receiving the replies to the
+ * pending requests first.
+ */
+static ssize_t lttng_live_send_nowait(struct bt_live_viewer_connection *viewer_connection,
 		const void *buf, size_t len)
 {
-	struct lttng_live_component *lttng_live =
-			viewer_connection->lttng_live;
 	BT_SOCKET sock = viewer_connection->control_sock;
-	ssize_t ret;
-
-	for (;;) {
-		ret = bt_socket_send_nosigpipe(sock, buf, len);
-		if (ret == BT_SOCKET_ERROR && bt_socket_interrupted()) {
-			if (lttng_live_is_canceled(lttng_live)) {
-				break;
-			} else {
-				continue;
-			}
-		} else {
+	ssize_t ret = BT_SOCKET_ERROR;
+	size_t sent = 0;
+
+	while (sent < len) {
+		ret = bt_socket_send_nosigpipe(sock, buf + sent, len - sent);
+		if (ret >= 0) {
+			sent += ret;
+			continue;
+		}
+		if (lttng_live_retry_io(viewer_connection, true)) {
+			continue;
+		}
+		break;
+	}
+	if (ret >= 0)
+		ret = sent;
+	return ret;
+}
+
+static
+void free_prefetched_packet(struct lttng_live_prefetched_packet *packet)
+{
+	if (!packet) {
+		return;
+	}
+
+	if (packet->data) {
+		g_byte_array_free(packet->data, TRUE);
+	}
+	g_free(packet);
+}
+
+/*
+ * Drops the prefetched packet data of a stream, and makes sure the
+ * replies to its GET_PACKET requests which are still pending are
+ * discarded when received.
+ */
+static
+void drop_prefetched_packets(struct lttng_live_stream_iterator *stream)
+{
+	if (!stream->prefetched_packets) {
+		return;
+	}
+
+	while (!g_queue_is_empty(stream->prefetched_packets)) {
+		free_prefetched_packet(
+			g_queue_pop_head(stream->prefetched_packets));
+	}
+	stream->prefetch_gen++;
+}
+
+/*
+ * Makes sure the connection's reception buffer contains the first
+ * `len` bytes of the reply to its oldest pending request.
+ *
+ * If `wait` is false, only receives what is available.
+ *
+ * Returns 0 if the bytes are received, 1 if they are not available
+ * yet, and -1 on error.
+ */
+static
+int recv_reply_bytes(struct bt_live_viewer_connection *viewer_connection,
+		size_t len, bool wait)
+{
+	GByteArray *recv_buf = viewer_connection->recv_buf;
+	size_t cur_len = recv_buf->len;
+	ssize_t ret_len;
+
+	if (cur_len >= len) {
+		return 0;
+	}
+
+	g_byte_array_set_size(recv_buf, len);
+	if (wait) {
+		ret_len = lttng_live_recv(viewer_connection,
+			recv_buf->data + cur_len, len - cur_len);
+	} else {
+		ret_len = bt_socket_recv(viewer_connection->control_sock,
+			recv_buf->data + cur_len, len - cur_len, 0);
+	}
+
+	if (ret_len > 0) {
+		g_byte_array_set_size(recv_buf, cur_len + ret_len);
+		return recv_buf->len == len ? 0 : 1;
+	}
+
+	g_byte_array_set_size(recv_buf, cur_len);
+	if (ret_len == 0) {
+		BT_LOGI("Remote side has closed connection");
+		return -1;
+	}
+	if (!wait && (bt_socket_would_block() || bt_socket_interrupted())) {
+		return 1;
+	}
+
+	BT_LOGE("Error receiving reply: %s", bt_socket_errormsg());
+	return -1;
+}
+
+static
+int recv_pending_get_packet(struct bt_live_viewer_connection *viewer_connection,
+		struct lttng_live_pending_request *request, bool wait)
+{
+	struct lttng_live_stream_iterator *stream = request->stream;
+	struct lttng_live_prefetched_packet *packet;
+	struct lttng_viewer_trace_packet rp;
+	uint32_t flags, status, len = 0;
+	int ret;
+
+	ret = recv_reply_bytes(viewer_connection, sizeof(rp), wait);
+	if (ret) {
+		return ret;
+	}
+
+	memcpy(&rp, viewer_connection->recv_buf->data, sizeof(rp));
+	flags = be32toh(rp.flags);
+	status = be32toh(rp.status);
+	if (status == LTTNG_VIEWER_GET_PACKET_OK) {
+		len = be32toh(rp.len);
+	}
+
+	ret = recv_reply_bytes(viewer_connection, sizeof(rp) + len, wait);
+	if (ret) {
+		return ret;
+	}
+
+	/* The whole reply is received: the packet data follows `rp`. */
+	packet = g_new0(struct lttng_live_prefetched_packet, 1);
+	packet->offset = request->offset;
+	packet->status = BT_NOTIF_ITER_MEDIUM_STATUS_OK;
+	packet->data = viewer_connection->recv_buf;
+	g_byte_array_remove_range(packet->data, 0, sizeof(rp));
+	viewer_connection->recv_buf = g_byte_array_new();
+
+	if (stream) {
+		stream->pending_packet_requests--;
+	}
+
+	switch (status) {
+	case LTTNG_VIEWER_GET_PACKET_OK:
+		BT_LOGD("get_data_packet: Ok, packet size : %" PRIu32 "", len);
+		if (len == 0) {
+			packet->status = BT_NOTIF_ITER_MEDIUM_STATUS_ERROR;
+		}
+		break;
+	case LTTNG_VIEWER_GET_PACKET_RETRY:
+		/* Unimplemented by relay daemon */
+		BT_LOGD("get_data_packet: retry");
+		packet->status = BT_NOTIF_ITER_MEDIUM_STATUS_AGAIN;
+		break;
+	case LTTNG_VIEWER_GET_PACKET_ERR:
+		if (stream && (flags & LTTNG_VIEWER_FLAG_NEW_METADATA)) {
+			BT_LOGD("get_data_packet: new metadata needed, try again later");
+			stream->trace->new_metadata_needed = true;
+		}
+		if (stream && (flags & LTTNG_VIEWER_FLAG_NEW_STREAM)) {
+			BT_LOGD("get_data_packet: new streams needed, try again later");
+			lttng_live_need_new_streams(viewer_connection->lttng_live);
+		}
+		if (flags & (LTTNG_VIEWER_FLAG_NEW_METADATA
+				| LTTNG_VIEWER_FLAG_NEW_STREAM)) {
+			packet->status = BT_NOTIF_ITER_MEDIUM_STATUS_AGAIN;
 			break;
 		}
+		BT_LOGE("get_data_packet: error");
+		packet->status = BT_NOTIF_ITER_MEDIUM_STATUS_ERROR;
+		break;
+	case LTTNG_VIEWER_GET_PACKET_EOF:
+		packet->status = BT_NOTIF_ITER_MEDIUM_STATUS_EOF;
+		break;
+	default:
+		BT_LOGE("get_data_packet: unknown");
+		packet->status = BT_NOTIF_ITER_MEDIUM_STATUS_ERROR;
+		break;
+	}
+
+	if (stream && request->prefetch_gen == stream->prefetch_gen) {
+		g_queue_push_tail(stream->prefetched_packets, packet);
+	} else {
+		free_prefetched_packet(packet);
+	}
+
+	return 0;
+}
+
+static
+int recv_pending_get_next_index(struct bt_live_viewer_connection *viewer_connection,
+		struct lttng_live_pending_request *request, bool wait)
+{
+	struct lttng_live_stream_iterator *stream = request->stream;
+	struct lttng_viewer_index rp;
+	uint32_t status;
+	int ret;
+
+	ret = recv_reply_bytes(viewer_connection, sizeof(rp), wait);
+	if (ret) {
+		return ret;
+	}
+
+	memcpy(&rp, viewer_connection->recv_buf->data, sizeof(rp));
+	g_byte_array_set_size(viewer_connection->recv_buf, 0);
+
+	if (!stream) {
+		return 0;
+	}
+
+	stream->next_index_requested = false;
+	status = be32toh(rp.status);
+	switch (status) {
+	case LTTNG_VIEWER_INDEX_RETRY:
+	case LTTNG_VIEWER_INDEX_INACTIVE:
+		/*
+		 * The relay daemon does not move to the next index in
+		 * those cases: drop this reply so that the stream asks
+		 * again when it actually needs its next index.
+		 */
+		BT_LOGD("Dropping pipelined get_next_index reply: status=%" PRIu32,
+			status);
+		break;
+	default:
+		stream->prefetched_index = rp;
+		stream->has_prefetched_index = true;
+		break;
+	}
+
+	return 0;
+}
+
+/*
+ * Receives the reply to the oldest pending request of the connection.
+ *
+ * If `wait` is false, returns 1 if the whole reply is not received
+ * yet: the received part is kept for the next call.
+ */
+static
+int lttng_live_recv_pending_request(
+		struct bt_live_viewer_connection *viewer_connection, bool wait)
+{
+	struct lttng_live_pending_request *request;
+	int ret;
+
+	request = g_queue_peek_head(viewer_connection->pending_requests);
+	assert(request);
+
+	switch (request->type) {
+	case LTTNG_LIVE_REQUEST_GET_PACKET:
+		ret = recv_pending_get_packet(viewer_connection, request,
+			wait);
+		break;
+	case LTTNG_LIVE_REQUEST_GET_NEXT_INDEX:
+		ret = recv_pending_get_next_index(viewer_connection, request,
+			wait);
+		break;
+	default:
+		abort();
+	}
+
+	if (ret == 0) {
+		g_queue_pop_head(viewer_connection->pending_requests);
+		g_free(request);
+	}
+
+	return ret;
+}
+
+static
+int lttng_live_drain_pending_requests(
+		struct bt_live_viewer_connection *viewer_connection)
+{
+	while (!g_queue_is_empty(viewer_connection->pending_requests)) {
+		if (lttng_live_recv_pending_request(viewer_connection, true)) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Sends (part of) a command of which the reply is received right
+ * after. The replies to the pending requests are received first since
+ * the relay daemon replies in order.
+ */
+static ssize_t lttng_live_send(struct bt_live_viewer_connection *viewer_connection,
+		const void *buf, size_t len)
+{
+	if (lttng_live_drain_pending_requests(viewer_connection)) {
+		return BT_SOCKET_ERROR;
+	}
+
+	return lttng_live_send_nowait(viewer_connection, buf, len);
+}
+
+/*
+ * Appends a command and its payload to `msg`, and records the
+ * request as pending.
+ */
+static
+void append_request(struct bt_live_viewer_connection *viewer_connection,
+		GByteArray *msg, enum lttng_live_request_type type,
+		struct lttng_live_stream_iterator *stream,
+		uint64_t offset, uint64_t len)
+{
+	struct lttng_live_pending_request *request;
+	struct lttng_viewer_cmd cmd;
+
+	cmd.cmd_version = htobe32(0);
+
+	switch (type) {
+	case LTTNG_LIVE_REQUEST_GET_PACKET:
+	{
+		struct lttng_viewer_get_packet rq;
+
+		cmd.cmd = htobe32(LTTNG_VIEWER_GET_PACKET);
+		cmd.data_size = htobe64((uint64_t) sizeof(rq));
+		memset(&rq, 0, sizeof(rq));
+		rq.stream_id = htobe64(stream->viewer_stream_id);
+		rq.offset = htobe64(offset);
+		rq.len = htobe32(len);
+		g_byte_array_append(msg, (guint8 *) &cmd, sizeof(cmd));
+		g_byte_array_append(msg, (guint8 *) &rq, sizeof(rq));
+		break;
+	}
+	case LTTNG_LIVE_REQUEST_GET_NEXT_INDEX:
+	{
+		struct lttng_viewer_get_next_index rq;
+
+		cmd.cmd = htobe32(LTTNG_VIEWER_GET_NEXT_INDEX);
+		cmd.data_size = htobe64((uint64_t) sizeof(rq));
+		memset(&rq, 0, sizeof(rq));
+		rq.stream_id = htobe64(stream->viewer_stream_id);
+		g_byte_array_append(msg, (guint8 *) &cmd, sizeof(cmd));
+		g_byte_array_append(msg, (guint8 *) &rq, sizeof(rq));
+		break;
+	}
+	default:
+		abort();
+	}
+
+	request = g_new0(struct lttng_live_pending_request, 1);
+	request->type = type;
+	request->stream = stream;
+	request->prefetch_gen = stream->prefetch_gen;
+	request->offset = offset;
+	g_queue_push_tail(viewer_connection->pending_requests, request);
+}
+
+/*
+ * Sends, in a single message, the GET_PACKET requests needed to keep
+ * up to LTTNG_LIVE_MAX_PREFETCHED_PACKETS replies pending or
+ * prefetched for the current index of `stream`, followed by a
+ * GET_NEXT_INDEX request once the whole index is requested.
+ */
+static
+int request_stream_packets(struct bt_live_viewer_connection *viewer_connection,
+		struct lttng_live_stream_iterator *stream)
+{
+	uint64_t end = stream->base_offset + stream->len;
+	unsigned int nr_requests;
+	GByteArray *msg;
+	ssize_t ret_len;
+	int ret = 0;
+
+	if (stream->prefetch_offset < stream->offset ||
+			stream->prefetch_offset > end) {
+		/* The stream moved to another index. */
+		drop_prefetched_packets(stream);
+		stream->prefetch_offset = stream->offset;
+	}
+
+	msg = g_byte_array_new();
+	if (!msg) {
+		ret = -1;
+		goto end;
+	}
+
+	nr_requests = stream->pending_packet_requests +
+		g_queue_get_length(stream->prefetched_packets);
+	while (nr_requests < LTTNG_LIVE_MAX_PREFETCHED_PACKETS &&
+			stream->prefetch_offset < end) {
+		uint64_t len = MIN(stream->buflen,
+			end - stream->prefetch_offset);
+
+		append_request(viewer_connection, msg,
+			LTTNG_LIVE_REQUEST_GET_PACKET, stream,
+			stream->prefetch_offset, len);
+		stream->prefetch_offset += len;
+		stream->pending_packet_requests++;
+		nr_requests++;
+	}
+
+	if (stream->prefetch_offset == end && !stream->next_index_requested &&
+			!stream->has_prefetched_index) {
+		append_request(viewer_connection, msg,
+			LTTNG_LIVE_REQUEST_GET_NEXT_INDEX, stream, 0, 0);
+		stream->next_index_requested = true;
+	}
+
+	if (msg->len == 0) {
+		goto end;
+	}
+
+	BT_LOGD("Sending pipelined requests: stream-id=%" PRIu64 ", "
+		"prefetch-offset=%" PRIu64 ", pending-packet-requests=%u",
+		stream->viewer_stream_id, stream->prefetch_offset,
+		stream->pending_packet_requests);
+	ret_len = lttng_live_send_nowait(viewer_connection, msg->data,
+		msg->len);
+	if (ret_len == BT_SOCKET_ERROR) {
+		BT_LOGE("Error sending pipelined requests: %s",
+			bt_socket_errormsg());
+		ret = -1;
+		goto end;
+	}
+	assert(ret_len == msg->len);
+
+end:
+	if (msg) {
+		g_byte_array_free(msg, TRUE);
 	}
 	return ret;
 }
 
+/*
+ * Makes sure the replies to the pending requests of a stream which is
+ * about to be destroyed are discarded, and drops its prefetched data.
+ */
+BT_HIDDEN
+void lttng_live_cancel_stream_requests(
+		struct bt_live_viewer_connection *viewer_connection,
+		struct lttng_live_stream_iterator *stream)
+{
+	GList *node;
+
+	for (node = viewer_connection->pending_requests->head; node;
+			node = node->next) {
+		struct lttng_live_pending_request *request = node->data;
+
+		if (request->stream == stream) {
+			request->stream = NULL;
+		}
+	}
+
+	drop_prefetched_packets(stream);
+	stream->pending_packet_requests = 0;
+	stream->next_index_requested = false;
+	stream->has_prefetched_index = false;
+}
+
 static int parse_url(struct bt_live_viewer_connection *viewer_connection)
 {
 	char error_buf[256] = { 0 };
@@ -250,6 +703,17 @@ static int lttng_live_connect_viewer(struct bt_live_viewer_connection *viewer_co
 		BT_LOGE("Connection failed: %s", bt_socket_errormsg());
 		goto error;
 	}
+
+	/*
+	 * Replies to pipelined requests are received without blocking
+	 * so that the graph can wait for this socket instead.
+	 */
+	if (bt_socket_set_nonblocking(viewer_connection->control_sock) ==
+			BT_SOCKET_ERROR) {
+		BT_LOGE("Cannot make socket non-blocking: %s",
+			bt_socket_errormsg());
+		goto error;
+	}
 	if (lttng_live_handshake(viewer_connection)) {
 		goto error;
 	}
@@ -1093,6 +1557,30 @@ enum bt_lttng_live_iterator_status lttng_live_get_next_index(struct lttng_live_c
 			lttng_live->viewer_connection;
 	struct lttng_live_trace *trace = stream->trace;
 
+	/*
+	 * Receive the reply to the pipelined request, if any, without
+	 * blocking: the graph can wait for the viewer socket instead.
+	 */
+	while (stream->next_index_requested) {
+		int ret = lttng_live_recv_pending_request(viewer_connection,
+			false);
+
+		if (ret < 0) {
+			goto error;
+		} else if (ret > 0) {
+			BT_LOGD("get_next_index: pipelined reply not received yet");
+			retstatus = BT_LTTNG_LIVE_ITERATOR_STATUS_AGAIN;
+			goto end;
+		}
+	}
+
+	if (stream->has_prefetched_index) {
+		BT_LOGD("get_next_index: using pipelined reply");
+		rp = stream->prefetched_index;
+		stream->has_prefetched_index = false;
+		goto handle_reply;
+	}
+
 	cmd.cmd = htobe32(LTTNG_VIEWER_GET_NEXT_INDEX);
 	cmd.data_size = htobe64((uint64_t) sizeof(rq));
 	cmd.cmd_version = htobe32(0);
@@ -1125,6 +1613,7 @@ enum bt_lttng_live_iterator_status lttng_live_get_next_index(struct lttng_live_c
 	}
 	assert(ret_len == sizeof(rp));
 
+handle_reply:
 	flags = be32toh(rp.flags);
 	status = be32toh(rp.status);
 
@@ -1211,114 +1700,84 @@ error:
 	return retstatus;
 }
 
+/*
+ * Copies the data of `stream` at `offset` to `buf`, from the replies to
+ * its pipelined GET_PACKET requests.
+ *
+ * The pipeline of the stream is filled first, so that the relay daemon
+ * sends the following data while the caller decodes this one.
+ */
 BT_HIDDEN
 enum bt_notif_iter_medium_status lttng_live_get_stream_bytes(struct lttng_live_component *lttng_live,
 		struct lttng_live_stream_iterator *stream, uint8_t *buf, uint64_t offset,
 		uint64_t req_len, uint64_t *recv_len)
 {
 	enum bt_notif_iter_medium_status retstatus = BT_NOTIF_ITER_MEDIUM_STATUS_OK;
-	struct lttng_viewer_cmd cmd;
-	struct lttng_viewer_get_packet rq;
-	struct lttng_viewer_trace_packet rp;
-	ssize_t ret_len;
-	uint32_t flags, status;
 	struct bt_live_viewer_connection *viewer_connection =
 			lttng_live->viewer_connection;
-	struct lttng_live_trace *trace = stream->trace;
+	struct lttng_live_prefetched_packet *packet;
+	size_t len;
 
 	BT_LOGD("lttng_live_get_stream_bytes: offset=%" PRIu64 ", req_len=%" PRIu64,
 			offset, req_len);
-	cmd.cmd = htobe32(LTTNG_VIEWER_GET_PACKET);
-	cmd.data_size = htobe64((uint64_t) sizeof(rq));
-	cmd.cmd_version = htobe32(0);
-
-	memset(&rq, 0, sizeof(rq));
-	rq.stream_id = htobe64(stream->viewer_stream_id);
-	rq.offset = htobe64(offset);
-	rq.len = htobe32(req_len);
+	assert(offset == stream->offset);
 
-	ret_len = lttng_live_send(viewer_connection, &cmd, sizeof(cmd));
-	if (ret_len == BT_SOCKET_ERROR) {
-		BT_LOGE("Error sending cmd: %s", bt_socket_errormsg());
+	if (request_stream_packets(viewer_connection, stream)) {
 		goto error;
 	}
-	assert(ret_len == sizeof(cmd));
 
-	ret_len = lttng_live_send(viewer_connection, &rq, sizeof(rq));
-	if (ret_len == BT_SOCKET_ERROR) {
-		BT_LOGE("Error sending get_data request: %s", bt_socket_errormsg());
-		goto error;
-	}
-	assert(ret_len == sizeof(rq));
+	while (g_queue_is_empty(stream->prefetched_packets)) {
+		int ret;
 
-	ret_len = lttng_live_recv(viewer_connection, &rp, sizeof(rp));
-	if (ret_len == 0) {
-		BT_LOGI("Remote side has closed connection");
-		goto error;
-	}
-	if (ret_len == BT_SOCKET_ERROR) {
-		BT_LOGE("Error receiving get_data response: %s", bt_socket_errormsg());
-		goto error;
-	}
-	if (ret_len != sizeof(rp)) {
-		BT_LOGE("get_data_packet: expected %zu"
-				", received %zd", sizeof(rp),
-				ret_len);
-		goto error;
-	}
-
-	flags = be32toh(rp.flags);
-	status = be32toh(rp.status);
-
-	switch (status) {
-	case LTTNG_VIEWER_GET_PACKET_OK:
-		req_len = be32toh(rp.len);
-		BT_LOGD("get_data_packet: Ok, packet size : %" PRIu64 "", req_len);
-		break;
-	case LTTNG_VIEWER_GET_PACKET_RETRY:
-		/* Unimplemented by relay daemon */
-		BT_LOGD("get_data_packet: retry");
-		retstatus = BT_NOTIF_ITER_MEDIUM_STATUS_AGAIN;
-		goto end;
-	case LTTNG_VIEWER_GET_PACKET_ERR:
-		if (flags & LTTNG_VIEWER_FLAG_NEW_METADATA) {
-			BT_LOGD("get_data_packet: new metadata needed, try again later");
-			trace->new_metadata_needed = true;
-		}
-		if (flags & LTTNG_VIEWER_FLAG_NEW_STREAM) {
-			BT_LOGD("get_data_packet: new streams needed, try again later");
-			lttng_live_need_new_streams(lttng_live);
+		if (!stream->pending_packet_requests) {
+			BT_LOGE("No requested data: offset=%" PRIu64, offset);
+			goto error;
 		}
-		if (flags & (LTTNG_VIEWER_FLAG_NEW_METADATA
-				| LTTNG_VIEWER_FLAG_NEW_STREAM)) {
+
+		ret = lttng_live_recv_pending_request(viewer_connection, false);
+		if (ret < 0) {
+			goto error;
+		} else if (ret > 0) {
+			/*
+			 * Do not block: the graph can wait for the
+			 * viewer socket to be readable instead.
+			 */
+			BT_LOGD("Requested data not received yet: offset=%" PRIu64,
+				offset);
+			stream->waiting_for_data = true;
 			retstatus = BT_NOTIF_ITER_MEDIUM_STATUS_AGAIN;
 			goto end;
 		}
-		BT_LOGE("get_data_packet: error");
-		goto error;
-	case LTTNG_VIEWER_GET_PACKET_EOF:
-		retstatus = BT_NOTIF_ITER_MEDIUM_STATUS_EOF;
-		goto end;
-	default:
-		BT_LOGE("get_data_packet: unknown");
-		goto error;
 	}
 
-	if (req_len == 0) {
+	packet = g_queue_peek_head(stream->prefetched_packets);
+	if (packet->offset + packet->pos != offset) {
+		BT_LOGE("Unexpected prefetched data offset: "
+			"expected=%" PRIu64 ", actual=%" PRIu64,
+			offset, packet->offset + packet->pos);
 		goto error;
 	}
 
-	ret_len = lttng_live_recv(viewer_connection, buf, req_len);
-	if (ret_len == 0) {
-		BT_LOGI("Remote side has closed connection");
-		goto error;
+	if (packet->status != BT_NOTIF_ITER_MEDIUM_STATUS_OK) {
+		retstatus = packet->status;
+
+		/* The following data is requested again, if needed. */
+		drop_prefetched_packets(stream);
+		stream->prefetch_offset = offset;
+		if (retstatus == BT_NOTIF_ITER_MEDIUM_STATUS_ERROR) {
+			goto error;
+		}
+		goto end;
 	}
-	if (ret_len == BT_SOCKET_ERROR) {
-		BT_LOGE("Error receiving trace packet: %s", bt_socket_errormsg());
-		goto error;
+
+	len = MIN(req_len, packet->data->len - packet->pos);
+	memcpy(buf, packet->data->data + packet->pos, len);
+	packet->pos += len;
+	if (packet->pos == packet->data->len) {
+		g_queue_pop_head(stream->prefetched_packets);
+		free_prefetched_packet(packet);
 	}
-	assert(ret_len == req_len);
-	*recv_len = ret_len;
+	*recv_len = len;
 end:
 	return retstatus;
 
@@ -1443,6 +1902,14 @@ struct bt_live_viewer_connection *
 	if (!viewer_connection->url) {
 		goto error;
 	}
+	viewer_connection->pending_requests = g_queue_new();
+	if (!viewer_connection->pending_requests) {
+		goto error;
+	}
+	viewer_connection->recv_buf = g_byte_array_new();
+	if (!viewer_connection->recv_buf) {
+		goto error;
+	}
 
 	BT_LOGD("Establishing connection to url \"%s\"...", url);
 	if (lttng_live_connect_viewer(viewer_connection)) {
@@ -1454,6 +1921,15 @@ struct bt_live_viewer_connection *
 error_report:
 	BT_LOGW("Failure to establish connection to url \"%s\"", url);
 error:
+	if (viewer_connection->url) {
+		g_string_free(viewer_connection->url, TRUE);
+	}
+	if (viewer_connection->pending_requests) {
+		g_queue_free(viewer_connection->pending_requests);
+	}
+	if (viewer_connection->recv_buf) {
+		g_byte_array_free(viewer_connection->recv_buf, TRUE);
+	}
 	g_free(viewer_connection);
 	return NULL;
 }
@@ -1473,6 +1949,11 @@ void bt_live_viewer_connection_destroy(struct bt_live_viewer_connection *viewer_
 	if (viewer_connection->session_name) {
 		g_string_free(viewer_connection->session_name, TRUE);
 	}
+	while (!g_queue_is_empty(viewer_connection->pending_requests)) {
+		g_free(g_queue_pop_head(viewer_connection->pending_requests));
+	}
+	g_queue_free(viewer_connection->pending_requests);
+	g_byte_array_free(viewer_connection->recv_buf, TRUE);
 	g_free(viewer_connection);
 
 	bt_socket_fini();
@@ -39,6 +39,29 @@
 #define LTTNG_LIVE_MINOR			4
 
 struct lttng_live_component;
+struct lttng_live_stream_iterator;
+
+enum lttng_live_request_type {
+	LTTNG_LIVE_REQUEST_GET_PACKET,
+	LTTNG_LIVE_REQUEST_GET_NEXT_INDEX,
+};
+
+/*
+ * Request sent to the relay daemon without waiting for its reply.
+ *
+ * The relay daemon replies to the commands of a connection in order,
+ * so the replies to pending requests are received before the reply to
+ * any other command.
+ */
+struct lttng_live_pending_request {
+	enum lttng_live_request_type type;
+	/* Weak, NULL if the stream is destroyed since. */
+	struct lttng_live_stream_iterator *stream;
+	/* Value of the stream's `prefetch_gen` when sent. */
+	uint64_t prefetch_gen;
+	/* GET_PACKET: requested offset in the stream, in bytes. */
+	uint64_t offset;
+};
 
 struct bt_live_viewer_connection {
 	struct bt_object obj;
@@ -55,6 +78,11 @@ struct bt_live_viewer_connection {
 	int32_t major;
 	int32_t minor;
 
+	/* Sent requests (struct lttng_live_pending_request *), in order. */
+	GQueue *pending_requests;
+	/* Received part of the reply to the oldest pending request. */
+	GByteArray *recv_buf;
+
 	struct lttng_live_component *lttng_live;
 };
 
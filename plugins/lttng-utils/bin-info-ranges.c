@@ -0,0 +1,126 @@
+/*
+ * Babeltrace - Debug information binary address ranges
+ *
+ * Copyright (c) 2017 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include "bin-info-ranges.h"
+
+BT_HIDDEN
+GArray *bin_info_ranges_create(void)
+{
+	return g_array_new(FALSE, FALSE, sizeof(struct bin_info_range));
+}
+
+BT_HIDDEN
+guint bin_info_ranges_upper_bound(GArray *ranges, uint64_t addr)
+{
+	guint low = 0;
+	guint high = ranges->len;
+
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+
+		if (g_array_index(ranges, struct bin_info_range,
+				mid).low_addr <= addr) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+BT_HIDDEN
+void bin_info_ranges_add(GArray *ranges, struct bin_info *bin)
+{
+	struct bin_info_range new_range = {
+		.low_addr = bin->low_addr,
+		.high_addr = bin->high_addr,
+		.bin = bin,
+	};
+	guint i;
+
+	if (new_range.low_addr >= new_range.high_addr) {
+		return;
+	}
+
+	i = bin_info_ranges_upper_bound(ranges, new_range.low_addr);
+	if (i > 0 && g_array_index(ranges, struct bin_info_range,
+			i - 1).high_addr > new_range.low_addr) {
+		i--;
+	}
+
+	while (i < ranges->len) {
+		struct bin_info_range *range = &g_array_index(ranges,
+				struct bin_info_range, i);
+
+		if (range->low_addr >= new_range.high_addr) {
+			break;
+		}
+
+		g_array_remove_index(ranges, i);
+	}
+
+	g_array_insert_val(ranges, i, new_range);
+}
+
+BT_HIDDEN
+void bin_info_ranges_remove(GArray *ranges, struct bin_info *bin)
+{
+	struct bin_info_range *range;
+	guint i;
+
+	i = bin_info_ranges_upper_bound(ranges, bin->low_addr);
+	if (i == 0) {
+		return;
+	}
+
+	range = &g_array_index(ranges, struct bin_info_range, i - 1);
+	if (range->bin != bin) {
+		/* Replaced by an overlapping binary */
+		return;
+	}
+
+	g_array_remove_index(ranges, i - 1);
+}
+
+BT_HIDDEN
+struct bin_info *bin_info_ranges_find(GArray *ranges, uint64_t addr)
+{
+	struct bin_info_range *range;
+	guint i;
+
+	/* Last range starting at or before `addr` */
+	i = bin_info_ranges_upper_bound(ranges, addr);
+	if (i == 0) {
+		return NULL;
+	}
+
+	range = &g_array_index(ranges, struct bin_info_range, i - 1);
+	if (addr >= range->high_addr) {
+		return NULL;
+	}
+
+	return range->bin;
+}
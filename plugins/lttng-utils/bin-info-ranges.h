@@ -0,0 +1,79 @@
+#ifndef BABELTRACE_PLUGIN_BIN_INFO_RANGES_H
+#define BABELTRACE_PLUGIN_BIN_INFO_RANGES_H
+
+/*
+ * Babeltrace - Debug information binary address ranges
+ *
+ * Copyright (c) 2017 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <glib.h>
+#include <babeltrace/babeltrace-internal.h>
+#include "bin-info.h"
+
+/* Address range [low_addr, high_addr) of a mapped binary */
+struct bin_info_range {
+	uint64_t low_addr;
+	uint64_t high_addr;
+	/* Weak. */
+	struct bin_info *bin;
+};
+
+/*
+ * Creates an address range index: an array of struct bin_info_range,
+ * sorted by low address, which do not overlap.
+ */
+BT_HIDDEN
+GArray *bin_info_ranges_create(void);
+
+/*
+ * Returns the index, within `ranges`, of the first range of which the
+ * low address is greater than `addr`.
+ */
+BT_HIDDEN
+guint bin_info_ranges_upper_bound(GArray *ranges, uint64_t addr);
+
+/*
+ * Adds the address range of `bin` to `ranges`. The ranges of previously
+ * mapped binaries overlapping this one are removed from `ranges`, since
+ * the new mapping replaces them. A binary of which the memory size is
+ * 0 is not added.
+ */
+BT_HIDDEN
+void bin_info_ranges_add(GArray *ranges, struct bin_info *bin);
+
+/*
+ * Removes the address range of `bin`, if any, from `ranges`. The range
+ * of a binary which a more recent overlapping binary replaced is
+ * already removed: this function then does not change `ranges`.
+ */
+BT_HIDDEN
+void bin_info_ranges_remove(GArray *ranges, struct bin_info *bin);
+
+/*
+ * Returns the binary of which the range of `ranges` contains `addr`, or
+ * NULL if there's none.
+ */
+BT_HIDDEN
+struct bin_info *bin_info_ranges_find(GArray *ranges, uint64_t addr);
+
+#endif /* BABELTRACE_PLUGIN_BIN_INFO_RANGES_H */
@@ -37,6 +37,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <dwarf.h>
 #include <glib.h>
 #include <errno.h>
@@ -52,6 +53,19 @@
  */
 #define ADDR_STR_LEN 20
 
+/*
+ * Address range of a DWARF function (subprogram DIE) or compile unit
+ * (CU), relative to the base address for PIC.
+ */
+struct bin_info_dwarf_range {
+	uint64_t low_addr;
+	uint64_t high_addr;
+	/* Offset of the CU header in the DWARF file. */
+	Dwarf_Off cu_offset;
+	/* Offset of the DIE in the DWARF file. */
+	Dwarf_Off die_offset;
+};
+
 BT_HIDDEN
 int bin_info_init(void)
 {
@@ -121,6 +135,14 @@ void bin_info_destroy(struct bin_info *bin)
 
 	dwarf_end(bin->dwarf_info);
 
+	if (bin->dwarf_func_ranges) {
+		g_array_free(bin->dwarf_func_ranges, TRUE);
+	}
+
+	if (bin->dwarf_cu_ranges) {
+		g_array_free(bin->dwarf_cu_ranges, TRUE);
+	}
+
 	free(bin->debug_info_dir);
 	free(bin->elf_path);
 	free(bin->dwarf_path);
@@ -490,6 +512,44 @@ end:
 	return ret;
 }
 
+BT_HIDDEN
+int bin_info_get_file_stat(struct bin_info *bin, uint64_t *size,
+		int64_t *mtime_ns)
+{
+	struct stat st;
+
+	if (!bin || !size || !mtime_ns) {
+		return -1;
+	}
+
+	if (!bin->has_file_stat) {
+		if (stat(bin->elf_path, &st)) {
+			BT_LOGD("Failed to get ELF file information: "
+				"path=\"%s\", errno=%d", bin->elf_path, errno);
+			return -1;
+		}
+
+		/*
+		 * Best resolution available: a binary which is rebuilt
+		 * within the same second must not be mistaken for the
+		 * previous one.
+		 */
+		bin->file_size = (uint64_t) st.st_size;
+		bin->file_mtime_ns = (int64_t) st.st_mtime *
+			INT64_C(1000000000);
+#if defined(HAVE_STRUCT_STAT_ST_MTIM)
+		bin->file_mtime_ns += (int64_t) st.st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+		bin->file_mtime_ns += (int64_t) st.st_mtimespec.tv_nsec;
+#endif
+		bin->has_file_stat = true;
+	}
+
+	*size = bin->file_size;
+	*mtime_ns = bin->file_mtime_ns;
+	return 0;
+}
+
 /**
  * Initialize the ELF file for a given executable.
  *
@@ -782,31 +842,208 @@ error:
 	return ret;
 }
 
+static
+void bin_info_dwarf_append_die_ranges(GArray *ranges, Dwarf_Die *dwarf_die,
+		Dwarf_Off cu_offset)
+{
+	ptrdiff_t offset = 0;
+	Dwarf_Addr base, start, end;
+
+	while ((offset = dwarf_ranges(dwarf_die, offset, &base, &start,
+			&end)) > 0) {
+		struct bin_info_dwarf_range range = {
+			.low_addr = start,
+			.high_addr = end,
+			.cu_offset = cu_offset,
+			.die_offset = dwarf_dieoffset(dwarf_die),
+		};
+
+		if (start < end) {
+			g_array_append_val(ranges, range);
+		}
+	}
+}
+
+static
+gint bin_info_dwarf_range_compare(gconstpointer a, gconstpointer b)
+{
+	const struct bin_info_dwarf_range *range_a = a;
+	const struct bin_info_dwarf_range *range_b = b;
+
+	if (range_a->low_addr != range_b->low_addr) {
+		return range_a->low_addr < range_b->low_addr ? -1 : 1;
+	}
+
+	/* Keep the DWARF order on ties. */
+	if (range_a->die_offset != range_b->die_offset) {
+		return range_a->die_offset < range_b->die_offset ? -1 : 1;
+	}
+
+	return 0;
+}
+
 /**
- * Get the name of the function containing a given address within a
- * given compile unit (CU).
+ * Build the sorted address ranges of the functions (subprogram DIEs)
+ * and compile units of the DWARF info of `bin`, if not already done,
+ * so that each lookup is a binary search instead of a walk of all the
+ * CUs and DIEs.
  *
- * If found, the out parameter `func_name` is set on success. On
- * failure, it remains unchanged.
+ * A failure is recorded so that the index is only built once: the
+ * callers fall back to walking the CUs.
  *
- * @param cu		bt_dwarf_cu instance which may contain the address
- * @param addr		Virtual memory address for which to find the
- *			function name
- * @param func_name	Out parameter, the function name
+ * @param bin		bin_info instance
  * @returns		0 on success, -1 on failure
  */
 static
-int bin_info_lookup_cu_function_name(struct bt_dwarf_cu *cu, uint64_t addr,
-		char **func_name)
+int bin_info_build_dwarf_index(struct bin_info *bin)
 {
-	int ret = 0;
-	bool found = false;
+	struct bt_dwarf_cu *cu = NULL;
 	struct bt_dwarf_die *die = NULL;
+	gint64 begin_us;
+	unsigned int cu_count = 0;
 
-	if (!cu || !func_name) {
+	if (bin->dwarf_func_ranges) {
+		return 0;
+	}
+
+	if (bin->dwarf_index_failed) {
+		return -1;
+	}
+
+	begin_us = g_get_monotonic_time();
+	bin->dwarf_func_ranges = g_array_new(FALSE, FALSE,
+			sizeof(struct bin_info_dwarf_range));
+	bin->dwarf_cu_ranges = g_array_new(FALSE, FALSE,
+			sizeof(struct bin_info_dwarf_range));
+	if (!bin->dwarf_func_ranges || !bin->dwarf_cu_ranges) {
 		goto error;
 	}
 
+	cu = bt_dwarf_cu_create(bin->dwarf_info);
+	if (!cu) {
+		goto error;
+	}
+
+	while (bt_dwarf_cu_next(cu) == 0) {
+		die = bt_dwarf_die_create(cu);
+		if (!die) {
+			goto error;
+		}
+
+		bin_info_dwarf_append_die_ranges(bin->dwarf_cu_ranges,
+				die->dwarf_die, cu->offset);
+
+		while (bt_dwarf_die_next(die) == 0) {
+			int tag;
+
+			if (bt_dwarf_die_get_tag(die, &tag)) {
+				goto error;
+			}
+
+			if (tag == DW_TAG_subprogram) {
+				bin_info_dwarf_append_die_ranges(
+						bin->dwarf_func_ranges,
+						die->dwarf_die, cu->offset);
+			}
+		}
+
+		bt_dwarf_die_destroy(die);
+		die = NULL;
+		cu_count++;
+	}
+
+	g_array_sort(bin->dwarf_func_ranges, bin_info_dwarf_range_compare);
+	g_array_sort(bin->dwarf_cu_ranges, bin_info_dwarf_range_compare);
+	bt_dwarf_cu_destroy(cu);
+	BT_LOGI("Built DWARF address range index: path=\"%s\", "
+		"cu-count=%u, function-range-count=%u, cu-range-count=%u, "
+		"duration-us=%" PRId64,
+		bin->dwarf_path ? bin->dwarf_path : bin->elf_path, cu_count,
+		bin->dwarf_func_ranges->len, bin->dwarf_cu_ranges->len,
+		(int64_t) (g_get_monotonic_time() - begin_us));
+	return 0;
+
+error:
+	BT_LOGW("Failed to build DWARF address range index: "
+		"falling back to walking the CUs on each lookup: path=\"%s\"",
+		bin->elf_path);
+	bin->dwarf_index_failed = true;
+	bt_dwarf_die_destroy(die);
+	bt_dwarf_cu_destroy(cu);
+
+	if (bin->dwarf_func_ranges) {
+		g_array_free(bin->dwarf_func_ranges, TRUE);
+		bin->dwarf_func_ranges = NULL;
+	}
+
+	if (bin->dwarf_cu_ranges) {
+		g_array_free(bin->dwarf_cu_ranges, TRUE);
+		bin->dwarf_cu_ranges = NULL;
+	}
+
+	return -1;
+}
+
+/**
+ * Find the range containing the address `addr` within the sorted
+ * ranges `ranges`.
+ *
+ * @param ranges	Array of struct bin_info_dwarf_range
+ * @param addr		Address relative to the base address for PIC
+ * @returns		The range containing `addr`, or NULL if not found
+ */
+static
+struct bin_info_dwarf_range *bin_info_find_dwarf_range(GArray *ranges,
+		uint64_t addr)
+{
+	struct bin_info_dwarf_range *range;
+	guint low = 0;
+	guint high = ranges->len;
+
+	/* Find the first range starting after `addr`. */
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+
+		if (g_array_index(ranges, struct bin_info_dwarf_range,
+				mid).low_addr <= addr) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	if (low == 0) {
+		return NULL;
+	}
+
+	range = &g_array_index(ranges, struct bin_info_dwarf_range, low - 1);
+	if (addr >= range->high_addr) {
+		return NULL;
+	}
+
+	return range;
+}
+
+/**
+ * Find the function (subprogram) DIE containing a given address within
+ * a given compile unit (CU) by walking its top-level DIEs.
+ *
+ * On success, the out parameter `func_die` is set to a new DIE if
+ * found. On failure, it remains unchanged.
+ *
+ * @param cu		bt_dwarf_cu instance which may contain the address
+ * @param addr		The address for which to look for
+ * @param func_die	Out parameter, the function DIE
+ * @returns		0 on success, -1 on failure
+ */
+static
+int bin_info_find_cu_function_die(struct bt_dwarf_cu *cu, uint64_t addr,
+		struct bt_dwarf_die **func_die)
+{
+	int ret = 0;
+	bool found = false;
+	struct bt_dwarf_die *die = NULL;
+
 	die = bt_dwarf_die_create(cu);
 	if (!die) {
 		goto error;
@@ -827,39 +1064,92 @@ int bin_info_lookup_cu_function_name(struct bt_dwarf_cu *cu, uint64_t addr,
 			}
 
 			if (found) {
-				break;
+				*func_die = die;
+				return 0;
 			}
 		}
 	}
 
-	if (found) {
-		uint64_t low_addr = 0;
-		char *die_name = NULL;
+	bt_dwarf_die_destroy(die);
+	return 0;
 
-		ret = bt_dwarf_die_get_name(die, &die_name);
-		if (ret) {
-			goto error;
-		}
+error:
+	bt_dwarf_die_destroy(die);
+	return -1;
+}
 
-		ret = dwarf_lowpc(die->dwarf_die, &low_addr);
-		if (ret) {
-			free(die_name);
-			goto error;
-		}
+/**
+ * Find the function (subprogram) DIE containing a given address within
+ * an executable, using the DWARF address range index if it could be
+ * built, or by walking all the CUs otherwise.
+ *
+ * On success, the out parameters `func_cu` and `func_die` are set to a
+ * new CU and a new DIE if found. On failure, they remain unchanged.
+ *
+ * @param bin		bin_info instance for the executable containing
+ *			the address
+ * @param addr		Address relative to the base address for PIC
+ * @param func_cu	Out parameter, the CU of the function DIE
+ * @param func_die	Out parameter, the function DIE
+ * @returns		0 on success, -1 on failure
+ */
+static
+int bin_info_find_dwarf_function_die(struct bin_info *bin, uint64_t addr,
+		struct bt_dwarf_cu **func_cu, struct bt_dwarf_die **func_die)
+{
+	int ret = 0;
+	struct bt_dwarf_cu *cu = NULL;
+	struct bt_dwarf_die *die = NULL;
+	struct bin_info_dwarf_range *range;
 
-		ret = bin_info_append_offset_str(die_name, low_addr, addr,
-						func_name);
-		free(die_name);
-		if (ret) {
-			goto error;
+	cu = bt_dwarf_cu_create(bin->dwarf_info);
+	if (!cu) {
+		goto error;
+	}
+
+	if (bin_info_build_dwarf_index(bin)) {
+		while (bt_dwarf_cu_next(cu) == 0) {
+			ret = bin_info_find_cu_function_die(cu, addr, &die);
+			if (ret) {
+				goto error;
+			}
+
+			if (die) {
+				goto end;
+			}
 		}
+
+		goto end;
+	}
+
+	range = bin_info_find_dwarf_range(bin->dwarf_func_ranges, addr);
+	if (!range) {
+		goto end;
+	}
+
+	ret = bt_dwarf_cu_set_offset(cu, range->cu_offset);
+	if (ret) {
+		goto error;
+	}
+
+	die = bt_dwarf_die_create_at_offset(cu, range->die_offset);
+	if (!die) {
+		goto error;
+	}
+
+end:
+	if (die) {
+		*func_cu = cu;
+		*func_die = die;
+	} else {
+		bt_dwarf_cu_destroy(cu);
 	}
 
-	bt_dwarf_die_destroy(die);
 	return 0;
 
 error:
 	bt_dwarf_die_destroy(die);
+	bt_dwarf_cu_destroy(cu);
 	return -1;
 }
 
@@ -882,39 +1172,43 @@ int bin_info_lookup_dwarf_function_name(struct bin_info *bin, uint64_t addr,
 		char **func_name)
 {
 	int ret = 0;
-	char *_func_name = NULL;
+	char *die_name = NULL;
+	uint64_t low_addr = 0;
 	struct bt_dwarf_cu *cu = NULL;
+	struct bt_dwarf_die *die = NULL;
 
 	if (!bin || !func_name) {
 		goto error;
 	}
 
-	cu = bt_dwarf_cu_create(bin->dwarf_info);
-	if (!cu) {
+	ret = bin_info_find_dwarf_function_die(bin, addr, &cu, &die);
+	if (ret || !die) {
 		goto error;
 	}
 
-	while (bt_dwarf_cu_next(cu) == 0) {
-		ret = bin_info_lookup_cu_function_name(cu, addr, &_func_name);
-		if (ret) {
-			goto error;
-		}
+	ret = bt_dwarf_die_get_name(die, &die_name);
+	if (ret) {
+		goto error;
+	}
 
-		if (_func_name) {
-			break;
-		}
+	ret = dwarf_lowpc(die->dwarf_die, &low_addr);
+	if (ret) {
+		goto error;
 	}
 
-	if (_func_name) {
-		*func_name = _func_name;
-	} else {
+	ret = bin_info_append_offset_str(die_name, low_addr, addr, func_name);
+	if (ret) {
 		goto error;
 	}
 
+	free(die_name);
+	bt_dwarf_die_destroy(die);
 	bt_dwarf_cu_destroy(cu);
 	return 0;
 
 error:
+	free(die_name);
+	bt_dwarf_die_destroy(die);
 	bt_dwarf_cu_destroy(cu);
 	return -1;
 }
@@ -1064,67 +1358,38 @@ error:
 }
 
 /**
- * Lookup the source location for a given address within a CU, making
- * the assumption that it is contained within an inline routine in a
- * function.
+ * Lookup the source location for a given address within a function,
+ * making the assumption that it is contained within an inline routine
+ * in this function.
  *
- * @param cu		bt_dwarf_cu instance in which to look for the address
+ * @param die		bt_dwarf_die instance of the function (subprogram)
+ *			containing the address; its position is advanced
  * @param addr		The address for which to look for
  * @param src_loc	Out parameter, the source location (filename and
  *			line number) for the address
  * @returns		0 on success, -1 on failure
  */
 static
-int bin_info_lookup_cu_src_loc_inl(struct bt_dwarf_cu *cu, uint64_t addr,
+int bin_info_lookup_die_src_loc_inl(struct bt_dwarf_die *die, uint64_t addr,
 		struct source_location **src_loc)
 {
 	int ret = 0;
 	bool found = false;
-	struct bt_dwarf_die *die = NULL;
 	struct source_location *_src_loc = NULL;
 
-	if (!cu || !src_loc) {
+	if (!die || !src_loc) {
 		goto error;
 	}
 
-	die = bt_dwarf_die_create(cu);
-	if (!die) {
+	/*
+	 * Try to find an inlined subroutine child of this DIE
+	 * containing addr.
+	 */
+	ret = bin_info_child_die_has_address(die, addr, &found);
+	if (ret) {
 		goto error;
 	}
 
-	while (bt_dwarf_die_next(die) == 0) {
-		int tag;
-
-		ret = bt_dwarf_die_get_tag(die, &tag);
-		if (ret) {
-			goto error;
-		}
-
-		if (tag == DW_TAG_subprogram) {
-			bool contains = false;
-
-			ret = bt_dwarf_die_contains_addr(die, addr, &contains);
-			if (ret) {
-				goto error;
-			}
-
-			if (contains) {
-				/*
-				 * Try to find an inlined subroutine
-				 * child of this DIE containing addr.
-				 */
-				ret = bin_info_child_die_has_address(die, addr,
-						&found);
-				if(ret) {
-					goto error;
-				}
-
-				goto end;
-			}
-		}
-	}
-
-end:
 	if (found) {
 		char *filename = NULL;
 		uint64_t line_no;
@@ -1149,12 +1414,10 @@ end:
 		*src_loc = _src_loc;
 	}
 
-	bt_dwarf_die_destroy(die);
 	return 0;
 
 error:
 	source_location_destroy(_src_loc);
-	bt_dwarf_die_destroy(die);
 	return -1;
 }
 
@@ -1237,66 +1500,14 @@ error:
 	return -1;
 }
 
-/**
- * Get the source location (file name and line number) for a given
- * address within a compile unit (CU).
- *
- * On success, the out parameter `src_loc` is set if found. On
- * failure, it remains unchanged.
- *
- * @param cu		bt_dwarf_cu instance for the compile unit which
- *			may contain the address
- * @param addr		Virtual memory address for which to find the
- *			source location
- * @param src_loc	Out parameter, the source location
- * @returns		0 on success, -1 on failure
- */
-static
-int bin_info_lookup_cu_src_loc(struct bt_dwarf_cu *cu, uint64_t addr,
-		struct source_location **src_loc)
-{
-	int ret = 0;
-	struct source_location *_src_loc = NULL;
-
-	if (!cu || !src_loc) {
-		goto error;
-	}
-
-	ret = bin_info_lookup_cu_src_loc_inl(cu, addr, &_src_loc);
-	if (ret) {
-		goto error;
-	}
-
-	if (_src_loc) {
-		goto end;
-	}
-
-	ret = bin_info_lookup_cu_src_loc_no_inl(cu, addr, &_src_loc);
-	if (ret) {
-		goto error;
-	}
-
-	if (_src_loc) {
-		goto end;
-	}
-
-end:
-	if (_src_loc) {
-		*src_loc = _src_loc;
-	}
-
-	return 0;
-
-error:
-	source_location_destroy(_src_loc);
-	return -1;
-}
-
 BT_HIDDEN
 int bin_info_lookup_source_location(struct bin_info *bin, uint64_t addr,
 		struct source_location **src_loc)
 {
+	int ret;
 	struct bt_dwarf_cu *cu = NULL;
+	struct bt_dwarf_die *die = NULL;
+	struct bin_info_dwarf_range *range;
 	struct source_location *_src_loc = NULL;
 
 	if (!bin || !src_loc) {
@@ -1328,24 +1539,65 @@ int bin_info_lookup_source_location(struct bin_info *bin, uint64_t addr,
 		addr -= bin->low_addr;
 	}
 
-	cu = bt_dwarf_cu_create(bin->dwarf_info);
-	if (!cu) {
+	/* Find the function, or at least the CU, containing addr. */
+	ret = bin_info_find_dwarf_function_die(bin, addr, &cu, &die);
+	if (ret) {
 		goto error;
 	}
 
-	while (bt_dwarf_cu_next(cu) == 0) {
-		int ret;
-
-		ret = bin_info_lookup_cu_src_loc(cu, addr, &_src_loc);
+	if (die) {
+		ret = bin_info_lookup_die_src_loc_inl(die, addr, &_src_loc);
 		if (ret) {
 			goto error;
 		}
 
 		if (_src_loc) {
-			break;
+			goto end;
+		}
+	} else if (bin->dwarf_index_failed) {
+		/* No index: try the line table of each CU. */
+		cu = bt_dwarf_cu_create(bin->dwarf_info);
+		if (!cu) {
+			goto error;
+		}
+
+		while (bt_dwarf_cu_next(cu) == 0) {
+			ret = bin_info_lookup_cu_src_loc_no_inl(cu, addr,
+					&_src_loc);
+			if (ret) {
+				goto error;
+			}
+
+			if (_src_loc) {
+				break;
+			}
+		}
+
+		goto end;
+	} else {
+		range = bin_info_find_dwarf_range(bin->dwarf_cu_ranges, addr);
+		if (!range) {
+			goto end;
+		}
+
+		cu = bt_dwarf_cu_create(bin->dwarf_info);
+		if (!cu) {
+			goto error;
+		}
+
+		ret = bt_dwarf_cu_set_offset(cu, range->cu_offset);
+		if (ret) {
+			goto error;
 		}
 	}
 
+	ret = bin_info_lookup_cu_src_loc_no_inl(cu, addr, &_src_loc);
+	if (ret) {
+		goto error;
+	}
+
+end:
+	bt_dwarf_die_destroy(die);
 	bt_dwarf_cu_destroy(cu);
 	if (_src_loc) {
 		*src_loc = _src_loc;
@@ -1355,6 +1607,7 @@ int bin_info_lookup_source_location(struct bin_info *bin, uint64_t addr,
 
 error:
 	source_location_destroy(_src_loc);
+	bt_dwarf_die_destroy(die);
 	bt_dwarf_cu_destroy(cu);
 	return -1;
 }
@@ -31,6 +31,7 @@
 #include <stdbool.h>
 #include <gelf.h>
 #include <elfutils/libdw.h>
+#include <glib.h>
 #include <babeltrace/babeltrace-internal.h>
 
 #define DEFAULT_DEBUG_DIR "/usr/lib/debug"
@@ -51,6 +52,13 @@ struct bin_info {
 	/* libelf and libdw objects representing the files. */
 	Elf *elf_file;
 	Dwarf *dwarf_info;
+	/*
+	 * Sorted address ranges of the DWARF functions and compile
+	 * units (struct bin_info_dwarf_range), built on the first DWARF
+	 * lookup.
+	 */
+	GArray *dwarf_func_ranges;
+	GArray *dwarf_cu_ranges;
 	/* Optional build ID info. */
 	uint8_t *build_id;
 	size_t build_id_len;
@@ -62,6 +70,12 @@ struct bin_info {
 	int dwarf_fd;
 	/* Configuration. */
 	char *debug_info_dir;
+	/*
+	 * Size and modification time (ns) of the ELF file, set by
+	 * bin_info_get_file_stat().
+	 */
+	uint64_t file_size;
+	int64_t file_mtime_ns;
 	/* Denotes whether the executable is position independent code. */
 	bool is_pic:1;
 	/*
@@ -69,6 +83,13 @@ struct bin_info {
 	 * DWARF info.
 	 */
 	bool is_elf_only:1;
+	/*
+	 * Denotes whether building the DWARF address range index
+	 * failed, in which case the DWARF lookups walk all the CUs.
+	 */
+	bool dwarf_index_failed:1;
+	/* Denotes whether `file_size` and `file_mtime_ns` are set. */
+	bool has_file_stat:1;
 };
 
 struct source_location {
@@ -139,6 +160,23 @@ BT_HIDDEN
 int bin_info_set_debug_link(struct bin_info *bin, const char *filename,
 		uint32_t crc);
 
+/**
+ * Gets the size and the modification time, in nanoseconds, of the ELF
+ * file of a given bin_info instance.
+ *
+ * The file is only examined on the first call: the next ones return
+ * the same values.
+ *
+ * @param bin		bin_info instance
+ * @param size		Out parameter, the size of the ELF file
+ * @param mtime_ns	Out parameter, the modification time of the
+ *			ELF file
+ * @returns		0 on success, -1 on failure
+ */
+BT_HIDDEN
+int bin_info_get_file_stat(struct bin_info *bin, uint64_t *size,
+		int64_t *mtime_ns);
+
 /**
  * Returns whether or not the given bin info \p bin contains the
  * address \p addr.
@@ -1568,6 +1568,44 @@ end:
 	return ret;
 }
 
+/*
+ * Returns the field to set in a writer event in place of the input
+ * event's field `field`.
+ *
+ * Input fields are frozen, so unless the component is asked to copy
+ * them, the writer event shares them by reference: only the added
+ * debug information fields are created for each event.
+ */
+static
+struct bt_field *get_writer_field(struct bt_field *field,
+		struct debug_info_component *component)
+{
+	if (component->arg_copy_fields) {
+		return bt_field_copy(field);
+	}
+
+	return bt_get(field);
+}
+
+static
+struct bt_field_type *get_writer_stream_event_context_type(
+		struct bt_event *writer_event)
+{
+	struct bt_event_class *writer_event_class;
+	struct bt_stream_class *writer_stream_class;
+	struct bt_field_type *type;
+
+	writer_event_class = bt_event_get_class(writer_event);
+	assert(writer_event_class);
+	writer_stream_class = bt_event_class_get_stream_class(
+			writer_event_class);
+	assert(writer_stream_class);
+	type = bt_stream_class_get_event_context_type(writer_stream_class);
+	bt_put(writer_stream_class);
+	bt_put(writer_event_class);
+	return type;
+}
+
 static
 int copy_set_debug_info_stream_event_context(FILE *err,
 		struct bt_field *event_context,
@@ -1584,10 +1622,8 @@ int copy_set_debug_info_stream_event_context(FILE *err,
 	struct debug_info_source *dbg_info_src;
 	int ret, nr_fields, i;
 
-	writer_event_context = bt_event_get_stream_event_context(writer_event);
-	assert(writer_event_context);
-
-	writer_event_context_type = bt_field_get_type(writer_event_context);
+	writer_event_context_type = get_writer_stream_event_context_type(
+			writer_event);
 	assert(writer_event_context_type);
 
 	event_context_type = bt_field_get_type(event_context);
@@ -1598,10 +1634,28 @@ int copy_set_debug_info_stream_event_context(FILE *err,
 	 * fields, so just assign it as is.
 	 */
 	if (bt_field_type_get_type_id(writer_event_context_type) != BT_FIELD_TYPE_ID_STRUCT) {
-		ret = bt_event_set_event_context(writer_event, event_context);
+		ret = bt_event_set_stream_event_context(writer_event,
+				event_context);
 		goto end;
 	}
 
+	/*
+	 * The writer event is created without fields: its stream event
+	 * context is the only field which is always created here.
+	 */
+	writer_event_context = bt_field_create(writer_event_context_type);
+	if (!writer_event_context) {
+		BT_LOGE_STR("Failed to create stream event context field.");
+		goto error;
+	}
+
+	ret = bt_event_set_stream_event_context(writer_event,
+			writer_event_context);
+	if (ret) {
+		BT_LOGE_STR("Failed to set stream event context.");
+		goto error;
+	}
+
 	dbg_info_src = lookup_debug_info(err, event, debug_info);
 
 	nr_fields = bt_field_type_structure_get_field_count(writer_event_context_type);
@@ -1639,7 +1693,7 @@ int copy_set_debug_info_stream_event_context(FILE *err,
 			}
 			BT_PUT(debug_field);
 		} else {
-			copy_field = bt_field_copy(field);
+			copy_field = get_writer_field(field, component);
 			if (!copy_field) {
 				BT_LOGE("Failed to copy field: field-name=\"%s\"",
 						field_name);
@@ -1773,7 +1827,12 @@ struct bt_event *debug_info_copy_event(FILE *err, struct bt_event *event,
 	struct bt_field *field = NULL, *copy_field = NULL;
 	int ret;
 
-	writer_event = bt_event_create(writer_event_class);
+	/*
+	 * All the fields of the writer event are either shared with or
+	 * copied from the event, except for its stream event context:
+	 * do not create fields to replace them.
+	 */
+	writer_event = bt_event_create_empty(writer_event_class);
 	if (!writer_event) {
 		BT_LOGE_STR("Failed to create new event.");
 		goto error;
@@ -1787,15 +1846,22 @@ struct bt_event *debug_info_copy_event(FILE *err, struct bt_event *event,
 
 	/* Optional field, so it can fail silently. */
 	field = bt_event_get_header(event);
-	if (field) {
+	if (field && component->arg_copy_fields) {
 		ret = ctf_copy_event_header(err, event, writer_event_class,
 				writer_event, field);
 		if (ret) {
 			BT_LOGE_STR("Failed to copy event header.");
 			goto error;
 		}
-		BT_PUT(field);
+	} else if (field) {
+		/* The clock value is already set above. */
+		ret = bt_event_set_header(writer_event, field);
+		if (ret < 0) {
+			BT_LOGE_STR("Failed to set event header.");
+			goto error;
+		}
 	}
+	BT_PUT(field);
 
 	/* Optional field, so it can fail silently. */
 	field = bt_event_get_stream_event_context(event);
@@ -1813,7 +1879,7 @@ struct bt_event *debug_info_copy_event(FILE *err, struct bt_event *event,
 	/* Optional field, so it can fail silently. */
 	field = bt_event_get_event_context(event);
 	if (field) {
-		copy_field = bt_field_copy(field);
+		copy_field = get_writer_field(field, component);
 		if (!copy_field) {
 			BT_LOGE_STR("Failed to copy field.");
 			goto error;
@@ -1830,7 +1896,7 @@ struct bt_event *debug_info_copy_event(FILE *err, struct bt_event *event,
 	field = bt_event_get_event_payload(event);
 	assert(field);
 
-	copy_field = bt_field_copy(field);
+	copy_field = get_writer_field(field, component);
 	if (copy_field) {
 		ret = bt_event_set_event_payload(writer_event, copy_field);
 		if (ret < 0) {
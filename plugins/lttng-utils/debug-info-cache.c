@@ -0,0 +1,400 @@
+/*
+ * Babeltrace - Debug information symbolization cache
+ *
+ * Copyright (c) 2017 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_LOG_TAG "PLUGIN-CTF-LTTNG-UTILS-DEBUG-INFO-FLT-CACHE"
+#include "logging.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include <glib.h>
+#include "debug-info-cache.h"
+#include "utils.h"
+
+/*
+ * Symbolization cache key.
+ *
+ * The debug info source of an address only depends on the binary file
+ * and on the offset of the address within this binary, so that the
+ * processes of a trace which map the same binary share their entries.
+ *
+ * A binary is identified by its build ID when it has one. Otherwise,
+ * it is identified by the size and the modification time of its file:
+ * two different binaries can have the same path, for example when a
+ * package is upgraded while it is traced.
+ *
+ * The path of the binary is also part of the key, as the cached debug
+ * info source contains it: the same binary found at two different
+ * paths has an entry per path.
+ */
+struct debug_info_cache_key {
+	/*
+	 * Build ID of the binary, or NULL if it has none. Owned by the
+	 * cache entry, weak for lookups.
+	 */
+	const uint8_t *build_id;
+	size_t build_id_len;
+
+	/* Path of the binary. Owned by the cache entry, weak for lookups. */
+	const char *path;
+
+	/*
+	 * Size and modification time (ns) of the binary's file if it
+	 * has no build ID, otherwise 0.
+	 */
+	uint64_t file_size;
+	int64_t file_mtime_ns;
+
+	/*
+	 * Offset of the address from the binary's load address for
+	 * position independent code, otherwise the address itself.
+	 */
+	uint64_t offset;
+};
+
+struct debug_info_cache_entry {
+	struct debug_info_cache_key key;
+
+	/* Owned by this. */
+	struct debug_info_source *src;
+
+	/* Link within debug_info_cache::lru. */
+	GList lru_link;
+};
+
+struct debug_info_cache {
+	/*
+	 * Hash table: struct debug_info_cache_key * to
+	 * struct debug_info_cache_entry *; owned by debug_info_cache.
+	 */
+	GHashTable *entries;
+
+	/*
+	 * Entries of `entries`, from the most recently used (head) to
+	 * the least recently used (tail).
+	 */
+	GQueue lru;
+
+	uint64_t max_entry_count;
+
+	/* Weak. */
+	struct debug_info_cache_stats *stats;
+
+	/*
+	 * Debug info source of the last lookup of an address within a
+	 * binary which cannot be cached; owned by debug_info_cache.
+	 */
+	struct debug_info_source *uncached_src;
+};
+
+static
+void debug_info_source_destroy(struct debug_info_source *debug_info_src)
+{
+	if (!debug_info_src) {
+		return;
+	}
+
+	free(debug_info_src->func);
+	free(debug_info_src->src_path);
+	free(debug_info_src->bin_path);
+	free(debug_info_src->bin_loc);
+	g_free(debug_info_src);
+}
+
+static
+struct debug_info_source *debug_info_source_create_from_bin(struct bin_info *bin,
+		uint64_t ip)
+{
+	int ret;
+	struct debug_info_source *debug_info_src = NULL;
+	struct source_location *src_loc = NULL;
+
+	debug_info_src = g_new0(struct debug_info_source, 1);
+
+	if (!debug_info_src) {
+		goto end;
+	}
+
+	/* Lookup function name */
+	ret = bin_info_lookup_function_name(bin, ip, &debug_info_src->func);
+	if (ret) {
+		goto error;
+	}
+
+	/* Can't retrieve src_loc from ELF, or could not find binary, skip. */
+	if (!bin->is_elf_only || !debug_info_src->func) {
+		/* Lookup source location */
+		ret = bin_info_lookup_source_location(bin, ip, &src_loc);
+		BT_LOGD("Failed to lookup source location: ret=%d", ret);
+	}
+
+	if (src_loc) {
+		debug_info_src->line_no = src_loc->line_no;
+
+		if (src_loc->filename) {
+			debug_info_src->src_path = strdup(src_loc->filename);
+			if (!debug_info_src->src_path) {
+				goto error;
+			}
+
+			debug_info_src->short_src_path = get_filename_from_path(
+					debug_info_src->src_path);
+		}
+
+		source_location_destroy(src_loc);
+	}
+
+	if (bin->elf_path) {
+		debug_info_src->bin_path = strdup(bin->elf_path);
+		if (!debug_info_src->bin_path) {
+			goto error;
+		}
+
+		debug_info_src->short_bin_path = get_filename_from_path(
+				debug_info_src->bin_path);
+
+		ret = bin_info_get_bin_loc(bin, ip, &(debug_info_src->bin_loc));
+		if (ret) {
+			goto error;
+		}
+	}
+
+end:
+	return debug_info_src;
+
+error:
+	debug_info_source_destroy(debug_info_src);
+	return NULL;
+}
+
+static
+guint debug_info_cache_key_hash(gconstpointer data)
+{
+	const struct debug_info_cache_key *key = data;
+	guint hash = 5381;
+	size_t i;
+
+	for (i = 0; i < key->build_id_len; i++) {
+		hash = (hash << 5) + hash + key->build_id[i];
+	}
+
+	hash ^= g_str_hash(key->path);
+	hash ^= (guint) key->file_mtime_ns ^ (guint) key->file_size;
+	return hash ^ (guint) key->offset ^ (guint) (key->offset >> 32);
+}
+
+static
+gboolean debug_info_cache_key_equal(gconstpointer a, gconstpointer b)
+{
+	const struct debug_info_cache_key *key_a = a;
+	const struct debug_info_cache_key *key_b = b;
+
+	return key_a->offset == key_b->offset &&
+		key_a->file_size == key_b->file_size &&
+		key_a->file_mtime_ns == key_b->file_mtime_ns &&
+		key_a->build_id_len == key_b->build_id_len &&
+		(key_a->build_id_len == 0 ||
+			memcmp(key_a->build_id, key_b->build_id,
+				key_a->build_id_len) == 0) &&
+		strcmp(key_a->path, key_b->path) == 0;
+}
+
+static
+void debug_info_cache_entry_destroy(struct debug_info_cache_entry *entry)
+{
+	if (!entry) {
+		return;
+	}
+
+	g_free((gpointer) entry->key.build_id);
+	g_free((gpointer) entry->key.path);
+	debug_info_source_destroy(entry->src);
+	g_free(entry);
+}
+
+/*
+ * Initializes `key` for the address `ip` within `bin`. `key` borrows
+ * the build ID and the path of `bin`.
+ *
+ * Returns -1 if `bin` has no path, or if it has no build ID and its
+ * file cannot be examined: it cannot be cached.
+ */
+static
+int debug_info_cache_key_init(struct debug_info_cache_key *key,
+		struct bin_info *bin, uint64_t ip)
+{
+	if (!bin->elf_path) {
+		return -1;
+	}
+
+	key->path = bin->elf_path;
+	key->offset = bin->is_pic ? ip - bin->low_addr : ip;
+
+	if (bin->build_id && bin->build_id_len > 0) {
+		key->build_id = bin->build_id;
+		key->build_id_len = bin->build_id_len;
+		key->file_size = 0;
+		key->file_mtime_ns = 0;
+	} else {
+		key->build_id = NULL;
+		key->build_id_len = 0;
+		if (bin_info_get_file_stat(bin, &key->file_size,
+				&key->file_mtime_ns)) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static
+void debug_info_cache_evict(struct debug_info_cache *cache)
+{
+	GList *link = g_queue_pop_tail_link(&cache->lru);
+	struct debug_info_cache_entry *entry;
+
+	assert(link);
+	entry = link->data;
+	cache->stats->evictions++;
+	BT_LOGV("Evicting symbolization cache entry: path=\"%s\", "
+		"offset=%" PRIx64, entry->key.path, entry->key.offset);
+	g_hash_table_remove(cache->entries, &entry->key);
+}
+
+BT_HIDDEN
+struct debug_info_source *debug_info_cache_get_source(
+		struct debug_info_cache *cache, struct bin_info *bin,
+		uint64_t ip)
+{
+	struct debug_info_source *debug_info_src = NULL;
+	struct debug_info_cache_entry *entry;
+	struct debug_info_cache_key key;
+
+	if (debug_info_cache_key_init(&key, bin, ip)) {
+		/* Resolve it again on each lookup. */
+		cache->stats->misses++;
+		debug_info_source_destroy(cache->uncached_src);
+		cache->uncached_src =
+			debug_info_source_create_from_bin(bin, ip);
+		debug_info_src = cache->uncached_src;
+		goto end;
+	}
+
+	entry = g_hash_table_lookup(cache->entries, &key);
+	if (entry) {
+		/* Move to the head: most recently used. */
+		cache->stats->hits++;
+		g_queue_unlink(&cache->lru, &entry->lru_link);
+		g_queue_push_head_link(&cache->lru, &entry->lru_link);
+		debug_info_src = entry->src;
+		goto end;
+	}
+
+	cache->stats->misses++;
+	debug_info_src = debug_info_source_create_from_bin(bin, ip);
+	if (!debug_info_src) {
+		goto end;
+	}
+
+	entry = g_new0(struct debug_info_cache_entry, 1);
+	if (!entry) {
+		goto error;
+	}
+
+	entry->key = key;
+	entry->key.build_id = g_memdup(key.build_id, key.build_id_len);
+	entry->key.path = g_strdup(key.path);
+	if ((key.build_id && !entry->key.build_id) || !entry->key.path) {
+		entry->src = NULL;
+		debug_info_cache_entry_destroy(entry);
+		goto error;
+	}
+
+	entry->src = debug_info_src;
+	entry->lru_link.data = entry;
+
+	if (g_queue_get_length(&cache->lru) >= cache->max_entry_count) {
+		debug_info_cache_evict(cache);
+	}
+
+	g_hash_table_insert(cache->entries, &entry->key, entry);
+	g_queue_push_head_link(&cache->lru, &entry->lru_link);
+
+end:
+	return debug_info_src;
+
+error:
+	debug_info_source_destroy(debug_info_src);
+	return NULL;
+}
+
+BT_HIDDEN
+uint64_t debug_info_cache_get_entry_count(struct debug_info_cache *cache)
+{
+	return (uint64_t) g_hash_table_size(cache->entries);
+}
+
+BT_HIDDEN
+struct debug_info_cache *debug_info_cache_create(uint64_t max_entry_count,
+		struct debug_info_cache_stats *stats)
+{
+	struct debug_info_cache *cache;
+
+	assert(max_entry_count > 0);
+	assert(stats);
+	cache = g_new0(struct debug_info_cache, 1);
+	if (!cache) {
+		goto end;
+	}
+
+	cache->entries = g_hash_table_new_full(debug_info_cache_key_hash,
+			debug_info_cache_key_equal, NULL,
+			(GDestroyNotify) debug_info_cache_entry_destroy);
+	if (!cache->entries) {
+		g_free(cache);
+		cache = NULL;
+		goto end;
+	}
+
+	g_queue_init(&cache->lru);
+	cache->max_entry_count = max_entry_count;
+	cache->stats = stats;
+
+end:
+	return cache;
+}
+
+BT_HIDDEN
+void debug_info_cache_destroy(struct debug_info_cache *cache)
+{
+	if (!cache) {
+		return;
+	}
+
+	BT_LOGD("Destroying symbolization cache: entry-count=%u",
+		g_hash_table_size(cache->entries));
+	g_hash_table_destroy(cache->entries);
+	debug_info_source_destroy(cache->uncached_src);
+	g_free(cache);
+}
@@ -0,0 +1,73 @@
+#ifndef BABELTRACE_PLUGIN_DEBUG_INFO_CACHE_H
+#define BABELTRACE_PLUGIN_DEBUG_INFO_CACHE_H
+
+/*
+ * Babeltrace - Debug information symbolization cache
+ *
+ * Copyright (c) 2017 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <babeltrace/babeltrace-internal.h>
+#include "debug-info.h"
+#include "bin-info.h"
+
+/*
+ * Symbolization cache: debug info sources of addresses within binaries,
+ * of which the least recently used ones are discarded when the cache
+ * is full.
+ */
+struct debug_info_cache;
+
+/*
+ * Creates a symbolization cache holding at most `max_entry_count`
+ * entries (greater than 0) and updating the counters of `stats`, which
+ * must outlive it.
+ */
+BT_HIDDEN
+struct debug_info_cache *debug_info_cache_create(uint64_t max_entry_count,
+		struct debug_info_cache_stats *stats);
+
+BT_HIDDEN
+void debug_info_cache_destroy(struct debug_info_cache *cache);
+
+/*
+ * Returns the debug info source of the address `ip` within `bin`, or
+ * NULL on error.
+ *
+ * A binary without a build ID is identified by the size and the
+ * modification time of its file when it is first looked up: if its
+ * file cannot be examined, the debug info source of an address within
+ * it is resolved again on each call.
+ *
+ * The returned debug info source is owned by `cache`: it is only valid
+ * until the next call.
+ */
+BT_HIDDEN
+struct debug_info_source *debug_info_cache_get_source(
+		struct debug_info_cache *cache, struct bin_info *bin,
+		uint64_t ip);
+
+/* Returns the current number of entries of `cache`. */
+BT_HIDDEN
+uint64_t debug_info_cache_get_entry_count(struct debug_info_cache *cache);
+
+#endif /* BABELTRACE_PLUGIN_DEBUG_INFO_CACHE_H */
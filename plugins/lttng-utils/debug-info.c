@@ -29,10 +29,13 @@
 #include "logging.h"
 
 #include <assert.h>
+#include <inttypes.h>
+#include <string.h>
 #include <glib.h>
 #include "debug-info.h"
+#include "debug-info-cache.h"
 #include "bin-info.h"
-#include "utils.h"
+#include "bin-info-ranges.h"
 #include "copy.h"
 
 struct proc_debug_info_sources {
@@ -43,15 +46,22 @@ struct proc_debug_info_sources {
 	GHashTable *baddr_to_bin_info;
 
 	/*
-	 * Hash table: IP (pointer to uint64_t) to (struct debug_info_source *);
-	 * owned by proc_debug_info_sources.
+	 * Array of struct bin_info_range, sorted by low address, which
+	 * do not overlap: the address ranges of the currently mapped
+	 * binaries of baddr_to_bin_info.
 	 */
-	GHashTable *ip_to_debug_info_src;
+	GArray *bin_info_ranges;
 };
 
 struct debug_info {
 	struct debug_info_component *comp;
 
+	/*
+	 * Symbolization cache shared by all the processes of the trace;
+	 * owned by debug_info.
+	 */
+	struct debug_info_cache *cache;
+
 	/*
 	 * Hash table of VPIDs (pointer to int64_t) to
 	 * (struct ctf_proc_debug_infos*); owned by debug_info.
@@ -84,86 +94,6 @@ int debug_info_init(struct debug_info *info)
 	return bin_info_init();
 }
 
-static
-void debug_info_source_destroy(struct debug_info_source *debug_info_src)
-{
-	if (!debug_info_src) {
-		return;
-	}
-
-	free(debug_info_src->func);
-	free(debug_info_src->src_path);
-	free(debug_info_src->bin_path);
-	free(debug_info_src->bin_loc);
-	g_free(debug_info_src);
-}
-
-static
-struct debug_info_source *debug_info_source_create_from_bin(struct bin_info *bin,
-		uint64_t ip)
-{
-	int ret;
-	struct debug_info_source *debug_info_src = NULL;
-	struct source_location *src_loc = NULL;
-
-	debug_info_src = g_new0(struct debug_info_source, 1);
-
-	if (!debug_info_src) {
-		goto end;
-	}
-
-	/* Lookup function name */
-	ret = bin_info_lookup_function_name(bin, ip, &debug_info_src->func);
-	if (ret) {
-		goto error;
-	}
-
-	/* Can't retrieve src_loc from ELF, or could not find binary, skip. */
-	if (!bin->is_elf_only || !debug_info_src->func) {
-		/* Lookup source location */
-		ret = bin_info_lookup_source_location(bin, ip, &src_loc);
-		BT_LOGD("Failed to lookup source location: ret=%d", ret);
-	}
-
-	if (src_loc) {
-		debug_info_src->line_no = src_loc->line_no;
-
-		if (src_loc->filename) {
-			debug_info_src->src_path = strdup(src_loc->filename);
-			if (!debug_info_src->src_path) {
-				goto error;
-			}
-
-			debug_info_src->short_src_path = get_filename_from_path(
-					debug_info_src->src_path);
-		}
-
-		source_location_destroy(src_loc);
-	}
-
-	if (bin->elf_path) {
-		debug_info_src->bin_path = strdup(bin->elf_path);
-		if (!debug_info_src->bin_path) {
-			goto error;
-		}
-
-		debug_info_src->short_bin_path = get_filename_from_path(
-				debug_info_src->bin_path);
-
-		ret = bin_info_get_bin_loc(bin, ip, &(debug_info_src->bin_loc));
-		if (ret) {
-			goto error;
-		}
-	}
-
-end:
-	return debug_info_src;
-
-error:
-	debug_info_source_destroy(debug_info_src);
-	return NULL;
-}
-
 static
 void proc_debug_info_sources_destroy(
 		struct proc_debug_info_sources *proc_dbg_info_src)
@@ -176,8 +106,8 @@ void proc_debug_info_sources_destroy(
 		g_hash_table_destroy(proc_dbg_info_src->baddr_to_bin_info);
 	}
 
-	if (proc_dbg_info_src->ip_to_debug_info_src) {
-		g_hash_table_destroy(proc_dbg_info_src->ip_to_debug_info_src);
+	if (proc_dbg_info_src->bin_info_ranges) {
+		g_array_free(proc_dbg_info_src->bin_info_ranges, TRUE);
 	}
 
 	g_free(proc_dbg_info_src);
@@ -200,10 +130,8 @@ struct proc_debug_info_sources *proc_debug_info_sources_create(void)
 		goto error;
 	}
 
-	proc_dbg_info_src->ip_to_debug_info_src = g_hash_table_new_full(
-			g_int64_hash, g_int64_equal, (GDestroyNotify) g_free,
-			(GDestroyNotify) debug_info_source_destroy);
-	if (!proc_dbg_info_src->ip_to_debug_info_src) {
+	proc_dbg_info_src->bin_info_ranges = bin_info_ranges_create();
+	if (!proc_dbg_info_src->bin_info_ranges) {
 		goto error;
 	}
 
@@ -219,22 +147,22 @@ static
 struct proc_debug_info_sources *proc_debug_info_sources_ht_get_entry(
 		GHashTable *ht, int64_t vpid)
 {
-	gpointer key = g_new0(int64_t, 1);
+	gpointer key = NULL;
 	struct proc_debug_info_sources *proc_dbg_info_src = NULL;
 
-	if (!key) {
-		goto end;
-	}
-
-	*((int64_t *) key) = vpid;
-
 	/* Exists? Return it */
-	proc_dbg_info_src = g_hash_table_lookup(ht, key);
+	proc_dbg_info_src = g_hash_table_lookup(ht, (gpointer) &vpid);
 	if (proc_dbg_info_src) {
 		goto end;
 	}
 
 	/* Otherwise, create and return it */
+	key = g_new0(int64_t, 1);
+	if (!key) {
+		goto end;
+	}
+
+	*((int64_t *) key) = vpid;
 	proc_dbg_info_src = proc_debug_info_sources_create();
 	if (!proc_dbg_info_src) {
 		goto end;
@@ -248,69 +176,13 @@ end:
 	return proc_dbg_info_src;
 }
 
-static
-struct debug_info_source *proc_debug_info_sources_get_entry(
-		struct proc_debug_info_sources *proc_dbg_info_src, uint64_t ip)
-{
-	struct debug_info_source *debug_info_src = NULL;
-	gpointer key = g_new0(uint64_t, 1);
-	GHashTableIter iter;
-	gpointer baddr, value;
-
-	if (!key) {
-		goto end;
-	}
-
-	*((uint64_t *) key) = ip;
-
-	/* Look in IP to debug infos hash table first. */
-	debug_info_src = g_hash_table_lookup(
-			proc_dbg_info_src->ip_to_debug_info_src,
-			key);
-	if (debug_info_src) {
-		goto end;
-	}
-
-	/* Check in all bin_infos. */
-	g_hash_table_iter_init(&iter, proc_dbg_info_src->baddr_to_bin_info);
-
-	while (g_hash_table_iter_next(&iter, &baddr, &value))
-	{
-		struct bin_info *bin = value;
-
-		if (!bin_info_has_address(value, ip)) {
-			continue;
-		}
-
-		/*
-		 * Found; add it to cache.
-		 *
-		 * FIXME: this should be bounded in size (and implement
-		 * a caching policy), and entries should be prunned when
-		 * libraries are unmapped.
-		 */
-		debug_info_src = debug_info_source_create_from_bin(bin, ip);
-		if (debug_info_src) {
-			g_hash_table_insert(
-					proc_dbg_info_src->ip_to_debug_info_src,
-					key, debug_info_src);
-			/* Ownership passed to ht. */
-			key = NULL;
-		}
-		break;
-	}
-
-end:
-	free(key);
-	return debug_info_src;
-}
-
 BT_HIDDEN
 struct debug_info_source *debug_info_query(struct debug_info *debug_info,
 		int64_t vpid, uint64_t ip)
 {
 	struct debug_info_source *dbg_info_src = NULL;
 	struct proc_debug_info_sources *proc_dbg_info_src;
+	struct bin_info *bin;
 
 	proc_dbg_info_src = proc_debug_info_sources_ht_get_entry(
 			debug_info->vpid_to_proc_dbg_info_src, vpid);
@@ -318,7 +190,12 @@ struct debug_info_source *debug_info_query(struct debug_info *debug_info,
 		goto end;
 	}
 
-	dbg_info_src = proc_debug_info_sources_get_entry(proc_dbg_info_src, ip);
+	bin = bin_info_ranges_find(proc_dbg_info_src->bin_info_ranges, ip);
+	if (!bin) {
+		goto end;
+	}
+
+	dbg_info_src = debug_info_cache_get_source(debug_info->cache, bin, ip);
 
 end:
 	return dbg_info_src;
@@ -342,6 +219,12 @@ struct debug_info *debug_info_create(struct debug_info_component *comp)
 		goto error;
 	}
 
+	debug_info->cache = debug_info_cache_create(comp->arg_cache_size,
+			&comp->cache_stats);
+	if (!debug_info->cache) {
+		goto error;
+	}
+
 	debug_info->comp = comp;
 	ret = debug_info_init(debug_info);
 	if (ret) {
@@ -351,6 +234,11 @@ struct debug_info *debug_info_create(struct debug_info_component *comp)
 end:
 	return debug_info;
 error:
+	if (debug_info->vpid_to_proc_dbg_info_src) {
+		g_hash_table_destroy(debug_info->vpid_to_proc_dbg_info_src);
+	}
+
+	debug_info_cache_destroy(debug_info->cache);
 	g_free(debug_info);
 	return NULL;
 }
@@ -366,6 +254,8 @@ void debug_info_destroy(struct debug_info *debug_info)
 		g_hash_table_destroy(debug_info->vpid_to_proc_dbg_info_src);
 	}
 
+	debug_info_cache_destroy(debug_info->cache);
+
 	g_free(debug_info);
 end:
 	return;
@@ -420,9 +310,14 @@ void handle_statedump_build_id_event(FILE *err, struct debug_info *debug_info,
 		goto end;
 	}
 	if (build_id_len > SIZE_MAX) {
-		bin->build_id_len = (size_t) build_id_len;
+		BT_LOGE("Build ID is too large: len=%" PRIu64, build_id_len);
+		g_free(bin->build_id);
+		bin->build_id = NULL;
+		goto end;
 	}
 
+	bin->build_id_len = (size_t) build_id_len;
+
 	/*
 	 * Reset the is_elf_only flag in case it had been set
 	 * previously, because we might find separate debug info using
@@ -606,6 +501,7 @@ void handle_bin_info_event(FILE *err, struct debug_info *debug_info,
 			key, bin);
 	/* Ownership passed to ht. */
 	key = NULL;
+	bin_info_ranges_add(proc_dbg_info_src->bin_info_ranges, bin);
 
 end:
 	g_free(key);
@@ -631,6 +527,7 @@ void handle_lib_unload_event(FILE *err, struct debug_info *debug_info,
 		struct bt_event *event)
 {
 	struct proc_debug_info_sources *proc_dbg_info_src;
+	struct bin_info *bin;
 	uint64_t baddr;
 	int64_t vpid;
 	gpointer key_ptr = NULL;
@@ -658,6 +555,13 @@ void handle_lib_unload_event(FILE *err, struct debug_info *debug_info,
 	}
 
 	key_ptr = (gpointer) &baddr;
+	bin = g_hash_table_lookup(proc_dbg_info_src->baddr_to_bin_info,
+			key_ptr);
+	if (!bin) {
+		goto end;
+	}
+
+	bin_info_ranges_remove(proc_dbg_info_src->bin_info_ranges, bin);
 	(void) g_hash_table_remove(proc_dbg_info_src->baddr_to_bin_info,
 			key_ptr);
 end:
@@ -684,8 +588,8 @@ void handle_statedump_start(FILE *err, struct debug_info *debug_info,
 		goto end;
 	}
 
+	g_array_set_size(proc_dbg_info_src->bin_info_ranges, 0);
 	g_hash_table_remove_all(proc_dbg_info_src->baddr_to_bin_info);
-	g_hash_table_remove_all(proc_dbg_info_src->ip_to_debug_info_src);
 
 end:
 	return;
@@ -42,6 +42,9 @@
 #define MEMSZ_FIELD_NAME	"memsz"
 #define PATH_FIELD_NAME		"path"
 
+/* Default maximum number of entries of a symbolization cache */
+#define DEBUG_INFO_DEFAULT_CACHE_SIZE	16384
+
 enum debug_info_stream_state {
 	/*
 	 * We know the stream exists but we have never received a
@@ -54,12 +57,27 @@ enum debug_info_stream_state {
 	DEBUG_INFO_COMPLETED_STREAM,
 };
 
+/* Symbolization cache counters. */
+struct debug_info_cache_stats {
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+};
+
 struct debug_info_component {
 	FILE *err;
+	/* Name of this component; owned by debug_info_component. */
+	char *name;
 	char *arg_debug_info_field_name;
 	const char *arg_debug_dir;
 	bool arg_full_path;
+	/* Deep-copy the input event fields instead of sharing them. */
+	bool arg_copy_fields;
 	const char *arg_target_prefix;
+	/* Maximum number of entries of each symbolization cache. */
+	uint64_t arg_cache_size;
+	/* Counters of the symbolization caches of all the traces. */
+	struct debug_info_cache_stats cache_stats;
 };
 
 struct debug_info_iterator {
@@ -115,6 +133,10 @@ struct debug_info *debug_info_create(struct debug_info_component *comp);
 BT_HIDDEN
 void debug_info_destroy(struct debug_info *debug_info);
 
+/*
+ * The returned debug info source is owned by the symbolization cache
+ * of `debug_info`: it is only valid until the next call.
+ */
 BT_HIDDEN
 struct debug_info_source *debug_info_query(struct debug_info *debug_info,
 		int64_t vpid, uint64_t ip);
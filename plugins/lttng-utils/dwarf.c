@@ -82,6 +82,33 @@ end:
 	return ret;
 }
 
+BT_HIDDEN
+int bt_dwarf_cu_set_offset(struct bt_dwarf_cu *cu, Dwarf_Off offset)
+{
+	int ret;
+	Dwarf_Off next_offset;
+	size_t cu_header_size;
+
+	if (!cu) {
+		ret = -1;
+		goto end;
+	}
+
+	ret = dwarf_nextcu(cu->dwarf_info, offset, &next_offset,
+			&cu_header_size, NULL, NULL, NULL);
+	if (ret) {
+		ret = -1;
+		goto end;
+	}
+
+	cu->offset = offset;
+	cu->next_offset = next_offset;
+	cu->header_size = cu_header_size;
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 struct bt_dwarf_die *bt_dwarf_die_create(struct bt_dwarf_cu *cu)
 {
@@ -120,6 +147,43 @@ error:
 	return NULL;
 }
 
+BT_HIDDEN
+struct bt_dwarf_die *bt_dwarf_die_create_at_offset(struct bt_dwarf_cu *cu,
+		Dwarf_Off offset)
+{
+	Dwarf_Die *dwarf_die = NULL;
+	struct bt_dwarf_die *die = NULL;
+
+	if (!cu) {
+		goto error;
+	}
+
+	dwarf_die = g_new0(Dwarf_Die, 1);
+	if (!dwarf_die) {
+		goto error;
+	}
+
+	if (!dwarf_offdie(cu->dwarf_info, offset, dwarf_die)) {
+		goto error;
+	}
+
+	die = g_new0(struct bt_dwarf_die, 1);
+	if (!die) {
+		goto error;
+	}
+
+	die->cu = cu;
+	die->dwarf_die = dwarf_die;
+	die->depth = 1;
+
+	return die;
+
+error:
+	g_free(dwarf_die);
+	g_free(die);
+	return NULL;
+}
+
 BT_HIDDEN
 void bt_dwarf_die_destroy(struct bt_dwarf_die *die)
 {
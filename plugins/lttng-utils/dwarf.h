@@ -100,6 +100,20 @@ void bt_dwarf_cu_destroy(struct bt_dwarf_cu *cu);
 BT_HIDDEN
 int bt_dwarf_cu_next(struct bt_dwarf_cu *cu);
 
+/**
+ * Move the compile unit `cu` to the one of which the header is located
+ * at `offset`, as previously read from the `offset` member of a
+ * bt_dwarf_cu instance.
+ *
+ * On failure, `cu` remains unchanged.
+ *
+ * @param cu		bt_dwarf_cu instance
+ * @param offset	Offset in bytes in the DWARF file to the CU header
+ * @returns		0 on success, -1 on failure
+ */
+BT_HIDDEN
+int bt_dwarf_cu_set_offset(struct bt_dwarf_cu *cu, Dwarf_Off offset);
+
 /**
  * Instantiate a structure to access debug information entries (DIE)
  * for the given compile unit `cu`.
@@ -111,6 +125,20 @@ int bt_dwarf_cu_next(struct bt_dwarf_cu *cu);
 BT_HIDDEN
 struct bt_dwarf_die *bt_dwarf_die_create(struct bt_dwarf_cu *cu);
 
+/**
+ * Instantiate a structure to access the debug information entry (DIE)
+ * located at `offset`, within the compile unit `cu`, as a child of
+ * the CU's root DIE (depth of 1).
+ *
+ * @param cu		bt_dwarf_cu instance
+ * @param offset	Offset in bytes in the DWARF file to the DIE
+ * @returns		Pointer to the new bt_dwarf_die on success,
+ *			NULL on failure.
+ */
+BT_HIDDEN
+struct bt_dwarf_die *bt_dwarf_die_create_at_offset(struct bt_dwarf_cu *cu,
+		Dwarf_Off offset);
+
 /**
  * Destroy the given bt_dwarf_die instance.
  *
@@ -32,6 +32,8 @@
 #include <babeltrace/babeltrace.h>
 #include <plugins-common.h>
 #include <assert.h>
+#include <string.h>
+#include <inttypes.h>
 #include "debug-info.h"
 #include "copy.h"
 
@@ -46,18 +48,64 @@ gboolean empty_trace_map(gpointer key, gpointer value, gpointer user_data)
 	return TRUE;
 }
 
+/*
+ * Live debug_info_component objects (weak references), reported by the
+ * `cache-stats` query object: a query method has no component, so this
+ * is the only way to reach the counters of the existing components.
+ */
+static GPtrArray *debug_info_components;
+
+static
+int register_debug_info_component(struct debug_info_component *debug_info)
+{
+	if (!debug_info_components) {
+		debug_info_components = g_ptr_array_new();
+		if (!debug_info_components) {
+			BT_LOGE_STR("Failed to allocate a GPtrArray.");
+			return -1;
+		}
+	}
+
+	g_ptr_array_add(debug_info_components, debug_info);
+	return 0;
+}
+
+static
+void unregister_debug_info_component(struct debug_info_component *debug_info)
+{
+	if (!debug_info_components) {
+		return;
+	}
+
+	g_ptr_array_remove_fast(debug_info_components, debug_info);
+	if (debug_info_components->len == 0) {
+		g_ptr_array_free(debug_info_components, TRUE);
+		debug_info_components = NULL;
+	}
+}
+
 static
 void destroy_debug_info_data(struct debug_info_component *debug_info)
 {
+	unregister_debug_info_component(debug_info);
 	free(debug_info->arg_debug_info_field_name);
+	g_free(debug_info->name);
 	g_free(debug_info);
 }
 
 static
 void destroy_debug_info_component(struct bt_private_component *component)
 {
-	void *data = bt_private_component_get_user_data(component);
-	destroy_debug_info_data(data);
+	struct debug_info_component *debug_info =
+		bt_private_component_get_user_data(component);
+
+	BT_LOGI("Destroying debug-info component: name=\"%s\", "
+		"cache-hits=%" PRIu64 ", cache-misses=%" PRIu64 ", "
+		"cache-evictions=%" PRIu64, debug_info->name,
+		debug_info->cache_stats.hits,
+		debug_info->cache_stats.misses,
+		debug_info->cache_stats.evictions);
+	destroy_debug_info_data(debug_info);
 }
 
 static
@@ -415,6 +463,47 @@ enum bt_component_status init_from_params(
 		goto end;
 	}
 
+        value = bt_value_map_get(params, "copy-fields");
+	if (value) {
+		enum bt_value_status value_ret;
+		bt_bool bool_val;
+
+		value_ret = bt_value_bool_get(value,
+				&bool_val);
+		if (value_ret) {
+			ret = BT_COMPONENT_STATUS_INVALID;
+			BT_LOGE_STR("Failed to retrieve copy-fields value. "
+					"Expecting a boolean.");
+		}
+
+		debug_info_component->arg_copy_fields = bool_val;
+	}
+	bt_put(value);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto end;
+	}
+
+	debug_info_component->arg_cache_size = DEBUG_INFO_DEFAULT_CACHE_SIZE;
+        value = bt_value_map_get(params, "cache-size");
+	if (value) {
+		enum bt_value_status value_ret;
+		int64_t int_val;
+
+		value_ret = bt_value_integer_get(value, &int_val);
+		if (value_ret || int_val <= 0) {
+			ret = BT_COMPONENT_STATUS_INVALID;
+			BT_LOGE_STR("Failed to retrieve cache-size value. "
+					"Expecting a positive integer.");
+		} else {
+			debug_info_component->arg_cache_size =
+				(uint64_t) int_val;
+		}
+	}
+	bt_put(value);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto end;
+	}
+
 end:
 	return ret;
 }
@@ -425,12 +514,22 @@ enum bt_component_status debug_info_component_init(
 {
 	enum bt_component_status ret;
 	struct debug_info_component *debug_info = create_debug_info_component_data();
+	struct bt_component *comp;
 
 	if (!debug_info) {
 		ret = BT_COMPONENT_STATUS_NOMEM;
 		goto end;
 	}
 
+	comp = bt_component_from_private(component);
+	assert(comp);
+	debug_info->name = g_strdup(bt_component_get_name(comp));
+	bt_put(comp);
+	if (!debug_info->name || register_debug_info_component(debug_info)) {
+		ret = BT_COMPONENT_STATUS_NOMEM;
+		goto error;
+	}
+
 	ret = bt_private_component_set_user_data(component, debug_info);
 	if (ret != BT_COMPONENT_STATUS_OK) {
 		goto error;
@@ -456,6 +555,120 @@ error:
 	return ret;
 }
 
+static
+struct bt_value *create_cache_stats_map(struct debug_info_component *debug_info)
+{
+	struct bt_value *map = bt_value_map_create();
+	int ret = 0;
+
+	if (!map) {
+		BT_LOGE_STR("Cannot create map value.");
+		goto end;
+	}
+
+	ret |= bt_value_map_insert_string(map, "component-name",
+		debug_info->name);
+	ret |= bt_value_map_insert_integer(map, "hits",
+		(int64_t) debug_info->cache_stats.hits);
+	ret |= bt_value_map_insert_integer(map, "misses",
+		(int64_t) debug_info->cache_stats.misses);
+	ret |= bt_value_map_insert_integer(map, "evictions",
+		(int64_t) debug_info->cache_stats.evictions);
+	if (ret) {
+		BT_LOGE_STR("Cannot insert cache counters into map value.");
+		BT_PUT(map);
+	}
+
+end:
+	return map;
+}
+
+static
+struct bt_component_class_query_method_return cache_stats_query(
+		struct bt_value *params)
+{
+	struct bt_component_class_query_method_return query_ret = {
+		.result = NULL,
+		.status = BT_QUERY_STATUS_OK,
+	};
+	struct bt_value *name_value = NULL;
+	const char *name = NULL;
+	guint i;
+
+	if (bt_value_is_map(params)) {
+		name_value = bt_value_map_get(params, "component-name");
+		if (name_value && bt_value_string_get(name_value, &name)) {
+			BT_LOGE_STR("Cannot get `component-name` string parameter.");
+			query_ret.status = BT_QUERY_STATUS_INVALID_PARAMS;
+			goto error;
+		}
+	}
+
+	query_ret.result = bt_value_array_create();
+	if (!query_ret.result) {
+		query_ret.status = BT_QUERY_STATUS_NOMEM;
+		goto error;
+	}
+
+	for (i = 0; debug_info_components &&
+			i < debug_info_components->len; i++) {
+		struct debug_info_component *debug_info =
+			g_ptr_array_index(debug_info_components, i);
+		struct bt_value *map;
+		int ret;
+
+		if (name && strcmp(debug_info->name, name) != 0) {
+			continue;
+		}
+
+		map = create_cache_stats_map(debug_info);
+		if (!map) {
+			goto error;
+		}
+
+		ret = bt_value_array_append(query_ret.result, map);
+		bt_put(map);
+		if (ret) {
+			BT_LOGE_STR("Cannot append map value to array value.");
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	BT_PUT(query_ret.result);
+
+	if (query_ret.status >= 0) {
+		query_ret.status = BT_QUERY_STATUS_ERROR;
+	}
+
+end:
+	bt_put(name_value);
+	return query_ret;
+}
+
+static
+struct bt_component_class_query_method_return debug_info_component_query(
+		struct bt_component_class *comp_class,
+		struct bt_query_executor *query_exec,
+		const char *object, struct bt_value *params)
+{
+	struct bt_component_class_query_method_return ret = {
+		.result = NULL,
+		.status = BT_QUERY_STATUS_OK,
+	};
+
+	if (!strcmp(object, "cache-stats")) {
+		ret = cache_stats_query(params);
+	} else {
+		BT_LOGE("Unknown query object `%s`", object);
+		ret.status = BT_QUERY_STATUS_INVALID_OBJECT;
+	}
+
+	return ret;
+}
+
 #ifndef BT_BUILT_IN_PLUGINS
 BT_PLUGIN_MODULE();
 #endif
@@ -474,6 +687,8 @@ BT_PLUGIN_FILTER_COMPONENT_CLASS_INIT_METHOD_WITH_ID(lttng_utils,
 	debug_info, debug_info_component_init);
 BT_PLUGIN_FILTER_COMPONENT_CLASS_FINALIZE_METHOD_WITH_ID(lttng_utils,
 	debug_info, destroy_debug_info_component);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_QUERY_METHOD_WITH_ID(lttng_utils,
+	debug_info, debug_info_component_query);
 BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_INIT_METHOD_WITH_ID(
 	lttng_utils, debug_info, debug_info_iterator_init);
 BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_FINALIZE_METHOD_WITH_ID(
@@ -39,6 +39,9 @@
 
 #include "pretty.h"
 
+/* Maximum number of notifications to handle per consuming call */
+#define CONSUME_BATCH_CAPACITY	64
+
 GQuark stream_packet_context_quarks[STREAM_PACKET_CONTEXT_QUARKS_LEN];
 
 static
@@ -189,12 +192,14 @@ void pretty_port_connected(
 BT_HIDDEN
 enum bt_component_status pretty_consume(struct bt_private_component *component)
 {
-	enum bt_component_status ret;
-	struct bt_notification *notification = NULL;
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct bt_notification *notifications[CONSUME_BATCH_CAPACITY];
 	struct bt_notification_iterator *it;
 	struct pretty_component *pretty =
 		bt_private_component_get_user_data(component);
 	enum bt_notification_iterator_status it_ret;
+	uint64_t count = 0;
+	uint64_t i;
 
 	if (unlikely(pretty->error)) {
 		ret = BT_COMPONENT_STATUS_ERROR;
@@ -202,7 +207,8 @@ enum bt_component_status pretty_consume(struct bt_private_component *component)
 	}
 
 	it = pretty->input_iterator;
-	it_ret = bt_notification_iterator_next(it);
+	it_ret = bt_notification_iterator_next_batch(it, notifications,
+		CONSUME_BATCH_CAPACITY, &count);
 
 	switch (it_ret) {
 	case BT_NOTIFICATION_ITERATOR_STATUS_END:
@@ -219,12 +225,17 @@ enum bt_component_status pretty_consume(struct bt_private_component *component)
 		goto end;
 	}
 
-	notification = bt_notification_iterator_get_notification(it);
-	assert(notification);
-	ret = handle_notification(pretty, notification);
+	for (i = 0; i < count; i++) {
+		assert(notifications[i]);
+
+		if (ret == BT_COMPONENT_STATUS_OK) {
+			ret = handle_notification(pretty, notifications[i]);
+		}
+
+		bt_put(notifications[i]);
+	}
 
 end:
-	bt_put(notification);
 	return ret;
 }
 
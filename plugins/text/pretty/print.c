@@ -85,20 +85,11 @@ void print_timestamp_cycles(struct pretty_component *pretty,
 		struct bt_event *event)
 {
 	int ret;
-	struct bt_clock_value *clock_value;
 	uint64_t cycles;
 
-	clock_value = bt_event_get_clock_value(event, clock_class);
-	if (!clock_value) {
-		g_string_append(pretty->string, "????????????????????");
-		return;
-	}
-
-	ret = bt_clock_value_get_value(clock_value, &cycles);
-	bt_put(clock_value);
+	ret = bt_event_get_clock_value_cycles(event, clock_class, &cycles);
 	if (ret) {
-		// TODO: log, this is unexpected
-		g_string_append(pretty->string, "Error");
+		g_string_append(pretty->string, "????????????????????");
 		return;
 	}
 
@@ -783,8 +774,9 @@ enum bt_component_status print_enum(struct pretty_component *pretty,
 	struct bt_field *container_field = NULL;
 	struct bt_field_type *enumeration_field_type = NULL;
 	struct bt_field_type *container_field_type = NULL;
-	struct bt_field_type_enumeration_mapping_iterator *iter = NULL;
-	int nr_mappings = 0;
+	const char * const *mapping_names = NULL;
+	int64_t nr_mappings;
+	int64_t i;
 	int is_signed;
 
 	enumeration_field_type = bt_field_get_type(field);
@@ -815,8 +807,9 @@ enum bt_component_status print_enum(struct pretty_component *pretty,
 			ret = BT_COMPONENT_STATUS_ERROR;
 			goto end;
 		}
-		iter = bt_field_type_enumeration_find_mappings_by_signed_value(
-				enumeration_field_type, value);
+		nr_mappings =
+			bt_field_type_enumeration_get_mapping_names_by_signed_value(
+				enumeration_field_type, value, &mapping_names);
 	} else {
 		uint64_t value;
 
@@ -825,12 +818,16 @@ enum bt_component_status print_enum(struct pretty_component *pretty,
 			ret = BT_COMPONENT_STATUS_ERROR;
 			goto end;
 		}
-		iter = bt_field_type_enumeration_find_mappings_by_unsigned_value(
-				enumeration_field_type, value);
+		nr_mappings =
+			bt_field_type_enumeration_get_mapping_names_by_unsigned_value(
+				enumeration_field_type, value, &mapping_names);
+	}
+	if (nr_mappings < 0) {
+		ret = BT_COMPONENT_STATUS_ERROR;
+		goto end;
 	}
 	g_string_append(pretty->string, "( ");
-	ret = bt_field_type_enumeration_mapping_iterator_next(iter);
-	if (ret) {
+	if (nr_mappings == 0) {
 		if (pretty->use_colors) {
 			g_string_append(pretty->string, COLOR_UNKNOWN);
 		}
@@ -838,30 +835,18 @@ enum bt_component_status print_enum(struct pretty_component *pretty,
 		if (pretty->use_colors) {
 			g_string_append(pretty->string, COLOR_RST);
 		}
-		goto skip_loop;
 	}
-	for (;;) {
-		const char *mapping_name;
-
-		if (bt_field_type_enumeration_mapping_iterator_get_signed(
-				iter, &mapping_name, NULL, NULL) < 0) {
-			ret = BT_COMPONENT_STATUS_ERROR;
-			goto end;
-		}
-		if (nr_mappings++)
+	for (i = 0; i < nr_mappings; i++) {
+		if (i > 0)
 			g_string_append(pretty->string, ", ");
 		if (pretty->use_colors) {
 			g_string_append(pretty->string, COLOR_ENUM_MAPPING_NAME);
 		}
-		print_escape_string(pretty, mapping_name);
+		print_escape_string(pretty, mapping_names[i]);
 		if (pretty->use_colors) {
 			g_string_append(pretty->string, COLOR_RST);
 		}
-		if (bt_field_type_enumeration_mapping_iterator_next(iter) < 0) {
-			break;
-		}
 	}
-skip_loop:
 	g_string_append(pretty->string, " : container = ");
 	ret = print_integer(pretty, container_field);
 	if (ret != BT_COMPONENT_STATUS_OK) {
@@ -869,7 +854,6 @@ skip_loop:
 	}
 	g_string_append(pretty->string, " )");
 end:
-	bt_put(iter);
 	bt_put(container_field_type);
 	bt_put(container_field);
 	bt_put(enumeration_field_type);
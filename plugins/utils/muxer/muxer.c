@@ -30,6 +30,7 @@
 #include <babeltrace/graph/component-internal.h>
 #include <babeltrace/graph/notification-iterator-internal.h>
 #include <babeltrace/graph/connection-internal.h>
+#include <babeltrace/prio-heap-internal.h>
 #include <plugins-common.h>
 #include <glib.h>
 #include <stdbool.h>
@@ -39,6 +40,33 @@
 #include <string.h>
 
 #define ASSUME_ABSOLUTE_CLOCK_CLASSES_PARAM_NAME	"assume-absolute-clock-classes"
+#define UPSTREAM_SELECTION_PARAM_NAME			"upstream-selection"
+
+/*
+ * Maximum number of notifications to get at once from an upstream
+ * notification iterator.
+ */
+#define UPSTREAM_NOTIF_ITER_BATCH_CAPACITY		64
+
+/*
+ * How a muxer notification iterator finds the upstream notification
+ * iterator of which the current notification is the youngest.
+ */
+enum muxer_upstream_selection {
+	/*
+	 * Scan all the upstream notification iterators and get the
+	 * time of each current notification on each "next" operation:
+	 * O(N) per notification.
+	 */
+	MUXER_UPSTREAM_SELECTION_LINEAR,
+
+	/*
+	 * Keep the valid upstream notification iterators in a min-heap
+	 * ordered by the cached time of their current notification:
+	 * O(log N) per notification.
+	 */
+	MUXER_UPSTREAM_SELECTION_HEAP,
+};
 
 struct muxer_comp {
 	/*
@@ -55,6 +83,7 @@ struct muxer_comp {
 	bool error;
 	bool initializing_muxer_notif_iter;
 	bool assume_absolute_clock_classes;
+	enum muxer_upstream_selection upstream_selection;
 };
 
 struct muxer_upstream_notif_iter {
@@ -73,6 +102,32 @@ struct muxer_upstream_notif_iter {
 	 * is NULL (which means the upstream iterator is finished).
 	 */
 	bool is_valid;
+
+	/*
+	 * Notifications obtained from the upstream notification
+	 * iterator with bt_notification_iterator_next_batch() (owned by
+	 * this). The entry at index `cur_notif_index` is the current
+	 * notification; the following ones are not considered yet.
+	 */
+	struct bt_notification *notifs[UPSTREAM_NOTIF_ITER_BATCH_CAPACITY];
+	uint64_t notif_count;
+	uint64_t cur_notif_index;
+
+	/*
+	 * Time (ns from Epoch) of the current notification, or
+	 * INT64_MIN if it has no time. Only used with
+	 * MUXER_UPSTREAM_SELECTION_HEAP, and only valid when this
+	 * object is in the muxer notification iterator's heap.
+	 */
+	int64_t cur_notif_ts_ns;
+
+	/*
+	 * Order in which this object was added to its muxer
+	 * notification iterator. The heap selection uses it to break
+	 * ties: the most recently added upstream notification iterator
+	 * wins, like with the linear selection.
+	 */
+	uint64_t add_index;
 };
 
 enum muxer_notif_iter_clock_class_expectation {
@@ -86,13 +141,35 @@ struct muxer_notif_iter {
 	/*
 	 * Array of struct muxer_upstream_notif_iter * (owned by this).
 	 *
-	 * NOTE: This array is searched in linearly to find the youngest
-	 * current notification. Keep this until benchmarks confirm that
-	 * another data structure is faster than this for our typical
-	 * use cases.
+	 * With MUXER_UPSTREAM_SELECTION_LINEAR, this array is searched
+	 * in linearly to find the youngest current notification. With
+	 * MUXER_UPSTREAM_SELECTION_HEAP, the heap below is used instead
+	 * (see `tests/plugins/bench-utils-muxer.c`).
 	 */
 	GPtrArray *muxer_upstream_notif_iters;
 
+	/* Copy of the muxer component's upstream selection mode */
+	enum muxer_upstream_selection upstream_selection;
+
+	/*
+	 * With MUXER_UPSTREAM_SELECTION_HEAP only: heap of valid, non-ended
+	 * struct muxer_upstream_notif_iter * (weak refs) of which the top
+	 * element has the youngest current notification.
+	 */
+	struct ptr_heap upstream_notif_iter_heap;
+
+	/*
+	 * With MUXER_UPSTREAM_SELECTION_HEAP only: array of invalid
+	 * struct muxer_upstream_notif_iter * (weak refs) to validate
+	 * and put into the heap above before the next selection. This
+	 * is the last selected one and the newly added ones, so that
+	 * the "next" operation does not need to visit all of them.
+	 */
+	GPtrArray *invalid_muxer_upstream_notif_iters;
+
+	/* Value of the next muxer_upstream_notif_iter::add_index */
+	uint64_t next_upstream_notif_iter_add_index;
+
 	/*
 	 * List of "recently" connected input ports (weak) to
 	 * handle by this muxer notification iterator.
@@ -107,6 +184,13 @@ struct muxer_notif_iter {
 	/* Next thing to return by the "next" method */
 	struct bt_notification_iterator_next_method_return next_next_return;
 
+	/*
+	 * Status to return by the next call of the "next batch" method
+	 * because the previous call returned notifications before
+	 * getting it (BT_NOTIFICATION_ITERATOR_STATUS_OK means none).
+	 */
+	enum bt_notification_iterator_status pending_batch_status;
+
 	/* Last time returned in a notification */
 	int64_t last_returned_ts_ns;
 
@@ -121,6 +205,52 @@ struct muxer_notif_iter {
 	unsigned char expected_clock_class_uuid[BABELTRACE_UUID_LEN];
 };
 
+static
+void put_muxer_upstream_notif_iter_notifs(
+		struct muxer_upstream_notif_iter *muxer_upstream_notif_iter)
+{
+	uint64_t i;
+
+	for (i = muxer_upstream_notif_iter->cur_notif_index;
+			i < muxer_upstream_notif_iter->notif_count; i++) {
+		BT_PUT(muxer_upstream_notif_iter->notifs[i]);
+	}
+
+	muxer_upstream_notif_iter->notif_count = 0;
+	muxer_upstream_notif_iter->cur_notif_index = 0;
+}
+
+static inline
+struct bt_notification *muxer_upstream_notif_iter_borrow_cur_notif(
+		struct muxer_upstream_notif_iter *muxer_upstream_notif_iter)
+{
+	assert(muxer_upstream_notif_iter->cur_notif_index <
+		muxer_upstream_notif_iter->notif_count);
+	return muxer_upstream_notif_iter->notifs[
+		muxer_upstream_notif_iter->cur_notif_index];
+}
+
+/*
+ * "Greater than" function of the upstream notification iterator heap:
+ * the top element of the heap is the one of which the current
+ * notification is the youngest.
+ */
+static
+int muxer_upstream_notif_iter_heap_gt(void *a, void *b)
+{
+	struct muxer_upstream_notif_iter *muxer_upstream_notif_iter_a = a;
+	struct muxer_upstream_notif_iter *muxer_upstream_notif_iter_b = b;
+
+	if (muxer_upstream_notif_iter_a->cur_notif_ts_ns !=
+			muxer_upstream_notif_iter_b->cur_notif_ts_ns) {
+		return muxer_upstream_notif_iter_a->cur_notif_ts_ns <
+			muxer_upstream_notif_iter_b->cur_notif_ts_ns;
+	}
+
+	return muxer_upstream_notif_iter_a->add_index >
+		muxer_upstream_notif_iter_b->add_index;
+}
+
 static
 void destroy_muxer_upstream_notif_iter(
 		struct muxer_upstream_notif_iter *muxer_upstream_notif_iter)
@@ -134,6 +264,7 @@ void destroy_muxer_upstream_notif_iter(
 		muxer_upstream_notif_iter,
 		muxer_upstream_notif_iter->notif_iter,
 		muxer_upstream_notif_iter->is_valid);
+	put_muxer_upstream_notif_iter_notifs(muxer_upstream_notif_iter);
 	bt_put(muxer_upstream_notif_iter->notif_iter);
 	g_free(muxer_upstream_notif_iter);
 }
@@ -154,8 +285,18 @@ struct muxer_upstream_notif_iter *muxer_notif_iter_add_upstream_notif_iter(
 
 	muxer_upstream_notif_iter->notif_iter = bt_get(notif_iter);
 	muxer_upstream_notif_iter->is_valid = false;
+	muxer_upstream_notif_iter->add_index =
+		muxer_notif_iter->next_upstream_notif_iter_add_index++;
 	g_ptr_array_add(muxer_notif_iter->muxer_upstream_notif_iters,
 		muxer_upstream_notif_iter);
+
+	if (muxer_notif_iter->upstream_selection ==
+			MUXER_UPSTREAM_SELECTION_HEAP) {
+		g_ptr_array_add(
+			muxer_notif_iter->invalid_muxer_upstream_notif_iters,
+			muxer_upstream_notif_iter);
+	}
+
 	BT_LOGD("Added muxer's upstream notification iterator wrapper: "
 		"addr=%p, muxer-notif-iter-addr=%p, notif-iter-addr=%p",
 		muxer_upstream_notif_iter, muxer_notif_iter,
@@ -257,6 +398,13 @@ struct bt_value *get_default_params(void)
 		goto error;
 	}
 
+	ret = bt_value_map_insert_string(params,
+		UPSTREAM_SELECTION_PARAM_NAME, "heap");
+	if (ret) {
+		BT_LOGE_STR("Cannot add string value to map value object.");
+		goto error;
+	}
+
 	goto end;
 
 error:
@@ -272,8 +420,10 @@ int configure_muxer_comp(struct muxer_comp *muxer_comp, struct bt_value *params)
 	struct bt_value *default_params = NULL;
 	struct bt_value *real_params = NULL;
 	struct bt_value *assume_absolute_clock_classes = NULL;
+	struct bt_value *upstream_selection = NULL;
 	int ret = 0;
 	bt_bool bool_val;
+	const char *str_val;
 
 	default_params = get_default_params();
 	if (!default_params) {
@@ -305,9 +455,37 @@ int configure_muxer_comp(struct muxer_comp *muxer_comp, struct bt_value *params)
 	ret = bt_value_bool_get(assume_absolute_clock_classes, &bool_val);
 	assert(ret == 0);
 	muxer_comp->assume_absolute_clock_classes = (bool) bool_val;
+
+	upstream_selection = bt_value_map_get(real_params,
+		UPSTREAM_SELECTION_PARAM_NAME);
+	if (!bt_value_is_string(upstream_selection)) {
+		BT_LOGE("Expecting a string value for the `%s` parameter: "
+			"muxer-comp-addr=%p, value-type=%s",
+			UPSTREAM_SELECTION_PARAM_NAME, muxer_comp,
+			bt_value_type_string(
+				bt_value_get_type(upstream_selection)));
+		goto error;
+	}
+
+	ret = bt_value_string_get(upstream_selection, &str_val);
+	assert(ret == 0);
+
+	if (strcmp(str_val, "heap") == 0) {
+		muxer_comp->upstream_selection = MUXER_UPSTREAM_SELECTION_HEAP;
+	} else if (strcmp(str_val, "linear") == 0) {
+		muxer_comp->upstream_selection =
+			MUXER_UPSTREAM_SELECTION_LINEAR;
+	} else {
+		BT_LOGE("Unknown value for the `%s` parameter: "
+			"muxer-comp-addr=%p, value=\"%s\"",
+			UPSTREAM_SELECTION_PARAM_NAME, muxer_comp, str_val);
+		goto error;
+	}
+
 	BT_LOGD("Configured muxer component: muxer-comp-addr=%p, "
-		"assume-absolute-clock-classes=%d",
-		muxer_comp, muxer_comp->assume_absolute_clock_classes);
+		"assume-absolute-clock-classes=%d, upstream-selection=%s",
+		muxer_comp, muxer_comp->assume_absolute_clock_classes,
+		str_val);
 	goto end;
 
 error:
@@ -317,6 +495,7 @@ end:
 	bt_put(default_params);
 	bt_put(real_params);
 	bt_put(assume_absolute_clock_classes);
+	bt_put(upstream_selection);
 	return ret;
 }
 
@@ -450,14 +629,41 @@ enum bt_notification_iterator_status muxer_upstream_notif_iter_next(
 {
 	enum bt_notification_iterator_status status;
 
-	BT_LOGV("Calling upstream notification iterator's \"next\" method: "
+	if (muxer_upstream_notif_iter->notif_count > 0) {
+		/* Release the notification which was already muxed */
+		BT_PUT(muxer_upstream_notif_iter->notifs[
+			muxer_upstream_notif_iter->cur_notif_index]);
+		muxer_upstream_notif_iter->cur_notif_index++;
+
+		if (muxer_upstream_notif_iter->cur_notif_index <
+				muxer_upstream_notif_iter->notif_count) {
+			/*
+			 * We already have the next notification from
+			 * the last batch: no need to call the upstream
+			 * notification iterator.
+			 */
+			muxer_upstream_notif_iter->is_valid = true;
+			status = BT_NOTIFICATION_ITERATOR_STATUS_OK;
+			goto end;
+		}
+
+		muxer_upstream_notif_iter->notif_count = 0;
+		muxer_upstream_notif_iter->cur_notif_index = 0;
+	}
+
+	BT_LOGV("Calling upstream notification iterator's \"next batch\" method: "
 		"muxer-upstream-notif-iter-wrap-addr=%p, notif-iter-addr=%p",
 		muxer_upstream_notif_iter,
 		muxer_upstream_notif_iter->notif_iter);
-	status = bt_notification_iterator_next(
-		muxer_upstream_notif_iter->notif_iter);
-	BT_LOGV("Upstream notification iterator's \"next\" method returned: "
-		"status=%s", bt_notification_iterator_status_string(status));
+	status = bt_notification_iterator_next_batch(
+		muxer_upstream_notif_iter->notif_iter,
+		muxer_upstream_notif_iter->notifs,
+		UPSTREAM_NOTIF_ITER_BATCH_CAPACITY,
+		&muxer_upstream_notif_iter->notif_count);
+	BT_LOGV("Upstream notification iterator's \"next batch\" method returned: "
+		"status=%s, count=%" PRIu64,
+		bt_notification_iterator_status_string(status),
+		muxer_upstream_notif_iter->notif_count);
 
 	switch (status) {
 	case BT_NOTIFICATION_ITERATOR_STATUS_OK:
@@ -498,6 +704,7 @@ enum bt_notification_iterator_status muxer_upstream_notif_iter_next(
 		break;
 	}
 
+end:
 	return status;
 }
 
@@ -806,11 +1013,23 @@ int get_notif_ts_ns(struct muxer_comp *muxer_comp,
 
 	switch (bt_notification_get_type(notif)) {
 	case BT_NOTIFICATION_TYPE_EVENT:
+		/*
+		 * Read the event's clock value in place: this is the
+		 * hot path, so avoid creating a clock value object.
+		 */
 		event = bt_notification_event_get_event(notif);
 		assert(event);
-		clock_value = bt_event_get_clock_value(event,
-			clock_class);
-		break;
+		ret = bt_event_get_clock_value_ns_from_epoch(event,
+			clock_class, ts_ns);
+		if (ret) {
+			BT_LOGE("Cannot get event's clock value in nanoseconds from Epoch for clock class: "
+				"event-addr=%p, clock-class-addr=%p, "
+				"clock-class-name=\"%s\"",
+				event, clock_class, cc_name);
+			goto error;
+		}
+
+		goto end;
 	case BT_NOTIFICATION_TYPE_INACTIVITY:
 		clock_value = bt_notification_inactivity_get_clock_value(
 			notif, clock_class);
@@ -907,12 +1126,11 @@ muxer_notif_iter_youngest_upstream_notif_iter(
 		}
 
 		assert(cur_muxer_upstream_notif_iter->is_valid);
-		notif = bt_notification_iterator_get_notification(
-			cur_muxer_upstream_notif_iter->notif_iter);
+		notif = muxer_upstream_notif_iter_borrow_cur_notif(
+			cur_muxer_upstream_notif_iter);
 		assert(notif);
 		ret = get_notif_ts_ns(muxer_comp, muxer_notif_iter, notif,
 			muxer_notif_iter->last_returned_ts_ns, &notif_ts_ns);
-		bt_put(notif);
 		if (ret) {
 			/* get_notif_ts_ns() logs errors */
 			*muxer_upstream_notif_iter = NULL;
@@ -937,6 +1155,46 @@ end:
 	return status;
 }
 
+/*
+ * Heap version of muxer_notif_iter_youngest_upstream_notif_iter(): the
+ * youngest upstream notification iterator is the top element of the
+ * heap, and the time of its current notification is already cached.
+ *
+ * On success, the upstream notification iterator is removed from the
+ * heap: the caller must invalidate it so that
+ * validate_muxer_upstream_notif_iters_heap() puts it back.
+ */
+static
+enum bt_notification_iterator_status
+muxer_notif_iter_youngest_upstream_notif_iter_heap(
+		struct muxer_notif_iter *muxer_notif_iter,
+		struct muxer_upstream_notif_iter **muxer_upstream_notif_iter,
+		int64_t *ts_ns)
+{
+	enum bt_notification_iterator_status status =
+		BT_NOTIFICATION_ITERATOR_STATUS_OK;
+
+	assert(muxer_notif_iter);
+	assert(muxer_upstream_notif_iter);
+	*muxer_upstream_notif_iter = bt_heap_remove(
+		&muxer_notif_iter->upstream_notif_iter_heap);
+	if (!*muxer_upstream_notif_iter) {
+		status = BT_NOTIFICATION_ITERATOR_STATUS_END;
+		*ts_ns = INT64_MIN;
+		goto end;
+	}
+
+	if ((*muxer_upstream_notif_iter)->cur_notif_ts_ns == INT64_MIN) {
+		/* No time: always the youngest */
+		*ts_ns = muxer_notif_iter->last_returned_ts_ns;
+	} else {
+		*ts_ns = (*muxer_upstream_notif_iter)->cur_notif_ts_ns;
+	}
+
+end:
+	return status;
+}
+
 static
 enum bt_notification_iterator_status validate_muxer_upstream_notif_iter(
 	struct muxer_upstream_notif_iter *muxer_upstream_notif_iter)
@@ -1021,6 +1279,106 @@ end:
 	return status;
 }
 
+/*
+ * Heap version of validate_muxer_upstream_notif_iters(): only the
+ * invalid upstream notification iterators are validated. Each one
+ * which is not ended is then put into the heap with the time of its
+ * current notification.
+ */
+static
+enum bt_notification_iterator_status validate_muxer_upstream_notif_iters_heap(
+	struct muxer_comp *muxer_comp,
+	struct muxer_notif_iter *muxer_notif_iter)
+{
+	enum bt_notification_iterator_status status =
+		BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	GPtrArray *invalid_muxer_upstream_notif_iters =
+		muxer_notif_iter->invalid_muxer_upstream_notif_iters;
+
+	BT_LOGV("Validating muxer's invalid upstream notification iterator wrappers: "
+		"muxer-notif-iter-addr=%p, count=%u", muxer_notif_iter,
+		invalid_muxer_upstream_notif_iters->len);
+
+	while (invalid_muxer_upstream_notif_iters->len > 0) {
+		struct muxer_upstream_notif_iter *muxer_upstream_notif_iter =
+			g_ptr_array_index(invalid_muxer_upstream_notif_iters,
+				0);
+		int ret;
+
+		status = validate_muxer_upstream_notif_iter(
+			muxer_upstream_notif_iter);
+		if (status != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+			if (status < 0) {
+				BT_LOGE("Cannot validate muxer's upstream notification iterator wrapper: "
+					"muxer-notif-iter-addr=%p, "
+					"muxer-upstream-notif-iter-wrap-addr=%p",
+					muxer_notif_iter,
+					muxer_upstream_notif_iter);
+			} else {
+				BT_LOGV("Cannot validate muxer's upstream notification iterator wrapper: "
+					"muxer-notif-iter-addr=%p, "
+					"muxer-upstream-notif-iter-wrap-addr=%p",
+					muxer_notif_iter,
+					muxer_upstream_notif_iter);
+			}
+
+			goto end;
+		}
+
+		if (!muxer_upstream_notif_iter->notif_iter) {
+			/*
+			 * Ended or canceled: destroy it instead of
+			 * putting it into the heap.
+			 */
+			BT_LOGV("Removing muxer's upstream notification iterator wrapper: ended or canceled: "
+				"muxer-notif-iter-addr=%p, "
+				"muxer-upstream-notif-iter-wrap-addr=%p",
+				muxer_notif_iter, muxer_upstream_notif_iter);
+			g_ptr_array_remove_index(
+				invalid_muxer_upstream_notif_iters, 0);
+			g_ptr_array_remove_fast(
+				muxer_notif_iter->muxer_upstream_notif_iters,
+				muxer_upstream_notif_iter);
+			continue;
+		}
+
+		/*
+		 * Get the time of the current notification once. Pass
+		 * INT64_MIN as the last returned time so that a
+		 * notification without a time sorts before all the
+		 * others: the actual time to return for it is only
+		 * known when it's selected.
+		 */
+		assert(muxer_upstream_notif_iter->is_valid);
+		ret = get_notif_ts_ns(muxer_comp, muxer_notif_iter,
+			muxer_upstream_notif_iter_borrow_cur_notif(
+				muxer_upstream_notif_iter),
+			INT64_MIN, &muxer_upstream_notif_iter->cur_notif_ts_ns);
+		if (ret) {
+			/* get_notif_ts_ns() logs errors */
+			status = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+			goto end;
+		}
+
+		ret = bt_heap_insert(&muxer_notif_iter->upstream_notif_iter_heap,
+			muxer_upstream_notif_iter);
+		if (ret) {
+			BT_LOGE("Cannot insert muxer's upstream notification iterator wrapper into heap: "
+				"muxer-notif-iter-addr=%p, "
+				"muxer-upstream-notif-iter-wrap-addr=%p, ret=%d",
+				muxer_notif_iter, muxer_upstream_notif_iter,
+				ret);
+			status = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+			goto end;
+		}
+
+		g_ptr_array_remove_index(invalid_muxer_upstream_notif_iters, 0);
+	}
+
+end:
+	return status;
+}
+
 static
 struct bt_notification_iterator_next_method_return muxer_notif_iter_do_next(
 		struct muxer_comp *muxer_comp,
@@ -1047,10 +1405,19 @@ struct bt_notification_iterator_next_method_return muxer_notif_iter_do_next(
 			goto end;
 		}
 
-		next_return.status =
-			validate_muxer_upstream_notif_iters(muxer_notif_iter);
+		if (muxer_notif_iter->upstream_selection ==
+				MUXER_UPSTREAM_SELECTION_HEAP) {
+			next_return.status =
+				validate_muxer_upstream_notif_iters_heap(
+					muxer_comp, muxer_notif_iter);
+		} else {
+			next_return.status =
+				validate_muxer_upstream_notif_iters(
+					muxer_notif_iter);
+		}
+
 		if (next_return.status != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
-			/* validate_muxer_upstream_notif_iters() logs details */
+			/* validate_muxer_upstream_notif_iters*() log details */
 			goto end;
 		}
 
@@ -1077,10 +1444,19 @@ struct bt_notification_iterator_next_method_return muxer_notif_iter_do_next(
 	 * amongst those, of which the current notification is the
 	 * youngest.
 	 */
-	next_return.status =
-		muxer_notif_iter_youngest_upstream_notif_iter(muxer_comp,
-			muxer_notif_iter, &muxer_upstream_notif_iter,
-			&next_return_ts);
+	if (muxer_notif_iter->upstream_selection ==
+			MUXER_UPSTREAM_SELECTION_HEAP) {
+		next_return.status =
+			muxer_notif_iter_youngest_upstream_notif_iter_heap(
+				muxer_notif_iter, &muxer_upstream_notif_iter,
+				&next_return_ts);
+	} else {
+		next_return.status =
+			muxer_notif_iter_youngest_upstream_notif_iter(
+				muxer_comp, muxer_notif_iter,
+				&muxer_upstream_notif_iter, &next_return_ts);
+	}
+
 	if (next_return.status < 0 ||
 			next_return.status == BT_NOTIFICATION_ITERATOR_STATUS_END ||
 			next_return.status == BT_NOTIFICATION_ITERATOR_STATUS_CANCELED) {
@@ -1114,8 +1490,9 @@ struct bt_notification_iterator_next_method_return muxer_notif_iter_do_next(
 		muxer_notif_iter, muxer_upstream_notif_iter, next_return_ts);
 	assert(next_return.status == BT_NOTIFICATION_ITERATOR_STATUS_OK);
 	assert(muxer_upstream_notif_iter);
-	next_return.notification = bt_notification_iterator_get_notification(
-		muxer_upstream_notif_iter->notif_iter);
+	next_return.notification = bt_get(
+		muxer_upstream_notif_iter_borrow_cur_notif(
+			muxer_upstream_notif_iter));
 	assert(next_return.notification);
 
 	/*
@@ -1126,6 +1503,13 @@ struct bt_notification_iterator_next_method_return muxer_notif_iter_do_next(
 	muxer_upstream_notif_iter->is_valid = false;
 	muxer_notif_iter->last_returned_ts_ns = next_return_ts;
 
+	if (muxer_notif_iter->upstream_selection ==
+			MUXER_UPSTREAM_SELECTION_HEAP) {
+		g_ptr_array_add(
+			muxer_notif_iter->invalid_muxer_upstream_notif_iters,
+			muxer_upstream_notif_iter);
+	}
+
 end:
 	return next_return;
 }
@@ -1146,6 +1530,13 @@ void destroy_muxer_notif_iter(struct muxer_notif_iter *muxer_notif_iter)
 			muxer_notif_iter->muxer_upstream_notif_iters, TRUE);
 	}
 
+	if (muxer_notif_iter->invalid_muxer_upstream_notif_iters) {
+		g_ptr_array_free(
+			muxer_notif_iter->invalid_muxer_upstream_notif_iters,
+			TRUE);
+	}
+
+	bt_heap_free(&muxer_notif_iter->upstream_notif_iter_heap);
 	g_list_free(muxer_notif_iter->newly_connected_priv_ports);
 	g_free(muxer_notif_iter);
 }
@@ -1268,6 +1659,25 @@ enum bt_notification_iterator_status muxer_notif_iter_init(
 		goto error;
 	}
 
+	muxer_notif_iter->upstream_selection = muxer_comp->upstream_selection;
+
+	if (muxer_notif_iter->upstream_selection ==
+			MUXER_UPSTREAM_SELECTION_HEAP) {
+		muxer_notif_iter->invalid_muxer_upstream_notif_iters =
+			g_ptr_array_new();
+		if (!muxer_notif_iter->invalid_muxer_upstream_notif_iters) {
+			BT_LOGE_STR("Failed to allocate a GPtrArray.");
+			goto error;
+		}
+
+		ret = bt_heap_init(&muxer_notif_iter->upstream_notif_iter_heap,
+			0, muxer_upstream_notif_iter_heap_gt);
+		if (ret) {
+			BT_LOGE("Cannot initialize heap: ret=%d", ret);
+			goto error;
+		}
+	}
+
 	/*
 	 * Add the muxer notification iterator to the component's array
 	 * of muxer notification iterators here because
@@ -1395,6 +1805,56 @@ end:
 	return next_ret;
 }
 
+BT_HIDDEN
+struct bt_notification_iterator_next_batch_method_return muxer_notif_iter_next_batch(
+		struct bt_private_connection_private_notification_iterator *priv_notif_iter,
+		struct bt_notification **notifs, uint64_t capacity)
+{
+	struct bt_notification_iterator_next_batch_method_return batch_ret = {
+		.count = 0,
+		.status = BT_NOTIFICATION_ITERATOR_STATUS_OK,
+	};
+	struct muxer_notif_iter *muxer_notif_iter =
+		bt_private_connection_private_notification_iterator_get_user_data(priv_notif_iter);
+
+	assert(muxer_notif_iter);
+	assert(capacity > 0);
+
+	if (muxer_notif_iter->pending_batch_status !=
+			BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		batch_ret.status = muxer_notif_iter->pending_batch_status;
+		muxer_notif_iter->pending_batch_status =
+			BT_NOTIFICATION_ITERATOR_STATUS_OK;
+		goto end;
+	}
+
+	while (batch_ret.count < capacity) {
+		struct bt_notification_iterator_next_method_return next_ret =
+			muxer_notif_iter_next(priv_notif_iter);
+
+		if (next_ret.status != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+			if (batch_ret.count == 0) {
+				batch_ret.status = next_ret.status;
+			} else {
+				/*
+				 * Return what we have now and this
+				 * status on the next call.
+				 */
+				muxer_notif_iter->pending_batch_status =
+					next_ret.status;
+			}
+
+			break;
+		}
+
+		notifs[batch_ret.count] = next_ret.notification;
+		batch_ret.count++;
+	}
+
+end:
+	return batch_ret;
+}
+
 BT_HIDDEN
 void muxer_port_connected(
 		struct bt_private_component *priv_comp,
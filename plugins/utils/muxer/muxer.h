@@ -48,6 +48,11 @@ BT_HIDDEN
 struct bt_notification_iterator_next_method_return muxer_notif_iter_next(
 		struct bt_private_connection_private_notification_iterator *priv_notif_iter);
 
+BT_HIDDEN
+struct bt_notification_iterator_next_batch_method_return muxer_notif_iter_next_batch(
+		struct bt_private_connection_private_notification_iterator *priv_notif_iter,
+		struct bt_notification **notifs, uint64_t capacity);
+
 BT_HIDDEN
 void muxer_port_connected(
 		struct bt_private_component *priv_comp,
@@ -0,0 +1,201 @@
+/*
+ * Copyright 2017 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Benchmark of bt_event_create().
+ *
+ * This program creates events of an event class with a few payload
+ * fields, and prints the average time per created event in two
+ * situations:
+ *
+ * new:
+ *     All the events are kept alive until the end of the run, so that
+ *     each one is allocated and gets new fields. This is the path of
+ *     the first events of a given event class.
+ *
+ * recycled:
+ *     Each event is released before the next one is created, so that
+ *     bt_event_create() reuses it.
+ *
+ * To compare the event creation rate of two library versions, build
+ * and run this program on both.
+ *
+ * This is not part of `make check`. Run it like this from the build
+ * directory:
+ *
+ *     tests/lib/bench_event_create [EVENT-COUNT]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <babeltrace/babeltrace.h>
+#include <glib.h>
+
+#define DEFAULT_EVENT_COUNT	(1 << 20)
+#define PAYLOAD_INT_FIELD_COUNT	8
+
+static uint64_t event_count = DEFAULT_EVENT_COUNT;
+static struct bt_trace *trace;
+static struct bt_stream_class *stream_class;
+static struct bt_event_class *event_class;
+
+static
+void init_static_data(void)
+{
+	int ret;
+	int i;
+	struct bt_field_type *int_ft;
+	struct bt_field_type *string_ft;
+
+	trace = bt_trace_create();
+	assert(trace);
+	ret = bt_trace_set_native_byte_order(trace,
+		BT_BYTE_ORDER_LITTLE_ENDIAN);
+	assert(ret == 0);
+	stream_class = bt_stream_class_create("stream");
+	assert(stream_class);
+	event_class = bt_event_class_create("event");
+	assert(event_class);
+	int_ft = bt_field_type_integer_create(64);
+	assert(int_ft);
+	string_ft = bt_field_type_string_create();
+	assert(string_ft);
+
+	for (i = 0; i < PAYLOAD_INT_FIELD_COUNT; i++) {
+		char name[16];
+
+		snprintf(name, sizeof(name), "int%d", i);
+		ret = bt_event_class_add_field(event_class, int_ft, name);
+		assert(ret == 0);
+	}
+
+	ret = bt_event_class_add_field(event_class, string_ft, "str");
+	assert(ret == 0);
+	ret = bt_stream_class_add_event_class(stream_class, event_class);
+	assert(ret == 0);
+	ret = bt_trace_add_stream_class(trace, stream_class);
+	assert(ret == 0);
+	bt_put(int_ft);
+	bt_put(string_ft);
+}
+
+static
+void fini_static_data(void)
+{
+	bt_put(event_class);
+	bt_put(stream_class);
+	bt_put(trace);
+}
+
+/* Returns the average time per created event (ns), or -1 on error. */
+static
+double run_new(void)
+{
+	struct bt_event **events;
+	gint64 begin, end;
+	double ns_per_event = -1.;
+	uint64_t i;
+
+	events = g_new0(struct bt_event *, event_count);
+	if (!events) {
+		goto end;
+	}
+
+	begin = g_get_monotonic_time();
+
+	for (i = 0; i < event_count; i++) {
+		events[i] = bt_event_create(event_class);
+		if (!events[i]) {
+			goto put_events;
+		}
+	}
+
+	end = g_get_monotonic_time();
+	ns_per_event = (double) (end - begin) * 1000.0 / (double) event_count;
+
+put_events:
+	for (i = 0; i < event_count; i++) {
+		bt_put(events[i]);
+	}
+
+	g_free(events);
+
+end:
+	return ns_per_event;
+}
+
+/* Returns the average time per created event (ns), or -1 on error. */
+static
+double run_recycled(void)
+{
+	gint64 begin, end;
+	uint64_t i;
+
+	begin = g_get_monotonic_time();
+
+	for (i = 0; i < event_count; i++) {
+		struct bt_event *event = bt_event_create(event_class);
+
+		if (!event) {
+			return -1.;
+		}
+
+		bt_put(event);
+	}
+
+	end = g_get_monotonic_time();
+	return (double) (end - begin) * 1000.0 / (double) event_count;
+}
+
+int main(int argc, char **argv)
+{
+	double new_ns, recycled_ns;
+	int ret = 0;
+
+	if (argc > 1) {
+		event_count = strtoull(argv[1], NULL, 10);
+		if (event_count == 0) {
+			fprintf(stderr, "Invalid number of events: `%s`\n",
+				argv[1]);
+			ret = 1;
+			goto end;
+		}
+	}
+
+	init_static_data();
+	new_ns = run_new();
+	recycled_ns = run_recycled();
+	if (new_ns < 0 || recycled_ns < 0) {
+		fprintf(stderr, "Cannot create events\n");
+		ret = 1;
+		goto fini;
+	}
+
+	printf("%10s %16s %20s\n", "events", "new (ns/event)",
+		"recycled (ns/event)");
+	printf("%10" PRIu64 " %16.1f %20.1f\n", event_count, new_ns,
+		recycled_ns);
+
+fini:
+	fini_static_data();
+
+end:
+	return ret;
+}
@@ -59,7 +59,10 @@
 
 #include "tap/tap.h"
 
-#define NR_TESTS	31
+#define NR_TESTS	36
+
+/* Capacity used by the "next batch" methods of this test */
+#define BATCH_CAPACITY	3
 
 enum test {
 	TEST_NO_AUTO_NOTIFS,
@@ -75,6 +78,7 @@ enum test {
 	TEST_MULTIPLE_AUTO_STREAM_END_FROM_END,
 	TEST_MULTIPLE_AUTO_PACKET_END_STREAM_END_FROM_END,
 	TEST_OUTPUT_PORT_NOTIFICATION_ITERATOR,
+	TEST_BATCH,
 };
 
 enum test_event_type {
@@ -508,6 +512,7 @@ enum bt_notification_iterator_status src_iter_init(
 	switch (current_test) {
 	case TEST_NO_AUTO_NOTIFS:
 	case TEST_OUTPUT_PORT_NOTIFICATION_ITERATOR:
+	case TEST_BATCH:
 		user_data->seq = seq_no_auto_notifs;
 		break;
 	case TEST_AUTO_STREAM_BEGIN_FROM_PACKET_BEGIN:
@@ -694,6 +699,42 @@ struct bt_notification_iterator_next_method_return src_iter_next(
 	return next_return;
 }
 
+static
+struct bt_notification_iterator_next_batch_method_return src_iter_next_batch(
+		struct bt_private_connection_private_notification_iterator *priv_iterator,
+		struct bt_notification **notifications, uint64_t capacity)
+{
+	struct bt_notification_iterator_next_batch_method_return batch_return = {
+		.status = BT_NOTIFICATION_ITERATOR_STATUS_OK,
+		.count = 0,
+	};
+	struct src_iter_user_data *user_data =
+		bt_private_connection_private_notification_iterator_get_user_data(priv_iterator);
+
+	assert(user_data);
+	assert(capacity >= BATCH_CAPACITY);
+
+	/*
+	 * Return at most BATCH_CAPACITY notifications to also exercise
+	 * the library's handling of multiple batches.
+	 */
+	while (batch_return.count < BATCH_CAPACITY &&
+			user_data->seq[user_data->at] != SEQ_END) {
+		struct bt_notification_iterator_next_method_return next_return =
+			src_iter_next_seq(user_data);
+
+		assert(next_return.status == BT_NOTIFICATION_ITERATOR_STATUS_OK);
+		notifications[batch_return.count] = next_return.notification;
+		batch_return.count++;
+	}
+
+	if (batch_return.count == 0) {
+		batch_return.status = BT_NOTIFICATION_ITERATOR_STATUS_END;
+	}
+
+	return batch_return;
+}
+
 static
 enum bt_component_status src_init(
 		struct bt_private_component *private_component,
@@ -713,33 +754,11 @@ void src_finalize(struct bt_private_component *private_component)
 }
 
 static
-enum bt_notification_iterator_status common_consume(
-		struct bt_notification_iterator *notif_iter)
+void append_test_event_from_notification(
+		struct bt_notification *notification)
 {
-	enum bt_notification_iterator_status ret;
-	struct bt_notification *notification = NULL;
 	struct test_event test_event = { 0 };
-	bool do_append_test_event = true;
-	assert(notif_iter);
 
-	ret = bt_notification_iterator_next(notif_iter);
-	if (ret < 0) {
-		do_append_test_event = false;
-		goto end;
-	}
-
-	switch (ret) {
-	case BT_NOTIFICATION_ITERATOR_STATUS_END:
-		test_event.type = TEST_EV_TYPE_END;
-		goto end;
-	case BT_NOTIFICATION_ITERATOR_STATUS_AGAIN:
-		abort();
-	default:
-		break;
-	}
-
-	notification = bt_notification_iterator_get_notification(
-		notif_iter);
 	assert(notification);
 
 	switch (bt_notification_get_type(notification)) {
@@ -798,15 +817,83 @@ enum bt_notification_iterator_status common_consume(
 		bt_put(test_event.stream);
 	}
 
-end:
-	if (do_append_test_event) {
+	append_test_event(&test_event);
+}
+
+static
+enum bt_notification_iterator_status common_consume(
+		struct bt_notification_iterator *notif_iter)
+{
+	enum bt_notification_iterator_status ret;
+	struct bt_notification *notification = NULL;
+	struct test_event test_event = { 0 };
+
+	assert(notif_iter);
+	ret = bt_notification_iterator_next(notif_iter);
+	if (ret < 0) {
+		goto end;
+	}
+
+	switch (ret) {
+	case BT_NOTIFICATION_ITERATOR_STATUS_END:
+		test_event.type = TEST_EV_TYPE_END;
 		append_test_event(&test_event);
+		goto end;
+	case BT_NOTIFICATION_ITERATOR_STATUS_AGAIN:
+		abort();
+	default:
+		break;
 	}
 
+	notification = bt_notification_iterator_get_notification(
+		notif_iter);
+	append_test_event_from_notification(notification);
+
+end:
 	bt_put(notification);
 	return ret;
 }
 
+static
+enum bt_notification_iterator_status common_consume_batch(
+		struct bt_notification_iterator *notif_iter)
+{
+	enum bt_notification_iterator_status ret;
+	struct bt_notification *notifications[BATCH_CAPACITY];
+	struct test_event test_event = { 0 };
+	uint64_t count = 0;
+	uint64_t i;
+
+	assert(notif_iter);
+	ret = bt_notification_iterator_next_batch(notif_iter, notifications,
+		BATCH_CAPACITY, &count);
+	if (ret < 0) {
+		goto end;
+	}
+
+	switch (ret) {
+	case BT_NOTIFICATION_ITERATOR_STATUS_END:
+		assert(count == 0);
+		test_event.type = TEST_EV_TYPE_END;
+		append_test_event(&test_event);
+		goto end;
+	case BT_NOTIFICATION_ITERATOR_STATUS_AGAIN:
+		abort();
+	default:
+		break;
+	}
+
+	assert(count > 0 && count <= BATCH_CAPACITY);
+
+	for (i = 0; i < count; i++) {
+		append_test_event_from_notification(notifications[i]);
+		bt_put(notifications[i]);
+	}
+
+end:
+	return ret;
+}
+
 static
 enum bt_component_status sink_consume(
 		struct bt_private_component *priv_component)
@@ -817,7 +904,12 @@ enum bt_component_status sink_consume(
 	enum bt_notification_iterator_status it_ret;
 
 	assert(user_data && user_data->notif_iter);
-	it_ret = common_consume(user_data->notif_iter);
+
+	if (current_test == TEST_BATCH) {
+		it_ret = common_consume_batch(user_data->notif_iter);
+	} else {
+		it_ret = common_consume(user_data->notif_iter);
+	}
 
 	if (it_ret < 0) {
 		ret = BT_COMPONENT_STATUS_ERROR;
@@ -913,6 +1005,13 @@ void create_source_sink(struct bt_graph *graph, struct bt_component **source,
 		ret = bt_component_class_source_set_notification_iterator_finalize_method(
 			src_comp_class, src_iter_finalize);
 		assert(ret == 0);
+
+		if (current_test == TEST_BATCH) {
+			ret = bt_component_class_source_set_notification_iterator_next_batch_method(
+				src_comp_class, src_iter_next_batch);
+			assert(ret == 0);
+		}
+
 		ret = bt_graph_add_component(graph, src_comp_class, "source",
 			NULL, source);
 		assert(ret == 0);
@@ -1485,6 +1584,114 @@ void test_output_port_notification_iterator_cannot_consume(void)
 	bt_put(notif_iter);
 }
 
+static
+void test_output_port_notification_iterator_batch(void)
+{
+	const struct test_event expected_test_events[] = {
+		{ .type = TEST_EV_TYPE_NOTIF_STREAM_BEGIN, .stream = src_stream1, .packet = NULL, },
+		{ .type = TEST_EV_TYPE_NOTIF_PACKET_BEGIN, .stream = src_stream1, .packet = src_stream1_packet1, },
+		{ .type = TEST_EV_TYPE_NOTIF_EVENT, .stream = src_stream1, .packet = src_stream1_packet1, },
+		{ .type = TEST_EV_TYPE_NOTIF_EVENT, .stream = src_stream1, .packet = src_stream1_packet1, },
+		{ .type = TEST_EV_TYPE_NOTIF_STREAM_BEGIN, .stream = src_stream2, .packet = NULL, },
+		{ .type = TEST_EV_TYPE_NOTIF_EVENT, .stream = src_stream1, .packet = src_stream1_packet1, },
+		{ .type = TEST_EV_TYPE_NOTIF_PACKET_BEGIN, .stream = src_stream2, .packet = src_stream2_packet2, },
+		{ .type = TEST_EV_TYPE_NOTIF_EVENT, .stream = src_stream2, .packet = src_stream2_packet2, },
+		{ .type = TEST_EV_TYPE_NOTIF_EVENT, .stream = src_stream1, .packet = src_stream1_packet1, },
+		{ .type = TEST_EV_TYPE_NOTIF_PACKET_END, .stream = src_stream1, .packet = src_stream1_packet1, },
+		{ .type = TEST_EV_TYPE_NOTIF_PACKET_END, .stream = src_stream2, .packet = src_stream2_packet2, },
+		{ .type = TEST_EV_TYPE_NOTIF_PACKET_BEGIN, .stream = src_stream1, .packet = src_stream1_packet2, },
+		{ .type = TEST_EV_TYPE_NOTIF_EVENT, .stream = src_stream1, .packet = src_stream1_packet2, },
+		{ .type = TEST_EV_TYPE_NOTIF_STREAM_END, .stream = src_stream2, .packet = NULL, },
+		{ .type = TEST_EV_TYPE_NOTIF_PACKET_END, .stream = src_stream1, .packet = src_stream1_packet2, },
+		{ .type = TEST_EV_TYPE_NOTIF_STREAM_END, .stream = src_stream1, .packet = NULL, },
+		{ .type = TEST_EV_TYPE_END, },
+		{ .type = TEST_EV_TYPE_SENTINEL, },
+	};
+	struct bt_component *src_comp;
+	struct bt_notification_iterator *notif_iter;
+	enum bt_notification_iterator_status iter_status;
+	struct bt_notification *current_notif;
+	bool current_notif_kept = true;
+	struct bt_port *upstream_port;
+	struct bt_graph *graph;
+
+	clear_test_events();
+	current_test = TEST_OUTPUT_PORT_NOTIFICATION_ITERATOR;
+	diag("test: output port notification iterator consumed by batches");
+	graph = bt_graph_create();
+	assert(graph);
+	create_source_sink(graph, &src_comp, NULL);
+
+	/* Create notification iterator on source's output port */
+	upstream_port = bt_component_source_get_output_port_by_name(src_comp, "out");
+	notif_iter = bt_output_port_notification_iterator_create(upstream_port,
+		NULL, NULL);
+	assert(notif_iter);
+	bt_put(upstream_port);
+
+	/* Make the first notification the current one */
+	iter_status = common_consume(notif_iter);
+	assert(iter_status == BT_NOTIFICATION_ITERATOR_STATUS_OK);
+	current_notif = bt_notification_iterator_get_notification(notif_iter);
+	assert(current_notif);
+
+	/* Consume the rest of the notification iterator by batches */
+	while (iter_status == BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		struct bt_notification *notif;
+
+		iter_status = common_consume_batch(notif_iter);
+		notif = bt_notification_iterator_get_notification(notif_iter);
+		if (notif != current_notif) {
+			current_notif_kept = false;
+		}
+
+		bt_put(notif);
+	}
+
+	ok(iter_status == BT_NOTIFICATION_ITERATOR_STATUS_END,
+		"output port notification iterator consumed by batches finishes without any error");
+	ok(current_notif_kept,
+		"bt_notification_iterator_next_batch() does not change the output port notification iterator's current notification");
+
+	/* Compare the resulting test events */
+	ok(compare_test_events(expected_test_events),
+		"the produced sequence of test events is the expected one");
+
+	bt_put(current_notif);
+	bt_put(src_comp);
+	bt_put(graph);
+	bt_put(notif_iter);
+}
+
+static
+void test_batch(void)
+{
+	const struct test_event expected_test_events[] = {
+		{ .type = TEST_EV_TYPE_NOTIF_STREAM_BEGIN, .stream = src_stream1, .packet = NULL, },
+		{ .type = TEST_EV_TYPE_NOTIF_PACKET_BEGIN, .stream = src_stream1, .packet = src_stream1_packet1, },
+		{ .type = TEST_EV_TYPE_NOTIF_EVENT, .stream = src_stream1, .packet = src_stream1_packet1, },
+		{ .type = TEST_EV_TYPE_NOTIF_EVENT, .stream = src_stream1, .packet = src_stream1_packet1, },
+		{ .type = TEST_EV_TYPE_NOTIF_STREAM_BEGIN, .stream = src_stream2, .packet = NULL, },
+		{ .type = TEST_EV_TYPE_NOTIF_EVENT, .stream = src_stream1, .packet = src_stream1_packet1, },
+		{ .type = TEST_EV_TYPE_NOTIF_PACKET_BEGIN, .stream = src_stream2, .packet = src_stream2_packet2, },
+		{ .type = TEST_EV_TYPE_NOTIF_EVENT, .stream = src_stream2, .packet = src_stream2_packet2, },
+		{ .type = TEST_EV_TYPE_NOTIF_EVENT, .stream = src_stream1, .packet = src_stream1_packet1, },
+		{ .type = TEST_EV_TYPE_NOTIF_PACKET_END, .stream = src_stream1, .packet = src_stream1_packet1, },
+		{ .type = TEST_EV_TYPE_NOTIF_PACKET_END, .stream = src_stream2, .packet = src_stream2_packet2, },
+		{ .type = TEST_EV_TYPE_NOTIF_PACKET_BEGIN, .stream = src_stream1, .packet = src_stream1_packet2, },
+		{ .type = TEST_EV_TYPE_NOTIF_EVENT, .stream = src_stream1, .packet = src_stream1_packet2, },
+		{ .type = TEST_EV_TYPE_NOTIF_STREAM_END, .stream = src_stream2, .packet = NULL, },
+		{ .type = TEST_EV_TYPE_NOTIF_PACKET_END, .stream = src_stream1, .packet = src_stream1_packet2, },
+		{ .type = TEST_EV_TYPE_NOTIF_STREAM_END, .stream = src_stream1, .packet = NULL, },
+		{ .type = TEST_EV_TYPE_END, },
+		{ .type = TEST_EV_TYPE_SENTINEL, },
+	};
+
+	do_std_test(TEST_BATCH,
+		"\"next batch\" methods on both sides of a connection",
+		expected_test_events);
+}
+
 #define DEBUG_ENV_VAR	"TEST_BT_NOTIFICATION_ITERATOR_DEBUG"
 
 int main(int argc, char **argv)
@@ -1510,6 +1717,8 @@ int main(int argc, char **argv)
 	test_output_port_notification_iterator();
 	test_output_port_notification_iterator_subscribe_events();
 	test_output_port_notification_iterator_cannot_consume();
+	test_output_port_notification_iterator_batch();
+	test_batch();
 	fini_static_data();
 	return exit_status();
 }
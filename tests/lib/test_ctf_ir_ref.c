@@ -29,12 +29,13 @@
 #include <babeltrace/ctf-ir/fields.h>
 #include <babeltrace/ctf-ir/event.h>
 #include <babeltrace/ctf-ir/event-class.h>
+#include <babeltrace/ctf-ir/event-class-internal.h>
 #include <babeltrace/object-internal.h>
 #include <babeltrace/compat/stdlib-internal.h>
 #include <assert.h>
 #include "common.h"
 
-#define NR_TESTS 41
+#define NR_TESTS 61
 
 struct user {
 	struct bt_ctf_writer *writer;
@@ -689,6 +690,294 @@ static void test_put_order(void)
 	test_put_order_permute(array, USER_NR_ELEMENTS, USER_NR_ELEMENTS);
 }
 
+/*
+ * Creates a trace with a single stream class which contains a single
+ * simple event class. Unlike create_tc1(), this does not report any
+ * test result.
+ */
+static struct bt_trace *create_single_event_tc(void)
+{
+	int ret;
+	struct bt_trace *tc;
+	struct bt_stream_class *sc;
+	struct bt_event_class *ec;
+
+	tc = bt_trace_create();
+	assert(tc);
+	set_trace_packet_header(tc);
+	sc = bt_stream_class_create_empty("sc");
+	assert(sc);
+	set_stream_class_field_types(sc);
+	ec = create_simple_event("ec");
+	assert(ec);
+	ret = bt_stream_class_add_event_class(sc, ec);
+	assert(!ret);
+	ret = bt_trace_add_stream_class(tc, sc);
+	assert(!ret);
+	bt_put(ec);
+	bt_put(sc);
+	return tc;
+}
+
+static void test_event_recycling(void)
+{
+	int ret;
+	uint64_t value;
+	long ec_ref_count;
+	struct bt_trace *tc = NULL;
+	struct bt_stream_class *sc = NULL;
+	struct bt_event_class *ec = NULL;
+	struct bt_event *event = NULL, *weak_event = NULL;
+	struct bt_field *field = NULL;
+
+	tc = create_single_event_tc();
+	sc = bt_trace_get_stream_class_by_index(tc, 0);
+	assert(sc);
+	ec = bt_stream_class_get_event_class_by_index(sc, 0);
+	assert(ec);
+	ec_ref_count = bt_object_get_ref_count(ec);
+
+	event = bt_event_create(ec);
+	ok(event, "Create event");
+	if (!event) {
+		goto end;
+	}
+
+	field = bt_event_get_payload(event, "payload_8");
+	assert(field);
+	ret = bt_field_unsigned_integer_set_value(field, 23);
+	assert(!ret);
+	BT_PUT(field);
+	weak_event = event;
+	BT_PUT(event);
+	ok(bt_object_get_ref_count(ec) == ec_ref_count,
+		"Recycled event does not keep a reference on its class");
+
+	event = bt_event_create(ec);
+	ok(event == weak_event, "Released event is reused by bt_event_create()");
+	field = bt_event_get_payload(event, "payload_8");
+	assert(field);
+	ok(!bt_field_is_set(field), "Recycled event's payload field is reset");
+	ret = bt_field_unsigned_integer_set_value(field, 42);
+	assert(!ret);
+
+	/* A field which is still shared must not be reset */
+	BT_PUT(event);
+	ret = bt_field_unsigned_integer_get_value(field, &value);
+	ok(!ret && value == 42,
+		"Field shared with user is left intact when its event is released");
+
+end:
+	BT_PUT(field);
+	BT_PUT(event);
+	BT_PUT(ec);
+	BT_PUT(sc);
+	BT_PUT(tc);
+}
+
+static void test_event_pool_max_count(void)
+{
+	int i;
+	struct bt_trace *tc = NULL;
+	struct bt_stream_class *sc = NULL;
+	struct bt_event_class *ec = NULL;
+	struct bt_event *events[BT_EVENT_CLASS_EVENT_POOL_MAX_COUNT + 1];
+
+	tc = create_single_event_tc();
+	sc = bt_trace_get_stream_class_by_index(tc, 0);
+	assert(sc);
+	ec = bt_stream_class_get_event_class_by_index(sc, 0);
+	assert(ec);
+
+	for (i = 0; i < BT_EVENT_CLASS_EVENT_POOL_MAX_COUNT + 1; i++) {
+		events[i] = bt_event_create(ec);
+		assert(events[i]);
+	}
+
+	for (i = 0; i < BT_EVENT_CLASS_EVENT_POOL_MAX_COUNT + 1; i++) {
+		BT_PUT(events[i]);
+	}
+
+	ok(ec->event_pool.objects->len == BT_EVENT_CLASS_EVENT_POOL_MAX_COUNT,
+		"Event pool does not keep more events than its maximum count");
+
+	BT_PUT(ec);
+	BT_PUT(sc);
+	BT_PUT(tc);
+}
+
+static void test_event_shared_fields(void)
+{
+	int ret;
+	uint64_t value;
+	struct bt_trace *tc = NULL;
+	struct bt_stream_class *sc = NULL;
+	struct bt_event_class *ec = NULL;
+	struct bt_field_type *header_ft = NULL;
+	struct bt_event *in_event = NULL, *event = NULL, *weak_event = NULL;
+	struct bt_field *in_payload = NULL, *header = NULL, *payload = NULL;
+	struct bt_field *field = NULL, *weak_header = NULL;
+
+	tc = create_single_event_tc();
+	sc = bt_trace_get_stream_class_by_index(tc, 0);
+	assert(sc);
+	ec = bt_stream_class_get_event_class_by_index(sc, 0);
+	assert(ec);
+	header_ft = bt_stream_class_get_event_header_type(sc);
+	assert(header_ft);
+
+	/* Input event of which the payload is shared */
+	in_event = bt_event_create(ec);
+	assert(in_event);
+	in_payload = bt_event_get_event_payload(in_event);
+	assert(in_payload);
+	field = bt_field_structure_get_field_by_name(in_payload, "payload_8");
+	assert(field);
+	ret = bt_field_unsigned_integer_set_value(field, 23);
+	assert(!ret);
+	BT_PUT(field);
+
+	event = bt_event_create_empty(ec);
+	ok(event, "Create event without fields");
+	if (!event) {
+		goto end;
+	}
+
+	header = bt_event_get_header(event);
+	payload = bt_event_get_event_payload(event);
+	ok(!header && !payload, "Event created without fields has no fields");
+
+	/* Augmented event: its own header, the input event's payload */
+	header = bt_field_create(header_ft);
+	assert(header);
+	ret = bt_event_set_header(event, header);
+	ret |= bt_event_set_event_payload(event, in_payload);
+	ok(!ret, "Set created and shared fields of event without fields");
+	weak_header = header;
+	BT_PUT(header);
+	weak_event = event;
+	BT_PUT(event);
+
+	field = bt_field_structure_get_field_by_name(in_payload, "payload_8");
+	assert(field);
+	ret = bt_field_unsigned_integer_get_value(field, &value);
+	BT_PUT(field);
+	ok(!ret && value == 23 && bt_object_get_ref_count(in_payload) == 2,
+		"Recycled event drops the shared field without resetting it");
+
+	event = bt_event_create(ec);
+	ok(event == weak_event,
+		"Event which shared a field is reused by bt_event_create()");
+	payload = bt_event_get_event_payload(event);
+	ok(payload && payload != in_payload && !bt_field_is_set(payload),
+		"Recycled event has a new field in place of the shared field");
+	header = bt_event_get_header(event);
+	ok(header == weak_header && !bt_field_is_set(header),
+		"Recycled event's own field is reset and reused");
+	BT_PUT(header);
+	BT_PUT(payload);
+	BT_PUT(event);
+
+	/* The input event is released before the augmented event */
+	event = bt_event_create_empty(ec);
+	assert(event);
+	ret = bt_event_set_event_payload(event, in_payload);
+	assert(!ret);
+	BT_PUT(in_payload);
+	BT_PUT(in_event);
+	payload = bt_event_get_event_payload(event);
+	assert(payload);
+	field = bt_field_structure_get_field_by_name(payload, "payload_8");
+	assert(field);
+	ret = bt_field_unsigned_integer_get_value(field, &value);
+	ok(!ret && value == 23,
+		"Field shared with another event is left intact when its event is released");
+
+end:
+	BT_PUT(field);
+	BT_PUT(header);
+	BT_PUT(payload);
+	BT_PUT(in_payload);
+	BT_PUT(event);
+	BT_PUT(in_event);
+	BT_PUT(header_ft);
+	BT_PUT(ec);
+	BT_PUT(sc);
+	BT_PUT(tc);
+}
+
+static void test_field_tree_refs(void)
+{
+	int ret;
+	uint64_t value;
+	struct bt_field_type *int_ft = NULL, *inner_ft = NULL, *outer_ft = NULL;
+	struct bt_field *outer = NULL, *inner = NULL, *copy = NULL;
+	struct bt_field *a = NULL, *a_by_index = NULL, *f = NULL;
+
+	int_ft = bt_field_type_integer_create(32);
+	inner_ft = bt_field_type_structure_create();
+	outer_ft = bt_field_type_structure_create();
+	assert(int_ft && inner_ft && outer_ft);
+	ret = bt_field_type_structure_add_field(inner_ft, int_ft, "f");
+	assert(!ret);
+	ret = bt_field_type_structure_add_field(outer_ft, int_ft, "a");
+	assert(!ret);
+	ret = bt_field_type_structure_add_field(outer_ft, int_ft, "b");
+	assert(!ret);
+	ret = bt_field_type_structure_add_field(outer_ft, inner_ft, "inner");
+	assert(!ret);
+
+	outer = bt_field_create(outer_ft);
+	ok(outer, "Create structure field");
+	if (!outer) {
+		goto end;
+	}
+
+	a = bt_field_structure_get_field_by_name(outer, "a");
+	a_by_index = bt_field_structure_get_field_by_index(outer, 0);
+	ok(a && a == a_by_index,
+		"Structure field's member is the same by name and by index");
+	ok(bt_object_get_ref_count(outer) == 2,
+		"Structure field's member keeps its structure field alive");
+	BT_PUT(a_by_index);
+
+	inner = bt_field_structure_get_field_by_name(outer, "inner");
+	assert(inner);
+	f = bt_field_structure_get_field_by_name(inner, "f");
+	assert(f);
+	BT_PUT(inner);
+	ok(bt_object_get_ref_count(outer) == 3,
+		"Nested structure field's member keeps its root alive");
+	BT_PUT(f);
+
+	/* Same field tree: must not create a reference cycle */
+	ret = bt_field_unsigned_integer_set_value(a, 23);
+	assert(!ret);
+	ret = bt_field_structure_set_field_by_name(outer, "b", a);
+	assert(!ret);
+	BT_PUT(a);
+	ok(bt_object_get_ref_count(outer) == 1,
+		"Member set to another member of the same structure field holds no reference");
+
+	copy = bt_field_copy(outer);
+	assert(copy);
+	a = bt_field_structure_get_field_by_name(copy, "b");
+	assert(a);
+	ret = bt_field_unsigned_integer_get_value(a, &value);
+	ok(!ret && value == 23, "Copied structure field's member has the same value");
+
+end:
+	BT_PUT(a);
+	BT_PUT(a_by_index);
+	BT_PUT(f);
+	BT_PUT(inner);
+	BT_PUT(copy);
+	BT_PUT(outer);
+	BT_PUT(outer_ft);
+	BT_PUT(inner_ft);
+	BT_PUT(int_ft);
+}
+
 /**
  * The objective of this test is to implement and expand upon the scenario
  * described in the reference counting documentation and ensure that any node of
@@ -705,6 +994,10 @@ int main(int argc, char **argv)
 
 	test_example_scenario();
 	test_put_order();
+	test_event_recycling();
+	test_event_pool_max_count();
+	test_event_shared_fields();
+	test_field_tree_refs();
 
 	return exit_status();
 }
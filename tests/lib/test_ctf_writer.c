@@ -38,6 +38,8 @@
 #include <stdio.h>
 #include <babeltrace/compat/limits-internal.h>
 #include <babeltrace/compat/stdio-internal.h>
+#include <babeltrace/ctf-writer/lttng-index-internal.h>
+#include <babeltrace/endian-internal.h>
 #include <string.h>
 #include <assert.h>
 #include <fcntl.h>
@@ -59,7 +61,7 @@
 #define DEFAULT_CLOCK_TIME 0
 #define DEFAULT_CLOCK_VALUE 0
 
-#define NR_TESTS 625
+#define NR_TESTS 666
 
 struct bt_utsname {
 	char sysname[BABELTRACE_HOST_NAME_MAX];
@@ -2814,6 +2816,517 @@ void test_trace_uuid(void)
 	bt_put(trace);
 }
 
+#define SERIALIZE_ON_APPEND_TEST_PACKET_COUNT	3
+#define SERIALIZE_ON_APPEND_TEST_EVENT_COUNT	5000
+
+/*
+ * Writes the same packets to a new trace, with or without serializing
+ * the events on append, and returns the path of its stream file.
+ */
+static
+gchar *write_serialize_on_append_trace(bt_bool serialize_on_append)
+{
+	int ret = 0, ret_size;
+	int i, j;
+	gchar *trace_path;
+	gchar *stream_path = NULL;
+	const unsigned char uuid[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+	struct bt_ctf_writer *writer = NULL;
+	struct bt_trace *trace = NULL;
+	struct bt_ctf_clock *clock = NULL;
+	struct bt_stream_class *stream_class = NULL;
+	struct bt_stream *stream = NULL;
+	struct bt_event_class *event_class = NULL;
+	struct bt_field_type *int_type = NULL;
+	struct bt_field_type *string_type = NULL;
+	struct bt_event *event = NULL;
+	struct bt_field *field = NULL;
+	int64_t time = 0;
+
+	trace_path = g_build_filename(g_get_tmp_dir(), "ctfwriter_XXXXXX", NULL);
+	if (!bt_mkdtemp(trace_path)) {
+		perror("# perror");
+	}
+
+	writer = bt_ctf_writer_create(trace_path);
+	assert(writer);
+	trace = bt_ctf_writer_get_trace(writer);
+	assert(trace);
+	ret = bt_trace_set_uuid(trace, uuid);
+	assert(!ret);
+	clock = bt_ctf_clock_create("append_clock");
+	assert(clock);
+	ret = bt_ctf_writer_add_clock(writer, clock);
+	assert(!ret);
+	stream_class = bt_stream_class_create("append_stream");
+	assert(stream_class);
+	ret = bt_stream_class_set_clock(stream_class, clock);
+	assert(!ret);
+	event_class = bt_event_class_create("append_event");
+	assert(event_class);
+	int_type = bt_field_type_integer_create(17);
+	assert(int_type);
+	string_type = bt_field_type_string_create();
+	assert(string_type);
+	ret = bt_event_class_add_field(event_class, int_type, "an_int");
+	assert(!ret);
+	ret = bt_event_class_add_field(event_class, string_type, "a_string");
+	assert(!ret);
+	ret = bt_stream_class_add_event_class(stream_class, event_class);
+	assert(!ret);
+	stream = bt_ctf_writer_create_stream(writer, stream_class);
+	assert(stream);
+	ret = bt_stream_enable_packet_index(stream);
+	assert(!ret);
+
+	if (serialize_on_append) {
+		ok(bt_stream_set_serialize_on_append(NULL, BT_TRUE) < 0,
+			"bt_stream_set_serialize_on_append handles NULL correctly");
+		ok(bt_stream_set_serialize_on_append(stream, BT_TRUE) == 0,
+			"Enable serialize-on-append mode on a writer stream");
+	}
+
+	for (i = 0; i < SERIALIZE_ON_APPEND_TEST_PACKET_COUNT; i++) {
+		for (j = 0; j < SERIALIZE_ON_APPEND_TEST_EVENT_COUNT; j++) {
+			event = bt_event_create(event_class);
+			assert(event);
+			field = bt_event_get_payload(event, "an_int");
+			ret |= bt_field_unsigned_integer_set_value(field, j);
+			BT_PUT(field);
+			field = bt_event_get_payload(event, "a_string");
+			ret |= bt_field_string_set_value(field,
+				j % 2 ? "odd" : "even event");
+			BT_PUT(field);
+			ret |= bt_ctf_clock_set_time(clock, ++time);
+			ret |= bt_stream_append_event(stream, event);
+
+			if (i == 0 && j == 0) {
+				uint64_t count = 0, size = 0;
+
+				ok(!bt_stream_get_packet_event_count(stream,
+					&count) && count == 1,
+					"bt_stream_get_packet_event_count returns the current packet's event count");
+				ret_size = bt_stream_get_packet_content_size(
+					stream, &size);
+				if (serialize_on_append) {
+					ok(!ret_size && size > 0,
+						"bt_stream_get_packet_content_size returns the current packet's content size");
+				} else {
+					ok(ret_size < 0,
+						"bt_stream_get_packet_content_size fails when events are not serialized on append");
+				}
+			}
+
+			if (serialize_on_append && i == 0 && j == 0) {
+				ok(bt_stream_append_event(stream, event) < 0,
+					"An event serialized on append cannot be appended again");
+				ok(bt_stream_set_serialize_on_append(stream,
+					BT_FALSE) < 0,
+					"Serialize-on-append mode cannot be changed while the current packet is not empty");
+			}
+
+			BT_PUT(event);
+		}
+
+		bt_stream_append_discarded_events(stream, i);
+		ret |= bt_stream_flush(stream);
+
+		if (serialize_on_append && i == 0) {
+			uint64_t count = 1, size = 1;
+
+			ok(!bt_stream_get_packet_event_count(stream, &count) &&
+				!bt_stream_get_packet_content_size(stream,
+					&size) && count == 0 && size == 0,
+				"Stream's current packet is empty after a flush");
+			ok(bt_stream_enable_packet_index(stream) == 0,
+				"Enabling an enabled packet index succeeds");
+		}
+	}
+
+	ok(ret == 0, "Write packets to a stream (serialize on append: %s)",
+		serialize_on_append ? "yes" : "no");
+	stream_path = g_build_filename(trace_path, "append_stream-0-0", NULL);
+
+	/* Closes the stream file */
+	bt_put(stream);
+	bt_put(writer);
+	bt_put(trace);
+	bt_put(clock);
+	bt_put(stream_class);
+	bt_put(event_class);
+	bt_put(int_type);
+	bt_put(string_type);
+	g_free(trace_path);
+	return stream_path;
+}
+
+/* Returns the packet index file path of a stream file path. */
+static
+gchar *get_packet_index_path(const gchar *stream_path)
+{
+	gchar *trace_path = g_path_get_dirname(stream_path);
+	gchar *basename = g_path_get_basename(stream_path);
+	gchar *index_name = g_strconcat(basename, ".idx", NULL);
+	gchar *index_path = g_build_filename(trace_path, "index", index_name,
+		NULL);
+
+	g_free(index_name);
+	g_free(basename);
+	g_free(trace_path);
+	return index_path;
+}
+
+/*
+ * Checks that the packet index file of a stream file contains one
+ * entry per packet, and that these entries cover the whole stream file.
+ */
+static
+bt_bool check_packet_index(const gchar *stream_path, gsize stream_len,
+		uint64_t packet_count)
+{
+	gchar *index_path = get_packet_index_path(stream_path);
+	gchar *data = NULL;
+	gsize len = 0;
+	const struct ctf_packet_index_file_hdr *hdr;
+	const struct ctf_packet_index *entries;
+	uint64_t offset = 0;
+	uint64_t i;
+	bt_bool valid = BT_FALSE;
+
+	if (!g_file_get_contents(index_path, &data, &len, NULL) ||
+			len != sizeof(*hdr) + packet_count * sizeof(*entries)) {
+		goto end;
+	}
+
+	hdr = (const struct ctf_packet_index_file_hdr *) data;
+	if (be32toh(hdr->magic) != CTF_INDEX_MAGIC ||
+			be32toh(hdr->packet_index_len) != sizeof(*entries)) {
+		goto end;
+	}
+
+	entries = (const struct ctf_packet_index *) (data + sizeof(*hdr));
+	for (i = 0; i < packet_count; i++) {
+		const struct ctf_packet_index *entry = &entries[i];
+
+		if (be64toh(entry->offset) != offset ||
+				be64toh(entry->content_size) >
+					be64toh(entry->packet_size) ||
+				be64toh(entry->timestamp_begin) >
+					be64toh(entry->timestamp_end) ||
+				be64toh(entry->events_discarded) !=
+					i * (i + 1) / 2) {
+			goto end;
+		}
+		offset += be64toh(entry->packet_size) / CHAR_BIT;
+	}
+
+	valid = offset == stream_len;
+
+end:
+	g_free(data);
+	g_free(index_path);
+	return valid;
+}
+
+static
+void remove_stream_trace(gchar *stream_path)
+{
+	gchar *trace_path = g_path_get_dirname(stream_path);
+
+	recursive_rmdir(trace_path);
+	g_free(trace_path);
+	g_free(stream_path);
+}
+
+static
+void test_packed_elements(void)
+{
+	const uint16_t values[] = { 1, 0x1234, 0xffff };
+	const uint16_t *ret_values;
+	uint64_t count = 0;
+	uint64_t value = 0;
+	int ret;
+	struct bt_field_type *uint16_type;
+	struct bt_field_type *array_type;
+	struct bt_field_type *sequence_type;
+	struct bt_field *array;
+	struct bt_field *array_copy;
+	struct bt_field *sequence;
+	struct bt_field *length;
+	struct bt_field *element;
+
+	uint16_type = bt_field_type_integer_create(16);
+	assert(uint16_type);
+	array_type = bt_field_type_array_create(uint16_type, 3);
+	assert(array_type);
+	sequence_type = bt_field_type_sequence_create(uint16_type, "len");
+	assert(sequence_type);
+	array = bt_field_create(array_type);
+	assert(array);
+	sequence = bt_field_create(sequence_type);
+	assert(sequence);
+	length = bt_field_create(uint16_type);
+	assert(length);
+
+	ok(!bt_field_array_get_packed_elements(array, &count),
+		"An array field has no packed elements initially");
+	ok(bt_field_array_set_packed_elements(array, values, 2),
+		"bt_field_array_set_packed_elements fails with a wrong count");
+	ok(bt_field_array_set_packed_elements(array, values, 3) == 0,
+		"Set the packed elements of an array field");
+	ret_values = bt_field_array_get_packed_elements(array, &count);
+	ok(ret_values && count == 3 &&
+		memcmp(ret_values, values, sizeof(values)) == 0,
+		"bt_field_array_get_packed_elements returns the set elements");
+	ok(bt_field_is_set(array),
+		"An array field with packed elements is set");
+	array_copy = bt_field_copy(array);
+	ret_values = bt_field_array_get_packed_elements(array_copy, &count);
+	ok(ret_values && count == 3 &&
+		memcmp(ret_values, values, sizeof(values)) == 0,
+		"Copying an array field copies its packed elements");
+	element = bt_field_array_get_field(array, 1);
+	ret = bt_field_unsigned_integer_get_value(element, &value);
+	ok(ret == 0 && value == 0x1234,
+		"bt_field_array_get_field returns a field with a packed element's value");
+	ok(!bt_field_array_get_packed_elements(array, &count),
+		"Getting an element field unpacks the array field's elements");
+	bt_put(element);
+
+	ok(bt_field_sequence_set_packed_elements(sequence, values, 3),
+		"bt_field_sequence_set_packed_elements fails without a length field");
+	ret = bt_field_unsigned_integer_set_value(length, 3);
+	assert(!ret);
+	ret = bt_field_sequence_set_length(sequence, length);
+	assert(!ret);
+	ok(bt_field_sequence_set_packed_elements(sequence, values, 4),
+		"bt_field_sequence_set_packed_elements fails with a wrong count");
+	ok(bt_field_sequence_set_packed_elements(sequence, values, 3) == 0,
+		"Set the packed elements of a sequence field");
+	ret_values = bt_field_sequence_get_packed_elements(sequence, &count);
+	ok(ret_values && count == 3 &&
+		memcmp(ret_values, values, sizeof(values)) == 0,
+		"bt_field_sequence_get_packed_elements returns the set elements");
+	element = bt_field_sequence_get_field(sequence, 2);
+	ret = bt_field_unsigned_integer_get_value(element, &value);
+	ok(ret == 0 && value == 0xffff,
+		"bt_field_sequence_get_field returns a field with a packed element's value");
+	bt_put(element);
+
+	bt_put(length);
+	bt_put(sequence);
+	bt_put(array_copy);
+	bt_put(array);
+	bt_put(sequence_type);
+	bt_put(array_type);
+	bt_put(uint16_type);
+}
+
+static
+void test_string_external_value(void)
+{
+	struct bt_field_type *string_type;
+	struct bt_field *string;
+	struct bt_field *string_copy;
+	struct bt_value *owner;
+	const char *value = NULL;
+	enum bt_value_status status;
+
+	string_type = bt_field_type_string_create();
+	assert(string_type);
+	string = bt_field_create(string_type);
+	assert(string);
+	owner = bt_value_string_create_init("external");
+	assert(owner);
+	status = bt_value_string_get(owner, &value);
+	assert(status == BT_VALUE_STATUS_OK);
+
+	ok(bt_field_string_set_external_value(string, value, owner) == 0,
+		"Set the external value of a string field");
+	BT_PUT(owner);
+	ok(bt_field_string_get_value(string) == value,
+		"bt_field_string_get_value returns the external value itself");
+	string_copy = bt_field_copy(string);
+	ok(string_copy && bt_field_string_get_value(string_copy) == value,
+		"Copying a string field shares its external value");
+	ok(bt_field_string_append(string, "_value") == 0 &&
+		strcmp(bt_field_string_get_value(string),
+			"external_value") == 0,
+		"Appending to a string field with an external value copies it");
+	ok(bt_field_string_set_value(string_copy, "copied") == 0 &&
+		strcmp(bt_field_string_get_value(string_copy),
+			"copied") == 0,
+		"Set a copied value after an external value");
+
+	bt_put(string_copy);
+	bt_put(string);
+	bt_put(string_type);
+}
+
+static
+void test_enumeration_mapping_names(void)
+{
+	const char * const *names = NULL;
+	struct bt_field_type_enumeration_mapping_iterator *iter;
+	struct bt_field_type *int_type;
+	struct bt_field_type *uint_type;
+	struct bt_field_type *enum_type;
+	struct bt_field_type *uenum_type;
+	struct bt_field *field;
+	const char *name = NULL;
+	int64_t count;
+	int ret;
+
+	int_type = bt_field_type_integer_create(32);
+	assert(int_type);
+	ret = bt_field_type_integer_set_is_signed(int_type, 1);
+	assert(!ret);
+	uint_type = bt_field_type_integer_create(32);
+	assert(uint_type);
+	enum_type = bt_field_type_enumeration_create(int_type);
+	assert(enum_type);
+	uenum_type = bt_field_type_enumeration_create(uint_type);
+	assert(uenum_type);
+	ret = bt_field_type_enumeration_add_mapping_signed(enum_type,
+		"NEGATIVE", INT64_MIN, -1);
+	assert(!ret);
+	ret = bt_field_type_enumeration_add_mapping_signed(enum_type,
+		"SMALL", -10, 10);
+	assert(!ret);
+	ret = bt_field_type_enumeration_add_mapping_signed(enum_type,
+		"TEN", 10, 10);
+	assert(!ret);
+	ret = bt_field_type_enumeration_add_mapping_unsigned(uenum_type,
+		"BIG", 1000, UINT64_MAX);
+	assert(!ret);
+
+	ok(bt_field_type_enumeration_get_mapping_names_by_signed_value(
+		enum_type, 10, &names) < 0,
+		"bt_field_type_enumeration_get_mapping_names_by_signed_value fails with a non-frozen enumeration field type");
+
+	/* Creating a field freezes its type */
+	field = bt_field_create(enum_type);
+	assert(field);
+	bt_put(field);
+	field = bt_field_create(uenum_type);
+	assert(field);
+	bt_put(field);
+
+	count = bt_field_type_enumeration_get_mapping_names_by_signed_value(
+		enum_type, -5, &names);
+	ok(count == 2 && strcmp(names[0], "NEGATIVE") == 0 &&
+		strcmp(names[1], "SMALL") == 0,
+		"Get the names of overlapping mappings containing a signed value");
+	count = bt_field_type_enumeration_get_mapping_names_by_signed_value(
+		enum_type, 10, &names);
+	ok(count == 2 && strcmp(names[0], "SMALL") == 0 &&
+		strcmp(names[1], "TEN") == 0,
+		"Get the names of the mappings containing a range's last value");
+	ok(bt_field_type_enumeration_get_mapping_names_by_signed_value(
+		enum_type, 11, &names) == 0 && !names,
+		"No mapping names are returned for a value out of all ranges");
+	ok(bt_field_type_enumeration_get_mapping_names_by_unsigned_value(
+		enum_type, 10, &names) < 0,
+		"bt_field_type_enumeration_get_mapping_names_by_unsigned_value fails with a signed enumeration field type");
+	count = bt_field_type_enumeration_get_mapping_names_by_unsigned_value(
+		uenum_type, UINT64_MAX, &names);
+	ok(count == 1 && strcmp(names[0], "BIG") == 0,
+		"Get the name of the mapping containing the maximal unsigned value");
+
+	iter = bt_field_type_enumeration_find_mappings_by_signed_value(
+		enum_type, 10);
+	ok(iter && !bt_field_type_enumeration_mapping_iterator_next(iter) &&
+		!bt_field_type_enumeration_mapping_iterator_get_signed(iter,
+			&name, NULL, NULL) && strcmp(name, "SMALL") == 0 &&
+		!bt_field_type_enumeration_mapping_iterator_next(iter) &&
+		!bt_field_type_enumeration_mapping_iterator_get_signed(iter,
+			&name, NULL, NULL) && strcmp(name, "TEN") == 0 &&
+		bt_field_type_enumeration_mapping_iterator_next(iter) < 0,
+		"Mapping iterator of a frozen enumeration field type visits the mappings containing a value");
+
+	bt_put(iter);
+	bt_put(uenum_type);
+	bt_put(enum_type);
+	bt_put(uint_type);
+	bt_put(int_type);
+}
+
+static
+void test_serialize_on_append(void)
+{
+	gchar *buffered_path, *streamed_path;
+	gchar *buffered_index_path, *streamed_index_path;
+	gchar *buffered_data = NULL, *streamed_data = NULL;
+	gsize buffered_len = 0, streamed_len = 0;
+	struct bt_stream_class *stream_class = NULL;
+	struct bt_field_type *packet_context_type = NULL;
+	struct bt_field_type *string_type = NULL;
+	struct bt_ctf_writer *writer = NULL;
+	struct bt_stream *stream = NULL;
+	gchar *trace_path;
+	int ret;
+
+	buffered_path = write_serialize_on_append_trace(BT_FALSE);
+	streamed_path = write_serialize_on_append_trace(BT_TRUE);
+	ok(g_file_get_contents(buffered_path, &buffered_data, &buffered_len,
+		NULL) && g_file_get_contents(streamed_path, &streamed_data,
+		&streamed_len, NULL) && buffered_len == streamed_len &&
+		memcmp(buffered_data, streamed_data, buffered_len) == 0,
+		"Serializing events on append writes the same stream file");
+	ok(check_packet_index(streamed_path, streamed_len,
+		SERIALIZE_ON_APPEND_TEST_PACKET_COUNT),
+		"Packet index file has one entry per packet of the stream file");
+	g_free(buffered_data);
+	g_free(streamed_data);
+	buffered_data = NULL;
+	streamed_data = NULL;
+	buffered_index_path = get_packet_index_path(buffered_path);
+	streamed_index_path = get_packet_index_path(streamed_path);
+	ok(g_file_get_contents(buffered_index_path, &buffered_data,
+		&buffered_len, NULL) && g_file_get_contents(
+		streamed_index_path, &streamed_data, &streamed_len, NULL) &&
+		buffered_len == streamed_len &&
+		memcmp(buffered_data, streamed_data, buffered_len) == 0,
+		"Serializing events on append writes the same packet index file");
+	g_free(buffered_data);
+	g_free(streamed_data);
+	g_free(buffered_index_path);
+	g_free(streamed_index_path);
+	remove_stream_trace(buffered_path);
+	remove_stream_trace(streamed_path);
+
+	/* A variable-size packet context cannot be written back */
+	trace_path = g_build_filename(g_get_tmp_dir(), "ctfwriter_XXXXXX", NULL);
+	if (!bt_mkdtemp(trace_path)) {
+		perror("# perror");
+	}
+
+	writer = bt_ctf_writer_create(trace_path);
+	assert(writer);
+	stream_class = bt_stream_class_create("variable_context_stream");
+	assert(stream_class);
+	packet_context_type = bt_stream_class_get_packet_context_type(
+		stream_class);
+	assert(packet_context_type);
+	string_type = bt_field_type_string_create();
+	assert(string_type);
+	ret = bt_field_type_structure_add_field(packet_context_type,
+		string_type, "a_string");
+	assert(!ret);
+	stream = bt_ctf_writer_create_stream(writer, stream_class);
+	assert(stream);
+	ok(bt_stream_set_serialize_on_append(stream, BT_TRUE) < 0,
+		"Serialize-on-append mode requires a fixed-size packet context");
+
+	bt_put(stream);
+	bt_put(writer);
+	bt_put(stream_class);
+	bt_put(packet_context_type);
+	bt_put(string_type);
+	recursive_rmdir(trace_path);
+	g_free(trace_path);
+}
+
 int main(int argc, char **argv)
 {
 	const char *env_resize_length;
@@ -3465,6 +3978,14 @@ int main(int argc, char **argv)
 
 	test_trace_uuid();
 
+	test_serialize_on_append();
+
+	test_packed_elements();
+
+	test_string_external_value();
+
+	test_enumeration_mapping_names();
+
 	metadata_string = bt_ctf_writer_get_metadata_string(writer);
 	ok(metadata_string, "Get metadata string");
 
@@ -0,0 +1,324 @@
+/*
+ * Copyright 2017 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Benchmark of the CTF binary type reader's (BTR) decoding of
+ * fixed-layout compound fields.
+ *
+ * For each field type layout, this program decodes the same buffer of
+ * consecutive pseudo-random fields once with the state machine and once
+ * with the precompiled decoding programs, with user functions which
+ * only accumulate the decoded values, and prints the average time per
+ * field of each run.
+ *
+ * This is not part of `make check`. Run it like this from the build
+ * directory:
+ *
+ *     tests/plugins/bench-ctf-btr [FIELD-COUNT]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <babeltrace/babeltrace.h>
+#include <ctf/common/btr/btr.h>
+#include <glib.h>
+
+#define DEFAULT_FIELD_COUNT	100000
+
+struct layout {
+	const char *name;
+	struct bt_field_type *(*create_ft)(void);
+};
+
+static uint64_t field_count = DEFAULT_FIELD_COUNT;
+
+/* Accumulated decoded values: keeps the user functions from being useless */
+static uint64_t value_sum;
+
+static
+enum bt_btr_status signed_int_cb(int64_t value, struct bt_field_type *ft,
+		void *data)
+{
+	value_sum += (uint64_t) value;
+	return BT_BTR_STATUS_OK;
+}
+
+static
+enum bt_btr_status unsigned_int_cb(uint64_t value, struct bt_field_type *ft,
+		void *data)
+{
+	value_sum += value;
+	return BT_BTR_STATUS_OK;
+}
+
+static
+enum bt_btr_status floating_point_cb(double value, struct bt_field_type *ft,
+		void *data)
+{
+	value_sum += (uint64_t) (value != 0.);
+	return BT_BTR_STATUS_OK;
+}
+
+static
+enum bt_btr_status compound_cb(struct bt_field_type *ft, void *data)
+{
+	value_sum++;
+	return BT_BTR_STATUS_OK;
+}
+
+static
+struct bt_field_type *create_int_ft(unsigned int size, bool is_signed,
+		enum bt_byte_order bo, unsigned int alignment)
+{
+	struct bt_field_type *ft = bt_field_type_integer_create(size);
+	int ret;
+
+	assert(ft);
+	ret = bt_field_type_integer_set_is_signed(ft, is_signed);
+	assert(ret == 0);
+	ret = bt_field_type_set_byte_order(ft, bo);
+	assert(ret == 0);
+	ret = bt_field_type_set_alignment(ft, alignment);
+	assert(ret == 0);
+	return ft;
+}
+
+static
+void add_field(struct bt_field_type *struct_ft, struct bt_field_type *ft,
+		const char *name)
+{
+	int ret = bt_field_type_structure_add_field(struct_ft, ft, name);
+
+	assert(ret == 0);
+	bt_put(ft);
+}
+
+/* Structure of 16 aligned 32-bit little-endian integers */
+static
+struct bt_field_type *create_aligned_ints_ft(void)
+{
+	struct bt_field_type *ft = bt_field_type_structure_create();
+	char name[8];
+	int i;
+
+	assert(ft);
+
+	for (i = 0; i < 16; i++) {
+		snprintf(name, sizeof(name), "f%d", i);
+		add_field(ft, create_int_ft(32, false,
+			BT_BYTE_ORDER_LITTLE_ENDIAN, 8), name);
+	}
+
+	return ft;
+}
+
+/*
+ * Structure of unaligned bit fields and byte-aligned integers with
+ * both byte orders, as found in kernel event payloads.
+ */
+static
+struct bt_field_type *create_mixed_ft(void)
+{
+	struct bt_field_type *ft = bt_field_type_structure_create();
+	const enum bt_byte_order le = BT_BYTE_ORDER_LITTLE_ENDIAN;
+	const enum bt_byte_order be = BT_BYTE_ORDER_BIG_ENDIAN;
+
+	assert(ft);
+	add_field(ft, create_int_ft(3, false, le, 1), "a");
+	add_field(ft, create_int_ft(13, true, le, 1), "b");
+	add_field(ft, create_int_ft(16, false, be, 8), "c");
+	add_field(ft, create_int_ft(5, false, be, 1), "d");
+	add_field(ft, create_int_ft(32, false, be, 1), "e");
+	add_field(ft, create_int_ft(7, true, be, 1), "f");
+	add_field(ft, create_int_ft(4, false, be, 1), "g");
+	add_field(ft, create_int_ft(64, true, le, 8), "h");
+	add_field(ft, create_int_ft(12, false, le, 1), "i");
+	add_field(ft, create_int_ft(64, false, le, 1), "j");
+	add_field(ft, create_int_ft(8, false, le, 8), "k");
+	return ft;
+}
+
+/* Array of 8 structures of 8-bit, 16-bit, 32-bit and 64-bit integers */
+static
+struct bt_field_type *create_nested_ft(void)
+{
+	struct bt_field_type *ft = bt_field_type_structure_create();
+	struct bt_field_type *elem_ft = bt_field_type_structure_create();
+	const enum bt_byte_order le = BT_BYTE_ORDER_LITTLE_ENDIAN;
+
+	assert(ft);
+	assert(elem_ft);
+	add_field(elem_ft, create_int_ft(8, false, le, 8), "a");
+	add_field(elem_ft, create_int_ft(16, false, le, 8), "b");
+	add_field(elem_ft, create_int_ft(32, false, le, 8), "c");
+	add_field(elem_ft, create_int_ft(64, false, le, 8), "d");
+	add_field(ft, bt_field_type_array_create(elem_ft, 8), "array");
+	bt_put(elem_ft);
+	return ft;
+}
+
+static const struct layout layouts[] = {
+	{ "16 x uint32", create_aligned_ints_ft },
+	{ "mixed bit fields", create_mixed_ft },
+	{ "8 x nested struct", create_nested_ft },
+};
+
+/*
+ * Returns the size (bytes) of a field of type `ft`, or -1 on error.
+ */
+static
+int64_t get_field_size(struct bt_btr *btr, struct bt_field_type *ft)
+{
+	uint8_t buf[4096] = { 0 };
+	enum bt_btr_status status;
+	size_t bits;
+
+	bits = bt_btr_start(btr, ft, buf, 0, 0, sizeof(buf), &status);
+	if (status != BT_BTR_STATUS_OK || bits % 8 != 0) {
+		return -1;
+	}
+
+	return (int64_t) bits / 8;
+}
+
+/*
+ * Decodes `field_count` consecutive fields of type `ft` from `buf`
+ * and returns the average time per field (ns), or -1 on error.
+ */
+static
+double run_btr(struct bt_field_type *ft, const uint8_t *buf,
+		size_t field_size, bool use_progs)
+{
+	struct bt_btr_cbs cbs = {
+		.types = {
+			.signed_int = signed_int_cb,
+			.unsigned_int = unsigned_int_cb,
+			.floating_point = floating_point_cb,
+			.compound_begin = compound_cb,
+			.compound_end = compound_cb,
+		},
+	};
+	struct bt_btr *btr;
+	enum bt_btr_status status;
+	gint64 begin, end;
+	double ns_per_field = -1.;
+	uint64_t i;
+
+	btr = bt_btr_create(cbs, NULL);
+	assert(btr);
+	bt_btr_set_use_progs(btr, use_progs);
+
+	/* Compile the decoding program before measuring */
+	(void) bt_btr_start(btr, ft, buf, 0, 0, field_size, &status);
+	if (status != BT_BTR_STATUS_OK) {
+		goto end;
+	}
+
+	begin = g_get_monotonic_time();
+
+	for (i = 0; i < field_count; i++) {
+		(void) bt_btr_start(btr, ft, &buf[i * field_size], 0,
+			i * field_size * 8, field_size, &status);
+		if (status != BT_BTR_STATUS_OK) {
+			goto end;
+		}
+	}
+
+	end = g_get_monotonic_time();
+	ns_per_field = (double) (end - begin) * 1000.0 / (double) field_count;
+
+end:
+	bt_btr_destroy(btr);
+	return ns_per_field;
+}
+
+int main(int argc, char **argv)
+{
+	struct bt_btr_cbs cbs = { .types = { 0 } };
+	struct bt_btr *size_btr;
+	size_t i;
+	int ret = 0;
+
+	if (argc > 1) {
+		field_count = strtoull(argv[1], NULL, 10);
+		if (field_count == 0) {
+			fprintf(stderr, "Invalid number of fields: `%s`\n",
+				argv[1]);
+			ret = 1;
+			goto end;
+		}
+	}
+
+	size_btr = bt_btr_create(cbs, NULL);
+	assert(size_btr);
+	srand(23);
+	printf("%20s %8s %18s %18s %8s\n", "layout", "bytes",
+		"state (ns/field)", "program (ns/field)", "speedup");
+
+	for (i = 0; i < sizeof(layouts) / sizeof(*layouts); i++) {
+		struct bt_field_type *ft = layouts[i].create_ft();
+		int64_t field_size = get_field_size(size_btr, ft);
+		uint8_t *buf;
+		double state_ns, prog_ns;
+		uint64_t j;
+
+		if (field_size <= 0) {
+			fprintf(stderr, "Cannot get the size of layout `%s`\n",
+				layouts[i].name);
+			bt_put(ft);
+			ret = 1;
+			break;
+		}
+
+		buf = g_malloc(field_count * field_size);
+		assert(buf);
+
+		for (j = 0; j < field_count * field_size; j++) {
+			buf[j] = (uint8_t) rand();
+		}
+
+		state_ns = run_btr(ft, buf, field_size, false);
+		prog_ns = run_btr(ft, buf, field_size, true);
+		g_free(buf);
+		bt_put(ft);
+
+		if (state_ns < 0 || prog_ns < 0) {
+			fprintf(stderr, "Cannot decode layout `%s`\n",
+				layouts[i].name);
+			ret = 1;
+			break;
+		}
+
+		printf("%20s %8" PRId64 " %18.1f %18.1f %7.2fx\n",
+			layouts[i].name, field_size, state_ns, prog_ns,
+			state_ns / prog_ns);
+	}
+
+	bt_btr_destroy(size_btr);
+
+	/* Printed so that the decoded values are used */
+	if (value_sum == 0) {
+		printf("(all decoded values are zero)\n");
+	}
+
+end:
+	return ret;
+}
@@ -0,0 +1,477 @@
+/*
+ * Copyright 2017 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Benchmark of the utils.muxer component's upstream selection modes.
+ *
+ * For each input port count, this program runs a graph made of a
+ * source with as many output ports, each one emitting events with
+ * increasing pseudo-random timestamps, a utils.muxer filter, and a
+ * sink which only counts the notifications. It does so once with the
+ * `linear` upstream selection and once with the `heap` upstream
+ * selection, and prints the average time per notification of each run.
+ *
+ * This is not part of `make check`. Run it like this from the build
+ * directory:
+ *
+ *     BABELTRACE_PLUGIN_PATH=plugins/utils \
+ *         tests/plugins/bench-utils-muxer [EVENTS-PER-PORT]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <babeltrace/babeltrace.h>
+#include <glib.h>
+
+#define DEFAULT_EVENTS_PER_PORT	4096
+
+static const uint64_t port_counts[] = { 1, 2, 4, 16, 64, 256, 1024 };
+
+static struct bt_clock_class_priority_map *src_cc_prio_map;
+static struct bt_clock_class *src_clock_class;
+static struct bt_stream_class *src_stream_class;
+static struct bt_event_class *src_event_class;
+static uint64_t cur_port_count;
+static uint64_t events_per_port = DEFAULT_EVENTS_PER_PORT;
+static uint64_t sink_notif_count;
+
+struct src_iter_user_data {
+	struct bt_packet *packet;
+	uint64_t at;
+	uint64_t ts;
+	uint32_t seed;
+};
+
+struct sink_user_data {
+	struct bt_notification_iterator *notif_iter;
+};
+
+static
+void init_static_data(void)
+{
+	int ret;
+	struct bt_trace *trace;
+	struct bt_field_type *empty_struct_ft;
+
+	empty_struct_ft = bt_field_type_structure_create();
+	assert(empty_struct_ft);
+	trace = bt_trace_create();
+	assert(trace);
+	ret = bt_trace_set_native_byte_order(trace,
+		BT_BYTE_ORDER_LITTLE_ENDIAN);
+	assert(ret == 0);
+	ret = bt_trace_set_packet_header_type(trace, empty_struct_ft);
+	assert(ret == 0);
+	src_clock_class = bt_clock_class_create("my-clock", 1000000000);
+	assert(src_clock_class);
+	ret = bt_clock_class_set_is_absolute(src_clock_class, 1);
+	assert(ret == 0);
+	ret = bt_trace_add_clock_class(trace, src_clock_class);
+	assert(ret == 0);
+	src_cc_prio_map = bt_clock_class_priority_map_create();
+	assert(src_cc_prio_map);
+	ret = bt_clock_class_priority_map_add_clock_class(src_cc_prio_map,
+		src_clock_class, 0);
+	assert(ret == 0);
+	src_stream_class = bt_stream_class_create("my-stream-class");
+	assert(src_stream_class);
+	ret = bt_stream_class_set_packet_context_type(src_stream_class,
+		empty_struct_ft);
+	assert(ret == 0);
+	ret = bt_stream_class_set_event_header_type(src_stream_class,
+		empty_struct_ft);
+	assert(ret == 0);
+	ret = bt_stream_class_set_event_context_type(src_stream_class,
+		empty_struct_ft);
+	assert(ret == 0);
+	src_event_class = bt_event_class_create("my-event-class");
+	assert(src_event_class);
+	ret = bt_event_class_set_context_type(src_event_class,
+		empty_struct_ft);
+	assert(ret == 0);
+	ret = bt_stream_class_add_event_class(src_stream_class,
+		src_event_class);
+	assert(ret == 0);
+	ret = bt_trace_add_stream_class(trace, src_stream_class);
+	assert(ret == 0);
+	bt_put(trace);
+	bt_put(empty_struct_ft);
+}
+
+static
+void fini_static_data(void)
+{
+	bt_put(src_cc_prio_map);
+	bt_put(src_clock_class);
+	bt_put(src_stream_class);
+	bt_put(src_event_class);
+}
+
+static
+void src_iter_finalize(
+		struct bt_private_connection_private_notification_iterator *private_notification_iterator)
+{
+	struct src_iter_user_data *user_data =
+		bt_private_connection_private_notification_iterator_get_user_data(
+			private_notification_iterator);
+
+	if (user_data) {
+		bt_put(user_data->packet);
+		g_free(user_data);
+	}
+}
+
+static
+enum bt_notification_iterator_status src_iter_init(
+		struct bt_private_connection_private_notification_iterator *priv_notif_iter,
+		struct bt_private_port *private_port)
+{
+	struct src_iter_user_data *user_data =
+		g_new0(struct src_iter_user_data, 1);
+	struct bt_port *port = bt_port_from_private(private_port);
+	struct bt_stream *stream;
+	int ret;
+
+	assert(user_data);
+	assert(port);
+	stream = bt_stream_create(src_stream_class, bt_port_get_name(port));
+	assert(stream);
+	user_data->packet = bt_packet_create(stream);
+	assert(user_data->packet);
+	user_data->seed = (uint32_t) g_str_hash(bt_port_get_name(port));
+	bt_put(stream);
+	bt_put(port);
+	ret = bt_private_connection_private_notification_iterator_set_user_data(
+		priv_notif_iter, user_data);
+	assert(ret == 0);
+	return BT_NOTIFICATION_ITERATOR_STATUS_OK;
+}
+
+static
+struct bt_notification_iterator_next_method_return src_iter_next(
+		struct bt_private_connection_private_notification_iterator *priv_iterator)
+{
+	struct bt_notification_iterator_next_method_return next_return = {
+		.notification = NULL,
+		.status = BT_NOTIFICATION_ITERATOR_STATUS_OK,
+	};
+	struct src_iter_user_data *user_data =
+		bt_private_connection_private_notification_iterator_get_user_data(
+			priv_iterator);
+	struct bt_event *event;
+	int ret;
+
+	assert(user_data);
+
+	if (user_data->at == events_per_port) {
+		next_return.status = BT_NOTIFICATION_ITERATOR_STATUS_END;
+		goto end;
+	}
+
+	/* Increasing, interleaved timestamps (LCG) */
+	user_data->seed = user_data->seed * 1103515245 + 12345;
+	user_data->ts += 1 + ((user_data->seed >> 16) % 1000);
+	event = bt_event_create(src_event_class);
+	assert(event);
+	ret = bt_event_set_packet(event, user_data->packet);
+	assert(ret == 0);
+	ret = bt_event_set_clock_value_cycles(event, src_clock_class,
+		user_data->ts);
+	assert(ret == 0);
+	next_return.notification = bt_notification_event_create(event,
+		src_cc_prio_map);
+	assert(next_return.notification);
+	bt_put(event);
+	user_data->at++;
+
+end:
+	return next_return;
+}
+
+static
+enum bt_component_status src_init(
+		struct bt_private_component *private_component,
+		struct bt_value *params, void *init_method_data)
+{
+	uint64_t i;
+
+	for (i = 0; i < cur_port_count; i++) {
+		char name[32];
+		int ret;
+
+		snprintf(name, sizeof(name), "out%" PRIu64, i);
+		ret = bt_private_component_source_add_output_private_port(
+			private_component, name, NULL, NULL);
+		assert(ret == 0);
+	}
+
+	return BT_COMPONENT_STATUS_OK;
+}
+
+static
+enum bt_component_status sink_consume(
+		struct bt_private_component *priv_component)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct sink_user_data *user_data =
+		bt_private_component_get_user_data(priv_component);
+	struct bt_notification *notifs[64];
+	uint64_t count = 0;
+	uint64_t i;
+	enum bt_notification_iterator_status it_ret;
+
+	assert(user_data && user_data->notif_iter);
+	it_ret = bt_notification_iterator_next_batch(user_data->notif_iter,
+		notifs, 64, &count);
+
+	switch (it_ret) {
+	case BT_NOTIFICATION_ITERATOR_STATUS_OK:
+		break;
+	case BT_NOTIFICATION_ITERATOR_STATUS_END:
+		ret = BT_COMPONENT_STATUS_END;
+		BT_PUT(user_data->notif_iter);
+		goto end;
+	case BT_NOTIFICATION_ITERATOR_STATUS_AGAIN:
+		ret = BT_COMPONENT_STATUS_AGAIN;
+		goto end;
+	default:
+		ret = BT_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		bt_put(notifs[i]);
+	}
+
+	sink_notif_count += count;
+
+end:
+	return ret;
+}
+
+static
+void sink_port_connected(struct bt_private_component *private_component,
+		struct bt_private_port *self_private_port,
+		struct bt_port *other_port)
+{
+	struct bt_private_connection *priv_conn =
+		bt_private_port_get_private_connection(self_private_port);
+	struct sink_user_data *user_data = bt_private_component_get_user_data(
+		private_component);
+	enum bt_connection_status conn_status;
+
+	assert(user_data);
+	assert(priv_conn);
+	conn_status = bt_private_connection_create_notification_iterator(
+		priv_conn, NULL, &user_data->notif_iter);
+	assert(conn_status == 0);
+	bt_put(priv_conn);
+}
+
+static
+enum bt_component_status sink_init(
+		struct bt_private_component *private_component,
+		struct bt_value *params, void *init_method_data)
+{
+	struct sink_user_data *user_data = g_new0(struct sink_user_data, 1);
+	int ret;
+
+	assert(user_data);
+	ret = bt_private_component_set_user_data(private_component,
+		user_data);
+	assert(ret == 0);
+	ret = bt_private_component_sink_add_input_private_port(
+		private_component, "in", NULL, NULL);
+	assert(ret == 0);
+	return BT_COMPONENT_STATUS_OK;
+}
+
+static
+void sink_finalize(struct bt_private_component *private_component)
+{
+	struct sink_user_data *user_data = bt_private_component_get_user_data(
+		private_component);
+
+	if (user_data) {
+		bt_put(user_data->notif_iter);
+		g_free(user_data);
+	}
+}
+
+/*
+ * Runs one graph and returns the average time per notification (ns),
+ * or -1.0 on error.
+ */
+static
+double run_graph(uint64_t port_count, const char *upstream_selection)
+{
+	struct bt_component_class *src_comp_class;
+	struct bt_component_class *muxer_comp_class;
+	struct bt_component_class *sink_comp_class;
+	struct bt_component *src_comp;
+	struct bt_component *muxer_comp;
+	struct bt_component *sink_comp;
+	struct bt_port *upstream_port;
+	struct bt_port *downstream_port;
+	struct bt_value *muxer_params;
+	struct bt_graph *graph;
+	enum bt_graph_status graph_status = BT_GRAPH_STATUS_OK;
+	gint64 begin, end;
+	double ns_per_notif = -1.0;
+	uint64_t i;
+	int ret;
+
+	cur_port_count = port_count;
+	sink_notif_count = 0;
+	graph = bt_graph_create();
+	assert(graph);
+
+	src_comp_class = bt_component_class_source_create("src", src_iter_next);
+	assert(src_comp_class);
+	ret = bt_component_class_set_init_method(src_comp_class, src_init);
+	assert(ret == 0);
+	ret = bt_component_class_source_set_notification_iterator_init_method(
+		src_comp_class, src_iter_init);
+	assert(ret == 0);
+	ret = bt_component_class_source_set_notification_iterator_finalize_method(
+		src_comp_class, src_iter_finalize);
+	assert(ret == 0);
+	ret = bt_graph_add_component(graph, src_comp_class, "source", NULL,
+		&src_comp);
+	assert(ret == 0);
+
+	muxer_comp_class = bt_plugin_find_component_class("utils", "muxer",
+		BT_COMPONENT_CLASS_TYPE_FILTER);
+	assert(muxer_comp_class);
+	muxer_params = bt_value_map_create();
+	assert(muxer_params);
+	ret = bt_value_map_insert_string(muxer_params, "upstream-selection",
+		upstream_selection);
+	assert(ret == 0);
+	ret = bt_graph_add_component(graph, muxer_comp_class, "muxer",
+		muxer_params, &muxer_comp);
+	assert(ret == 0);
+
+	sink_comp_class = bt_component_class_sink_create("sink", sink_consume);
+	assert(sink_comp_class);
+	ret = bt_component_class_set_init_method(sink_comp_class, sink_init);
+	assert(ret == 0);
+	ret = bt_component_class_set_finalize_method(sink_comp_class,
+		sink_finalize);
+	assert(ret == 0);
+	ret = bt_component_class_set_port_connected_method(sink_comp_class,
+		sink_port_connected);
+	assert(ret == 0);
+	ret = bt_graph_add_component(graph, sink_comp_class, "sink", NULL,
+		&sink_comp);
+	assert(ret == 0);
+
+	for (i = 0; i < port_count; i++) {
+		upstream_port = bt_component_source_get_output_port_by_index(
+			src_comp, i);
+		assert(upstream_port);
+		downstream_port = bt_component_filter_get_input_port_by_index(
+			muxer_comp, i);
+		assert(downstream_port);
+		graph_status = bt_graph_connect_ports(graph,
+			upstream_port, downstream_port, NULL);
+		assert(graph_status == 0);
+		bt_put(upstream_port);
+		bt_put(downstream_port);
+	}
+
+	upstream_port = bt_component_filter_get_output_port_by_name(muxer_comp,
+		"out");
+	assert(upstream_port);
+	downstream_port = bt_component_sink_get_input_port_by_name(sink_comp,
+		"in");
+	assert(downstream_port);
+	graph_status = bt_graph_connect_ports(graph, upstream_port,
+		downstream_port, NULL);
+	assert(graph_status == 0);
+	bt_put(upstream_port);
+	bt_put(downstream_port);
+
+	begin = g_get_monotonic_time();
+
+	while (graph_status == BT_GRAPH_STATUS_OK ||
+			graph_status == BT_GRAPH_STATUS_AGAIN) {
+		graph_status = bt_graph_run(graph);
+	}
+
+	end = g_get_monotonic_time();
+
+	if (graph_status == BT_GRAPH_STATUS_END && sink_notif_count > 0) {
+		ns_per_notif = (double) (end - begin) * 1000.0 /
+			(double) sink_notif_count;
+	}
+
+	bt_put(muxer_params);
+	bt_put(src_comp_class);
+	bt_put(muxer_comp_class);
+	bt_put(sink_comp_class);
+	bt_put(src_comp);
+	bt_put(muxer_comp);
+	bt_put(sink_comp);
+	bt_put(graph);
+	return ns_per_notif;
+}
+
+int main(int argc, char **argv)
+{
+	size_t i;
+	int ret = 0;
+
+	if (argc > 1) {
+		events_per_port = strtoull(argv[1], NULL, 10);
+		if (events_per_port == 0) {
+			fprintf(stderr, "Invalid number of events per port: `%s`\n",
+				argv[1]);
+			ret = 1;
+			goto end;
+		}
+	}
+
+	init_static_data();
+	printf("%10s %12s %16s %16s %8s\n", "ports", "events/port",
+		"linear (ns/notif)", "heap (ns/notif)", "speedup");
+
+	for (i = 0; i < sizeof(port_counts) / sizeof(*port_counts); i++) {
+		double linear_ns = run_graph(port_counts[i], "linear");
+		double heap_ns = run_graph(port_counts[i], "heap");
+
+		if (linear_ns < 0 || heap_ns < 0) {
+			fprintf(stderr, "Cannot run graph with %" PRIu64 " ports\n",
+				port_counts[i]);
+			ret = 1;
+			break;
+		}
+
+		printf("%10" PRIu64 " %12" PRIu64 " %16.1f %16.1f %7.2fx\n",
+			port_counts[i], events_per_port, linear_ns, heap_ns,
+			linear_ns / heap_ns);
+	}
+
+	fini_static_data();
+
+end:
+	return ret;
+}
@@ -27,7 +27,7 @@
 
 #include "tap/tap.h"
 
-#define NR_TESTS	12
+#define NR_TESTS	16
 
 enum test {
 	TEST_NO_TS,
@@ -71,6 +71,7 @@ struct graph_listener_data {
 
 static bool debug = false;
 static enum test current_test;
+static const char *muxer_upstream_selection = "heap";
 static GArray *test_events;
 static struct bt_clock_class_priority_map *src_cc_prio_map;
 static struct bt_clock_class_priority_map *src_empty_cc_prio_map;
@@ -890,6 +891,7 @@ void create_source_muxer_sink(struct bt_graph *graph,
 	struct bt_component_class *src_comp_class;
 	struct bt_component_class *muxer_comp_class;
 	struct bt_component_class *sink_comp_class;
+	struct bt_value *muxer_params;
 	int ret;
 
 	/* Create source component */
@@ -913,8 +915,15 @@ void create_source_muxer_sink(struct bt_graph *graph,
 	muxer_comp_class = bt_plugin_find_component_class("utils", "muxer",
 		BT_COMPONENT_CLASS_TYPE_FILTER);
 	assert(muxer_comp_class);
-	ret = bt_graph_add_component(graph, muxer_comp_class, "muxer", NULL, muxer);
+	muxer_params = bt_value_map_create();
+	assert(muxer_params);
+	ret = bt_value_map_insert_string(muxer_params, "upstream-selection",
+		muxer_upstream_selection);
 	assert(ret == 0);
+	ret = bt_graph_add_component(graph, muxer_comp_class, "muxer",
+		muxer_params, muxer);
+	assert(ret == 0);
+	bt_put(muxer_params);
 
 	/* Create sink component */
 	sink_comp_class = bt_component_class_sink_create("sink", sink_consume);
@@ -951,7 +960,8 @@ void do_std_test(enum test test, const char *name,
 
 	clear_test_events();
 	current_test = test;
-	diag("test: %s", name);
+	diag("test: %s (upstream selection: %s)", name,
+		muxer_upstream_selection);
 	graph = bt_graph_create();
 	assert(graph);
 	create_source_muxer_sink(graph, &src_comp, &muxer_comp, &sink_comp);
@@ -1622,6 +1632,11 @@ int main(int argc, char **argv)
 	test_4_ports_with_retries();
 	test_single_end_then_multiple_full();
 	test_single_again_end_then_multiple_full();
+
+	/* Same timestamped tests with the linear upstream selection */
+	muxer_upstream_selection = "linear";
+	test_simple_4_ports();
+	test_4_ports_with_retries();
 	fini_static_data();
 	return exit_status();
 }
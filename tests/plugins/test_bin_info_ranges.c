@@ -0,0 +1,307 @@
+/*
+ * test_bin_info_ranges.c
+ *
+ * Babeltrace debug info binary address range index tests
+ *
+ * Copyright (c) 2017 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <glib.h>
+#include <lttng-utils/bin-info.h>
+#include <lttng-utils/bin-info-ranges.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 31
+
+/* Number of binaries of the sorted index test */
+#define NR_BINS 100
+
+static
+struct bin_info *create_bin(uint64_t low_addr, uint64_t memsz)
+{
+	struct bin_info *bin;
+
+	bin = bin_info_create("/usr/lib/libtest.so", low_addr, memsz, true,
+		NULL, NULL);
+	if (!bin) {
+		BAIL_OUT("Cannot create a bin info object");
+	}
+
+	return bin;
+}
+
+/* Checks that `ranges` is sorted and that its ranges do not overlap. */
+static
+bool ranges_are_valid(GArray *ranges)
+{
+	guint i;
+
+	for (i = 0; i < ranges->len; i++) {
+		struct bin_info_range *range = &g_array_index(ranges,
+			struct bin_info_range, i);
+
+		if (range->low_addr >= range->high_addr) {
+			diag("Empty range: index=%u", i);
+			return false;
+		}
+
+		if (i > 0 && g_array_index(ranges, struct bin_info_range,
+				i - 1).high_addr > range->low_addr) {
+			diag("Unsorted or overlapping ranges: index=%u", i);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static
+void test_upper_bound(void)
+{
+	GArray *ranges = bin_info_ranges_create();
+	struct bin_info *bin_a = create_bin(0x1000, 0x1000);
+	struct bin_info *bin_b = create_bin(0x3000, 0x1000);
+
+	diag("bin_info_ranges_upper_bound() tests");
+	ok(bin_info_ranges_upper_bound(ranges, 0x1000) == 0,
+		"Upper bound in an empty index is 0");
+
+	bin_info_ranges_add(ranges, bin_a);
+	bin_info_ranges_add(ranges, bin_b);
+	ok(bin_info_ranges_upper_bound(ranges, 0xfff) == 0,
+		"Upper bound before the first range is 0");
+	ok(bin_info_ranges_upper_bound(ranges, 0x1000) == 1,
+		"Upper bound at the low address of a range is the next range");
+	ok(bin_info_ranges_upper_bound(ranges, 0x2fff) == 1,
+		"Upper bound between two ranges is the second range");
+	ok(bin_info_ranges_upper_bound(ranges, 0x5000) == 2,
+		"Upper bound after the last range is the range count");
+
+	g_array_free(ranges, TRUE);
+	bin_info_destroy(bin_b);
+	bin_info_destroy(bin_a);
+}
+
+static
+void test_add_find(void)
+{
+	GArray *ranges = bin_info_ranges_create();
+	struct bin_info *bin_a = create_bin(0x1000, 0x1000);
+	struct bin_info *bin_b = create_bin(0x3000, 0x1000);
+	struct bin_info *bin_c = create_bin(0x2000, 0x1000);
+
+	diag("bin_info_ranges_add() and bin_info_ranges_find() tests");
+	ok(!bin_info_ranges_find(ranges, 0x1000),
+		"No binary is found in an empty index");
+
+	/* Added in any order */
+	bin_info_ranges_add(ranges, bin_b);
+	bin_info_ranges_add(ranges, bin_a);
+	ok(ranges->len == 2 && ranges_are_valid(ranges),
+		"Index of two binaries is sorted");
+	ok(bin_info_ranges_find(ranges, 0x1000) == bin_a,
+		"Binary is found at its low address");
+	ok(bin_info_ranges_find(ranges, 0x1fff) == bin_a,
+		"Binary is found at its last address");
+	ok(!bin_info_ranges_find(ranges, 0x2000),
+		"Binary is not found at its high address");
+	ok(!bin_info_ranges_find(ranges, 0xfff),
+		"No binary is found before the first range");
+	ok(bin_info_ranges_find(ranges, 0x3800) == bin_b,
+		"Second binary is found within its range");
+	ok(!bin_info_ranges_find(ranges, 0x4000),
+		"No binary is found after the last range");
+
+	/* Adjacent ranges do not overlap */
+	bin_info_ranges_add(ranges, bin_c);
+	ok(ranges->len == 3 && ranges_are_valid(ranges),
+		"Adjacent binary does not replace its neighbours");
+	ok(bin_info_ranges_find(ranges, 0x1fff) == bin_a &&
+		bin_info_ranges_find(ranges, 0x2000) == bin_c &&
+		bin_info_ranges_find(ranges, 0x3000) == bin_b,
+		"Adjacent binaries are found within their own range");
+
+	g_array_free(ranges, TRUE);
+	bin_info_destroy(bin_c);
+	bin_info_destroy(bin_b);
+	bin_info_destroy(bin_a);
+}
+
+static
+void test_overlap_remove(void)
+{
+	GArray *ranges = bin_info_ranges_create();
+	struct bin_info *bin_a = create_bin(0x1000, 0x1000);
+	struct bin_info *bin_b = create_bin(0x3000, 0x1000);
+	struct bin_info *bin_c = create_bin(0x1800, 0x2000);
+	struct bin_info *bin_d = create_bin(0x1000, 0x800);
+
+	diag("Overlapping dlopen() and dlclose() tests");
+	bin_info_ranges_add(ranges, bin_a);
+	bin_info_ranges_add(ranges, bin_b);
+
+	/* Mapped over the end of A and the beginning of B */
+	bin_info_ranges_add(ranges, bin_c);
+	ok(ranges->len == 1 && ranges_are_valid(ranges),
+		"Overlapping binary replaces the binaries it overlaps");
+	ok(bin_info_ranges_find(ranges, 0x1800) == bin_c &&
+		bin_info_ranges_find(ranges, 0x37ff) == bin_c,
+		"Overlapping binary is found within its range");
+	ok(!bin_info_ranges_find(ranges, 0x1000) &&
+		!bin_info_ranges_find(ranges, 0x3800),
+		"Replaced binaries are not found outside the new range");
+
+	/* Mapped at the same low address as a replaced binary */
+	bin_info_ranges_add(ranges, bin_d);
+	ok(ranges->len == 2 && ranges_are_valid(ranges),
+		"Binary before an overlapping binary is added");
+	ok(bin_info_ranges_find(ranges, 0x17ff) == bin_d &&
+		bin_info_ranges_find(ranges, 0x1800) == bin_c,
+		"Binaries are found within their own range");
+
+	/* dlclose() of replaced binaries */
+	bin_info_ranges_remove(ranges, bin_a);
+	bin_info_ranges_remove(ranges, bin_b);
+	ok(ranges->len == 2 && bin_info_ranges_find(ranges, 0x1000) == bin_d &&
+		bin_info_ranges_find(ranges, 0x1800) == bin_c,
+		"Removing replaced binaries does not remove their replacements");
+
+	/* dlclose() of mapped binaries */
+	bin_info_ranges_remove(ranges, bin_c);
+	ok(ranges->len == 1 && !bin_info_ranges_find(ranges, 0x1800),
+		"Removed binary is not found");
+	ok(bin_info_ranges_find(ranges, 0x1000) == bin_d,
+		"Other binary is still found after a removal");
+	bin_info_ranges_remove(ranges, bin_c);
+	ok(ranges->len == 1,
+		"Removing a binary twice does not remove another binary");
+	bin_info_ranges_remove(ranges, bin_d);
+	ok(ranges->len == 0 && !bin_info_ranges_find(ranges, 0x1000),
+		"Index is empty after removing all its binaries");
+
+	g_array_free(ranges, TRUE);
+	bin_info_destroy(bin_d);
+	bin_info_destroy(bin_c);
+	bin_info_destroy(bin_b);
+	bin_info_destroy(bin_a);
+}
+
+static
+void test_zero_size(void)
+{
+	GArray *ranges = bin_info_ranges_create();
+	struct bin_info *bin_a = create_bin(0x1000, 0x1000);
+	struct bin_info *bin_empty = create_bin(0x1000, 0);
+	struct bin_info *bin_empty_other = create_bin(0x5000, 0);
+
+	diag("Zero-size binary tests");
+	bin_info_ranges_add(ranges, bin_empty_other);
+	ok(ranges->len == 0 && !bin_info_ranges_find(ranges, 0x5000),
+		"Zero-size binary is not added");
+
+	bin_info_ranges_add(ranges, bin_a);
+	bin_info_ranges_add(ranges, bin_empty);
+	ok(ranges->len == 1 && bin_info_ranges_find(ranges, 0x1000) == bin_a,
+		"Zero-size binary does not replace a binary at its address");
+
+	bin_info_ranges_remove(ranges, bin_empty);
+	bin_info_ranges_remove(ranges, bin_empty_other);
+	ok(ranges->len == 1 && bin_info_ranges_find(ranges, 0x1000) == bin_a,
+		"Removing a zero-size binary does not remove a binary at its address");
+
+	g_array_free(ranges, TRUE);
+	bin_info_destroy(bin_empty_other);
+	bin_info_destroy(bin_empty);
+	bin_info_destroy(bin_a);
+}
+
+static
+void test_many(void)
+{
+	GArray *ranges = bin_info_ranges_create();
+	struct bin_info *bins[NR_BINS];
+	bool all_found = true;
+	int i;
+
+	diag("Index of %d binaries tests", NR_BINS);
+
+	/* In reverse order, with a gap between each binary */
+	for (i = NR_BINS - 1; i >= 0; i--) {
+		bins[i] = create_bin(0x10000 + (uint64_t) i * 0x2000, 0x1000);
+		bin_info_ranges_add(ranges, bins[i]);
+	}
+
+	ok(ranges->len == NR_BINS && ranges_are_valid(ranges),
+		"Index of %d binaries is sorted", NR_BINS);
+
+	for (i = 0; i < NR_BINS; i++) {
+		uint64_t low_addr = bins[i]->low_addr;
+
+		if (bin_info_ranges_find(ranges, low_addr) != bins[i] ||
+				bin_info_ranges_find(ranges,
+					low_addr + 0xfff) != bins[i] ||
+				bin_info_ranges_find(ranges,
+					low_addr + 0x1000)) {
+			diag("Unexpected lookup result: index=%d", i);
+			all_found = false;
+		}
+	}
+
+	ok(all_found, "Each binary is found within its range only");
+
+	/* Remove every other binary */
+	for (i = 0; i < NR_BINS; i += 2) {
+		bin_info_ranges_remove(ranges, bins[i]);
+	}
+
+	all_found = true;
+	for (i = 0; i < NR_BINS; i++) {
+		struct bin_info *bin = bin_info_ranges_find(ranges,
+			bins[i]->low_addr);
+
+		if (bin != (i % 2 ? bins[i] : NULL)) {
+			diag("Unexpected lookup result after removal: index=%d",
+				i);
+			all_found = false;
+		}
+	}
+
+	ok(ranges->len == NR_BINS / 2 && ranges_are_valid(ranges) && all_found,
+		"Only the remaining binaries are found after removals");
+
+	g_array_free(ranges, TRUE);
+
+	for (i = 0; i < NR_BINS; i++) {
+		bin_info_destroy(bins[i]);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	plan_tests(NR_TESTS);
+
+	test_upper_bound();
+	test_add_find();
+	test_overlap_remove();
+	test_zero_size();
+	test_many();
+
+	return exit_status();
+}
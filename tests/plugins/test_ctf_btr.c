@@ -0,0 +1,418 @@
+/*
+ * test_ctf_btr.c
+ *
+ * Babeltrace CTF binary type reader (BTR) tests: decoding of
+ * fixed-layout compound fields with precompiled programs compared to
+ * the state machine
+ *
+ * Copyright 2017 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <glib.h>
+#include <babeltrace/babeltrace.h>
+#include <ctf/common/btr/btr.h>
+#include "tap/tap.h"
+
+#define NR_TESTS	6
+
+/* Number of pseudo-random buffers to decode */
+#define NR_BUFFERS	200
+
+/* Size of the root field (bytes): see create_root_ft() */
+#define ROOT_SIZE	46
+
+enum record_type {
+	RECORD_TYPE_SIGNED_INT,
+	RECORD_TYPE_UNSIGNED_INT,
+	RECORD_TYPE_FLOAT,
+	RECORD_TYPE_COMPOUND_BEGIN,
+	RECORD_TYPE_COMPOUND_END,
+};
+
+/* One user function call */
+struct record {
+	enum record_type type;
+	struct bt_field_type *ft;
+	union {
+		int64_t s;
+		uint64_t u;
+		double d;
+	} value;
+};
+
+static
+void append_record(GArray *records, enum record_type type,
+		struct bt_field_type *ft, const void *value, size_t value_size)
+{
+	struct record record;
+
+	memset(&record, 0, sizeof(record));
+	record.type = type;
+	record.ft = ft;
+
+	if (value) {
+		memcpy(&record.value, value, value_size);
+	}
+
+	g_array_append_val(records, record);
+}
+
+static
+enum bt_btr_status signed_int_cb(int64_t value, struct bt_field_type *ft,
+		void *data)
+{
+	append_record(data, RECORD_TYPE_SIGNED_INT, ft, &value, sizeof(value));
+	return BT_BTR_STATUS_OK;
+}
+
+static
+enum bt_btr_status unsigned_int_cb(uint64_t value, struct bt_field_type *ft,
+		void *data)
+{
+	append_record(data, RECORD_TYPE_UNSIGNED_INT, ft, &value,
+		sizeof(value));
+	return BT_BTR_STATUS_OK;
+}
+
+static
+enum bt_btr_status floating_point_cb(double value, struct bt_field_type *ft,
+		void *data)
+{
+	append_record(data, RECORD_TYPE_FLOAT, ft, &value, sizeof(value));
+	return BT_BTR_STATUS_OK;
+}
+
+static
+enum bt_btr_status compound_begin_cb(struct bt_field_type *ft, void *data)
+{
+	append_record(data, RECORD_TYPE_COMPOUND_BEGIN, ft, NULL, 0);
+	return BT_BTR_STATUS_OK;
+}
+
+static
+enum bt_btr_status compound_end_cb(struct bt_field_type *ft, void *data)
+{
+	append_record(data, RECORD_TYPE_COMPOUND_END, ft, NULL, 0);
+	return BT_BTR_STATUS_OK;
+}
+
+static
+struct bt_field_type *create_int_ft(unsigned int size, bool is_signed,
+		enum bt_byte_order bo, unsigned int alignment)
+{
+	struct bt_field_type *ft = bt_field_type_integer_create(size);
+	int ret;
+
+	assert(ft);
+	ret = bt_field_type_integer_set_is_signed(ft, is_signed);
+	assert(ret == 0);
+	ret = bt_field_type_set_byte_order(ft, bo);
+	assert(ret == 0);
+	ret = bt_field_type_set_alignment(ft, alignment);
+	assert(ret == 0);
+	return ft;
+}
+
+static
+struct bt_field_type *create_float_ft(unsigned int exp_dig,
+		unsigned int mant_dig, enum bt_byte_order bo)
+{
+	struct bt_field_type *ft = bt_field_type_floating_point_create();
+	int ret;
+
+	assert(ft);
+	ret = bt_field_type_floating_point_set_exponent_digits(ft, exp_dig);
+	assert(ret == 0);
+	ret = bt_field_type_floating_point_set_mantissa_digits(ft, mant_dig);
+	assert(ret == 0);
+	ret = bt_field_type_set_byte_order(ft, bo);
+	assert(ret == 0);
+	return ft;
+}
+
+static
+void add_field(struct bt_field_type *struct_ft, struct bt_field_type *ft,
+		const char *name)
+{
+	int ret = bt_field_type_structure_add_field(struct_ft, ft, name);
+
+	assert(ret == 0);
+	bt_put(ft);
+}
+
+/*
+ * Creates the following fixed-layout structure field type (offsets in
+ * bits):
+ *
+ *       0: a: 3-bit unsigned integer, little endian
+ *       3: b: 13-bit signed integer, little endian
+ *      16: c: 16-bit unsigned integer, big endian
+ *      32: d: 5-bit unsigned integer, big endian
+ *      37: e: unaligned 32-bit unsigned integer, big endian
+ *      69: f: 7-bit signed integer, big endian
+ *      76: g: 4-bit unsigned integer, big endian
+ *      80: h: 32-bit floating point number, little endian
+ *     112: i: 64-bit floating point number, big endian
+ *     176: inner: structure:
+ *     176:     j: 8-bit unsigned integer
+ *     184:     k: 16-bit signed integer, little endian
+ *     200: l: array of three unaligned 12-bit unsigned integers,
+ *             little endian
+ *     236: m: unaligned 64-bit unsigned integer, little endian
+ *     304: n: 64-bit signed integer, big endian
+ *
+ * Total size: 368 bits (ROOT_SIZE bytes).
+ */
+static
+struct bt_field_type *create_root_ft(void)
+{
+	struct bt_field_type *root_ft = bt_field_type_structure_create();
+	struct bt_field_type *inner_ft = bt_field_type_structure_create();
+	struct bt_field_type *elem_ft;
+	const enum bt_byte_order le = BT_BYTE_ORDER_LITTLE_ENDIAN;
+	const enum bt_byte_order be = BT_BYTE_ORDER_BIG_ENDIAN;
+
+	assert(root_ft);
+	assert(inner_ft);
+	add_field(root_ft, create_int_ft(3, false, le, 1), "a");
+	add_field(root_ft, create_int_ft(13, true, le, 1), "b");
+	add_field(root_ft, create_int_ft(16, false, be, 8), "c");
+	add_field(root_ft, create_int_ft(5, false, be, 1), "d");
+	add_field(root_ft, create_int_ft(32, false, be, 1), "e");
+	add_field(root_ft, create_int_ft(7, true, be, 1), "f");
+	add_field(root_ft, create_int_ft(4, false, be, 1), "g");
+	add_field(root_ft, create_float_ft(8, 24, le), "h");
+	add_field(root_ft, create_float_ft(11, 53, be), "i");
+	add_field(inner_ft, create_int_ft(8, false, le, 8), "j");
+	add_field(inner_ft, create_int_ft(16, true, le, 8), "k");
+	add_field(root_ft, inner_ft, "inner");
+	elem_ft = create_int_ft(12, false, le, 1);
+	add_field(root_ft, bt_field_type_array_create(elem_ft, 3), "l");
+	bt_put(elem_ft);
+	add_field(root_ft, create_int_ft(64, false, le, 1), "m");
+	add_field(root_ft, create_int_ft(64, true, be, 8), "n");
+	return root_ft;
+}
+
+/*
+ * Decodes one field of type `ft` from `buf` with `btr`, passing the
+ * buffer `chunk_size` bytes at a time, and returns the number of
+ * decoded bits, or -1 on error.
+ */
+static
+int64_t decode(struct bt_btr *btr, struct bt_field_type *ft,
+		const uint8_t *buf, size_t buf_size, size_t chunk_size)
+{
+	enum bt_btr_status status;
+	size_t at = 0;
+	size_t consumed;
+
+	consumed = bt_btr_start(btr, ft, buf, 0, 0,
+		MIN(chunk_size, buf_size), &status);
+	at += MIN(chunk_size, buf_size);
+
+	while (status == BT_BTR_STATUS_EOF && at < buf_size) {
+		consumed += bt_btr_continue(btr, &buf[at],
+			MIN(chunk_size, buf_size - at), &status);
+		at += MIN(chunk_size, buf_size - at);
+	}
+
+	if (status != BT_BTR_STATUS_OK) {
+		return -1;
+	}
+
+	return (int64_t) consumed;
+}
+
+static
+bool records_equal(GArray *a, GArray *b)
+{
+	return a->len == b->len &&
+		memcmp(a->data, b->data, a->len * sizeof(struct record)) == 0;
+}
+
+/*
+ * Returns the record of the member named `name` of the structure field
+ * type `struct_ft`.
+ */
+static
+struct record *find_record(GArray *records, struct bt_field_type *struct_ft,
+		const char *name)
+{
+	struct bt_field_type *ft =
+		bt_field_type_structure_get_field_type_by_name(struct_ft, name);
+	struct record *found = NULL;
+	guint i;
+
+	assert(ft);
+
+	for (i = 0; i < records->len; i++) {
+		struct record *record = &g_array_index(records,
+			struct record, i);
+
+		if (record->ft == ft) {
+			found = record;
+			break;
+		}
+	}
+
+	bt_put(ft);
+	return found;
+}
+
+int main(int argc, char **argv)
+{
+	struct bt_btr_cbs cbs = {
+		.types = {
+			.signed_int = signed_int_cb,
+			.unsigned_int = unsigned_int_cb,
+			.floating_point = floating_point_cb,
+			.compound_begin = compound_begin_cb,
+			.compound_end = compound_end_cb,
+		},
+	};
+	GArray *prog_records = g_array_new(FALSE, FALSE, sizeof(struct record));
+	GArray *sm_records = g_array_new(FALSE, FALSE, sizeof(struct record));
+	GArray *chunked_records = g_array_new(FALSE, FALSE,
+		sizeof(struct record));
+	struct bt_btr *prog_btr, *sm_btr, *chunked_btr;
+	struct bt_field_type *root_ft, *inner_ft;
+	uint8_t buf[ROOT_SIZE];
+	bool sizes_ok = true;
+	bool sm_equal = true;
+	bool chunked_equal = true;
+	bool values_ok = true;
+	guint record_count = 0;
+	unsigned int i;
+	size_t j;
+
+	plan_tests(NR_TESTS);
+	assert(prog_records && sm_records && chunked_records);
+	root_ft = create_root_ft();
+	inner_ft = bt_field_type_structure_get_field_type_by_name(root_ft,
+		"inner");
+	assert(inner_ft);
+	prog_btr = bt_btr_create(cbs, prog_records);
+	sm_btr = bt_btr_create(cbs, sm_records);
+	chunked_btr = bt_btr_create(cbs, chunked_records);
+	ok(prog_btr && sm_btr && chunked_btr, "create BTRs");
+	if (!prog_btr || !sm_btr || !chunked_btr) {
+		goto end;
+	}
+
+	bt_btr_set_use_progs(sm_btr, false);
+	bt_btr_set_use_progs(chunked_btr, false);
+	srand(23);
+
+	for (i = 0; i < NR_BUFFERS; i++) {
+		uint64_t n = 0;
+		struct record *record;
+
+		for (j = 0; j < sizeof(buf); j++) {
+			buf[j] = (uint8_t) rand();
+		}
+
+		g_array_set_size(prog_records, 0);
+		g_array_set_size(sm_records, 0);
+		g_array_set_size(chunked_records, 0);
+
+		/* Program: whole buffer at once */
+		if (decode(prog_btr, root_ft, buf, sizeof(buf),
+				sizeof(buf)) != ROOT_SIZE * 8) {
+			sizes_ok = false;
+		}
+
+		/* State machine: whole buffer at once */
+		if (decode(sm_btr, root_ft, buf, sizeof(buf),
+				sizeof(buf)) != ROOT_SIZE * 8) {
+			sizes_ok = false;
+		}
+
+		/* State machine: one byte at a time (stitching) */
+		if (decode(chunked_btr, root_ft, buf, sizeof(buf),
+				1) != ROOT_SIZE * 8) {
+			sizes_ok = false;
+		}
+
+		record_count = prog_records->len;
+
+		if (!records_equal(prog_records, sm_records)) {
+			sm_equal = false;
+		}
+
+		if (!records_equal(prog_records, chunked_records)) {
+			chunked_equal = false;
+		}
+
+		/* Check the byte-aligned integers against the buffer */
+		record = find_record(prog_records, root_ft, "c");
+		if (!record || record->value.u !=
+				(uint64_t) ((buf[2] << 8) | buf[3])) {
+			values_ok = false;
+		}
+
+		record = find_record(prog_records, inner_ft, "k");
+		if (!record || record->value.s !=
+				(int16_t) (buf[23] | (buf[24] << 8))) {
+			values_ok = false;
+		}
+
+		for (j = 38; j < ROOT_SIZE; j++) {
+			n = (n << 8) | buf[j];
+		}
+
+		record = find_record(prog_records, root_ft, "n");
+		if (!record || record->value.s != (int64_t) n) {
+			values_ok = false;
+		}
+	}
+
+	ok(sizes_ok, "all decoding methods consume the whole field");
+	ok(record_count == 22,
+		"decoding program calls the user functions for each field");
+	ok(sm_equal,
+		"decoding program and state machine give the same values");
+	ok(chunked_equal,
+		"decoding program and byte-by-byte state machine give the same values");
+	ok(values_ok,
+		"decoding program gives the expected byte-aligned integer values");
+
+end:
+	if (prog_btr) {
+		bt_btr_destroy(prog_btr);
+	}
+
+	if (sm_btr) {
+		bt_btr_destroy(sm_btr);
+	}
+
+	if (chunked_btr) {
+		bt_btr_destroy(chunked_btr);
+	}
+
+	bt_put(inner_ft);
+	bt_put(root_ft);
+	g_array_free(prog_records, TRUE);
+	g_array_free(sm_records, TRUE);
+	g_array_free(chunked_records, TRUE);
+	return exit_status();
+}
@@ -0,0 +1,467 @@
+/*
+ * test_ctf_fs_strings.c
+ *
+ * Babeltrace CTF file system source tests: string fields which
+ * reference the mapped bytes of a data stream file compared to copied
+ * string fields
+ *
+ * Copyright 2017 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <babeltrace/babeltrace.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/common-internal.h>
+#include <babeltrace/compiler-internal.h>
+#include <babeltrace/object-internal.h>
+#include <babeltrace/ctf-ir/fields-internal.h>
+#include <babeltrace/compat/memstream-internal.h>
+#include <ctf/common/metadata/decoder.h>
+#include <ctf/common/notif-iter/notif-iter.h>
+#include <ctf/fs-src/fs.h>
+#include <ctf/fs-src/data-stream-file.h>
+#include "tap/tap.h"
+
+#define NR_TESTS	11
+
+/* Number of packets of the data stream file */
+#define NR_PACKETS	4
+
+/* Size of the packet context (bytes): see `metadata_text` */
+#define PACKET_CONTEXT_SIZE	16
+
+static const char metadata_text[] =
+	"/* CTF 1.8 */\n"
+	"typealias integer { size = 8; align = 8; signed = false; } := uint8_t;\n"
+	"typealias integer { size = 64; align = 8; signed = false; } := uint64_t;\n"
+	"trace {\n"
+	"	major = 1;\n"
+	"	minor = 8;\n"
+	"	byte_order = le;\n"
+	"};\n"
+	"stream {\n"
+	"	packet.context := struct {\n"
+	"		uint64_t packet_size;\n"
+	"		uint64_t content_size;\n"
+	"	};\n"
+	"	event.header := struct { uint8_t id; };\n"
+	"};\n"
+	"event {\n"
+	"	name = \"str\";\n"
+	"	id = 0;\n"
+	"	fields := struct { string s; };\n"
+	"};\n";
+
+/* Decoded string values and how they were decoded */
+struct decoded_strings {
+	/* Array of struct bt_notification * (owned by this) */
+	GPtrArray *notifs;
+
+	/* Array of struct bt_field * (string fields, owned by this) */
+	GPtrArray *fields;
+
+	unsigned int external_count;
+	unsigned int copied_count;
+};
+
+static
+void write_le_uint64(uint8_t *buf, uint64_t value)
+{
+	unsigned int i;
+
+	for (i = 0; i < 8; i++) {
+		buf[i] = (uint8_t) (value >> (i * 8));
+	}
+}
+
+/*
+ * Writes a data stream file of `NR_PACKETS` packets of which the size
+ * is two pages, appending the string value of each event to
+ * `expected`.
+ *
+ * The test maps one page of the file at a time: in each packet, one
+ * string crosses the boundary between the two pages, so that it cannot
+ * reference the bytes of a single mapping.
+ */
+static
+int write_data_stream_file(const char *path, size_t packet_len,
+		GPtrArray *expected)
+{
+	const size_t boundary = packet_len / 2;
+	uint8_t *packet = NULL;
+	FILE *fp = NULL;
+	unsigned int str_index = 0;
+	unsigned int i;
+	int ret = 0;
+
+	packet = g_new0(uint8_t, packet_len);
+	fp = fopen(path, "wb");
+	if (!packet || !fp) {
+		ret = -1;
+		goto end;
+	}
+
+	for (i = 0; i < NR_PACKETS; i++) {
+		size_t pos = PACKET_CONTEXT_SIZE;
+		bool crossed = false;
+
+		memset(packet, 0, packet_len);
+
+		while (true) {
+			size_t len = (str_index * 37) % 311;
+			size_t end;
+			GString *str;
+
+			/*
+			 * Make sure that an event does not end exactly
+			 * before the boundary, as the string which
+			 * crosses it would then start at the boundary.
+			 */
+			end = pos + 1 + len + 1;
+			if (!crossed && (end == boundary - 1 ||
+					end == boundary)) {
+				len += 2;
+				end += 2;
+			}
+
+			if (end > packet_len) {
+				break;
+			}
+
+			if (pos + 1 < boundary && end > boundary) {
+				crossed = true;
+			}
+
+			str = g_string_sized_new(len);
+			g_string_printf(str, "%u:", str_index);
+			while (str->len < len) {
+				g_string_append_c(str,
+					'a' + (str->len + str_index) % 26);
+			}
+
+			g_string_truncate(str, len);
+
+			/* Event header (ID) and payload */
+			packet[pos] = 0;
+			memcpy(&packet[pos + 1], str->str, len + 1);
+			g_ptr_array_add(expected, g_string_free(str, FALSE));
+			pos = end;
+			str_index++;
+		}
+
+		if (!crossed) {
+			diag("No string crosses the middle of packet %u", i);
+			ret = -1;
+			goto end;
+		}
+
+		write_le_uint64(&packet[0], (uint64_t) packet_len * 8);
+		write_le_uint64(&packet[8], (uint64_t) pos * 8);
+
+		if (fwrite(packet, packet_len, 1, fp) != 1) {
+			ret = -1;
+			goto end;
+		}
+	}
+
+end:
+	if (fp && fclose(fp)) {
+		ret = -1;
+	}
+
+	g_free(packet);
+	return ret;
+}
+
+static
+struct bt_trace *decode_metadata(void)
+{
+	struct ctf_metadata_decoder *mdec;
+	struct bt_trace *trace = NULL;
+	FILE *fp;
+
+	mdec = ctf_metadata_decoder_create(NULL, "test");
+	if (!mdec) {
+		goto end;
+	}
+
+	fp = bt_fmemopen((void *) metadata_text, strlen(metadata_text),
+		"rb");
+	if (!fp) {
+		goto end;
+	}
+
+	if (ctf_metadata_decoder_decode(mdec, fp) ==
+			CTF_METADATA_DECODER_STATUS_OK) {
+		trace = ctf_metadata_decoder_get_trace(mdec);
+	}
+
+	fclose(fp);
+
+end:
+	ctf_metadata_decoder_destroy(mdec);
+	return trace;
+}
+
+static
+void init_decoded_strings(struct decoded_strings *decoded)
+{
+	memset(decoded, 0, sizeof(*decoded));
+	decoded->notifs = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) bt_put);
+	decoded->fields = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) bt_put);
+}
+
+static
+void fini_decoded_strings(struct decoded_strings *decoded)
+{
+	g_ptr_array_free(decoded->fields, TRUE);
+	g_ptr_array_free(decoded->notifs, TRUE);
+}
+
+static
+int add_decoded_string(struct decoded_strings *decoded,
+		struct bt_notification *notif)
+{
+	struct bt_event *event = NULL;
+	struct bt_field *payload = NULL;
+	struct bt_field *field = NULL;
+	struct bt_field_string *string;
+	int ret = 0;
+
+	event = bt_notification_event_get_event(notif);
+	payload = bt_event_get_event_payload(event);
+	field = bt_field_structure_get_field_by_name(payload, "s");
+	if (!field) {
+		ret = -1;
+		goto end;
+	}
+
+	string = container_of(field, struct bt_field_string, parent);
+	if (string->external_value) {
+		decoded->external_count++;
+	} else {
+		decoded->copied_count++;
+	}
+
+	/* Keep the notification, and thus its string, alive */
+	g_ptr_array_add(decoded->notifs, bt_get(notif));
+	g_ptr_array_add(decoded->fields, field);
+	field = NULL;
+
+end:
+	bt_put(field);
+	bt_put(payload);
+	bt_put(event);
+	return ret;
+}
+
+static
+bool decoded_strings_match(struct decoded_strings *decoded,
+		GPtrArray *expected)
+{
+	guint i;
+
+	if (decoded->fields->len != expected->len) {
+		diag("Unexpected string count: expected=%u, actual=%u",
+			expected->len, decoded->fields->len);
+		return false;
+	}
+
+	for (i = 0; i < expected->len; i++) {
+		const char *value = bt_field_string_get_value(
+			g_ptr_array_index(decoded->fields, i));
+
+		if (!value || strcmp(value, g_ptr_array_index(expected, i))) {
+			diag("Unexpected string value: index=%u", i);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Decodes all the string values of the data stream file at `path`,
+ * mapping one page at a time, with the medium operations `medops`.
+ *
+ * If `first_mapping` is not NULL, sets it to a new reference to the
+ * mapping of the first event.
+ */
+static
+int decode_strings(struct bt_trace *trace, const char *path,
+		struct bt_notif_iter_medium_ops medops,
+		struct decoded_strings *decoded,
+		struct ctf_fs_ds_file_mapping **first_mapping)
+{
+	struct ctf_fs_trace ctf_fs_trace;
+	struct bt_stream_class *stream_class = NULL;
+	struct bt_stream *stream = NULL;
+	struct bt_notif_iter *notit = NULL;
+	struct ctf_fs_ds_file *ds_file = NULL;
+	int ret = 0;
+
+	memset(&ctf_fs_trace, 0, sizeof(ctf_fs_trace));
+	ctf_fs_trace.cc_prio_map = bt_clock_class_priority_map_create();
+	stream_class = bt_trace_get_stream_class_by_index(trace, 0);
+	if (!ctf_fs_trace.cc_prio_map || !stream_class) {
+		ret = -1;
+		goto end;
+	}
+
+	stream = bt_stream_create(stream_class, "test");
+	notit = bt_notif_iter_create(trace, bt_common_get_page_size() * 8,
+		medops, NULL, NULL);
+	if (!stream || !notit) {
+		ret = -1;
+		goto end;
+	}
+
+	ds_file = ctf_fs_ds_file_create(&ctf_fs_trace, notit, stream, path);
+	if (!ds_file) {
+		ret = -1;
+		goto end;
+	}
+
+	ds_file->mmap_max_len = bt_common_get_page_size();
+
+	while (true) {
+		struct bt_notification_iterator_next_method_return next =
+			ctf_fs_ds_file_next(ds_file);
+
+		if (next.status == BT_NOTIFICATION_ITERATOR_STATUS_END) {
+			break;
+		} else if (next.status != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+			ret = -1;
+			goto end;
+		}
+
+		if (bt_notification_get_type(next.notification) ==
+				BT_NOTIFICATION_TYPE_EVENT) {
+			if (first_mapping && !*first_mapping) {
+				*first_mapping = bt_get(ds_file->mapping);
+			}
+
+			ret = add_decoded_string(decoded, next.notification);
+		}
+
+		bt_put(next.notification);
+		if (ret) {
+			goto end;
+		}
+	}
+
+end:
+	/* Unmaps the last region, unless a string field references it */
+	ctf_fs_ds_file_destroy(ds_file);
+
+	if (notit) {
+		bt_notif_iter_destroy(notit);
+	}
+
+	bt_put(stream);
+	bt_put(stream_class);
+	bt_put(ctf_fs_trace.cc_prio_map);
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	struct bt_trace *trace = NULL;
+	struct bt_notif_iter_medium_ops copy_medops;
+	struct decoded_strings decoded;
+	struct decoded_strings copied;
+	struct ctf_fs_ds_file_mapping *first_mapping = NULL;
+	GPtrArray *expected;
+	char path[] = "/tmp/test_ctf_fs_strings_XXXXXX";
+	int fd;
+	int ret;
+
+	plan_tests(NR_TESTS);
+
+	expected = g_ptr_array_new_with_free_func(g_free);
+	fd = mkstemp(path);
+	if (fd < 0) {
+		BAIL_OUT("Cannot create a temporary file");
+	}
+
+	close(fd);
+	ret = write_data_stream_file(path,
+		bt_common_get_page_size() * 2, expected);
+	if (ret) {
+		unlink(path);
+		BAIL_OUT("Cannot write the data stream file");
+	}
+
+	trace = decode_metadata();
+	ok(trace, "Metadata is decoded");
+	if (!trace) {
+		unlink(path);
+		BAIL_OUT("Cannot decode the metadata");
+	}
+
+	/* Strings referencing the mapped bytes when possible */
+	init_decoded_strings(&decoded);
+	ret = decode_strings(trace, path, ctf_fs_ds_file_medops, &decoded,
+		&first_mapping);
+	ok(ret == 0, "Data stream file is decoded with a buffer owner");
+	ok(decoded.external_count > 0,
+		"String fields reference the bytes of the mappings");
+	ok(decoded.copied_count >= NR_PACKETS,
+		"String fields crossing two mappings are copied");
+	ok(first_mapping && bt_object_get_ref_count(first_mapping) > 1,
+		"String fields keep a reference on their mapping");
+	ok(decoded_strings_match(&decoded, expected),
+		"String values are valid after the data stream file releases its mappings");
+
+	/* Same strings, always copied */
+	copy_medops = ctf_fs_ds_file_medops;
+	copy_medops.borrow_buffer_owner = NULL;
+	init_decoded_strings(&copied);
+	ret = decode_strings(trace, path, copy_medops, &copied, NULL);
+	ok(ret == 0, "Data stream file is decoded without a buffer owner");
+	ok(copied.external_count == 0 &&
+		copied.copied_count == expected->len,
+		"String fields are copied without a buffer owner");
+	ok(decoded_strings_match(&copied, expected),
+		"Copied string values are the same as the referencing ones");
+	fini_decoded_strings(&copied);
+
+	/*
+	 * Releasing the events recycles them into their class's pool:
+	 * their string fields must release the mappings.
+	 */
+	g_ptr_array_set_size(decoded.fields, 0);
+	ok(first_mapping && bt_object_get_ref_count(first_mapping) > 1,
+		"Events keep a reference on the mapping of their strings");
+	g_ptr_array_set_size(decoded.notifs, 0);
+	ok(first_mapping && bt_object_get_ref_count(first_mapping) == 1,
+		"Recycled events release the mapping of their strings");
+	fini_decoded_strings(&decoded);
+
+	bt_put(first_mapping);
+	bt_put(trace);
+	g_ptr_array_free(expected, TRUE);
+	unlink(path);
+	return exit_status();
+}
@@ -0,0 +1,237 @@
+/*
+ * test_ctf_metadata_decoder.c
+ *
+ * Babeltrace CTF metadata decoder tests: incremental decoding of
+ * metadata chunks, as received from an LTTng relay daemon
+ *
+ * Copyright 2017 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <glib.h>
+#include <babeltrace/babeltrace.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/compat/memstream-internal.h>
+#include <ctf/common/metadata/decoder.h>
+#include "tap/tap.h"
+
+#define NR_TESTS	19
+
+static const char first_chunk[] =
+	"/* CTF 1.8 */\n"
+	"typealias integer { size = 8; align = 8; signed = false; } := uint8_t;\n"
+	"typealias integer { size = 32; align = 8; signed = false; } := uint32_t;\n"
+	"trace {\n"
+	"	major = 1;\n"
+	"	minor = 8;\n"
+	"	byte_order = le;\n"
+	"	packet.header := struct { uint32_t magic; uint32_t stream_id; };\n"
+	"};\n"
+	"stream {\n"
+	"	id = 0;\n"
+	"	event.header := struct { uint32_t id; };\n"
+	"};\n"
+	"event {\n"
+	"	name = \"first\";\n"
+	"	id = 0;\n"
+	"	stream_id = 0;\n"
+	"	fields := struct { uint8_t a; };\n"
+	"};\n";
+
+/* Uses the type aliases of the first chunk. */
+static const char second_chunk[] =
+	"event {\n"
+	"	name = \"second\";\n"
+	"	id = 1;\n"
+	"	stream_id = 0;\n"
+	"	fields := struct { uint32_t b; };\n"
+	"};\n";
+
+/* Stops within a structure field type's scope. */
+static const char third_chunk_begin[] =
+	"event {\n"
+	"	name = \"third\";\n"
+	"	id = 2;\n"
+	"	stream_id = 0;\n"
+	"	fields := struct { uint8_t";
+
+static const char third_chunk_end[] =
+	" c; };\n"
+	"};\n";
+
+/* Stops within a string literal. */
+static const char fourth_chunk_begin[] =
+	"event {\n"
+	"	name = \"fou";
+
+static const char fourth_chunk_end[] =
+	"rth\";\n"
+	"	id = 3;\n"
+	"	stream_id = 0;\n"
+	"	fields := struct { uint8_t d; };\n"
+	"};\n";
+
+/* Stops within a single-line comment. */
+static const char fifth_chunk_begin[] =
+	"// Fifth event";
+
+static const char fifth_chunk_end[] =
+	" class\n"
+	"event {\n"
+	"	name = \"fifth\";\n"
+	"	id = 4;\n"
+	"	stream_id = 0;\n"
+	"	fields := struct { uint8_t e; };\n"
+	"};\n";
+
+/* Stops within a hexadecimal constant's prefix. */
+static const char sixth_chunk_begin[] =
+	"event {\n"
+	"	name = \"sixth\";\n"
+	"	id = 0x";
+
+static const char sixth_chunk_end[] =
+	"5;\n"
+	"	stream_id = 0;\n"
+	"	fields := struct { uint8_t f; };\n"
+	"};\n";
+
+/* Syntax error before the end of the chunk: more text cannot fix it. */
+static const char invalid_chunk[] =
+	"event {\n"
+	"	name = \"seventh\";\n"
+	"	id = 6 7;\n"
+	"	stream_id = 0;\n"
+	"	fields := struct { uint8_t g; };\n"
+	"};\n";
+
+static
+enum ctf_metadata_decoder_status decode(struct ctf_metadata_decoder *mdec,
+		const char *text)
+{
+	enum ctf_metadata_decoder_status status;
+	FILE *fp;
+
+	fp = bt_fmemopen((void *) text, strlen(text), "rb");
+	if (!fp) {
+		diag("Cannot memory-open metadata chunk");
+		return CTF_METADATA_DECODER_STATUS_ERROR;
+	}
+
+	status = ctf_metadata_decoder_decode(mdec, fp);
+	fclose(fp);
+	return status;
+}
+
+static
+int64_t get_event_class_count(struct bt_trace *trace)
+{
+	struct bt_stream_class *stream_class;
+	int64_t count;
+
+	stream_class = bt_trace_get_stream_class_by_index(trace, 0);
+	if (!stream_class) {
+		return -1;
+	}
+
+	count = bt_stream_class_get_event_class_count(stream_class);
+	bt_put(stream_class);
+	return count;
+}
+
+/*
+ * Decodes a chunk which is cut within a token, and then the whole
+ * chunk, as lttng_live_metadata_update() does.
+ */
+static
+void test_cut_chunk(struct ctf_metadata_decoder *mdec,
+		struct bt_trace *trace, const char *begin, const char *end,
+		int64_t expected_count, const char *desc)
+{
+	char *chunk;
+
+	ok(decode(mdec, begin) == CTF_METADATA_DECODER_STATUS_INCOMPLETE,
+		"Chunk cut within %s is reported as incomplete", desc);
+
+	chunk = g_strconcat(begin, end, NULL);
+	ok(decode(mdec, chunk) == CTF_METADATA_DECODER_STATUS_OK,
+		"Chunk cut within %s is decoded once completed", desc);
+	g_free(chunk);
+	ok(get_event_class_count(trace) == expected_count,
+		"Event class of the chunk cut within %s is added once", desc);
+}
+
+int main(int argc, char **argv)
+{
+	struct ctf_metadata_decoder *mdec;
+	struct bt_trace *trace = NULL;
+	struct bt_trace *trace2 = NULL;
+	char *third_chunk;
+
+	plan_tests(NR_TESTS);
+
+	mdec = ctf_metadata_decoder_create(NULL, "test");
+	if (!mdec) {
+		BAIL_OUT("Cannot create CTF metadata decoder");
+	}
+
+	ok(decode(mdec, first_chunk) == CTF_METADATA_DECODER_STATUS_OK,
+		"First metadata chunk is decoded");
+	trace = ctf_metadata_decoder_get_trace(mdec);
+	ok(trace && bt_trace_get_stream_class_count(trace) == 1 &&
+		get_event_class_count(trace) == 1,
+		"Trace has one stream class with one event class");
+
+	ok(decode(mdec, second_chunk) == CTF_METADATA_DECODER_STATUS_OK,
+		"Chunk using type aliases of a previous chunk is decoded");
+	trace2 = ctf_metadata_decoder_get_trace(mdec);
+	ok(trace2 == trace,
+		"Decoder's trace is the same object after a new chunk");
+	ok(get_event_class_count(trace) == 2,
+		"New event class is added to the existing stream class");
+
+	ok(decode(mdec, third_chunk_begin) ==
+		CTF_METADATA_DECODER_STATUS_INCOMPLETE,
+		"Incomplete chunk is reported as such");
+
+	third_chunk = g_strconcat(third_chunk_begin, third_chunk_end, NULL);
+	ok(decode(mdec, third_chunk) == CTF_METADATA_DECODER_STATUS_OK,
+		"Completed chunk is decoded");
+	g_free(third_chunk);
+	ok(get_event_class_count(trace) == 3,
+		"Event class of the completed chunk is added once");
+
+	test_cut_chunk(mdec, trace, fourth_chunk_begin, fourth_chunk_end,
+		4, "a string literal");
+	test_cut_chunk(mdec, trace, fifth_chunk_begin, fifth_chunk_end,
+		5, "a single-line comment");
+	test_cut_chunk(mdec, trace, sixth_chunk_begin, sixth_chunk_end,
+		6, "a hexadecimal constant");
+
+	ok(decode(mdec, invalid_chunk) == CTF_METADATA_DECODER_STATUS_ERROR,
+		"Chunk with a syntax error is reported as an error, not as incomplete");
+	ok(get_event_class_count(trace) == 6,
+		"Invalid chunk adds no event class");
+
+	bt_put(trace2);
+	bt_put(trace);
+	ctf_metadata_decoder_destroy(mdec);
+	return exit_status();
+}
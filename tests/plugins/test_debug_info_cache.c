@@ -0,0 +1,225 @@
+/*
+ * test_debug_info_cache.c
+ *
+ * Babeltrace debug info symbolization cache tests
+ *
+ * Copyright (c) 2017 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <lttng-utils/bin-info.h>
+#include <lttng-utils/debug-info.h>
+#include <lttng-utils/debug-info-cache.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 26
+#define SO_NAME "libhello_so"
+#define SO_NAME_BUILD_ID "libhello_build_id_so"
+#define SO_LOW_ADDR 0x400000
+#define SO_MEMSZ 0x400000
+#define FUNC_FOO_ADDR 0x4014ee
+#define FUNC_FOO_NAME "foo+0xc3"
+#define FUNC_FOO_ADDR_2 0x4014ed
+#define FUNC_FOO_NAME_2 "foo+0xc2"
+#define BUILD_ID_LEN 20
+#define CACHE_SIZE 2
+
+static
+bool check_stats(struct debug_info_cache_stats *stats, uint64_t hits,
+		uint64_t misses, uint64_t evictions)
+{
+	if (stats->hits != hits || stats->misses != misses ||
+			stats->evictions != evictions) {
+		diag("Unexpected cache counters: hits=%" PRIu64 ", "
+			"misses=%" PRIu64 ", evictions=%" PRIu64,
+			stats->hits, stats->misses, stats->evictions);
+		return false;
+	}
+
+	return true;
+}
+
+static
+bool check_source(struct debug_info_source *src, const char *func,
+		const char *bin_path)
+{
+	return src && src->func && strcmp(src->func, func) == 0 &&
+		src->bin_path && strcmp(src->bin_path, bin_path) == 0;
+}
+
+static
+struct bin_info *create_bin_info(const char *path, const char *data_dir,
+		bool with_build_id)
+{
+	struct bin_info *bin;
+	uint8_t build_id[BUILD_ID_LEN] = {
+		0xcd, 0xd9, 0x8c, 0xdd, 0x87, 0xf7, 0xfe, 0x64, 0xc1, 0x3b,
+		0x6d, 0xaa, 0xd5, 0x53, 0x98, 0x7e, 0xaf, 0xd4, 0x0c, 0xbb
+	};
+
+	bin = bin_info_create(path, SO_LOW_ADDR, SO_MEMSZ, true, data_dir,
+		NULL);
+	if (!bin) {
+		return NULL;
+	}
+
+	if (with_build_id &&
+			bin_info_set_build_id(bin, build_id, BUILD_ID_LEN)) {
+		bin_info_destroy(bin);
+		return NULL;
+	}
+
+	return bin;
+}
+
+static
+void test_debug_info_cache(const char *data_dir)
+{
+	char path[PATH_MAX];
+	char other_path[PATH_MAX];
+	char no_build_id_path[PATH_MAX];
+	struct debug_info_cache_stats stats = { 0 };
+	struct debug_info_cache *cache;
+	struct debug_info_source *src;
+	struct debug_info_source *first_src;
+	struct bin_info *bin = NULL;
+	struct bin_info *other_bin = NULL;
+	struct bin_info *no_build_id_bin = NULL;
+
+	diag("debug-info cache tests");
+
+	snprintf(path, PATH_MAX, "%s/%s", data_dir, SO_NAME_BUILD_ID);
+
+	/* Same binary and build ID, found at another path */
+	snprintf(other_path, PATH_MAX, "%s/./%s", data_dir, SO_NAME_BUILD_ID);
+	snprintf(no_build_id_path, PATH_MAX, "%s/%s", data_dir, SO_NAME);
+
+	bin = create_bin_info(path, data_dir, true);
+	other_bin = create_bin_info(other_path, data_dir, true);
+	no_build_id_bin = create_bin_info(no_build_id_path, data_dir, false);
+	if (!bin || !other_bin || !no_build_id_bin) {
+		BAIL_OUT("Cannot create the bin info objects");
+	}
+
+	cache = debug_info_cache_create(CACHE_SIZE, &stats);
+	ok(cache, "debug_info_cache_create successful");
+	if (!cache) {
+		BAIL_OUT("Cannot create the cache");
+	}
+
+	/* Miss, then hit */
+	first_src = debug_info_cache_get_source(cache, bin, FUNC_FOO_ADDR);
+	ok(check_source(first_src, FUNC_FOO_NAME, path),
+		"First lookup returns the debug info source of the address");
+	ok(check_stats(&stats, 0, 1, 0), "First lookup is a miss");
+
+	src = debug_info_cache_get_source(cache, bin, FUNC_FOO_ADDR);
+	ok(src == first_src, "Second lookup returns the cached debug info source");
+	ok(check_stats(&stats, 1, 1, 0), "Second lookup is a hit");
+	ok(debug_info_cache_get_entry_count(cache) == 1,
+		"Cache contains one entry");
+
+	/* Same build ID and offset, other path */
+	src = debug_info_cache_get_source(cache, other_bin, FUNC_FOO_ADDR);
+	ok(check_source(src, FUNC_FOO_NAME, other_path),
+		"Lookup within a binary at another path returns this path");
+	ok(check_stats(&stats, 1, 2, 0),
+		"Lookup within a binary at another path is a miss");
+	ok(debug_info_cache_get_entry_count(cache) == 2,
+		"Cache contains two entries");
+
+	/*
+	 * The cache is full: a new entry evicts the least recently used
+	 * one, that is, the first one.
+	 */
+	src = debug_info_cache_get_source(cache, bin, FUNC_FOO_ADDR_2);
+	ok(check_source(src, FUNC_FOO_NAME_2, path),
+		"Lookup of another address returns its debug info source");
+	ok(check_stats(&stats, 1, 3, 1),
+		"Lookup of another address in a full cache evicts an entry");
+	ok(debug_info_cache_get_entry_count(cache) == CACHE_SIZE,
+		"Cache does not contain more entries than its size");
+
+	src = debug_info_cache_get_source(cache, other_bin, FUNC_FOO_ADDR);
+	ok(check_source(src, FUNC_FOO_NAME, other_path),
+		"Lookup of a more recently used entry returns its debug info source");
+	ok(check_stats(&stats, 2, 3, 1),
+		"More recently used entry is not evicted");
+
+	src = debug_info_cache_get_source(cache, bin, FUNC_FOO_ADDR);
+	ok(check_source(src, FUNC_FOO_NAME, path),
+		"Lookup of an evicted entry returns its debug info source");
+	ok(check_stats(&stats, 2, 4, 2),
+		"Least recently used entry was evicted");
+	src = debug_info_cache_get_source(cache, other_bin, FUNC_FOO_ADDR);
+	ok(check_stats(&stats, 3, 4, 2),
+		"Entry used before the last eviction is not evicted");
+	ok(debug_info_cache_get_entry_count(cache) == CACHE_SIZE,
+		"Cache still contains as many entries as its size");
+
+	/* Binary without a build ID: keyed on its path, size, and mtime */
+	src = debug_info_cache_get_source(cache, no_build_id_bin,
+		FUNC_FOO_ADDR);
+	ok(check_source(src, FUNC_FOO_NAME, no_build_id_path),
+		"Lookup within a binary without a build ID returns its debug info source");
+	ok(check_stats(&stats, 3, 5, 3),
+		"First lookup within a binary without a build ID is a miss");
+	first_src = src;
+	src = debug_info_cache_get_source(cache, no_build_id_bin,
+		FUNC_FOO_ADDR);
+	ok(src == first_src,
+		"Lookup within a binary without a build ID returns the cached debug info source");
+	ok(check_stats(&stats, 4, 5, 3),
+		"Second lookup within a binary without a build ID is a hit");
+	ok(no_build_id_bin->has_file_stat,
+		"Binary without a build ID is identified by its file");
+
+	/* Same path, but the file changed since it was cached */
+	no_build_id_bin->file_mtime_ns++;
+	src = debug_info_cache_get_source(cache, no_build_id_bin,
+		FUNC_FOO_ADDR);
+	ok(check_source(src, FUNC_FOO_NAME, no_build_id_path),
+		"Lookup within a modified binary returns its debug info source");
+	ok(check_stats(&stats, 4, 6, 4),
+		"Lookup within a modified binary without a build ID is a miss");
+
+	debug_info_cache_destroy(cache);
+	bin_info_destroy(no_build_id_bin);
+	bin_info_destroy(other_bin);
+	bin_info_destroy(bin);
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+
+	plan_tests(NR_TESTS);
+
+	if (argc != 2) {
+		return EXIT_FAILURE;
+	}
+
+	ret = bin_info_init();
+	ok(ret == 0, "bin_info_init successful");
+
+	test_debug_info_cache(argv[1]);
+
+	return EXIT_SUCCESS;
+}
@@ -28,7 +28,7 @@
 #include <lttng-utils/dwarf.h>
 #include "tap/tap.h"
 
-#define NR_TESTS 15
+#define NR_TESTS 20
 
 static
 void test_bt_dwarf(const char *data_dir)
@@ -36,8 +36,11 @@ void test_bt_dwarf(const char *data_dir)
 	int fd, ret, tag;
 	char path[PATH_MAX];
 	char *die_name = NULL;
+	char *die_name_at_offset = NULL;
 	struct bt_dwarf_cu *cu = NULL;
+	struct bt_dwarf_cu *cu_at_offset = NULL;
 	struct bt_dwarf_die *die = NULL;
+	struct bt_dwarf_die *die_at_offset = NULL;
 	Dwarf *dwarf_info = NULL;
 
 	snprintf(path, PATH_MAX, "%s/libhello_so", data_dir);
@@ -92,6 +95,34 @@ void test_bt_dwarf(const char *data_dir)
 	ok(strcmp(die_name, "size_t") == 0,
 		"bt_dwarf_die_get_name - correct name value");
 
+	/* Access the same CU and DIE directly from their offsets */
+	cu_at_offset = bt_dwarf_cu_create(dwarf_info);
+	if (!cu_at_offset) {
+		diag("Failed to create bt_dwarf_cu");
+		exit(EXIT_FAILURE);
+	}
+
+	ret = bt_dwarf_cu_set_offset(cu_at_offset, cu->offset);
+	ok(ret == 0, "bt_dwarf_cu_set_offset successful");
+	ok(cu_at_offset->next_offset == cu->next_offset &&
+		cu_at_offset->header_size == cu->header_size,
+		"bt_dwarf_cu_set_offset - correct CU values");
+	die_at_offset = bt_dwarf_die_create_at_offset(cu_at_offset,
+		dwarf_dieoffset(die->dwarf_die));
+	ok(die_at_offset != NULL, "bt_dwarf_die_create_at_offset successful");
+	if (!die_at_offset) {
+		exit(EXIT_FAILURE);
+	}
+
+	ok(die_at_offset->depth == 1,
+		"bt_dwarf_die_create_at_offset - correct depth value");
+	ret = bt_dwarf_die_get_name(die_at_offset, &die_name_at_offset);
+	ok(ret == 0 && strcmp(die_name_at_offset, "size_t") == 0,
+		"bt_dwarf_die_create_at_offset - correct DIE");
+
+	bt_dwarf_die_destroy(die_at_offset);
+	bt_dwarf_cu_destroy(cu_at_offset);
+	free(die_name_at_offset);
 	bt_dwarf_die_destroy(die);
 	bt_dwarf_cu_destroy(cu);
 	dwarf_end(dwarf_info);
@@ -0,0 +1,500 @@
+/*
+ * test_lttng_live_viewer.c
+ *
+ * Babeltrace LTTng live viewer connection tests, against a mock relay
+ * daemon
+ *
+ * Copyright 2017 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <glib.h>
+#include <babeltrace/endian-internal.h>
+#include <ctf/lttng-live/lttng-live-internal.h>
+#include <ctf/lttng-live/lttng-viewer-abi.h>
+#include "tap/tap.h"
+
+#define NR_TESTS		12
+
+#define CHUNK_SIZE		4096
+#define PACKET_SIZE		(4 * CHUNK_SIZE)
+#define NR_STREAMS		2
+
+/* Time the mock relay daemon waits for more commands before replying. */
+#define MOCK_BATCH_TIMEOUT_MS	100
+
+struct mock_cmd {
+	uint32_t cmd;
+	union {
+		struct lttng_viewer_connect connect;
+		struct lttng_viewer_get_packet get_packet;
+		struct lttng_viewer_get_next_index get_next_index;
+	} u;
+};
+
+struct mock_relayd {
+	int listen_fd;
+	int port;
+	GThread *thread;
+
+	/* Number of GET_NEXT_INDEX commands received for each stream. */
+	unsigned int nr_get_next_index[NR_STREAMS];
+	/* Maximum number of GET_PACKET commands received before replying. */
+	unsigned int max_batched_get_packet;
+	unsigned int nr_errors;
+};
+
+static
+uint8_t stream_byte(uint64_t stream_id, uint64_t offset)
+{
+	return (uint8_t) (stream_id * 31 + offset);
+}
+
+static
+int recv_all(int fd, void *buf, size_t len)
+{
+	size_t copied = 0;
+
+	while (copied < len) {
+		ssize_t ret = recv(fd, (char *) buf + copied,
+			len - copied, 0);
+
+		if (ret <= 0) {
+			return -1;
+		}
+		copied += ret;
+	}
+
+	return 0;
+}
+
+static
+int send_all(int fd, const void *buf, size_t len)
+{
+	size_t sent = 0;
+
+	while (sent < len) {
+		ssize_t ret = send(fd, (const char *) buf + sent,
+			len - sent, 0);
+
+		if (ret <= 0) {
+			return -1;
+		}
+		sent += ret;
+	}
+
+	return 0;
+}
+
+static
+int mock_recv_cmd(struct mock_relayd *relayd, int fd, struct mock_cmd *cmd)
+{
+	struct lttng_viewer_cmd hdr;
+	uint64_t data_size;
+
+	if (recv_all(fd, &hdr, sizeof(hdr))) {
+		return -1;
+	}
+
+	cmd->cmd = be32toh(hdr.cmd);
+	data_size = be64toh(hdr.data_size);
+	if (data_size > sizeof(cmd->u)) {
+		relayd->nr_errors++;
+		return -1;
+	}
+
+	return recv_all(fd, &cmd->u, data_size);
+}
+
+static
+int mock_reply(struct mock_relayd *relayd, int fd, struct mock_cmd *cmd)
+{
+	switch (cmd->cmd) {
+	case LTTNG_VIEWER_CONNECT:
+	{
+		struct lttng_viewer_connect rp;
+
+		memset(&rp, 0, sizeof(rp));
+		rp.viewer_session_id = htobe64(1);
+		rp.major = htobe32(LTTNG_LIVE_MAJOR);
+		rp.minor = htobe32(LTTNG_LIVE_MINOR);
+		return send_all(fd, &rp, sizeof(rp));
+	}
+	case LTTNG_VIEWER_GET_PACKET:
+	{
+		struct lttng_viewer_trace_packet rp;
+		uint64_t stream_id = be64toh(cmd->u.get_packet.stream_id);
+		uint64_t offset = be64toh(cmd->u.get_packet.offset);
+		uint32_t len = be32toh(cmd->u.get_packet.len);
+		uint8_t data[CHUNK_SIZE];
+		uint32_t i;
+
+		if (len > CHUNK_SIZE) {
+			relayd->nr_errors++;
+			return -1;
+		}
+
+		for (i = 0; i < len; i++) {
+			data[i] = stream_byte(stream_id, offset + i);
+		}
+
+		memset(&rp, 0, sizeof(rp));
+		rp.status = htobe32(LTTNG_VIEWER_GET_PACKET_OK);
+		rp.len = htobe32(len);
+		if (send_all(fd, &rp, sizeof(rp))) {
+			return -1;
+		}
+		return send_all(fd, data, len);
+	}
+	case LTTNG_VIEWER_GET_NEXT_INDEX:
+	{
+		struct lttng_viewer_index rp;
+		uint64_t stream_id = be64toh(cmd->u.get_next_index.stream_id);
+
+		if (stream_id >= NR_STREAMS) {
+			relayd->nr_errors++;
+			return -1;
+		}
+
+		/* One more packet, then the stream hangs up. */
+		memset(&rp, 0, sizeof(rp));
+		if (relayd->nr_get_next_index[stream_id]++ == 0) {
+			rp.status = htobe32(LTTNG_VIEWER_INDEX_OK);
+			rp.offset = htobe64(PACKET_SIZE);
+			rp.packet_size = htobe64(PACKET_SIZE * CHAR_BIT);
+			rp.content_size = htobe64(PACKET_SIZE * CHAR_BIT);
+		} else {
+			rp.status = htobe32(LTTNG_VIEWER_INDEX_HUP);
+		}
+		return send_all(fd, &rp, sizeof(rp));
+	}
+	default:
+		relayd->nr_errors++;
+		return -1;
+	}
+}
+
+/*
+ * Receives the commands which the viewer sends within
+ * MOCK_BATCH_TIMEOUT_MS of each other, and then replies to them in
+ * order, like a relay daemon behind a slow link would.
+ */
+static
+gpointer mock_relayd_thread(gpointer data)
+{
+	struct mock_relayd *relayd = data;
+	GArray *cmds = g_array_new(FALSE, TRUE, sizeof(struct mock_cmd));
+	int fd;
+
+	fd = accept(relayd->listen_fd, NULL, NULL);
+	if (fd < 0) {
+		relayd->nr_errors++;
+		goto end;
+	}
+
+	for (;;) {
+		struct pollfd pfd = { .fd = fd, .events = POLLIN };
+		unsigned int nr_get_packet = 0;
+		struct mock_cmd cmd;
+		guint i;
+
+		if (mock_recv_cmd(relayd, fd, &cmd)) {
+			/* Viewer is gone. */
+			break;
+		}
+		g_array_append_val(cmds, cmd);
+
+		if (poll(&pfd, 1, MOCK_BATCH_TIMEOUT_MS) > 0) {
+			continue;
+		}
+
+		for (i = 0; i < cmds->len; i++) {
+			struct mock_cmd *batched_cmd =
+				&g_array_index(cmds, struct mock_cmd, i);
+
+			if (batched_cmd->cmd == LTTNG_VIEWER_GET_PACKET) {
+				nr_get_packet++;
+			}
+			if (mock_reply(relayd, fd, batched_cmd)) {
+				goto close;
+			}
+		}
+
+		relayd->max_batched_get_packet = MAX(
+			relayd->max_batched_get_packet, nr_get_packet);
+		g_array_set_size(cmds, 0);
+	}
+
+close:
+	close(fd);
+end:
+	g_array_free(cmds, TRUE);
+	return NULL;
+}
+
+static
+int mock_relayd_start(struct mock_relayd *relayd)
+{
+	struct sockaddr_in addr;
+	socklen_t addr_len = sizeof(addr);
+
+	memset(relayd, 0, sizeof(*relayd));
+	relayd->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (relayd->listen_fd < 0) {
+		return -1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	if (bind(relayd->listen_fd, (struct sockaddr *) &addr, sizeof(addr)) ||
+			listen(relayd->listen_fd, 1) ||
+			getsockname(relayd->listen_fd,
+				(struct sockaddr *) &addr, &addr_len)) {
+		close(relayd->listen_fd);
+		return -1;
+	}
+
+	relayd->port = ntohs(addr.sin_port);
+	relayd->thread = g_thread_new("mock-relayd", mock_relayd_thread,
+		relayd);
+	return 0;
+}
+
+static
+void mock_relayd_join(struct mock_relayd *relayd)
+{
+	g_thread_join(relayd->thread);
+	close(relayd->listen_fd);
+}
+
+static
+struct lttng_live_stream_iterator *create_stream(
+		struct lttng_live_trace *trace, uint64_t stream_id)
+{
+	struct lttng_live_stream_iterator *stream =
+		g_new0(struct lttng_live_stream_iterator, 1);
+
+	stream->trace = trace;
+	stream->viewer_stream_id = stream_id;
+	stream->ctf_stream_class_id = -1ULL;
+	stream->state = LTTNG_LIVE_STREAM_ACTIVE_DATA;
+	stream->len = PACKET_SIZE;
+	stream->buf = g_new0(uint8_t, CHUNK_SIZE);
+	stream->buflen = CHUNK_SIZE;
+	stream->prefetched_packets = g_queue_new();
+	return stream;
+}
+
+static
+void destroy_stream(struct lttng_live_component *lttng_live,
+		struct lttng_live_stream_iterator *stream)
+{
+	lttng_live_cancel_stream_requests(lttng_live->viewer_connection,
+		stream);
+	g_queue_free(stream->prefetched_packets);
+	g_free(stream->buf);
+	g_free(stream);
+}
+
+/* Number of data requests which returned before their reply was received. */
+static unsigned int nr_data_again;
+
+/* Waits until the viewer connection's socket is readable. */
+static
+bool wait_readable(struct lttng_live_component *lttng_live)
+{
+	struct pollfd pfd = {
+		.fd = lttng_live->viewer_connection->control_sock,
+		.events = POLLIN,
+	};
+
+	return poll(&pfd, 1, 5000) == 1;
+}
+
+/*
+ * Reads up to `len` bytes of the current packet of `stream`, like the
+ * notification iterator's medium does, and checks their values.
+ */
+static
+bool read_stream(struct lttng_live_component *lttng_live,
+		struct lttng_live_stream_iterator *stream, uint64_t len)
+{
+	uint64_t end = MIN(stream->offset + len,
+		stream->base_offset + stream->len);
+
+	while (stream->offset < end) {
+		enum bt_notif_iter_medium_status status;
+		uint64_t recv_len = 0;
+		uint64_t i;
+
+		status = lttng_live_get_stream_bytes(lttng_live, stream,
+			stream->buf, stream->offset,
+			MIN(stream->buflen, end - stream->offset), &recv_len);
+		if (status == BT_NOTIF_ITER_MEDIUM_STATUS_AGAIN &&
+				stream->waiting_for_data) {
+			stream->waiting_for_data = false;
+			nr_data_again++;
+			if (!wait_readable(lttng_live)) {
+				diag("Timeout waiting for stream bytes");
+				return false;
+			}
+			continue;
+		}
+		if (status != BT_NOTIF_ITER_MEDIUM_STATUS_OK || !recv_len) {
+			diag("Cannot get stream bytes: status=%d", status);
+			return false;
+		}
+
+		for (i = 0; i < recv_len; i++) {
+			if (stream->buf[i] != stream_byte(
+					stream->viewer_stream_id,
+					stream->offset + i)) {
+				diag("Unexpected byte at offset %" PRIu64,
+					stream->offset + i);
+				return false;
+			}
+		}
+		stream->offset += recv_len;
+	}
+
+	return true;
+}
+
+static
+enum bt_lttng_live_iterator_status get_next_index(
+		struct lttng_live_component *lttng_live,
+		struct lttng_live_stream_iterator *stream,
+		struct packet_index *index)
+{
+	enum bt_lttng_live_iterator_status status;
+
+	for (;;) {
+		status = lttng_live_get_next_index(lttng_live, stream, index);
+		if (status != BT_LTTNG_LIVE_ITERATOR_STATUS_AGAIN) {
+			break;
+		}
+		if (!wait_readable(lttng_live)) {
+			diag("Timeout waiting for next index");
+			break;
+		}
+	}
+
+	return status;
+}
+
+static
+bool next_index(struct lttng_live_component *lttng_live,
+		struct lttng_live_stream_iterator *stream)
+{
+	enum bt_lttng_live_iterator_status status;
+	struct packet_index index;
+
+	status = get_next_index(lttng_live, stream, &index);
+	if (status != BT_LTTNG_LIVE_ITERATOR_STATUS_OK) {
+		return false;
+	}
+
+	stream->base_offset = index.offset;
+	stream->offset = index.offset;
+	stream->len = index.packet_size / CHAR_BIT;
+	return index.offset == PACKET_SIZE && stream->len == PACKET_SIZE;
+}
+
+int main(int argc, char **argv)
+{
+	struct mock_relayd relayd;
+	struct lttng_live_component *lttng_live;
+	struct lttng_live_session session;
+	struct lttng_live_trace trace;
+	struct lttng_live_stream_iterator *stream_a, *stream_b;
+	char *url;
+
+	plan_tests(NR_TESTS);
+
+	if (mock_relayd_start(&relayd)) {
+		BAIL_OUT("Cannot start mock relay daemon");
+	}
+
+	lttng_live = g_new0(struct lttng_live_component, 1);
+	lttng_live->max_query_size = CHUNK_SIZE;
+	memset(&session, 0, sizeof(session));
+	session.lttng_live = lttng_live;
+	memset(&trace, 0, sizeof(trace));
+	trace.session = &session;
+
+	url = g_strdup_printf("net://127.0.0.1:%d", relayd.port);
+	lttng_live->viewer_connection =
+		bt_live_viewer_connection_create(url, lttng_live);
+	g_free(url);
+	if (!lttng_live->viewer_connection) {
+		BAIL_OUT("Cannot connect to mock relay daemon");
+	}
+	pass("Viewer connection is established");
+
+	stream_a = create_stream(&trace, 0);
+	stream_b = create_stream(&trace, 1);
+
+	/* Leaves requests of stream A pending while B is read. */
+	ok(read_stream(lttng_live, stream_a, CHUNK_SIZE),
+		"First chunk of stream A has the expected content");
+	ok(nr_data_again > 0,
+		"Getting stream bytes does not block until the reply is received");
+	ok(read_stream(lttng_live, stream_b, PACKET_SIZE),
+		"Packet of stream B has the expected content");
+	ok(read_stream(lttng_live, stream_a, PACKET_SIZE),
+		"Rest of stream A's packet has the expected content");
+
+	ok(next_index(lttng_live, stream_a),
+		"Next index of stream A is the expected one");
+	ok(stream_a->state == LTTNG_LIVE_STREAM_ACTIVE_DATA,
+		"Stream A has data after getting its next index");
+	ok(next_index(lttng_live, stream_b),
+		"Next index of stream B is the expected one");
+	ok(read_stream(lttng_live, stream_a, PACKET_SIZE),
+		"Second packet of stream A has the expected content");
+	ok(get_next_index(lttng_live, stream_a,
+		&(struct packet_index) { 0 }) ==
+			BT_LTTNG_LIVE_ITERATOR_STATUS_END,
+		"Stream A hangs up after its second packet");
+
+	destroy_stream(lttng_live, stream_a);
+	destroy_stream(lttng_live, stream_b);
+	bt_live_viewer_connection_destroy(lttng_live->viewer_connection);
+	g_free(lttng_live);
+	mock_relayd_join(&relayd);
+
+	ok(relayd.max_batched_get_packet > 1,
+		"GET_PACKET requests are pipelined (%u in a batch)",
+		relayd.max_batched_get_packet);
+	ok(relayd.nr_get_next_index[0] == 2 &&
+		relayd.nr_get_next_index[1] == 1 && relayd.nr_errors == 0,
+		"Each GET_NEXT_INDEX request is sent once, without protocol errors");
+
+	return exit_status();
+}